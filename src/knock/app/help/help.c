@@ -53,6 +53,8 @@ static void app_help_print_help(void) {
   printf("  \033[36m--no-encrypt\033[0m              Disable payload encryption\n");
   printf("  \033[36m--dead-drop\033[0m               Send raw payload without structure\n");
   printf("  \033[36m--fragment <count>\033[0m        Split the request into the requested number of fragments\n");
+  printf("  \033[36m--batch <action> <payload>\033[0m Add one action to a batch request (repeatable; host and user only)\n");
+  printf("  \033[36m--batch-stop-on-error\033[0m     Skip the rest of a batch after the first failed entry\n");
   printf("  \033[36m--send-from <ipv4>\033[0m       Bind outbound UDP sends to a local IPv4\n");
   printf("  \033[36m--verbose <level>\033[0m         Set log verbosity (0-5, default 3 = INFO)\n");
   printf("  \033[36m--log <file>\033[0m              Log output to specified file (optional)\n\n");
@@ -125,6 +127,7 @@ static void app_help_print_help(void) {
   printf("  program --protocol v4 localhost root login \"Hello World\"\n");
   printf("  program --protocol v4 --fragment 2 localhost root login \"Hello World\"\n");
   printf("  program --stdin localhost root login < input.txt\n");
+  printf("  program --protocol v4 --batch login \"\" --batch sync \"full\" localhost root\n");
   printf("  program --send-from 127.0.0.1 localhost root login \"Hello World\"\n");
   printf("  program --send-from-default localhost root 192.168.1.210\n");
   printf("  program --send-from-default-clear localhost root\n");
@@ -58,6 +58,8 @@ typedef struct {
   int dead_drop;
   int output_mode;
   int stdin_requested;
+  int batch_count;
+  uint8_t batch_flags;
 
   uint32_t user_id;
   uint32_t action_id;
@@ -15,6 +15,7 @@
 
 #include "../../lib.h"
 #include "../app.h"
+#include "../../../shared/shared.h"
 
 enum {
   OPT_ID_NONE = 0,
@@ -32,7 +33,9 @@ enum {
   OPT_ID_VERBOSE,
   OPT_ID_LOG,
   OPT_ID_STDIN,
-  OPT_ID_OUTPUT_MODE
+  OPT_ID_OUTPUT_MODE,
+  OPT_ID_BATCH,
+  OPT_ID_BATCH_STOP
 };
 
 static const ArgvOptionSpec option_specs[] = {
@@ -52,6 +55,8 @@ static const ArgvOptionSpec option_specs[] = {
   { "--verbose",     OPT_ID_VERBOSE,     1, ARGV_OPT_KEYED, 0, 0, 1 },
   { "--log",         OPT_ID_LOG,         1, ARGV_OPT_KEYED, 0, 0, 1 },
   { "--output-mode", OPT_ID_OUTPUT_MODE, 1, ARGV_OPT_KEYED, 0, 0, 1 },
+  { "--batch",       OPT_ID_BATCH,       2, ARGV_OPT_KEYED, 0, 1, 0 },
+  { "--batch-stop-on-error", OPT_ID_BATCH_STOP, 0, ARGV_OPT_FLAG, 0, 0, 1 },
   { NULL, 0, 0, ARGV_OPT_FLAG, 0, 0, 0 }
 };
 
@@ -192,11 +197,16 @@ static int app_opts_transmit_validate(Opts *opts, AppCommand *cmd) {
     valid = 0;
   }
 
-  if (opts->action_id == 0) {
+  if (opts->action_id == 0 && opts->batch_count == 0) {
     app_opts_transmit_set_error(cmd, 2, "Invalid or missing action ID");
     valid = 0;
   }
 
+  if (opts->batch_count > 0 && (opts->dead_drop || opts->stdin_requested)) {
+    app_opts_transmit_set_error(cmd, 2, "--batch cannot be combined with --dead-drop or --stdin");
+    valid = 0;
+  }
+
   if (opts->action_id > UINT8_MAX) {
     app_opts_transmit_set_error(cmd, 2, "Resolved action ID exceeds packet range (max 255)");
     valid = 0;
@@ -293,6 +303,86 @@ static int app_opts_transmit_validate(Opts *opts, AppCommand *cmd) {
   return valid;
 }
 
+static int app_opts_transmit_resolve_user(const char *host_str,
+                                          const char *user_str,
+                                          Opts *out,
+                                          AppCommand *cmd) {
+  char message[256];
+
+  strncpy(out->host, host_str, sizeof(out->host) - 1);
+  strncpy(out->user_selector, user_str, sizeof(out->user_selector) - 1);
+
+  out->user_id = app.alias.resolve_user(host_str, user_str);
+  if (out->user_id == 0) {
+    if (!app_opts_transmit_parse_numeric_id(user_str, 1, UINT16_MAX, &out->user_id)) {
+      snprintf(message, sizeof(message),
+               "Unknown user alias or invalid user ID: %s (expected alias or numeric range 1-%u)",
+               user_str, (unsigned)UINT16_MAX);
+      return app_opts_transmit_set_error(cmd, 2, message);
+    }
+  }
+
+  return 1;
+}
+
+/*
+ * Batch mode: host and user are positional, and each --batch <action>
+ * <payload> becomes one entry of a single signed request sent as action 0.
+ */
+static int app_opts_transmit_apply_batch(const ArgvParsed *parsed, Opts *out, AppCommand *cmd) {
+  char message[256];
+  size_t len = 0;
+
+  if (parsed->num_positionals != 2) {
+    return app_opts_transmit_set_error(cmd, 2,
+                                       "Batch mode takes exactly two positional arguments: host, user");
+  }
+
+  if (!app_opts_transmit_resolve_user(parsed->positionals[0], parsed->positionals[1], out, cmd)) {
+    return 0;
+  }
+
+  if (!shared.knock.batch.begin(out->payload, sizeof(out->payload), out->batch_flags, &len)) {
+    return app_opts_transmit_set_error(cmd, 2, "Failed to start batch payload");
+  }
+
+  for (int i = 0; i < parsed->num_options; i++) {
+    const ArgvParsedOption *opt = &parsed->options[i];
+    const char *action_str = NULL;
+    const char *payload = NULL;
+    uint32_t action_id = 0;
+
+    if (opt->spec->id != OPT_ID_BATCH) {
+      continue;
+    }
+
+    action_str = opt->args[1];
+    payload = opt->args[2] ? opt->args[2] : "";
+
+    action_id = app.alias.resolve_action(out->host, action_str);
+    if (action_id == 0 &&
+        !app_opts_transmit_parse_numeric_id(action_str, 1, UINT8_MAX, &action_id)) {
+      snprintf(message, sizeof(message),
+               "Unknown action alias or invalid action ID in --batch: %s", action_str);
+      return app_opts_transmit_set_error(cmd, 2, message);
+    }
+
+    if (action_id > UINT8_MAX ||
+        !shared.knock.batch.append(out->payload, sizeof(out->payload), &len,
+                                   (uint8_t)action_id,
+                                   (const uint8_t *)payload, strlen(payload))) {
+      snprintf(message, sizeof(message),
+               "Batch does not fit in one request (max %u entries, %u payload bytes)",
+               (unsigned)SL_KNOCK_BATCH_ENTRY_MAX, (unsigned)(MAX_PAYLOAD_SIZE - 1));
+      return app_opts_transmit_set_error(cmd, 2, message);
+    }
+  }
+
+  out->action_id = SL_KNOCK_BATCH_ACTION_ID;
+  out->payload_len = len;
+  return 1;
+}
+
 static int app_opts_transmit_apply_parsed(const ArgvParsed *parsed, Opts *out, AppCommand *cmd) {
   ArgvError parse_err = {0};
   char message[256];
@@ -374,6 +464,12 @@ static int app_opts_transmit_apply_parsed(const ArgvParsed *parsed, Opts *out, A
     case OPT_ID_STDIN:
       out->stdin_requested = 1;
       break;
+    case OPT_ID_BATCH:
+      out->batch_count++;
+      break;
+    case OPT_ID_BATCH_STOP:
+      out->batch_flags |= SL_KNOCK_BATCH_FLAG_STOP_ON_ERROR;
+      break;
     case OPT_ID_OUTPUT_MODE: {
       static const ArgvEnumMap output_mode_map[] = {
         { "unicode", SL_OUTPUT_MODE_UNICODE },
@@ -398,6 +494,10 @@ static int app_opts_transmit_apply_parsed(const ArgvParsed *parsed, Opts *out, A
     }
   }
 
+  if (out->batch_count > 0) {
+    return app_opts_transmit_apply_batch(parsed, out, cmd);
+  }
+
   if (parsed->num_positionals < 3) {
     return app_opts_transmit_set_error(cmd, 2,
                                        "Missing required positional arguments: host, user, action");
@@ -408,17 +508,8 @@ static int app_opts_transmit_apply_parsed(const ArgvParsed *parsed, Opts *out, A
     const char *user_str = parsed->positionals[1];
     const char *action_str = parsed->positionals[2];
 
-    strncpy(out->host, host_str, sizeof(out->host) - 1);
-    strncpy(out->user_selector, user_str, sizeof(out->user_selector) - 1);
-
-    out->user_id = app.alias.resolve_user(host_str, user_str);
-    if (out->user_id == 0) {
-      if (!app_opts_transmit_parse_numeric_id(user_str, 1, UINT16_MAX, &out->user_id)) {
-        snprintf(message, sizeof(message),
-                 "Unknown user alias or invalid user ID: %s (expected alias or numeric range 1-%u)",
-                 user_str, (unsigned)UINT16_MAX);
-        return app_opts_transmit_set_error(cmd, 2, message);
-      }
+    if (!app_opts_transmit_resolve_user(host_str, user_str, out, cmd)) {
+      return 0;
     }
 
     out->action_id = app.alias.resolve_action(host_str, action_str);
@@ -481,6 +572,10 @@ static void app_opts_transmit_dump(const Opts *opts) {
   lib.print.uc_printf(NULL, "\nUser and Action:\n");
   lib.print.uc_printf(NULL, "  User ID          : %u\n", opts->user_id);
   lib.print.uc_printf(NULL, "  Action ID        : %u\n", opts->action_id);
+  if (opts->batch_count > 0) {
+    lib.print.uc_printf(NULL, "  Batch Entries    : %d (flags 0x%02x)\n",
+                        opts->batch_count, (unsigned)opts->batch_flags);
+  }
 
   lib.print.uc_printf(NULL, "\nPayload (%zu bytes):\n", opts->payload_len);
   if (opts->payload_len > 0) {
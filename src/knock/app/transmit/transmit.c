@@ -24,6 +24,36 @@
 
 #define KNOCKER_RESPONSE_TIMEOUT_MS 1500
 #define KNOCKER_RESPONSE_BUFFER_SIZE SHARED_KNOCK_CODEC_PACKET_MAX_SIZE
+/* out_status for a streamed output chunk; the final reply sets the real one. */
+#define KNOCKER_RESPONSE_STATUS_MORE -1
+
+/* Chunks a streamed reply may run ahead of the next one still missing. */
+#define KNOCKER_STREAM_WINDOW 64u
+
+/* Last streamed chunk did not end in a newline. */
+static int app_transmit_response_open_line = 0;
+
+/*
+ * Streamed output arrives as separate UDP packets numbered from 1. Chunks
+ * ahead of the next expected one wait here, and the final status waits until
+ * every chunk it counts has been written or the response window closes.
+ */
+typedef struct {
+  uint32_t next_seq;
+  uint32_t high_seq;
+  uint32_t total;
+  uint32_t lost;
+  int finished;
+  uint32_t held_seq[KNOCKER_STREAM_WINDOW];
+  size_t held_len[KNOCKER_STREAM_WINDOW];
+  uint8_t held[KNOCKER_STREAM_WINDOW][KNOCKER_RESPONSE_BUFFER_SIZE];
+  size_t final_len;
+  uint8_t final[KNOCKER_RESPONSE_BUFFER_SIZE];
+} AppTransmitStream;
+
+static AppTransmitStream app_transmit_stream = { .next_seq = 1u };
+/* The request was a batch envelope; its reply holds one line per entry. */
+static int app_transmit_response_batch = 0;
 
 #define FAIL_SINGLE_PACKET(...)                                                \
   if (1) {                                                                     \
@@ -115,30 +145,103 @@ static const char *app_transmit_protocol_name(KnockProtocol protocol) {
   }
 }
 
-static int app_transmit_response_print_payload(const uint8_t *payload,
-                                              size_t payload_len,
-                                              int *out_status) {
-  const char *status_name = "UNKNOWN";
-  char text[KNOCKER_RESPONSE_BUFFER_SIZE] = {0};
-  uint8_t status = 0;
-  uint8_t flags = 0;
-  size_t text_len = 0;
+static void app_transmit_stream_reset(void) {
+  memset(app_transmit_stream.held_seq, 0, sizeof(app_transmit_stream.held_seq));
+  app_transmit_stream.next_seq = 1u;
+  app_transmit_stream.high_seq = 0u;
+  app_transmit_stream.total = 0u;
+  app_transmit_stream.lost = 0u;
+  app_transmit_stream.finished = 0;
+  app_transmit_stream.final_len = 0u;
+}
 
-  if (!payload || !out_status) {
-    return 0;
+static uint32_t app_transmit_stream_get_seq(const uint8_t *in) {
+  return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) |
+         ((uint32_t)in[2] << 8) | (uint32_t)in[3];
+}
+
+static void app_transmit_stream_write(const uint8_t *text, size_t text_len) {
+  if (text_len == 0u) {
+    return;
   }
 
-  if (payload_len < SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE) {
-    if (lib.log.emit) {
-      lib.log.emit(LOG_ERROR, 1, "Received response packet with short payload (%u bytes)\n",
-                   (unsigned int)payload_len);
+  (void)fwrite(text, 1u, text_len, stdout);
+  fflush(stdout);
+  app_transmit_response_open_line = text[text_len - 1u] != '\n';
+}
+
+/* Write every chunk before upto, held or not; the ones never seen are lost. */
+static void app_transmit_stream_advance(uint32_t upto) {
+  AppTransmitStream *stream = &app_transmit_stream;
+
+  while (stream->next_seq < upto) {
+    size_t slot = stream->next_seq % KNOCKER_STREAM_WINDOW;
+
+    if (stream->held_seq[slot] == stream->next_seq) {
+      app_transmit_stream_write(stream->held[slot], stream->held_len[slot]);
+      stream->held_seq[slot] = 0u;
+    } else {
+      stream->lost++;
     }
-    return 0;
+    stream->next_seq++;
   }
+}
 
-  status = payload[0];
-  flags = payload[2];
-  text_len = payload_len - SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE;
+/* Write the held chunks that now follow on from what was written. */
+static void app_transmit_stream_flush_held(void) {
+  AppTransmitStream *stream = &app_transmit_stream;
+  size_t slot = stream->next_seq % KNOCKER_STREAM_WINDOW;
+
+  while (stream->held_seq[slot] == stream->next_seq) {
+    app_transmit_stream_write(stream->held[slot], stream->held_len[slot]);
+    stream->held_seq[slot] = 0u;
+    stream->next_seq++;
+    slot = stream->next_seq % KNOCKER_STREAM_WINDOW;
+  }
+}
+
+static void app_transmit_stream_chunk(uint32_t seq, const uint8_t *text, size_t text_len) {
+  AppTransmitStream *stream = &app_transmit_stream;
+  size_t slot = seq % KNOCKER_STREAM_WINDOW;
+
+  /* A duplicate of something already written. */
+  if (seq < stream->next_seq || text_len > KNOCKER_RESPONSE_BUFFER_SIZE) {
+    return;
+  }
+
+  if (seq > stream->high_seq) {
+    stream->high_seq = seq;
+  }
+
+  /* Too far ahead to hold: give up on the oldest missing chunks. */
+  if (seq - stream->next_seq >= KNOCKER_STREAM_WINDOW) {
+    app_transmit_stream_advance(seq - KNOCKER_STREAM_WINDOW + 1u);
+  }
+
+  if (seq == stream->next_seq) {
+    app_transmit_stream_write(text, text_len);
+    stream->next_seq++;
+  } else {
+    memcpy(stream->held[slot], text, text_len);
+    stream->held_len[slot] = text_len;
+    stream->held_seq[slot] = seq;
+  }
+
+  app_transmit_stream_flush_held();
+}
+
+static int app_transmit_response_print_status(uint8_t status,
+                                              uint8_t flags,
+                                              const uint8_t *body,
+                                              size_t text_len,
+                                              int *out_status) {
+  const char *status_name = "UNKNOWN";
+  char text[KNOCKER_RESPONSE_BUFFER_SIZE] = {0};
+
+  if (app_transmit_response_open_line) {
+    fputc('\n', stdout);
+    app_transmit_response_open_line = 0;
+  }
 
   switch (status) {
     case SL_KNOCK_RESPONSE_STATUS_OK:
@@ -157,9 +260,26 @@ static int app_transmit_response_print_payload(const uint8_t *payload,
       return 0;
   }
 
-  app_transmit_response_copy_text(text, sizeof(text),
-                                  payload + SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE,
-                                  text_len);
+  if (app_transmit_response_batch) {
+    const uint8_t *line = body;
+    const uint8_t *end = line + text_len;
+
+    lib.print.uc_printf(NULL, "%s batch%s\n", status_name,
+                        (flags & SL_KNOCK_RESPONSE_FLAG_TRUNCATED) ? " [truncated]" : "");
+    while (line < end) {
+      const uint8_t *eol = (const uint8_t *)memchr(line, '\n', (size_t)(end - line));
+      size_t line_len = eol ? (size_t)(eol - line) : (size_t)(end - line);
+
+      app_transmit_response_copy_text(text, sizeof(text), line, line_len);
+      if (text[0] != '\0') {
+        lib.print.uc_printf(NULL, "  %s\n", text);
+      }
+      line += line_len + (eol ? 1u : 0u);
+    }
+    return 1;
+  }
+
+  app_transmit_response_copy_text(text, sizeof(text), body, text_len);
 
   if (text[0] != '\0') {
     if (flags & SL_KNOCK_RESPONSE_FLAG_TRUNCATED) {
@@ -176,6 +296,147 @@ static int app_transmit_response_print_payload(const uint8_t *payload,
   return 1;
 }
 
+/*
+ * Print a final status held back for missing chunks. With force, whatever is
+ * still missing is given up on and reported. Leaves out_status alone while
+ * the status is still waiting.
+ */
+static int app_transmit_stream_finish(int force, int *out_status) {
+  AppTransmitStream *stream = &app_transmit_stream;
+  const uint8_t *final = stream->final;
+  int ok = 1;
+
+  if (force) {
+    app_transmit_stream_advance((stream->total > stream->high_seq ? stream->total
+                                                                   : stream->high_seq) + 1u);
+  } else if (stream->final_len == 0u || stream->next_seq <= stream->total) {
+    return 1;
+  }
+
+  if (stream->final_len > 0u) {
+    ok = app_transmit_response_print_status(
+        final[0],
+        final[2],
+        final + SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE + SL_KNOCK_RESPONSE_SEQ_SIZE,
+        stream->final_len - SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE - SL_KNOCK_RESPONSE_SEQ_SIZE,
+        out_status);
+    stream->final_len = 0u;
+    stream->finished = 1;
+  } else if (force && !stream->finished && stream->high_seq > 0u && lib.log.emit) {
+    if (app_transmit_response_open_line) {
+      fputc('\n', stdout);
+      app_transmit_response_open_line = 0;
+    }
+    lib.log.emit(LOG_ERROR, 1, "Streamed output ended without a final status\n");
+  }
+
+  if (stream->lost > 0u) {
+    if (lib.log.emit) {
+      lib.log.emit(LOG_ERROR, 1, "Output incomplete: %u of %u chunks lost\n",
+                   (unsigned int)stream->lost,
+                   (unsigned int)(stream->next_seq - 1u));
+    }
+    stream->lost = 0u;
+    *out_status = 2;
+  }
+
+  return ok;
+}
+
+static int app_transmit_response_print_payload(const uint8_t *payload,
+                                              size_t payload_len,
+                                              int *out_status) {
+  const uint8_t *text = NULL;
+  uint8_t status = 0;
+  uint8_t flags = 0;
+  uint32_t seq = 0;
+  size_t text_len = 0;
+
+  if (!payload || !out_status) {
+    return 0;
+  }
+
+  if (payload_len < SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE) {
+    if (lib.log.emit) {
+      lib.log.emit(LOG_ERROR, 1, "Received response packet with short payload (%u bytes)\n",
+                   (unsigned int)payload_len);
+    }
+    return 0;
+  }
+
+  status = payload[0];
+  flags = payload[2];
+  text = payload + SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE;
+  text_len = payload_len - SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE;
+
+  /* A bundle is several whole responses in one packet; print each in order. */
+  if (flags & SL_KNOCK_RESPONSE_FLAG_BUNDLE) {
+    const uint8_t *entry = payload + SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE;
+    const uint8_t *end = payload + payload_len;
+
+    *out_status = KNOCKER_RESPONSE_STATUS_MORE;
+    while ((size_t)(end - entry) >= SL_KNOCK_RESPONSE_BUNDLE_ENTRY_HEADER_SIZE) {
+      size_t entry_len = ((size_t)entry[0] << 8) | (size_t)entry[1];
+
+      entry += SL_KNOCK_RESPONSE_BUNDLE_ENTRY_HEADER_SIZE;
+      if (entry_len > (size_t)(end - entry) ||
+          (entry_len >= SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE &&
+           (entry[2] & SL_KNOCK_RESPONSE_FLAG_BUNDLE))) {
+        break;
+      }
+
+      if (!app_transmit_response_print_payload(entry, entry_len, out_status)) {
+        return 0;
+      }
+      entry += entry_len;
+    }
+
+    if (entry != end) {
+      if (lib.log.emit) {
+        lib.log.emit(LOG_ERROR, 1, "Received malformed bundled response (%u bytes)\n",
+                     (unsigned int)payload_len);
+      }
+      return 0;
+    }
+    return 1;
+  }
+
+  if (flags & SL_KNOCK_RESPONSE_FLAG_SEQ) {
+    if (text_len < SL_KNOCK_RESPONSE_SEQ_SIZE) {
+      if (lib.log.emit) {
+        lib.log.emit(LOG_ERROR, 1, "Received streamed response without a sequence number\n");
+      }
+      return 0;
+    }
+    seq = app_transmit_stream_get_seq(text);
+    text += SL_KNOCK_RESPONSE_SEQ_SIZE;
+    text_len -= SL_KNOCK_RESPONSE_SEQ_SIZE;
+  }
+
+  /* Streamed output is written in sequence order, ahead of the status line. */
+  if ((flags & SL_KNOCK_RESPONSE_FLAG_MORE) && status == SL_KNOCK_RESPONSE_STATUS_OK) {
+    *out_status = KNOCKER_RESPONSE_STATUS_MORE;
+    if (flags & SL_KNOCK_RESPONSE_FLAG_SEQ) {
+      app_transmit_stream_chunk(seq, text, text_len);
+      return app_transmit_stream_finish(0, out_status);
+    }
+
+    app_transmit_stream_write(text, text_len);
+    return 1;
+  }
+
+  /* The final status counts the chunks; hold it until they are all out. */
+  if ((flags & SL_KNOCK_RESPONSE_FLAG_SEQ) && payload_len <= sizeof(app_transmit_stream.final)) {
+    memcpy(app_transmit_stream.final, payload, payload_len);
+    app_transmit_stream.final_len = payload_len;
+    app_transmit_stream.total = seq;
+    *out_status = KNOCKER_RESPONSE_STATUS_MORE;
+    return app_transmit_stream_finish(0, out_status);
+  }
+
+  return app_transmit_response_print_status(status, flags, text, text_len, out_status);
+}
+
 static int app_transmit_response_print(const KnockPacket *reply_pkt, int *out_status) {
   if (!reply_pkt) {
     return 0;
@@ -917,6 +1178,8 @@ static int app_transmit_single_packet_m7mux(const Opts *opts) {
 
   runtime_opts = *opts;
   effective = &runtime_opts;
+  app_transmit_response_batch = effective->action_id == SL_KNOCK_BATCH_ACTION_ID;
+  app_transmit_stream_reset();
 
   do {
     if (!app_transmit_resolve_payload(&runtime_opts)) {
@@ -1071,6 +1334,10 @@ static int app_transmit_single_packet_m7mux(const Opts *opts) {
         uint64_t remaining_ms = 0u;
 
         if (now_ms >= response_deadline) {
+          /* Whatever streamed output is still missing is not coming. */
+          if (!app_transmit_stream_finish(1, &status)) {
+            status = 1;
+          }
           break;
         }
 
@@ -1100,6 +1367,17 @@ static int app_transmit_single_packet_m7mux(const Opts *opts) {
             FAIL_SINGLE_PACKET("Failed to process mux response\n");
           }
 
+          /* Streamed replies on v1-v3 arrive one synthetic session apiece. */
+          if (reply.synthetic_session) {
+            (void)lib.m7mux.inbox.release(mux_state, reply.session_id);
+          }
+
+          /* More output is on its way; give it a fresh response window. */
+          if (response_status == KNOCKER_RESPONSE_STATUS_MORE) {
+            response_deadline = lib.time.monotonic_ms() + KNOCKER_RESPONSE_TIMEOUT_MS;
+            continue;
+          }
+
           status = response_status;
         }
       }
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "batch.h"
+
+#include <string.h>
+
+static int shared_knock_batch_begin(uint8_t *buf, size_t cap, uint8_t flags, size_t *out_len) {
+  if (!buf || !out_len || cap < SL_KNOCK_BATCH_HEADER_SIZE) {
+    return 0;
+  }
+
+  buf[0] = SL_KNOCK_BATCH_VERSION;
+  buf[1] = flags;
+  buf[2] = 0u;
+  *out_len = SL_KNOCK_BATCH_HEADER_SIZE;
+  return 1;
+}
+
+static int shared_knock_batch_append(uint8_t *buf,
+                                     size_t cap,
+                                     size_t *inout_len,
+                                     uint8_t action_id,
+                                     const uint8_t *payload,
+                                     size_t payload_len) {
+  size_t offset = 0;
+
+  if (!buf || !inout_len || *inout_len < SL_KNOCK_BATCH_HEADER_SIZE ||
+      action_id == SL_KNOCK_BATCH_ACTION_ID || (payload_len > 0u && !payload)) {
+    return 0;
+  }
+
+  if (buf[2] >= SL_KNOCK_BATCH_ENTRY_MAX || payload_len > UINT16_MAX) {
+    return 0;
+  }
+
+  offset = *inout_len;
+  if (offset > cap || cap - offset < SL_KNOCK_BATCH_ENTRY_HEADER_SIZE + payload_len) {
+    return 0;
+  }
+
+  buf[offset] = action_id;
+  buf[offset + 1u] = (uint8_t)((payload_len >> 8) & 0xFFu);
+  buf[offset + 2u] = (uint8_t)(payload_len & 0xFFu);
+  if (payload_len > 0u) {
+    memcpy(buf + offset + SL_KNOCK_BATCH_ENTRY_HEADER_SIZE, payload, payload_len);
+  }
+
+  buf[2]++;
+  *inout_len = offset + SL_KNOCK_BATCH_ENTRY_HEADER_SIZE + payload_len;
+  return 1;
+}
+
+/*
+ * Split an envelope into entries. The view points into buf, so buf must
+ * outlive it. Trailing bytes, a zero count or an entry that runs past the
+ * end reject the whole batch.
+ */
+static int shared_knock_batch_parse(const uint8_t *buf, size_t len, SharedKnockBatchView *out) {
+  size_t offset = SL_KNOCK_BATCH_HEADER_SIZE;
+  size_t count = 0;
+  size_t i = 0;
+
+  if (!buf || !out || len < SL_KNOCK_BATCH_HEADER_SIZE) {
+    return 0;
+  }
+
+  memset(out, 0, sizeof(*out));
+
+  if (buf[0] != SL_KNOCK_BATCH_VERSION) {
+    return 0;
+  }
+
+  count = buf[2];
+  if (count == 0u || count > SL_KNOCK_BATCH_ENTRY_MAX) {
+    return 0;
+  }
+
+  for (i = 0; i < count; ++i) {
+    SharedKnockBatchEntry *entry = &out->entries[i];
+    size_t payload_len = 0;
+
+    if (len - offset < SL_KNOCK_BATCH_ENTRY_HEADER_SIZE) {
+      return 0;
+    }
+
+    payload_len = ((size_t)buf[offset + 1u] << 8) | (size_t)buf[offset + 2u];
+    offset += SL_KNOCK_BATCH_ENTRY_HEADER_SIZE;
+    if (len - offset < payload_len) {
+      return 0;
+    }
+
+    entry->action_id = buf[offset - SL_KNOCK_BATCH_ENTRY_HEADER_SIZE];
+    entry->payload = payload_len > 0u ? buf + offset : NULL;
+    entry->payload_len = payload_len;
+    offset += payload_len;
+  }
+
+  if (offset != len) {
+    return 0;
+  }
+
+  out->flags = buf[1];
+  out->count = count;
+  return 1;
+}
+
+static const SharedKnockBatchLib shared_knock_batch_lib = {
+  .begin = shared_knock_batch_begin,
+  .append = shared_knock_batch_append,
+  .parse = shared_knock_batch_parse
+};
+
+const SharedKnockBatchLib *get_shared_knock_batch_lib(void) {
+  return &shared_knock_batch_lib;
+}
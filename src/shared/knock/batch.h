@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef SIGLATCH_SHARED_KNOCK_BATCH_H
+#define SIGLATCH_SHARED_KNOCK_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Batch requests carry several (action_id, payload) entries under one
+ * encrypted, signed knock. The request goes out with action_id = 0, which no
+ * configured action can use, and the envelope below as its payload.
+ *
+ * Envelope layout:
+ *   byte 0: version (SL_KNOCK_BATCH_VERSION)
+ *   byte 1: flags
+ *   byte 2: entry count (1..SL_KNOCK_BATCH_ENTRY_MAX)
+ *   then per entry:
+ *     byte 0:    action id
+ *     byte 1..2: payload length (big-endian)
+ *     byte 3..n: payload bytes
+ *
+ * The daemon answers with one ordinary response whose text holds one line
+ * per entry.
+ */
+
+#define SL_KNOCK_BATCH_ACTION_ID 0
+
+#define SL_KNOCK_BATCH_VERSION 1u
+#define SL_KNOCK_BATCH_ENTRY_MAX 16u
+#define SL_KNOCK_BATCH_HEADER_SIZE 3u
+#define SL_KNOCK_BATCH_ENTRY_HEADER_SIZE 3u
+
+/* Skip the remaining entries once one fails. */
+#define SL_KNOCK_BATCH_FLAG_STOP_ON_ERROR 0x01u
+
+typedef struct {
+  uint8_t action_id;
+  const uint8_t *payload;
+  size_t payload_len;
+} SharedKnockBatchEntry;
+
+typedef struct {
+  uint8_t flags;
+  size_t count;
+  SharedKnockBatchEntry entries[SL_KNOCK_BATCH_ENTRY_MAX];
+} SharedKnockBatchView;
+
+typedef struct {
+  int (*begin)(uint8_t *buf, size_t cap, uint8_t flags, size_t *out_len);
+  int (*append)(uint8_t *buf,
+                size_t cap,
+                size_t *inout_len,
+                uint8_t action_id,
+                const uint8_t *payload,
+                size_t payload_len);
+  int (*parse)(const uint8_t *buf, size_t len, SharedKnockBatchView *out);
+} SharedKnockBatchLib;
+
+const SharedKnockBatchLib *get_shared_knock_batch_lib(void);
+
+#endif /* SIGLATCH_SHARED_KNOCK_BATCH_H */
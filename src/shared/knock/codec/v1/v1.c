@@ -17,6 +17,7 @@
 #include "../../../knock/response.h"
 #include "../../digest.h"
 #include "../../../../stdlib/nonce.h"
+#include "../../../../stdlib/arena.h"
 #include "../../../../stdlib/openssl/rsa/rsa.h"
 #include "../../../../stdlib/openssl/session/session.h"
 #include "v1_packet.h"
@@ -27,6 +28,7 @@
 struct SharedKnockCodecV1State {
   NonceCache nonce;
   int nonce_ready;
+  Arena scratch;
 };
 
 static const SharedKnockCodecContext *g_context = NULL;
@@ -361,6 +363,7 @@ int shared_knock_codec_v1_create_state(void **out_state_) {
   if (!state) {
     return 0;
   }
+  lib_arena_arena_init(&state->scratch, 0u);
 
   if (!shared_knock_codec_v1_sync_nonce_cache(state)) {
     shared_knock_codec_v1_destroy_state(state);
@@ -384,6 +387,7 @@ void shared_knock_codec_v1_destroy_state(void *state_) {
     state->nonce_ready = 0;
   }
 
+  lib_arena_arena_release(&state->scratch);
   free(state);
 }
 
@@ -414,6 +418,17 @@ void shared_knock_codec_v1_shutdown(void) {
   g_context = NULL;
 }
 
+/*
+ * Decrypt scratch for one detect/decode call, reset on every call. Callers
+ * hand the state in as const; the scratch arena is the only part that moves.
+ */
+static uint8_t *shared_knock_codec_v1_scratch(const SharedKnockCodecV1State *state, size_t len) {
+  Arena *scratch = (Arena *)&state->scratch;
+
+  lib_arena_reset(scratch);
+  return (uint8_t *)lib_arena_calloc(scratch, 1u, len);
+}
+
 int shared_knock_codec_v1_detect(const void *state_,
                                  const struct M7MuxIngress *ingress,
                                  M7MuxIngressIdentity *identity) {
@@ -449,7 +464,7 @@ int shared_knock_codec_v1_detect(const void *state_,
     return 0;
   }
   {
-    uint8_t *decrypted_buf = (uint8_t *)calloc(1u, decrypted_cap);
+    uint8_t *decrypted_buf = shared_knock_codec_v1_scratch(state, decrypted_cap);
     size_t decrypted_len = decrypted_cap;
     int ok = 0;
 
@@ -462,21 +477,16 @@ int shared_knock_codec_v1_detect(const void *state_,
                                                 decrypted_buf,
                                                 &decrypted_len);
     if (!ok) {
-      free(decrypted_buf);
       return 0;
     }
 
     if (decrypted_len != SHARED_KNOCK_CODEC_V1_PACKET_SIZE) {
-      free(decrypted_buf);
       return 0;
     }
 
     if (shared_knock_codec_v1_deserialize_wire(decrypted_buf, decrypted_len, &pkt) != SL_PAYLOAD_OK) {
-      free(decrypted_buf);
       return 0;
     }
-
-    free(decrypted_buf);
   }
 
   if (identity) {
@@ -546,7 +556,7 @@ int shared_knock_codec_v1_decode(const void *state_,
       return 0;
     }
     {
-      uint8_t *decrypted_buf = (uint8_t *)calloc(1u, decrypted_cap);
+      uint8_t *decrypted_buf = shared_knock_codec_v1_scratch(state, decrypted_cap);
       size_t decrypted_len = decrypted_cap;
 
       if (!decrypted_buf) {
@@ -556,17 +566,14 @@ int shared_knock_codec_v1_decode(const void *state_,
                                                   buflen,
                                                   decrypted_buf,
                                                   &decrypted_len)) {
-        free(decrypted_buf);
         return 0;
       }
       payload = decrypted_buf;
       payload_len = decrypted_len;
       rc = shared_knock_codec_v1_normalize(payload, payload_len, ip, client_port, should_decrypt, out);
       if (rc != SL_PAYLOAD_OK) {
-        free(decrypted_buf);
         return 0;
       }
-      free(decrypted_buf);
       return 1;
     }
   }
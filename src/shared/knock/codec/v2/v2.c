@@ -18,6 +18,7 @@
 #include "../../response.h"
 #include "../../digest.h"
 #include "../../../../stdlib/nonce.h"
+#include "../../../../stdlib/arena.h"
 #include "../../../../stdlib/openssl/rsa/rsa.h"
 #include "v2_form1.h"
 
@@ -50,6 +51,7 @@ static void shared_knock_codec_v2_write_u32_be(uint8_t *dst, uint32_t value) {
 struct SharedKnockCodecV2State {
   NonceCache nonce;
   int nonce_ready;
+  Arena scratch;
 };
 
 static const SharedKnockCodecContext *g_context = NULL;
@@ -539,6 +541,7 @@ int shared_knock_codec_v2_create_state(void **out_state_) {
   if (!state) {
     return 0;
   }
+  lib_arena_arena_init(&state->scratch, 0u);
 
   if (!shared_knock_codec_v2_sync_nonce_cache(state)) {
     shared_knock_codec_v2_destroy_state(state);
@@ -562,6 +565,7 @@ void shared_knock_codec_v2_destroy_state(void *state_) {
     state->nonce_ready = 0;
   }
 
+  lib_arena_arena_release(&state->scratch);
   free(state);
 }
 
@@ -592,6 +596,17 @@ void shared_knock_codec_v2_shutdown(void) {
   g_context = NULL;
 }
 
+/*
+ * Decrypt scratch for one detect/decode call, reset on every call. Callers
+ * hand the state in as const; the scratch arena is the only part that moves.
+ */
+static uint8_t *shared_knock_codec_v2_scratch(const SharedKnockCodecV2State *state, size_t len) {
+  Arena *scratch = (Arena *)&state->scratch;
+
+  lib_arena_reset(scratch);
+  return (uint8_t *)lib_arena_calloc(scratch, 1u, len);
+}
+
 int shared_knock_codec_v2_detect(const void *state_,
                                  const struct M7MuxIngress *ingress,
                                  M7MuxIngressIdentity *identity) {
@@ -630,7 +645,7 @@ int shared_knock_codec_v2_detect(const void *state_,
     return 0;
   }
   {
-    uint8_t *decrypted = (uint8_t *)calloc(1u, decrypted_cap);
+    uint8_t *decrypted = shared_knock_codec_v2_scratch(state, decrypted_cap);
     size_t decrypted_len = decrypted_cap;
 
     if (!decrypted) {
@@ -638,21 +653,16 @@ int shared_knock_codec_v2_detect(const void *state_,
     }
 
     if (!shared_knock_codec_v2_private_decrypt(buf, buflen, decrypted, &decrypted_len)) {
-      free(decrypted);
       return 0;
     }
 
     if (decrypted_len != SHARED_KNOCK_CODEC_V2_FORM1_PACKET_SIZE) {
-      free(decrypted);
       return 0;
     }
 
     if (shared_knock_codec_v2_deserialize_wire(decrypted, decrypted_len, &pkt) != SL_PAYLOAD_OK) {
-      free(decrypted);
       return 0;
     }
-
-    free(decrypted);
   }
 
   if (identity) {
@@ -726,7 +736,7 @@ int shared_knock_codec_v2_decode(const void *state_,
     if (decrypted_cap == 0u) {
       return 0;
     }
-    decrypted_buf = (uint8_t *)calloc(1u, decrypted_cap);
+    decrypted_buf = shared_knock_codec_v2_scratch(state, decrypted_cap);
     if (!decrypted_buf) {
       return 0;
     }
@@ -735,7 +745,6 @@ int shared_knock_codec_v2_decode(const void *state_,
                                                 buflen,
                                                 decrypted_buf,
                                                 &decrypted_len)) {
-      free(decrypted_buf);
       return 0;
     }
     payload = decrypted_buf;
@@ -748,16 +757,9 @@ int shared_knock_codec_v2_decode(const void *state_,
 
   rc = shared_knock_codec_v2_normalize(payload, payload_len, ip, client_port, should_decrypt, out);
   if (rc != SL_PAYLOAD_OK) {
-    if (should_decrypt) {
-      free((void *)payload);
-    }
     return 0;
   }
 
-  if (should_decrypt) {
-    free((void *)payload);
-  }
-
   return 1;
 }
 
@@ -24,8 +24,28 @@
 #define SL_KNOCK_RESPONSE_STATUS_ERROR 2
 
 #define SL_KNOCK_RESPONSE_FLAG_TRUNCATED 0x01
+/*
+ * More packets follow for this request. The text is a raw slice of the
+ * action's output; the final packet (without this flag) carries the status.
+ */
+#define SL_KNOCK_RESPONSE_FLAG_MORE      0x02
+/*
+ * The text is a run of whole responses for the same request stream, each as
+ * a 2-byte big-endian length followed by its own header and text. The outer
+ * header repeats the status and MORE flag of the last one.
+ */
+#define SL_KNOCK_RESPONSE_FLAG_BUNDLE    0x04
+/*
+ * The text starts with a 4-byte big-endian number. On a MORE packet it is
+ * the chunk's sequence number, counting from 1; on the final packet it is
+ * how many chunks were sent before it. The client reorders chunks by it and
+ * can tell when some never arrived.
+ */
+#define SL_KNOCK_RESPONSE_FLAG_SEQ       0x08
 
 #define SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE 3
+#define SL_KNOCK_RESPONSE_BUNDLE_ENTRY_HEADER_SIZE 2
+#define SL_KNOCK_RESPONSE_SEQ_SIZE 4
 
 typedef struct __attribute__((packed)) {
   uint8_t status;
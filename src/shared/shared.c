@@ -9,6 +9,7 @@
 
 Shared shared = {
   .knock = {
+    .batch = {0},
     .codec = {0},
     .debug = {0},
     .detect = {0},
@@ -31,12 +32,14 @@ int init_shared(const SharedContext *ctx) {
     return 0;
   }
 
+  shared.knock.batch = *get_shared_knock_batch_lib();
   shared.knock.codec = *get_shared_knock_codec_lib();
   shared.knock.debug = *get_shared_knock_debug_lib();
   shared.knock.detect = *get_shared_knock_detect_lib();
   shared.knock.digest = *get_shared_knock_digest_lib();
 
-  if (!shared.knock.codec.context.init || !shared.knock.codec.context.shutdown ||
+  if (!shared.knock.batch.begin || !shared.knock.batch.append || !shared.knock.batch.parse ||
+      !shared.knock.codec.context.init || !shared.knock.codec.context.shutdown ||
       !shared.knock.codec.context.create || !shared.knock.codec.context.destroy ||
       !shared.knock.codec.context.set_server_key || !shared.knock.codec.context.clear_server_key ||
       !shared.knock.codec.context.set_openssl_session || !shared.knock.codec.context.clear_openssl_session ||
@@ -9,6 +9,7 @@
 #include "../stdlib/log.h"
 #include "../stdlib/openssl/openssl.h"
 #include "../stdlib/print.h"
+#include "knock/batch.h"
 #include "knock/codec/codec.h"
 #include "knock/debug.h"
 #include "knock/detect.h"
@@ -21,6 +22,7 @@ typedef struct {
 } SharedContext;
 
 typedef struct {
+  SharedKnockBatchLib batch;
   SharedCodecLib codec;
   SharedKnockDebugLib debug;
   SharedKnockDetectLib detect;
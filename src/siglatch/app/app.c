@@ -34,9 +34,13 @@ int init_app(void) {
   int daemon_initialized = 0;
   int daemon_helper_initialized = 0;
   int daemon_auth_initialized = 0;
+  int daemon_batch_initialized = 0;
+  int daemon_cache_initialized = 0;
   int daemon_request_initialized = 0;
   int daemon_policy_initialized = 0;
   int daemon_payload_initialized = 0;
+  int daemon_stream_initialized = 0;
+  int daemon_executor_initialized = 0;
   int help_initialized = 0;
   int inbound_initialized = 0;
   int keys_initialized = 0;
@@ -92,13 +96,14 @@ int init_app(void) {
       !app.builtin.version.init || !app.builtin.version.shutdown || !app.builtin.version.handle ||
       !app.builtin.test_blurt.init || !app.builtin.test_blurt.shutdown || !app.builtin.test_blurt.handle ||
       !app.config.init || !app.config.shutdown ||
-      !app.config.load || !app.config.load_detached ||
+      !app.config.load || !app.config.load_detached || !app.config.load_detached_reusing ||
       !app.config.consume || !app.config.unload ||
       !app.config.detach || !app.config.attach || !app.config.destroy ||
-      !app.config.get || !app.config.set_context ||
+      !app.config.get || !app.config.acquire || !app.config.release ||
+      !app.config.set_context ||
       !app.config.dump || !app.config.dump_ptr ||
       !app.config.deaddrop_starts_with_buffer ||
-      !app.config.action_available_by_user ||
+      !app.config.action_available_by_user || !app.config.user_action_granted ||
       !app.config.user_by_id || !app.config.user_by_id_from ||
       !app.config.action_by_id || !app.config.action_by_id_from ||
       !app.config.server_by_name || !app.config.server_by_name_from ||
@@ -108,9 +113,15 @@ int init_app(void) {
       !app.daemon.init || !app.daemon.shutdown || !app.daemon.process ||
       !app.daemon.helper.init || !app.daemon.helper.shutdown ||
       !app.daemon.helper.copy_job_reply_to_send ||
-      !app.daemon.helper.time_until_ms ||
+      !app.daemon.helper.time_until_ms || !app.daemon.helper.reply_payload_max ||
       !app.daemon.auth.init || !app.daemon.auth.shutdown ||
       !app.daemon.auth.authorize ||
+      !app.daemon.batch.init || !app.daemon.batch.shutdown ||
+      !app.daemon.batch.is_batch || !app.daemon.batch.prepare ||
+      !app.daemon.batch.lead_action || !app.daemon.batch.execute ||
+      !app.daemon.cache.init || !app.daemon.cache.shutdown ||
+      !app.daemon.cache.lookup || !app.daemon.cache.store ||
+      !app.daemon.cache.invalidate || !app.daemon.cache.stats ||
       !app.daemon.request.init || !app.daemon.request.shutdown ||
       !app.daemon.request.resolve_user_action ||
       !app.daemon.request.bind_user_action ||
@@ -119,24 +130,52 @@ int init_app(void) {
       !app.daemon.runner.init || !app.daemon.runner.shutdown || !app.daemon.runner.run ||
       !app.daemon.payload.init || !app.daemon.payload.shutdown ||
       !app.daemon.payload.consume ||
+      !app.daemon.payload.execute || !app.daemon.payload.complete ||
+      !app.daemon.payload.complete_chunk ||
+      !app.daemon.stream.init || !app.daemon.stream.shutdown ||
+      !app.daemon.stream.wants || !app.daemon.stream.drain ||
+      !app.daemon.stream.has_pending || !app.daemon.stream.feed ||
+      !app.daemon.stream.next_at || !app.daemon.stream.pump ||
+      !app.daemon.stream.reset ||
+      !app.daemon.executor.init || !app.daemon.executor.shutdown ||
+      !app.daemon.executor.start || !app.daemon.executor.stop ||
+      !app.daemon.executor.is_running || !app.daemon.executor.wake_fd ||
+      !app.daemon.executor.accepts || !app.daemon.executor.at_limit ||
+      !app.daemon.executor.submit || !app.daemon.executor.submit_deaddrop || !app.daemon.executor.emit ||
+      !app.daemon.executor.drain ||
+      !app.daemon.executor.in_flight ||
       !app.daemon.job.init || !app.daemon.job.shutdown ||
       !app.daemon.job.state_init || !app.daemon.job.state_reset ||
       !app.daemon.job.enqueue || !app.daemon.job.drain ||
+      !app.daemon.job.requeue ||
       !app.daemon.job.consume ||
       !app.daemon.job.reserve_response ||
       !app.daemon.job.dispose ||
       !app.daemon.job.flush_buffer ||
+      !app.daemon.job.stats ||
       !app.daemon.tick.init || !app.daemon.tick.shutdown ||
       !app.daemon.tick.next_at || !app.daemon.tick.run ||
       !app.help.init || !app.help.shutdown || !app.help.version || !app.help.show ||
       !app.inbound.init || !app.inbound.shutdown ||
-      !app.keys.init || !app.keys.shutdown ||
+      !app.keys.init || !app.keys.shutdown || !app.keys.load || !app.keys.reload ||
+      !app.keys.user.pubkey || !app.keys.user.resolve ||
+      !app.keys.user.warm || !app.keys.user.next_at ||
+      !app.keys.keyring.open || !app.keys.keyring.close || !app.keys.keyring.write ||
       !app.object.init || !app.object.shutdown ||
       !app.object.supports_static || !app.object.supports_dynamic ||
       !app.object.build_context || !app.object.run_static || !app.object.run_dynamic ||
+      !app.object.sweep ||
       !app.opts.init || !app.opts.shutdown ||
       !app.payload.init || !app.payload.shutdown ||
       !app.payload.run_shell || !app.payload.run_shell_wait || !app.payload.run_shell_capture ||
+      !app.payload.run_shell_stream || !app.payload.spawn_shell_stdin || !app.payload.try_reap ||
+      !app.payload.kill_child ||
+      !app.payload.adopt_detached || !app.payload.reap_detached ||
+      !app.payload.zygote.init || !app.payload.zygote.shutdown ||
+      !app.payload.zygote.start || !app.payload.zygote.stop ||
+      !app.payload.zygote.is_running || !app.payload.zygote.spawn ||
+      !app.payload.zygote.set_object_runner || !app.payload.zygote.spawn_object ||
+      !app.payload.zygote.wait || !app.payload.zygote.recycle ||
       !app.policy.init || !app.policy.shutdown ||
       !app.policy.server_ip_allowed || !app.policy.user_ip_allowed ||
       !app.policy.action_ip_allowed || !app.policy.request_ip_allowed ||
@@ -145,9 +184,13 @@ int init_app(void) {
       !app.payload.digest.sign || !app.payload.digest.validate ||
       !app.payload.reply.reset || !app.payload.reply.set ||
       !app.payload.unstructured.init || !app.payload.unstructured.shutdown || !app.payload.unstructured.handle ||
+      !app.payload.unstructured.match || !app.payload.unstructured.run ||
       !app.runtime.init || !app.runtime.shutdown ||
       !app.runtime.invalidate_config_borrows || !app.runtime.reload_config ||
+      !app.runtime.reload_begin || !app.runtime.reload_state ||
+      !app.runtime.reload_commit || !app.runtime.reload_next_at || !app.runtime.poll ||
       !app.server.init || !app.server.shutdown ||
+      !app.server.action_available || !app.server.action_granted ||
       !app.signal.init || !app.signal.shutdown || !app.signal.install || !app.signal.should_exit || !app.signal.request_exit ||
       !app.workspace.init || !app.workspace.shutdown || !app.workspace.get ||
       !app.startup.init || !app.startup.shutdown ||
@@ -190,6 +233,18 @@ int init_app(void) {
   }
   daemon_auth_initialized = 1;
 
+  if (!app.daemon.batch.init()) {
+    fprintf(stderr, "Failed to initialize app.daemon.batch\n");
+    goto fail;
+  }
+  daemon_batch_initialized = 1;
+
+  if (!app.daemon.cache.init()) {
+    fprintf(stderr, "Failed to initialize app.daemon.cache\n");
+    goto fail;
+  }
+  daemon_cache_initialized = 1;
+
   if (!app.daemon.request.init()) {
     fprintf(stderr, "Failed to initialize app.daemon.request\n");
     goto fail;
@@ -208,6 +263,18 @@ int init_app(void) {
   }
   daemon_payload_initialized = 1;
 
+  if (!app.daemon.stream.init()) {
+    fprintf(stderr, "Failed to initialize app.daemon.stream\n");
+    goto fail;
+  }
+  daemon_stream_initialized = 1;
+
+  if (!app.daemon.executor.init()) {
+    fprintf(stderr, "Failed to initialize app.daemon.executor\n");
+    goto fail;
+  }
+  daemon_executor_initialized = 1;
+
   if (!app.help.init()) {
     fprintf(stderr, "Failed to initialize app.help\n");
     goto fail;
@@ -342,12 +409,24 @@ fail:
     if (daemon_auth_initialized) {
       app.daemon.auth.shutdown();
     }
+    if (daemon_batch_initialized) {
+      app.daemon.batch.shutdown();
+    }
+    if (daemon_cache_initialized) {
+      app.daemon.cache.shutdown();
+    }
     if (daemon_request_initialized) {
       app.daemon.request.shutdown();
     }
     if (daemon_policy_initialized) {
       app.daemon.policy.shutdown();
     }
+    if (daemon_executor_initialized) {
+      app.daemon.executor.shutdown();
+    }
+    if (daemon_stream_initialized) {
+      app.daemon.stream.shutdown();
+    }
     if (daemon_payload_initialized) {
       app.daemon.payload.shutdown();
     }
@@ -390,7 +469,11 @@ void shutdown_app(void) {
   app.builtin.shutdown();
   app.daemon.helper.shutdown();
   app.daemon.auth.shutdown();
+  app.daemon.batch.shutdown();
+  app.daemon.cache.shutdown();
   app.daemon.request.shutdown();
+  app.daemon.executor.shutdown();
+  app.daemon.stream.shutdown();
   app.daemon.payload.shutdown();
   app.daemon.shutdown();
   app.udp.shutdown();
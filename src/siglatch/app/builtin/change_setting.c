@@ -52,6 +52,12 @@ static int app_builtin_change_setting_push_wire_policy(
   m7mux_ctx.codec_context = workspace->codec_context;
   m7mux_ctx.enforce_wire_decode = enforce_wire_decode;
   m7mux_ctx.enforce_wire_auth = enforce_wire_auth;
+  m7mux_ctx.reply_cache_ms = (uint64_t)server->reply_cache_ms;
+  m7mux_ctx.rate_limit.rate = (uint32_t)server->rate_limit;
+  m7mux_ctx.rate_limit.burst = (uint32_t)server->rate_limit_burst;
+  m7mux_ctx.rate_limit.prefix_v4 = (uint8_t)server->rate_limit_prefix_v4;
+  m7mux_ctx.rate_limit.prefix_v6 = (uint8_t)server->rate_limit_prefix_v6;
+  m7mux_ctx.overload_high_water = (uint32_t)server->overload_high_water;
 
   if (!lib.m7mux.set_context(&m7mux_ctx)) {
     LOGE("[builtin:change_setting] Failed to refresh mux wire policy for m7mux\n");
@@ -192,6 +198,7 @@ static int app_builtin_change_setting_set_server_wire_flag(
     return 0;
   }
 
+  app.daemon.cache.invalidate();
   app_action_reply_set(reply,
                        1,
                        "%s=%s",
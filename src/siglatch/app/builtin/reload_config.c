@@ -34,18 +34,41 @@ int app_builtin_reload_config_handle(const AppBuiltinContext *ctx, AppActionRepl
                     ? ctx->listener->server->name
                     : NULL;
 
-  lib.log.emit(LOG_INFO, 1,
-               "[builtin:reload_config] user=%s ip=%s config=%s server=%s",
-               ctx->user->name,
-               ctx->ip_addr ? ctx->ip_addr : "(unknown)",
-               ctx->listener->config_path,
-               server_name ? server_name : "(current)");
-
-  if (!app.runtime.reload_config(
-          ctx->listener,
-          ctx->session,
-          ctx->listener->config_path,
-          server_name)) {
+  /*
+   * The snapshot is built on the reload thread while traffic keeps flowing.
+   * This request is parked (deferred) until the build finishes, then the
+   * loop publishes it and answers.
+   */
+  switch (app.runtime.reload_state()) {
+  case APP_RUNTIME_RELOAD_BUILDING:
+    reply->deferred = 1;
+    reply->should_reply = 0;
+    return 1;
+  case APP_RUNTIME_RELOAD_READY:
+    break;
+  case APP_RUNTIME_RELOAD_IDLE:
+  default:
+    lib.log.emit(LOG_INFO, 1,
+                 "[builtin:reload_config] user=%s ip=%s config=%s server=%s",
+                 ctx->user->name,
+                 ctx->ip_addr ? ctx->ip_addr : "(unknown)",
+                 ctx->listener->config_path,
+                 server_name ? server_name : "(current)");
+
+    if (!app.runtime.reload_begin(ctx->listener, ctx->listener->config_path, server_name)) {
+      lib.log.emit(LOG_ERROR, 1,
+                   "[builtin:reload_config] could not start reload for config=%s",
+                   ctx->listener->config_path);
+      app_action_reply_set(reply, 0, "RELOAD_FAILED");
+      return 0;
+    }
+
+    reply->deferred = 1;
+    reply->should_reply = 0;
+    return 1;
+  }
+
+  if (!app.runtime.reload_commit(ctx->listener, ctx->session)) {
     lib.log.emit(LOG_ERROR, 1,
                  "[builtin:reload_config] reload failed for config=%s",
                  ctx->listener->config_path);
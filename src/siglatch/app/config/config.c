@@ -10,14 +10,20 @@
 #include <openssl/evp.h>
 #include "config.h"
 #include "debug.h"
+#include "index.h"
+#include "snapshot.h"
+#include "user.h"
 #include "../app.h"
 #include "../../lib.h"
 
 #define TIMEOUT_SEC 5
 
 static void config_free(siglatch_config *config);
+static void config_release(const siglatch_config *config);
 static siglatch_config *config_consume_document_ptr(const IniDocument *document);
-static siglatch_config *config_build_from_path(const char *path);
+static siglatch_config *config_build_from_path(const char *path,
+                                               const siglatch_config *previous,
+                                               int initial);
 static int parse_output_mode_key(const char *value, const char *scope_label);
 static siglatch_action_handler parse_action_handler_key(
     const char *value,
@@ -69,9 +75,9 @@ static int config_init(const siglatch_config_context *ctx) {
 static void config_shutdown(void) {
   _ctx = (siglatch_config_context){0};
   if (_owned) 
-    config_free(_config);
+    config_release(_config);
   _owned = 0;
-  _config = NULL;
+  __atomic_store_n(&_config, NULL, __ATOMIC_RELEASE);
 }
 
 static int config_set_context(const siglatch_config_context *ctx) {
@@ -84,29 +90,60 @@ static int config_set_context(const siglatch_config_context *ctx) {
 }
 
 static const siglatch_config *config_get(void) {
-    return _config;
+    return __atomic_load_n(&_config, __ATOMIC_ACQUIRE);
 }
+
+/*
+ * Snapshots are only published and retired on the daemon loop, so pinning
+ * there cannot race a swap. A pinned snapshot may be handed to another thread
+ * and released from it.
+ */
+static const siglatch_config *config_acquire(void) {
+  siglatch_config *config = __atomic_load_n(&_config, __ATOMIC_ACQUIRE);
+
+  if (config) {
+    __atomic_add_fetch(&config->refs, 1, __ATOMIC_RELAXED);
+  }
+  return config;
+}
+
+static void config_release(const siglatch_config *config) {
+  siglatch_config *snapshot = (siglatch_config *)config;
+
+  if (!snapshot) {
+    return;
+  }
+
+  if (__atomic_sub_fetch(&snapshot->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+    config_free(snapshot);
+  }
+}
+
 static siglatch_config *config_detach(void) {
-    siglatch_config *detached = _config;
-    _config = NULL;
+    siglatch_config *detached = __atomic_load_n(&_config, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&_config, NULL, __ATOMIC_RELEASE);
     _owned = 0;
     return detached;
 }
 
+/* Publishes config, taking over the caller's reference. */
 static void config_attach(siglatch_config *config) {
+  siglatch_config *previous = NULL;
+
   if (!config)
     return;
 
-  if (_owned && _config)
-    config_free(_config);
-
-  _config = config;
+  previous = _owned ? _config : NULL;
+  __atomic_store_n(&_config, config, __ATOMIC_RELEASE);
   _owned = 1;
+
+  if (previous && previous != config)
+    config_release(previous);
 }
 
 static int config_load(const char *path) {
   siglatch_config *cfg = NULL;
-  cfg = config_build_from_path(path);
+  cfg = config_build_from_path(path, NULL, 1);
   if (!cfg) {
     return 0;
   }
@@ -115,7 +152,9 @@ static int config_load(const char *path) {
   return 1;
 }
 
-static int config_load_detached(const char *path, siglatch_config **out_config) {
+static int config_load_detached_reusing(const char *path,
+                                        const siglatch_config *previous,
+                                        siglatch_config **out_config) {
   siglatch_config *cfg = NULL;
 
   if (!out_config) {
@@ -123,7 +162,7 @@ static int config_load_detached(const char *path, siglatch_config **out_config)
   }
 
   *out_config = NULL;
-  cfg = config_build_from_path(path);
+  cfg = config_build_from_path(path, previous, 0);
   if (!cfg) {
     return 0;
   }
@@ -132,6 +171,10 @@ static int config_load_detached(const char *path, siglatch_config **out_config)
   return 1;
 }
 
+static int config_load_detached(const char *path, siglatch_config **out_config) {
+  return config_load_detached_reusing(path, NULL, out_config);
+}
+
 static int config_consume(const IniDocument *document) {
   siglatch_config *cfg = config_consume_document_ptr(document);
   if (cfg) {
@@ -202,15 +245,17 @@ static siglatch_payload_overflow_policy parse_payload_overflow_key(
   return fallback;
 }
 
-static siglatch_config *config_build_from_path(const char *path) {
+/*
+ * Parse path into a new config. With config_cache set, the result is saved
+ * for the next load, but only if the file still matches source: an edit that
+ * landed mid-parse leaves the next load to parse again.
+ */
+static siglatch_config *config_parse_path(const char *path,
+                                          const config_snapshot_source *source) {
   IniDocument *document = NULL;
   IniError error = {0};
   siglatch_config *cfg = NULL;
-
-  if (!path || path[0] == '\0') {
-    LOGE("Invalid config path\n");
-    return NULL;
-  }
+  config_snapshot_source reread;
 
   document = lib.parse.ini.read_file(path, &error);
   if (!document) {
@@ -232,7 +277,46 @@ static siglatch_config *config_build_from_path(const char *path) {
     return NULL;
   }
 
-  if (!app.keys.load(cfg)) {
+  if (!cfg->config_cache) {
+    config_snapshot_remove(path);
+  } else if (source && config_snapshot_fingerprint(path, &reread) &&
+             config_snapshot_same_source(source, &reread)) {
+    (void)config_snapshot_write(path, cfg, source);
+  }
+
+  return cfg;
+}
+
+/*
+ * initial marks the startup load, the only one allowed to leave user public
+ * keys for after the listener is up (lazy_user_keys).
+ */
+static siglatch_config *config_build_from_path(const char *path,
+                                               const siglatch_config *previous,
+                                               int initial) {
+  config_snapshot_source source;
+  int have_source = 0;
+  int keys_ok = 0;
+  siglatch_config *cfg = NULL;
+
+  if (!path || path[0] == '\0') {
+    LOGE("Invalid config path\n");
+    return NULL;
+  }
+
+  have_source = config_snapshot_fingerprint(path, &source);
+  cfg = have_source ? config_snapshot_load(path, &source) : NULL;
+  if (cfg) {
+    LOGD("Loaded config snapshot for %s (%d users)\n", path, cfg->user_count);
+  } else {
+    cfg = config_parse_path(path, have_source ? &source : NULL);
+    if (!cfg) {
+      return NULL;
+    }
+  }
+
+  keys_ok = initial ? app.keys.load(cfg) : app.keys.reload(cfg, previous);
+  if (!keys_ok) {
     config_free(cfg);
     return NULL;
   }
@@ -245,14 +329,7 @@ static const siglatch_user *config_user_by_id_from_ptr(
     uint32_t user_id) {
     if (!cfg) return NULL;
 
-    for (int i = 0; i < cfg->user_count; ++i) {
-        const siglatch_user *u = &cfg->users[i];
-        if (u->enabled && u->id == user_id) {
-            return u;
-        }
-    }
-
-    return NULL;  // Not found
+    return config_index_user_by_id(cfg, user_id);
 }
 
 const siglatch_user *config_user_by_id(uint32_t user_id) {
@@ -281,6 +358,15 @@ static int config_action_available_by_user(uint32_t user_id, const char *action)
     return 0;  // Not found
 }
 
+/* Bit test against the grant set compiled from the user's actions[] at load. */
+static int config_user_action_granted(const siglatch_user *user, uint32_t action_id) {
+  if (!user || action_id >= SL_ACTION_ID_SPACE) {
+    return 0;
+  }
+
+  return (user->action_grants[action_id >> 3] >> (action_id & 7u)) & 1u;
+}
+
 const char * config_username_by_id(uint32_t user_id){
   const siglatch_user * u = config_user_by_id(user_id);
   return u && u->name[0] != '\0'?
@@ -292,13 +378,8 @@ static const siglatch_action *config_action_by_id_from_ptr(
     const siglatch_config *cfg,
     uint32_t action_id) {
   if (!cfg) return NULL;
-  
-  for (int i = 0; i < cfg->action_count; ++i) {
-    if (cfg->actions[i].id == action_id) {
-      return &cfg->actions[i];
-    }
-  }
-  return NULL;
+
+  return config_index_action_by_id(cfg, action_id);
 }
 
 const siglatch_action *config_action_by_id(uint32_t action_id){
@@ -365,6 +446,54 @@ static int validate_action_handlers(const siglatch_config *cfg) {
   for (int i = 0; i < cfg->action_count; ++i) {
     const siglatch_action *action = &cfg->actions[i];
 
+    if (action->stream_payload && action->handler != SL_ACTION_HANDLER_SHELL) {
+      LOGE("Invalid action [%s]: stream_payload requires shell handler\n",
+           action->name);
+      return 0;
+    }
+
+    if (action->payload_memfd && action->handler != SL_ACTION_HANDLER_SHELL) {
+      LOGE("Invalid action [%s]: payload_memfd requires shell handler\n",
+           action->name);
+      return 0;
+    }
+
+    if (action->payload_memfd && action->stream_payload) {
+      LOGE("Invalid action [%s]: payload_memfd cannot be combined with stream_payload\n",
+           action->name);
+      return 0;
+    }
+
+    if (action->stream_reply && action->handler != SL_ACTION_HANDLER_SHELL) {
+      LOGE("Invalid action [%s]: stream_reply requires shell handler\n",
+           action->name);
+      return 0;
+    }
+
+    if (action->stream_reply && action->stream_payload) {
+      LOGE("Invalid action [%s]: stream_reply cannot be combined with stream_payload\n",
+           action->name);
+      return 0;
+    }
+
+    if (action->cache_ttl_ms > 0 && (action->stream_reply || action->stream_payload)) {
+      LOGE("Invalid action [%s]: cache_ttl_ms cannot be combined with stream_reply or stream_payload\n",
+           action->name);
+      return 0;
+    }
+
+    if (action->in_process && action->handler != SL_ACTION_HANDLER_STATIC) {
+      LOGE("Invalid action [%s]: in_process requires static handler\n",
+           action->name);
+      return 0;
+    }
+
+    if (action->in_process && action->run_as[0] != '\0') {
+      LOGE("Invalid action [%s]: in_process cannot be combined with run_as\n",
+           action->name);
+      return 0;
+    }
+
     switch (action->handler) {
     case SL_ACTION_HANDLER_SHELL:
       if (action->constructor[0] == '\0') {
@@ -451,8 +580,16 @@ static int validate_action_handlers(const siglatch_config *cfg) {
         return 0;
       }
 
-      if (action->constructor[0] != '\0' || action->builtin[0] != '\0') {
-        LOGE("Invalid action [%s]: dynamic handler cannot define constructor/builtin\n",
+      if (action->builtin[0] != '\0') {
+        LOGE("Invalid action [%s]: dynamic handler cannot define builtin\n",
+             action->name);
+        return 0;
+      }
+
+      /* Persistent dynamic workers name constructor/destructor symbols. */
+      if ((action->constructor[0] != '\0' || action->destructor[0] != '\0') &&
+          action->keepalive_interval <= 0) {
+        LOGE("Invalid action [%s]: dynamic constructor/destructor requires keepalive_interval\n",
              action->name);
         return 0;
       }
@@ -555,12 +692,7 @@ static const siglatch_deaddrop *config_deaddrop_by_name_from_ptr(
     const char *name) {
   if (!cfg || !name) return NULL;
 
-  for (int i = 0; i < cfg->deaddrop_count; ++i) {
-    if (strcmp(cfg->deaddrops[i].name, name) == 0) {
-      return &cfg->deaddrops[i];
-    }
-  }
-  return NULL;
+  return config_index_deaddrop_by_name(cfg, name);
 }
 
 const siglatch_deaddrop *config_deaddrop_by_name(const char *name) {
@@ -578,12 +710,7 @@ static const siglatch_server *config_server_by_name_from_ptr(
     const char *name) {
   if (!cfg || !name) return NULL;
 
-  for (int i = 0; i < cfg->server_count; ++i) {
-    if (strcmp(cfg->servers[i].name, name) == 0) {
-      return &cfg->servers[i];
-    }
-  }
-  return NULL;
+  return config_index_server_by_name(cfg, name);
 }
 
 const siglatch_server *config_server_by_name(const char *name) {
@@ -710,6 +837,37 @@ static void config_apply_defaults(siglatch_config *config) {
   config->payload_overflow = SL_PAYLOAD_OVERFLOW_REJECT;
 }
 
+/*
+ * Make room for one more entry in a heap-backed config table, doubling its
+ * capacity. Entries handed out earlier may move, so callers finish filling
+ * one entry before appending the next.
+ */
+static int config_reserve_table(void **table, int *capacity, int count, size_t elem_size) {
+  void *grown = NULL;
+  int next = 0;
+
+  if (!table || !capacity) {
+    return 0;
+  }
+
+  if (count < *capacity) {
+    return 1;
+  }
+
+  next = *capacity > 0 ? *capacity * 2 : 16;
+  grown = realloc(*table, (size_t)next * elem_size);
+  if (!grown) {
+    return 0;
+  }
+
+  memset((uint8_t *)grown + (size_t)*capacity * elem_size,
+         0,
+         (size_t)(next - *capacity) * elem_size);
+  *table = grown;
+  *capacity = next;
+  return 1;
+}
+
 static siglatch_user *config_append_user(siglatch_config *config, const char *name) {
   siglatch_user *user = NULL;
 
@@ -722,6 +880,14 @@ static siglatch_user *config_append_user(siglatch_config *config, const char *na
     return NULL;
   }
 
+  if (!config_reserve_table((void **)&config->users,
+                            &config->user_capacity,
+                            config->user_count,
+                            sizeof(*config->users))) {
+    LOGE("Out of memory growing user table; ignoring '%s'\n", name);
+    return NULL;
+  }
+
   user = &config->users[config->user_count++];
   lib.str.lcpy(user->name, name, sizeof(user->name));
   user->pubkey = NULL;
@@ -735,16 +901,25 @@ static siglatch_action *config_append_action(siglatch_config *config, const char
     return NULL;
   }
 
-  if (config->action_count >= MAX_ACTIONS) {
+  if (config->action_count >= MAX_ACTION_DEFS) {
     LOGW("Too many [action:*] sections; ignoring '%s'\n", name);
     return NULL;
   }
 
+  if (!config_reserve_table((void **)&config->actions,
+                            &config->action_capacity,
+                            config->action_count,
+                            sizeof(*config->actions))) {
+    LOGE("Out of memory growing action table; ignoring '%s'\n", name);
+    return NULL;
+  }
+
   action = &config->actions[config->action_count++];
   lib.str.lcpy(action->name, name, sizeof(action->name));
   action->handler = SL_ACTION_HANDLER_SHELL;
   action->exec_split = 1;
   action->enabled = 1;
+  action->stream_idle_ms = SL_STREAM_IDLE_MS_DEFAULT;
   action->require_ascii = 0;
   action->enforce_wire_auth = 0;
   action->payload_overflow = SL_PAYLOAD_OVERFLOW_INHERIT;
@@ -768,6 +943,7 @@ static siglatch_server *config_append_server(siglatch_config *config, const char
   lib.str.lcpy(server->label, server->name, sizeof(server->label));
   server->enforce_wire_decode = 0;
   server->enforce_wire_auth = 0;
+  server->overload_high_water = SL_OVERLOAD_HIGH_WATER_DEFAULT;
   server->payload_overflow = SL_PAYLOAD_OVERFLOW_INHERIT;
   return server;
 }
@@ -784,6 +960,14 @@ static siglatch_deaddrop *config_append_deaddrop(siglatch_config *config, const
     return NULL;
   }
 
+  if (!config_reserve_table((void **)&config->deaddrops,
+                            &config->deaddrop_capacity,
+                            config->deaddrop_count,
+                            sizeof(*config->deaddrops))) {
+    LOGE("Out of memory growing deaddrop table; ignoring '%s'\n", name);
+    return NULL;
+  }
+
   deaddrop = &config->deaddrops[config->deaddrop_count++];
   lib.str.lcpy(deaddrop->name, name, sizeof(deaddrop->name));
   lib.str.lcpy(deaddrop->label, deaddrop->name, sizeof(deaddrop->label));
@@ -814,6 +998,14 @@ static void config_consume_global_entry(siglatch_config *config, const IniEntry
   } else if (strcmp(key, "payload_overflow") == 0) {
     config->payload_overflow = parse_payload_overflow_key(
         val, "[global]", 0, config->payload_overflow);
+  } else if (strcmp(key, "watch_config") == 0) {
+    lib.str.to_bool(val, &config->watch_config);
+  } else if (strcmp(key, "lazy_user_keys") == 0) {
+    lib.str.to_bool(val, &config->lazy_user_keys);
+  } else if (strcmp(key, "config_cache") == 0) {
+    lib.str.to_bool(val, &config->config_cache);
+  } else if (strcmp(key, "keyring") == 0) {
+    lib.str.lcpy(config->keyring_path, val, PATH_MAX);
   }
 }
 
@@ -858,6 +1050,38 @@ static void config_consume_action_entry(siglatch_action *action, const IniEntry
   } else if (strcmp(key, "exec_split") == 0) {
     action->exec_split = 0;
     lib.str.to_bool(val, &action->exec_split);
+  } else if (strcmp(key, "stream_payload") == 0) {
+    action->stream_payload = 0;
+    lib.str.to_bool(val, &action->stream_payload);
+  } else if (strcmp(key, "stream_idle_ms") == 0) {
+    action->stream_idle_ms = atoi(val);
+    if (action->stream_idle_ms < 0) {
+      action->stream_idle_ms = 0;
+    }
+  } else if (strcmp(key, "in_process") == 0) {
+    action->in_process = 0;
+    lib.str.to_bool(val, &action->in_process);
+  } else if (strcmp(key, "payload_memfd") == 0) {
+    action->payload_memfd = 0;
+    lib.str.to_bool(val, &action->payload_memfd);
+  } else if (strcmp(key, "stream_reply") == 0) {
+    action->stream_reply = 0;
+    lib.str.to_bool(val, &action->stream_reply);
+  } else if (strcmp(key, "timeout_ms") == 0) {
+    action->timeout_ms = atoi(val);
+    if (action->timeout_ms < 0) {
+      action->timeout_ms = 0;
+    }
+  } else if (strcmp(key, "cache_ttl_ms") == 0) {
+    action->cache_ttl_ms = atoi(val);
+    if (action->cache_ttl_ms < 0) {
+      action->cache_ttl_ms = 0;
+    }
+  } else if (strcmp(key, "max_concurrency") == 0) {
+    action->max_concurrency = atoi(val);
+    if (action->max_concurrency < 0) {
+      action->max_concurrency = 0;
+    }
   } else if (strcmp(key, "payload_overflow") == 0) {
     action->payload_overflow = parse_payload_overflow_key(
         val, action->name, 1, action->payload_overflow);
@@ -887,25 +1111,31 @@ static void config_consume_user_entry(siglatch_user *user, const IniEntry *entry
     user->enabled = 0;
     lib.str.to_bool(val, &user->enabled);
   } else if (strcmp(key, "key_file") == 0) {
-    lib.str.lcpy(user->key_file, val, PATH_MAX);
+    if (!config_user_set_path(&user->key_file, val)) {
+      LOGE("Out of memory storing key_file for user '%s'\n", user->name);
+    }
   } else if (strcmp(key, "hmac_file") == 0) {
-    lib.str.lcpy(user->hmac_file, val, PATH_MAX);
+    if (!config_user_set_path(&user->hmac_file, val)) {
+      LOGE("Out of memory storing hmac_file for user '%s'\n", user->name);
+    }
   } else if (strcmp(key, "id") == 0) {
     user->id = atoi(val);
   } else if (strcmp(key, "actions") == 0) {
-    lib.str.parse_csv_fixed(
-        (char *)user->actions,
-        &user->action_count,
-        MAX_ACTIONS,
-        MAX_ACTION_NAME,
-        val);
+    if (!config_user_add_list((void **)&user->actions,
+                              &user->action_count,
+                              MAX_ACTIONS,
+                              MAX_ACTION_NAME,
+                              val)) {
+      LOGE("Out of memory storing actions for user '%s'\n", user->name);
+    }
   } else if (strcmp(key, "allowed_ips") == 0) {
-    lib.str.parse_csv_fixed(
-        (char *)user->allowed_ips,
-        &user->allowed_ip_count,
-        MAX_IP_RANGES,
-        MAX_IP_RANGE_LEN,
-        val);
+    if (!config_user_add_list((void **)&user->allowed_ips,
+                              &user->allowed_ip_count,
+                              MAX_IP_RANGES,
+                              MAX_IP_RANGE_LEN,
+                              val)) {
+      LOGE("Out of memory storing allowed_ips for user '%s'\n", user->name);
+    }
   }
 }
 
@@ -954,6 +1184,59 @@ static void config_consume_server_entry(siglatch_server *server, const IniEntry
              strcmp(key, "reject_wire_auth_error") == 0) {
     server->enforce_wire_auth = 0;
     lib.str.to_bool(val, &server->enforce_wire_auth);
+  } else if (strcmp(key, "coalesce_replies") == 0) {
+    server->coalesce_replies = 0;
+    lib.str.to_bool(val, &server->coalesce_replies);
+  } else if (strcmp(key, "deaddrop_match") == 0) {
+    if (strcasecmp(val, "longest") == 0) {
+      server->deaddrop_longest_match = 1;
+    } else if (strcasecmp(val, "first") == 0) {
+      server->deaddrop_longest_match = 0;
+    } else {
+      LOGW("Invalid deaddrop_match '%s' in [server:%s]; expected first|longest\n",
+           val,
+           server->name);
+    }
+  } else if (strcmp(key, "reply_cache_ms") == 0) {
+    server->reply_cache_ms = atoi(val);
+    if (server->reply_cache_ms < 0) {
+      LOGW("Negative reply_cache_ms in [server:%s]; disabling reply cache\n", server->name);
+      server->reply_cache_ms = 0;
+    }
+  } else if (strcmp(key, "rate_limit") == 0) {
+    server->rate_limit = atoi(val);
+    if (server->rate_limit < 0) {
+      LOGW("Negative rate_limit in [server:%s]; disabling rate limit\n", server->name);
+      server->rate_limit = 0;
+    }
+  } else if (strcmp(key, "rate_limit_burst") == 0) {
+    server->rate_limit_burst = atoi(val);
+    if (server->rate_limit_burst < 0) {
+      LOGW("Negative rate_limit_burst in [server:%s]; using rate_limit\n", server->name);
+      server->rate_limit_burst = 0;
+    }
+  } else if (strcmp(key, "rate_limit_prefix_v4") == 0) {
+    server->rate_limit_prefix_v4 = atoi(val);
+    if (server->rate_limit_prefix_v4 < 1 || server->rate_limit_prefix_v4 > 32) {
+      LOGW("Invalid rate_limit_prefix_v4 '%s' in [server:%s] (expected 1-32); using 32\n",
+           val,
+           server->name);
+      server->rate_limit_prefix_v4 = 0;
+    }
+  } else if (strcmp(key, "rate_limit_prefix_v6") == 0) {
+    server->rate_limit_prefix_v6 = atoi(val);
+    if (server->rate_limit_prefix_v6 < 1 || server->rate_limit_prefix_v6 > 128) {
+      LOGW("Invalid rate_limit_prefix_v6 '%s' in [server:%s] (expected 1-128); using 64\n",
+           val,
+           server->name);
+      server->rate_limit_prefix_v6 = 0;
+    }
+  } else if (strcmp(key, "overload_high_water") == 0) {
+    server->overload_high_water = atoi(val);
+    if (server->overload_high_water < 0) {
+      LOGW("Negative overload_high_water in [server:%s]; disabling load shedding\n", server->name);
+      server->overload_high_water = 0;
+    }
   } else if (strcmp(key, "logging") == 0) {
     server->logging = 0;
     lib.str.to_bool(val, &server->logging);
@@ -1024,6 +1307,14 @@ static void config_consume_deaddrop_entry(siglatch_deaddrop *deaddrop, const Ini
   } else if (strcmp(key, "exec_split") == 0) {
     deaddrop->exec_split = 0;
     lib.str.to_bool(val, &deaddrop->exec_split);
+  } else if (strcmp(key, "payload_memfd") == 0) {
+    deaddrop->payload_memfd = 0;
+    lib.str.to_bool(val, &deaddrop->payload_memfd);
+  } else if (strcmp(key, "timeout_ms") == 0) {
+    deaddrop->timeout_ms = atoi(val);
+    if (deaddrop->timeout_ms < 0) {
+      deaddrop->timeout_ms = 0;
+    }
   }
 }
 
@@ -1039,6 +1330,7 @@ static siglatch_config *config_consume_document_ptr(const IniDocument *document)
   if (!config) {
     return NULL;
   }
+  config->refs = 1;
 
   config_apply_defaults(config);
 
@@ -1122,17 +1414,22 @@ static siglatch_config *config_consume_document_ptr(const IniDocument *document)
 
   apply_server_runtime_defaults(config);
 
+  if (!config_index_build(config)) {
+    config_free(config);
+    return NULL;
+  }
+
   return config;
 }
 
 static void config_unload(void){
   siglatch_config *config = config_detach();
-  config_free(config);
+  config_release(config);
   
 }
 
 static void config_destroy(siglatch_config *config) {
-  config_free(config);
+  config_release(config);
 }
 
 static void config_free(siglatch_config *config) {
@@ -1148,6 +1445,7 @@ static void config_free(siglatch_config *config) {
             EVP_PKEY_free(u->pubkey);
             u->pubkey = NULL;
         }
+        config_user_free_storage(u);
     }
 
     // Free the server keys
@@ -1159,6 +1457,12 @@ static void config_free(siglatch_config *config) {
         s->priv_key = NULL;
       }
     }
+
+    app.keys.keyring.close(config);
+    config_index_free(config);
+    free(config->users);
+    free(config->actions);
+    free(config->deaddrops);
     free(config);
 }
 
@@ -1170,12 +1474,15 @@ static const ConfigLib config_instance = {
 
   .load = config_load,
   .load_detached = config_load_detached,
+  .load_detached_reusing = config_load_detached_reusing,
   .consume = config_consume,
   .unload = config_unload,
   .detach = config_detach,
   .attach = config_attach,
   .destroy = config_destroy,
   .get = config_get,
+  .acquire = config_acquire,
+  .release = config_release,
 
   .set_context = config_set_context,
 
@@ -1186,7 +1493,8 @@ static const ConfigLib config_instance = {
   .user_by_id_from = config_user_by_id_from,
   .action_by_id = config_action_by_id,
   .action_by_id_from = config_action_by_id_from,
-  .action_available_by_user = config_action_available_by_user, 
+  .action_available_by_user = config_action_available_by_user,
+  .user_action_granted = config_user_action_granted,
   .server_by_name = config_server_by_name,
   .server_by_name_from = config_server_by_name_from,
   .server_set_port = config_server_set_port,
@@ -11,13 +11,51 @@
 #include <openssl/evp.h>
 #include "../../../stdlib/parse/ini.h"
 
-#define MAX_USERS 32
+/*
+ * Users, actions and deaddrops live in heap tables that grow while the config
+ * is parsed; these only cap them. User ids are 16 bits and action ids 8 bits
+ * on the wire. MAX_ACTIONS still bounds the per-user and per-server lists.
+ */
+#define MAX_USERS 65535
+#define MAX_ACTION_DEFS 255
 #define MAX_ACTIONS 32
 #define MAX_SERVERS 5
-#define MAX_DEADDROPS 16
+#define MAX_DEADDROPS 4096
+#define SL_OVERLOAD_HIGH_WATER_DEFAULT 32
+#define SL_STREAM_IDLE_MS_DEFAULT 30000
+
+/*
+ * Action ids are one byte on the wire, so grants compile to a 256-bit set per
+ * user and per server, and action lookup is a direct table.
+ */
+#define SL_ACTION_ID_SPACE 256
+#define SL_ACTION_GRANT_BYTES (SL_ACTION_ID_SPACE / 8)
+
+/*
+ * Identity of a key file when it was last read. A reload reuses the parsed key
+ * from the live config while path and stamp are unchanged.
+ */
+typedef struct {
+  int valid;
+  unsigned long long dev;
+  unsigned long long ino;
+  long long size;
+  long long mtime_sec;
+  long mtime_nsec;
+  long long ctime_sec;
+  long ctime_nsec;
+} siglatch_key_stamp;
+
+/*
+ * Public key state of a file-backed user under lazy_user_keys. Users loaded
+ * up front stay SETTLED; see app_keys_user_pubkey() for the transitions.
+ */
+#define SL_USER_KEY_SETTLED 0
+#define SL_USER_KEY_PENDING 1
+#define SL_USER_KEY_LOADING 2
+#define SL_USER_KEY_FAILED 3
 
 #define MAX_ACTION_NAME 32
-#define MAX_KEY_DATA 1024
 #define MAX_SERVER_NAME     64
 #define MAX_DEADDROP_NAME   64
 #define MAX_BUILTIN_NAME    64
@@ -73,6 +111,14 @@ typedef struct {
   int enabled;
   int require_ascii;
   int exec_split;
+  int stream_payload;                              ///< Shell only; pipe fragments to stdin as they arrive
+  int stream_idle_ms;                              ///< stream_payload; expire after this long without a fragment; 0 = never
+  int max_concurrency;                             ///< Executor cap for this action; 0 = pool limit only
+  int timeout_ms;                                  ///< Wall-clock limit per run; 0 = no limit
+  int in_process;                                  ///< Static only; call the handler on the executor thread
+  int payload_memfd;                               ///< Shell only; payload on stdin as a sealed memfd
+  int stream_reply;                                ///< Shell only; stdout goes back as reply packets
+  int cache_ttl_ms;                                ///< Reuse a successful reply for identical requests; 0 = off
   int enforce_wire_auth;                           ///< App/job-layer only; mux does not consume this
   siglatch_payload_overflow_policy payload_overflow;
   char allowed_ips[MAX_IP_RANGES][MAX_IP_RANGE_LEN];
@@ -82,19 +128,23 @@ typedef struct {
 typedef struct {
   unsigned int id;
   char name[64];
-  char key_file[PATH_MAX];
-  char hmac_file[PATH_MAX];
+  char *key_file;                                  ///< Heap; NULL if unset (see config/user.h)
+  char *hmac_file;                                 ///< Heap; NULL if unset
   int enabled;
-  char actions[MAX_ACTIONS][MAX_ACTION_NAME];
+  char (*actions)[MAX_ACTION_NAME];                ///< Heap, action_count entries
   int action_count;
-  char allowed_ips[MAX_IP_RANGES][MAX_IP_RANGE_LEN];
+  uint8_t action_grants[SL_ACTION_GRANT_BYTES];    ///< Compiled from actions[] at load, by action id
+  char (*allowed_ips)[MAX_IP_RANGE_LEN];           ///< Heap, allowed_ip_count entries
   int allowed_ip_count;
 
   // Loaded key data
-  uint8_t key_data[MAX_KEY_DATA];
-  int key_length;
   EVP_PKEY *pubkey;
   uint8_t hmac_key[32];
+  siglatch_key_stamp key_stamp;                    ///< key_file as of pubkey
+  siglatch_key_stamp hmac_stamp;                   ///< hmac_file as of hmac_key
+  const uint8_t *keyring_der;                      ///< DER public key in the config's keyring map, if bound
+  uint32_t keyring_der_len;
+  int key_state;                                   ///< SL_USER_KEY_*; read and written atomically
 } siglatch_user;
 
 typedef struct {
@@ -112,12 +162,34 @@ typedef struct {
   int enabled;
   int require_ascii;
   int exec_split;
+  int timeout_ms;                                   ///< Kill the script after this long; 0 = no limit
+  int payload_memfd;                                ///< Body on stdin as a sealed memfd; stdout via memfd
   // Optional future:
   // int log_output;
-  // int timeout_ms;
   // int pass_env;
 } siglatch_deaddrop;
 
+/**
+ * @brief Prefix trie over one server's deaddrop `starts_with` patterns.
+ *
+ * Node 0 is the root. Children are a first-child/next-sibling chain. A node
+ * where a pattern ends carries that pattern's config-order rank and the
+ * deaddrop's table position.
+ */
+typedef struct {
+  uint32_t first_child;                        ///< 0 = none; the root is never a child
+  uint32_t next_sibling;
+  uint32_t rank;                               ///< UINT32_MAX when no pattern ends here
+  int32_t deaddrop;                            ///< Deaddrop table position for rank
+  uint8_t byte;
+} siglatch_deaddrop_trie_node;
+
+typedef struct {
+  siglatch_deaddrop_trie_node *nodes;
+  uint32_t count;
+  uint32_t cap;
+} siglatch_deaddrop_trie;
+
 typedef struct {
   unsigned int id;
   char name[MAX_SERVER_NAME];                  ///< [server:<name>] machine identifier
@@ -134,18 +206,47 @@ typedef struct {
   int secure;                                  ///< 1 = encrypted, 0 = plaintext
   int enforce_wire_decode;                     ///< Mux-layer policy
   int enforce_wire_auth;                       ///< Mux-layer policy
+  int reply_cache_ms;                          ///< Mux-layer; 0 = no retransmit replay
+  int coalesce_replies;                        ///< Pack replies to one peer into one packet
+  int rate_limit;                              ///< Mux-layer; packets/s per source prefix, 0 = off
+  int rate_limit_burst;                        ///< Bucket size in packets; 0 = rate_limit
+  int rate_limit_prefix_v4;                    ///< Source grouping; 0 = /32
+  int rate_limit_prefix_v6;                    ///< Source grouping; 0 = /64
+  int overload_high_water;                     ///< Mux-layer; queued work that starts load shedding, 0 = off
+  int deaddrop_longest_match;                  ///< 1 = longest starts_with wins, 0 = config order
   int output_mode;                             ///< 0=unset, else SL_OUTPUT_MODE_*
   siglatch_payload_overflow_policy payload_overflow;
 
   EVP_PKEY *priv_key;                          ///< Loaded OpenSSL private key
+  siglatch_key_stamp priv_key_stamp;           ///< priv_key_path as of priv_key (owned keys only)
 
   char deaddrops[MAX_ACTIONS][MAX_ACTION_NAME];
   int deaddrop_count;
   char actions[MAX_ACTIONS][MAX_ACTION_NAME];  ///< List of allowed actions
   int action_count;
+  uint8_t action_grants[SL_ACTION_GRANT_BYTES]; ///< Compiled from actions[] at load, by action id
+  siglatch_deaddrop_trie deaddrop_trie;        ///< Compiled from deaddrops[] at load
 } siglatch_server;
 
+/**
+ * @brief Open-addressed lookup index over one config table.
+ *
+ * Slots hold the entry's table position + 1 (0 = empty). Built once after
+ * the config is parsed and never modified afterwards.
+ */
+typedef struct {
+  uint32_t *slots;
+  size_t cap;                                  ///< Power of two, 0 when unbuilt
+} siglatch_config_index;
+
+/*
+ * A loaded config is an immutable snapshot once it is published with
+ * attach(). Readers that must outlive the next reload pin it with acquire()
+ * and drop it with release(); the snapshot is freed with its last reference.
+ */
 typedef struct {
+  int refs;                                    ///< Snapshot references; see acquire()/release()
+
   // Global log path (used if no per-server override)
   char log_file[PATH_MAX];
   char priv_key_path[PATH_MAX];
@@ -153,21 +254,38 @@ typedef struct {
   int output_mode;                             ///< 0=unset, else SL_OUTPUT_MODE_*
   siglatch_payload_overflow_policy payload_overflow;
   EVP_PKEY *master_privkey;                          ///< Loaded OpenSSL private key
+  siglatch_key_stamp master_key_stamp;               ///< priv_key_path as of master_privkey
+  int watch_config;                                  ///< Reload when the config or a key file changes
+  int lazy_user_keys;                                ///< Parse user public keys after startup, on demand
+  int config_cache;                                  ///< Reuse <config>.cache while the INI is unchanged
+  char keyring_path[PATH_MAX];                       ///< Optional keyring file; see keys/keyring.h
+  const uint8_t *keyring_map;                        ///< Read-only mapping of keyring_path
+  size_t keyring_map_len;
   // Users and their keys
-  siglatch_user users[MAX_USERS];
+  siglatch_user *users;
   int user_count;
+  int user_capacity;
 
   // Available actions (globally defined, servers link by name)
-  siglatch_action actions[MAX_ACTIONS];
+  siglatch_action *actions;
   int action_count;
+  int action_capacity;
 
   // Server blocks (forked individually)
   siglatch_server servers[MAX_SERVERS];
   int server_count;
 
   // Deaddrop definitions (linked by name from server)
-  siglatch_deaddrop deaddrops[MAX_DEADDROPS];
+  siglatch_deaddrop *deaddrops;
   int deaddrop_count;
+  int deaddrop_capacity;
+
+  // Lookup indexes, rebuilt with every load
+  siglatch_config_index user_by_id;            ///< Enabled users only; first id wins
+  siglatch_config_index action_by_name;        ///< Keeps duplicate names for grant compilation
+  int16_t action_slot[SL_ACTION_ID_SPACE];     ///< Action id -> table position, -1 if none
+  siglatch_config_index server_by_name;
+  siglatch_config_index deaddrop_by_name;
 } siglatch_config;
 
 
@@ -177,12 +295,17 @@ typedef struct {
 
   int  (*load)(const char *path);                        ///< Read, consume, materialize, and attach config from file
   int  (*load_detached)(const char *path, siglatch_config **out_config); ///< Read, consume, materialize, and return owned config without attaching it
+  int  (*load_detached_reusing)(const char *path,
+                                const siglatch_config *previous,
+                                siglatch_config **out_config); ///< As load_detached, taking unchanged keys from previous
   int  (*consume)(const IniDocument *document);          ///< Build + own config from parsed INI document
   void (*unload)(void);
   siglatch_config *(*detach)(void);                       ///< Export + relinquish ownership
   void (*attach)(siglatch_config * config);   ///< import + acquire ownership
-  void (*destroy)(siglatch_config *config);              ///< Destroy a detached config object
+  void (*destroy)(siglatch_config *config);              ///< Drop the caller's reference to a detached config
   const siglatch_config *(*get)(void);                    ///< Read-only access
+  const siglatch_config *(*acquire)(void);                ///< Pin the published snapshot (loop thread)
+  void (*release)(const siglatch_config *config);         ///< Unpin a snapshot (any thread)
 
   int (*set_context)(const siglatch_config_context *ctx);
   void (*dump)(void);
@@ -190,6 +313,7 @@ typedef struct {
 
   const siglatch_deaddrop *(*deaddrop_starts_with_buffer)(const uint8_t *payload, size_t payload_len);
   int (*action_available_by_user)(uint32_t user_id, const char *action);
+  int (*user_action_granted)(const siglatch_user *user, uint32_t action_id);
   const siglatch_user *(*user_by_id)(uint32_t id);
   const siglatch_user *(*user_by_id_from)(const siglatch_config *cfg, uint32_t id);
   const siglatch_action *(*action_by_id)(uint32_t id);
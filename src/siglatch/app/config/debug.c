@@ -61,6 +61,10 @@ void config_debug_dump_ptr(const siglatch_config *cfg) {
                   cfg->output_mode ? lib.print.output_mode_name(cfg->output_mode) : "(unset)");
   lib.log.console("  Payload overflow policy: %s\n",
                   payload_overflow_policy_name(cfg->payload_overflow));
+  lib.log.console("  Watch config: %s\n", cfg->watch_config ? "yes" : "no");
+  lib.log.console("  Lazy user keys: %s\n", cfg->lazy_user_keys ? "yes" : "no");
+  lib.log.console("  Config cache: %s\n", cfg->config_cache ? "yes" : "no");
+  lib.log.console("  Keyring: %s\n", cfg->keyring_path[0] ? cfg->keyring_path : "(none)");
   if (cfg->master_privkey) {
     lib.log.console("  Master private key loaded from %s\n", cfg->priv_key_path);
   } else {
@@ -84,6 +88,14 @@ void config_debug_dump_ptr(const siglatch_config *cfg) {
     lib.log.console("      Enabled  : %s\n", a->enabled ? "yes" : "no");
     lib.log.console("      Require Ascii Message  : %s\n", a->require_ascii ? "yes" : "no");
     lib.log.console("      exec_split  : %s\n", a->exec_split ? "yes" : "no");
+    lib.log.console("      Stream Payload  : %s\n", a->stream_payload ? "yes" : "no");
+    lib.log.console("      Stream Idle ms  : %d\n", a->stream_idle_ms);
+    lib.log.console("      In Process  : %s\n", a->in_process ? "yes" : "no");
+    lib.log.console("      Max Concurrency  : %d\n", a->max_concurrency);
+    lib.log.console("      Timeout ms  : %d\n", a->timeout_ms);
+    lib.log.console("      Payload memfd  : %s\n", a->payload_memfd ? "yes" : "no");
+    lib.log.console("      Stream Reply  : %s\n", a->stream_reply ? "yes" : "no");
+    lib.log.console("      Cache TTL ms  : %d\n", a->cache_ttl_ms);
     lib.log.console("      Enforce Wire Auth  : %s\n",
                     a->enforce_wire_auth ? "yes" : "no");
     lib.log.console("      Payload overflow policy : %s\n",
@@ -106,21 +118,28 @@ void config_debug_dump_ptr(const siglatch_config *cfg) {
     lib.log.console("    - [%s]\n", u->name);
     lib.log.console("      ID      : %u\n", u->id);
     lib.log.console("      Enabled : %s\n", u->enabled ? "yes" : "no");
-    lib.log.console("      Key file: %s\n", u->key_file);
-    if (u->pubkey) {
+    lib.log.console("      Key file: %s\n", u->key_file ? u->key_file : "(unset)");
+    if (u->keyring_der) {
+      lib.log.console("      User public key in keyring%s\n",
+                      u->pubkey ? " (decoded)" : " (decoded on first use)");
+    } else if (u->pubkey) {
       lib.log.console("      User public key loaded from %s\n", u->key_file);
+    } else if (u->key_state == SL_USER_KEY_PENDING || u->key_state == SL_USER_KEY_LOADING) {
+      lib.log.console("      User public key loads after startup\n");
     } else {
       lib.log.console("      User public key not loaded\n");
     }
 
-    lib.log.console("      HMAC file: %s\n", u->hmac_file);
+    lib.log.console("      HMAC file: %s\n", u->hmac_file ? u->hmac_file : "(unset)");
     for (int j = 0; j < (int)sizeof(u->hmac_key); ++j) {
       if (u->hmac_key[j] != 0) {
         all_zero = 0;
         break;
       }
     }
-    if (!all_zero) {
+    if (!all_zero && u->keyring_der) {
+      lib.log.console("      HMAC key loaded from keyring\n");
+    } else if (!all_zero) {
       lib.log.console("      HMAC key loaded from %s\n", u->hmac_file);
     } else {
       lib.log.console("      HMAC key not loaded\n");
@@ -158,6 +177,25 @@ void config_debug_dump_ptr(const siglatch_config *cfg) {
                     s->enforce_wire_decode ? "yes" : "no");
     lib.log.console("      Enforce Wire Auth   : %s\n",
                     s->enforce_wire_auth ? "yes" : "no");
+    lib.log.console("      Reply Cache : %d ms\n", s->reply_cache_ms);
+    lib.log.console("      Coalesce Replies    : %s\n",
+                    s->coalesce_replies ? "yes" : "no");
+    if (s->rate_limit > 0) {
+      lib.log.console("      Rate Limit  : %d/s burst %d per /%d (IPv4), /%d (IPv6)\n",
+                      s->rate_limit,
+                      s->rate_limit_burst > 0 ? s->rate_limit_burst : s->rate_limit,
+                      s->rate_limit_prefix_v4 > 0 ? s->rate_limit_prefix_v4 : 32,
+                      s->rate_limit_prefix_v6 > 0 ? s->rate_limit_prefix_v6 : 64);
+    } else {
+      lib.log.console("      Rate Limit  : off\n");
+    }
+    if (s->overload_high_water > 0) {
+      lib.log.console("      Load Shedding       : from %d queued\n", s->overload_high_water);
+    } else {
+      lib.log.console("      Load Shedding       : off\n");
+    }
+    lib.log.console("      Deaddrop Match      : %s\n",
+                    s->deaddrop_longest_match ? "longest" : "first");
     lib.log.console("      Bind IP  : %s\n", s->bind_ip[0] ? s->bind_ip : "(any)");
     lib.log.console("      Port     : %d\n", s->port);
     lib.log.console("      Log file : %s\n", s->log_file[0] ? s->log_file : "(none)");
@@ -213,6 +251,8 @@ void config_debug_dump_ptr(const siglatch_config *cfg) {
     lib.log.console("      Enabled  : %s\n", d->enabled ? "yes" : "no");
     lib.log.console("      Require Ascii Message  : %s\n", d->require_ascii ? "yes" : "no");
     lib.log.console("      exec_split  : %s\n", d->exec_split ? "yes" : "no");
+    lib.log.console("      Timeout ms  : %d\n", d->timeout_ms);
+    lib.log.console("      Payload memfd  : %s\n", d->payload_memfd ? "yes" : "no");
     lib.log.console("      Run As     : %s\n", d->run_as[0] ? d->run_as : "(daemon)");
     lib.log.console("      Constructor: %s\n", d->constructor);
     lib.log.console("      Filters:\n");
@@ -0,0 +1,415 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "index.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../lib.h"
+
+#define CONFIG_INDEX_MIN_CAP 16u
+
+typedef int (*config_index_match_fn)(const siglatch_config *cfg, size_t pos, const void *key);
+
+static uint64_t config_index_hash_id(uint32_t id) {
+  uint64_t h = (uint64_t)id;
+
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+static uint64_t config_index_hash_name(const char *name) {
+  uint64_t h = 1469598103934665603ULL;
+
+  while (*name) {
+    h ^= (uint8_t)*name++;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+/* Keep the load factor at or below one half so probe runs stay short. */
+static int config_index_alloc(siglatch_config_index *index, size_t count) {
+  size_t cap = CONFIG_INDEX_MIN_CAP;
+
+  while (cap < count * 2u) {
+    cap <<= 1;
+  }
+
+  index->slots = calloc(cap, sizeof(*index->slots));
+  if (!index->slots) {
+    index->cap = 0;
+    return 0;
+  }
+
+  index->cap = cap;
+  return 1;
+}
+
+static void config_index_release(siglatch_config_index *index) {
+  free(index->slots);
+  index->slots = NULL;
+  index->cap = 0;
+}
+
+static long config_index_find(const siglatch_config_index *index,
+                              uint64_t hash,
+                              config_index_match_fn match,
+                              const siglatch_config *cfg,
+                              const void *key) {
+  size_t mask = 0;
+  size_t i = 0;
+  size_t n = 0;
+
+  if (!index->slots || index->cap == 0u) {
+    return -1;
+  }
+
+  mask = index->cap - 1u;
+  for (i = (size_t)hash & mask, n = 0; n < index->cap; i = (i + 1u) & mask, ++n) {
+    uint32_t slot = index->slots[i];
+
+    if (slot == 0u) {
+      return -1;
+    }
+    if (match(cfg, (size_t)slot - 1u, key)) {
+      return (long)slot - 1;
+    }
+  }
+
+  return -1;
+}
+
+static void config_index_put(siglatch_config_index *index, uint64_t hash, size_t pos) {
+  size_t mask = index->cap - 1u;
+  size_t i = (size_t)hash & mask;
+
+  while (index->slots[i] != 0u) {
+    i = (i + 1u) & mask;
+  }
+  index->slots[i] = (uint32_t)pos + 1u;
+}
+
+static int config_index_match_user(const siglatch_config *cfg, size_t pos, const void *key) {
+  return cfg->users[pos].id == *(const uint32_t *)key;
+}
+
+static int config_index_match_server(const siglatch_config *cfg, size_t pos, const void *key) {
+  return strcmp(cfg->servers[pos].name, (const char *)key) == 0;
+}
+
+static int config_index_match_deaddrop(const siglatch_config *cfg, size_t pos, const void *key) {
+  return strcmp(cfg->deaddrops[pos].name, (const char *)key) == 0;
+}
+
+/*
+ * Set the grant bit of every action called name. Several actions may share a
+ * name, and each of them used to pass the old name comparison, so the probe
+ * runs to the end of the chain instead of stopping at the first match.
+ */
+static void config_index_grant_by_name(const siglatch_config *cfg,
+                                       const char *name,
+                                       uint8_t *grants) {
+  const siglatch_config_index *index = &cfg->action_by_name;
+  size_t mask = index->cap - 1u;
+  size_t i = (size_t)config_index_hash_name(name) & mask;
+  size_t n = 0;
+
+  for (n = 0; n < index->cap && index->slots[i] != 0u; ++n, i = (i + 1u) & mask) {
+    const siglatch_action *action = &cfg->actions[index->slots[i] - 1u];
+
+    if (action->id < SL_ACTION_ID_SPACE && strcmp(action->name, name) == 0) {
+      grants[action->id >> 3] |= (uint8_t)(1u << (action->id & 7u));
+    }
+  }
+}
+
+static void config_index_compile_grants(siglatch_config *cfg) {
+  int i = 0;
+  int j = 0;
+
+  for (i = 0; i < cfg->user_count; ++i) {
+    siglatch_user *u = &cfg->users[i];
+
+    memset(u->action_grants, 0, sizeof(u->action_grants));
+    for (j = 0; j < u->action_count; ++j) {
+      config_index_grant_by_name(cfg, u->actions[j], u->action_grants);
+    }
+  }
+
+  for (i = 0; i < cfg->server_count; ++i) {
+    siglatch_server *s = &cfg->servers[i];
+
+    memset(s->action_grants, 0, sizeof(s->action_grants));
+    for (j = 0; j < s->action_count; ++j) {
+      config_index_grant_by_name(cfg, s->actions[j], s->action_grants);
+    }
+  }
+}
+
+static uint32_t config_index_trie_node(siglatch_deaddrop_trie *trie) {
+  siglatch_deaddrop_trie_node *node = NULL;
+
+  if (trie->count == trie->cap) {
+    uint32_t next = trie->cap > 0u ? trie->cap * 2u : 64u;
+    siglatch_deaddrop_trie_node *grown = realloc(trie->nodes, (size_t)next * sizeof(*grown));
+
+    if (!grown) {
+      return 0;
+    }
+    trie->nodes = grown;
+    trie->cap = next;
+  }
+
+  node = &trie->nodes[trie->count];
+  memset(node, 0, sizeof(*node));
+  node->rank = UINT32_MAX;
+  node->deaddrop = -1;
+  return trie->count++;
+}
+
+/* Lower rank is earlier in config order; a repeated pattern keeps the first. */
+static int config_index_trie_insert(siglatch_deaddrop_trie *trie,
+                                    const char *pattern,
+                                    uint32_t rank,
+                                    int32_t deaddrop) {
+  uint32_t at = 0;
+  const uint8_t *p = (const uint8_t *)pattern;
+
+  for (; *p; ++p) {
+    uint32_t child = trie->nodes[at].first_child;
+
+    while (child != 0u && trie->nodes[child].byte != *p) {
+      child = trie->nodes[child].next_sibling;
+    }
+
+    if (child == 0u) {
+      child = config_index_trie_node(trie);
+      if (child == 0u) {
+        return 0;
+      }
+      trie->nodes[child].byte = *p;
+      trie->nodes[child].next_sibling = trie->nodes[at].first_child;
+      trie->nodes[at].first_child = child;
+    }
+    at = child;
+  }
+
+  if (rank < trie->nodes[at].rank) {
+    trie->nodes[at].rank = rank;
+    trie->nodes[at].deaddrop = deaddrop;
+  }
+  return 1;
+}
+
+static void config_index_trie_release(siglatch_deaddrop_trie *trie) {
+  free(trie->nodes);
+  memset(trie, 0, sizeof(*trie));
+}
+
+/*
+ * Every enabled deaddrop a server lists contributes its starts_with patterns
+ * to that server's trie, ranked by list position then pattern position, so
+ * the walk can reproduce first-match-in-config-order.
+ */
+static int config_index_compile_deaddrops(siglatch_config *cfg) {
+  int i = 0;
+  int j = 0;
+  int k = 0;
+
+  for (i = 0; i < cfg->server_count; ++i) {
+    siglatch_server *s = &cfg->servers[i];
+
+    config_index_trie_release(&s->deaddrop_trie);
+    (void)config_index_trie_node(&s->deaddrop_trie);
+    if (s->deaddrop_trie.count != 1u) {
+      return 0;
+    }
+
+    for (j = 0; j < s->deaddrop_count; ++j) {
+      const siglatch_deaddrop *d = config_index_deaddrop_by_name(cfg, s->deaddrops[j]);
+
+      if (!d || !d->enabled) {
+        continue;
+      }
+
+      for (k = 0; k < d->starts_with_count; ++k) {
+        if (!config_index_trie_insert(&s->deaddrop_trie,
+                                      d->starts_with[k],
+                                      (uint32_t)j * MAX_FILTERS + (uint32_t)k,
+                                      (int32_t)(d - cfg->deaddrops))) {
+          return 0;
+        }
+      }
+    }
+  }
+
+  return 1;
+}
+
+/*
+ * Duplicates keep the earliest entry, matching the first-match result the
+ * old linear scans gave. Grants are compiled last, against the finished
+ * action tables, and travel with the config so a reload swaps them together.
+ */
+int config_index_build(siglatch_config *cfg) {
+  int i = 0;
+
+  if (!cfg) {
+    return 0;
+  }
+
+  config_index_free(cfg);
+
+  if (!config_index_alloc(&cfg->user_by_id, (size_t)cfg->user_count) ||
+      !config_index_alloc(&cfg->action_by_name, (size_t)cfg->action_count) ||
+      !config_index_alloc(&cfg->server_by_name, (size_t)cfg->server_count) ||
+      !config_index_alloc(&cfg->deaddrop_by_name, (size_t)cfg->deaddrop_count)) {
+    LOGE("Failed to allocate config lookup indexes\n");
+    config_index_free(cfg);
+    return 0;
+  }
+
+  for (i = 0; i < cfg->user_count; ++i) {
+    const siglatch_user *u = &cfg->users[i];
+    uint32_t id = u->id;
+    uint64_t hash = config_index_hash_id(id);
+
+    if (!u->enabled) {
+      continue;
+    }
+    if (config_index_find(&cfg->user_by_id, hash, config_index_match_user, cfg, &id) >= 0) {
+      LOGW("Duplicate enabled user id %u; ignoring [user:%s]\n", id, u->name);
+      continue;
+    }
+    config_index_put(&cfg->user_by_id, hash, (size_t)i);
+  }
+
+  for (i = 0; i < SL_ACTION_ID_SPACE; ++i) {
+    cfg->action_slot[i] = -1;
+  }
+
+  for (i = 0; i < cfg->action_count; ++i) {
+    const siglatch_action *a = &cfg->actions[i];
+
+    config_index_put(&cfg->action_by_name, config_index_hash_name(a->name), (size_t)i);
+
+    if (a->id >= SL_ACTION_ID_SPACE) {
+      LOGW("Action id %u does not fit the wire; [action:%s] is unreachable\n", a->id, a->name);
+      continue;
+    }
+    if (cfg->action_slot[a->id] >= 0) {
+      LOGW("Duplicate action id %u; ignoring [action:%s]\n", a->id, a->name);
+      continue;
+    }
+    cfg->action_slot[a->id] = (int16_t)i;
+  }
+
+  for (i = 0; i < cfg->server_count; ++i) {
+    const char *name = cfg->servers[i].name;
+    uint64_t hash = config_index_hash_name(name);
+
+    if (config_index_find(&cfg->server_by_name, hash, config_index_match_server, cfg, name) < 0) {
+      config_index_put(&cfg->server_by_name, hash, (size_t)i);
+    }
+  }
+
+  for (i = 0; i < cfg->deaddrop_count; ++i) {
+    const char *name = cfg->deaddrops[i].name;
+    uint64_t hash = config_index_hash_name(name);
+
+    if (config_index_find(&cfg->deaddrop_by_name, hash, config_index_match_deaddrop, cfg, name) >= 0) {
+      LOGW("Duplicate deaddrop name '%s'; ignoring later definition\n", name);
+      continue;
+    }
+    config_index_put(&cfg->deaddrop_by_name, hash, (size_t)i);
+  }
+
+  config_index_compile_grants(cfg);
+
+  if (!config_index_compile_deaddrops(cfg)) {
+    LOGE("Failed to allocate deaddrop prefix tries\n");
+    config_index_free(cfg);
+    return 0;
+  }
+
+  return 1;
+}
+
+void config_index_free(siglatch_config *cfg) {
+  int i = 0;
+
+  if (!cfg) {
+    return;
+  }
+
+  for (i = 0; i < cfg->server_count; ++i) {
+    config_index_trie_release(&cfg->servers[i].deaddrop_trie);
+  }
+
+  config_index_release(&cfg->user_by_id);
+  config_index_release(&cfg->action_by_name);
+  config_index_release(&cfg->server_by_name);
+  config_index_release(&cfg->deaddrop_by_name);
+}
+
+const siglatch_user *config_index_user_by_id(const siglatch_config *cfg, uint32_t id) {
+  long pos = 0;
+
+  if (!cfg) {
+    return NULL;
+  }
+
+  pos = config_index_find(&cfg->user_by_id,
+                          config_index_hash_id(id),
+                          config_index_match_user,
+                          cfg,
+                          &id);
+  return pos >= 0 ? &cfg->users[pos] : NULL;
+}
+
+const siglatch_action *config_index_action_by_id(const siglatch_config *cfg, uint32_t id) {
+  if (!cfg || id >= SL_ACTION_ID_SPACE || !cfg->actions || cfg->action_slot[id] < 0) {
+    return NULL;
+  }
+
+  return &cfg->actions[cfg->action_slot[id]];
+}
+
+const siglatch_server *config_index_server_by_name(const siglatch_config *cfg, const char *name) {
+  long pos = 0;
+
+  if (!cfg || !name) {
+    return NULL;
+  }
+
+  pos = config_index_find(&cfg->server_by_name,
+                          config_index_hash_name(name),
+                          config_index_match_server,
+                          cfg,
+                          name);
+  return pos >= 0 ? &cfg->servers[pos] : NULL;
+}
+
+const siglatch_deaddrop *config_index_deaddrop_by_name(const siglatch_config *cfg,
+                                                       const char *name) {
+  long pos = 0;
+
+  if (!cfg || !name) {
+    return NULL;
+  }
+
+  pos = config_index_find(&cfg->deaddrop_by_name,
+                          config_index_hash_name(name),
+                          config_index_match_deaddrop,
+                          cfg,
+                          name);
+  return pos >= 0 ? &cfg->deaddrops[pos] : NULL;
+}
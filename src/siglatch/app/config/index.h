@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef SIGLATCH_SERVER_APP_CONFIG_INDEX_H
+#define SIGLATCH_SERVER_APP_CONFIG_INDEX_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+int config_index_build(siglatch_config *cfg);
+void config_index_free(siglatch_config *cfg);
+
+const siglatch_user *config_index_user_by_id(const siglatch_config *cfg, uint32_t id);
+const siglatch_action *config_index_action_by_id(const siglatch_config *cfg, uint32_t id);
+const siglatch_server *config_index_server_by_name(const siglatch_config *cfg, const char *name);
+const siglatch_deaddrop *config_index_deaddrop_by_name(const siglatch_config *cfg,
+                                                       const char *name);
+
+#endif
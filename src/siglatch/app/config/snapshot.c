@@ -0,0 +1,572 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "snapshot.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <openssl/evp.h>
+
+#include "index.h"
+#include "user.h"
+#include "../version.h"
+#include "../../lib.h"
+
+#define CONFIG_SNAPSHOT_MAGIC "SLCFGSNP"
+#define CONFIG_SNAPSHOT_FORMAT 2u
+#define CONFIG_SNAPSHOT_BUILD SIGLATCH_SERVER_VERSION " " __DATE__ " " __TIME__
+/* Zero runs shorter than this stay inside the literal around them. */
+#define CONFIG_SNAPSHOT_MIN_GAP 16u
+
+/*
+ * The body is the config struct and its user, action and deaddrop tables,
+ * each stored as (zero count, literal length, literal bytes) runs. The
+ * structs are mostly empty fixed-size strings, so this keeps the file near
+ * the size of the INI it came from. Each user is followed by its heap
+ * storage: the two key paths as (length, bytes), 0 for unset, then its
+ * action and IP lists as runs.
+ */
+typedef struct {
+  char magic[8];
+  uint32_t format;
+  uint32_t header_size;
+  char build[64];
+  uint32_t config_size;
+  uint32_t user_size;
+  uint32_t action_size;
+  uint32_t deaddrop_size;
+  uint32_t user_count;
+  uint32_t action_count;
+  uint32_t deaddrop_count;
+  uint32_t reserved;
+  uint64_t source_size;
+  uint8_t source_digest[CONFIG_SNAPSHOT_DIGEST_LEN];
+} ConfigSnapshotHeader;
+
+static int config_snapshot_path(const char *config_path, char *out, size_t out_size) {
+  int written = snprintf(out, out_size, "%s%s", config_path, CONFIG_SNAPSHOT_SUFFIX);
+
+  return written > 0 && (size_t)written < out_size;
+}
+
+/* SHA-256 and size of the INI file as it is on disk now. */
+int config_snapshot_fingerprint(const char *config_path, config_snapshot_source *out) {
+  uint8_t buf[16384];
+  EVP_MD_CTX *ctx = NULL;
+  FILE *fp = NULL;
+  size_t n = 0;
+  int ok = 0;
+
+  if (!config_path || !out) {
+    return 0;
+  }
+
+  memset(out, 0, sizeof(*out));
+  fp = fopen(config_path, "rb");
+  if (!fp) {
+    return 0;
+  }
+
+  ctx = EVP_MD_CTX_new();
+  if (ctx && EVP_DigestInit_ex(ctx, EVP_sha256(), NULL) == 1) {
+    ok = 1;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+      if (EVP_DigestUpdate(ctx, buf, n) != 1) {
+        ok = 0;
+        break;
+      }
+      out->size += n;
+    }
+    if (ok && (ferror(fp) || EVP_DigestFinal_ex(ctx, out->digest, NULL) != 1)) {
+      ok = 0;
+    }
+  }
+
+  EVP_MD_CTX_free(ctx);
+  fclose(fp);
+  return ok;
+}
+
+int config_snapshot_same_source(const config_snapshot_source *a, const config_snapshot_source *b) {
+  return a && b && a->size == b->size && memcmp(a->digest, b->digest, sizeof(a->digest)) == 0;
+}
+
+/*
+ * Clear what key loading and index building fill in. The snapshot is taken
+ * before either runs, and a loaded one goes through both again. A new field
+ * of that kind must be cleared here too.
+ */
+static void config_snapshot_reset_config(siglatch_config *cfg) {
+  int i = 0;
+
+  cfg->refs = 1;
+  cfg->users = NULL;
+  cfg->user_capacity = 0;
+  cfg->actions = NULL;
+  cfg->action_capacity = 0;
+  cfg->deaddrops = NULL;
+  cfg->deaddrop_capacity = 0;
+  cfg->master_privkey = NULL;
+  memset(&cfg->master_key_stamp, 0, sizeof(cfg->master_key_stamp));
+  cfg->keyring_map = NULL;
+  cfg->keyring_map_len = 0;
+  memset(&cfg->user_by_id, 0, sizeof(cfg->user_by_id));
+  memset(&cfg->action_by_name, 0, sizeof(cfg->action_by_name));
+  memset(&cfg->server_by_name, 0, sizeof(cfg->server_by_name));
+  memset(&cfg->deaddrop_by_name, 0, sizeof(cfg->deaddrop_by_name));
+
+  for (i = 0; i < MAX_SERVERS; ++i) {
+    siglatch_server *s = &cfg->servers[i];
+
+    s->priv_key = NULL;
+    s->key_owned = 0;
+    memset(&s->priv_key_stamp, 0, sizeof(s->priv_key_stamp));
+    memset(&s->deaddrop_trie, 0, sizeof(s->deaddrop_trie));
+  }
+}
+
+static void config_snapshot_reset_user(siglatch_user *u) {
+  u->key_file = NULL;
+  u->hmac_file = NULL;
+  u->actions = NULL;
+  u->allowed_ips = NULL;
+  u->pubkey = NULL;
+  u->keyring_der = NULL;
+  u->keyring_der_len = 0;
+  u->key_state = SL_USER_KEY_SETTLED;
+  memset(u->hmac_key, 0, sizeof(u->hmac_key));
+  memset(&u->key_stamp, 0, sizeof(u->key_stamp));
+  memset(&u->hmac_stamp, 0, sizeof(u->hmac_stamp));
+}
+
+static int config_snapshot_put_run(FILE *fp, uint32_t zeros, const uint8_t *literal, uint32_t len) {
+  uint32_t head[2];
+
+  head[0] = zeros;
+  head[1] = len;
+  if (fwrite(head, sizeof(head), 1, fp) != 1) {
+    return 0;
+  }
+
+  return len == 0u || fwrite(literal, len, 1, fp) == 1;
+}
+
+static int config_snapshot_encode(FILE *fp, const void *data, size_t len) {
+  const uint8_t *p = data;
+  size_t at = 0;
+
+  while (at < len) {
+    size_t zeros = 0;
+    size_t lit_start = 0;
+    size_t lit_end = 0;
+    size_t gap = 0;
+
+    while (at + zeros < len && p[at + zeros] == 0u) {
+      zeros++;
+    }
+
+    lit_start = at + zeros;
+    lit_end = lit_start;
+    while (lit_end < len) {
+      if (p[lit_end] != 0u) {
+        lit_end++;
+        gap = 0;
+        continue;
+      }
+
+      gap = 0;
+      while (lit_end + gap < len && p[lit_end + gap] == 0u && gap < CONFIG_SNAPSHOT_MIN_GAP) {
+        gap++;
+      }
+      if (gap >= CONFIG_SNAPSHOT_MIN_GAP || lit_end + gap == len) {
+        break;
+      }
+      lit_end += gap;
+    }
+
+    if (!config_snapshot_put_run(fp, (uint32_t)zeros, p + lit_start, (uint32_t)(lit_end - lit_start))) {
+      return 0;
+    }
+    at = lit_end;
+  }
+
+  return 1;
+}
+
+/* Fill dst (already zeroed) from runs at *pos, and stop exactly at its end. */
+static int config_snapshot_decode(const uint8_t **pos, const uint8_t *end, void *dst, size_t len) {
+  uint8_t *out = dst;
+  size_t filled = 0;
+
+  while (filled < len) {
+    uint32_t head[2];
+
+    if ((size_t)(end - *pos) < sizeof(head)) {
+      return 0;
+    }
+    memcpy(head, *pos, sizeof(head));
+    *pos += sizeof(head);
+
+    if ((uint64_t)head[0] + head[1] == 0u ||
+        (uint64_t)head[0] + head[1] > len - filled ||
+        head[1] > (size_t)(end - *pos)) {
+      return 0;
+    }
+
+    filled += head[0];
+    memcpy(out + filled, *pos, head[1]);
+    *pos += head[1];
+    filled += head[1];
+  }
+
+  return 1;
+}
+
+static int config_snapshot_put_path(FILE *fp, const char *path) {
+  uint32_t len = path ? (uint32_t)strlen(path) : 0u;
+
+  if (fwrite(&len, sizeof(len), 1, fp) != 1) {
+    return 0;
+  }
+
+  return len == 0u || fwrite(path, len, 1, fp) == 1;
+}
+
+static int config_snapshot_get_path(const uint8_t **pos, const uint8_t *end, char **out) {
+  uint32_t len = 0;
+  char *path = NULL;
+
+  if ((size_t)(end - *pos) < sizeof(len)) {
+    return 0;
+  }
+  memcpy(&len, *pos, sizeof(len));
+  *pos += sizeof(len);
+
+  if (len == 0u) {
+    return 1;
+  }
+  if (len >= PATH_MAX || len > (size_t)(end - *pos)) {
+    return 0;
+  }
+
+  path = malloc((size_t)len + 1u);
+  if (!path) {
+    return 0;
+  }
+  memcpy(path, *pos, len);
+  path[len] = '\0';
+  *pos += len;
+  *out = path;
+  return 1;
+}
+
+/* Decode one user and its heap storage. Anything allocated stays on u. */
+static int config_snapshot_get_user(const uint8_t **pos, const uint8_t *end, siglatch_user *u) {
+  int decoded = config_snapshot_decode(pos, end, u, sizeof(*u));
+
+  config_snapshot_reset_user(u);
+  if (!decoded) {
+    u->action_count = 0;
+    u->allowed_ip_count = 0;
+    return 0;
+  }
+
+  if (u->action_count < 0 || u->action_count > MAX_ACTIONS ||
+      u->allowed_ip_count < 0 || u->allowed_ip_count > MAX_IP_RANGES) {
+    u->action_count = 0;
+    u->allowed_ip_count = 0;
+    return 0;
+  }
+
+  if (!config_snapshot_get_path(pos, end, &u->key_file) ||
+      !config_snapshot_get_path(pos, end, &u->hmac_file)) {
+    return 0;
+  }
+
+  if (u->action_count > 0) {
+    u->actions = calloc((size_t)u->action_count, sizeof(*u->actions));
+    if (!u->actions ||
+        !config_snapshot_decode(pos, end, u->actions,
+                                (size_t)u->action_count * sizeof(*u->actions))) {
+      return 0;
+    }
+  }
+
+  if (u->allowed_ip_count > 0) {
+    u->allowed_ips = calloc((size_t)u->allowed_ip_count, sizeof(*u->allowed_ips));
+    if (!u->allowed_ips ||
+        !config_snapshot_decode(pos, end, u->allowed_ips,
+                                (size_t)u->allowed_ip_count * sizeof(*u->allowed_ips))) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+static int config_snapshot_put_user(FILE *fp, const siglatch_user *u) {
+  siglatch_user user = *u;
+
+  config_snapshot_reset_user(&user);
+  if (!config_snapshot_encode(fp, &user, sizeof(user)) ||
+      !config_snapshot_put_path(fp, u->key_file) ||
+      !config_snapshot_put_path(fp, u->hmac_file)) {
+    return 0;
+  }
+
+  if (u->action_count > 0 &&
+      !config_snapshot_encode(fp, u->actions, (size_t)u->action_count * sizeof(*u->actions))) {
+    return 0;
+  }
+
+  return u->allowed_ip_count <= 0 ||
+         config_snapshot_encode(fp, u->allowed_ips,
+                                (size_t)u->allowed_ip_count * sizeof(*u->allowed_ips));
+}
+
+static int config_snapshot_header_ok(const ConfigSnapshotHeader *h, const config_snapshot_source *source) {
+  return memcmp(h->magic, CONFIG_SNAPSHOT_MAGIC, sizeof(h->magic)) == 0 &&
+         h->format == CONFIG_SNAPSHOT_FORMAT &&
+         h->header_size == sizeof(*h) &&
+         strncmp(h->build, CONFIG_SNAPSHOT_BUILD, sizeof(h->build)) == 0 &&
+         h->config_size == sizeof(siglatch_config) &&
+         h->user_size == sizeof(siglatch_user) &&
+         h->action_size == sizeof(siglatch_action) &&
+         h->deaddrop_size == sizeof(siglatch_deaddrop) &&
+         h->user_count <= MAX_USERS &&
+         h->action_count <= MAX_ACTION_DEFS &&
+         h->deaddrop_count <= MAX_DEADDROPS &&
+         h->source_size == source->size &&
+         memcmp(h->source_digest, source->digest, sizeof(h->source_digest)) == 0;
+}
+
+static void config_snapshot_free_users(siglatch_user *users, uint32_t count) {
+  uint32_t i = 0;
+
+  for (i = 0; i < count; ++i) {
+    config_user_free_storage(&users[i]);
+  }
+  free(users);
+}
+
+static void config_snapshot_discard(siglatch_config *cfg) {
+  if (!cfg) {
+    return;
+  }
+
+  config_index_free(cfg);
+  config_snapshot_free_users(cfg->users, (uint32_t)cfg->user_count);
+  free(cfg->actions);
+  free(cfg->deaddrops);
+  free(cfg);
+}
+
+static siglatch_config *config_snapshot_materialize(const uint8_t *map, size_t len) {
+  const ConfigSnapshotHeader *h = (const ConfigSnapshotHeader *)map;
+  const uint8_t *pos = map + sizeof(*h);
+  const uint8_t *end = map + len;
+  siglatch_config *cfg = NULL;
+  siglatch_user *users = NULL;
+  siglatch_action *actions = NULL;
+  siglatch_deaddrop *deaddrops = NULL;
+  uint32_t i = 0;
+  int ok = 0;
+
+  cfg = calloc(1, sizeof(*cfg));
+  users = calloc(h->user_count > 0u ? h->user_count : 1u, sizeof(*users));
+  actions = calloc(h->action_count > 0u ? h->action_count : 1u, sizeof(*actions));
+  deaddrops = calloc(h->deaddrop_count > 0u ? h->deaddrop_count : 1u, sizeof(*deaddrops));
+  ok = cfg && users && actions && deaddrops &&
+       config_snapshot_decode(&pos, end, cfg, sizeof(*cfg));
+  for (i = 0; ok && i < h->user_count; ++i) {
+    ok = config_snapshot_get_user(&pos, end, &users[i]);
+  }
+  if (!ok ||
+      !config_snapshot_decode(&pos, end, actions, (size_t)h->action_count * sizeof(*actions)) ||
+      !config_snapshot_decode(&pos, end, deaddrops, (size_t)h->deaddrop_count * sizeof(*deaddrops)) ||
+      pos != end) {
+    free(cfg);
+    if (users) {
+      config_snapshot_free_users(users, h->user_count);
+    }
+    free(actions);
+    free(deaddrops);
+    return NULL;
+  }
+
+  config_snapshot_reset_config(cfg);
+
+  cfg->users = users;
+  cfg->user_count = (int)h->user_count;
+  cfg->user_capacity = (int)h->user_count;
+  cfg->actions = actions;
+  cfg->action_count = (int)h->action_count;
+  cfg->action_capacity = (int)h->action_count;
+  cfg->deaddrops = deaddrops;
+  cfg->deaddrop_count = (int)h->deaddrop_count;
+  cfg->deaddrop_capacity = (int)h->deaddrop_count;
+
+  if (cfg->server_count < 0 || cfg->server_count > MAX_SERVERS || !config_index_build(cfg)) {
+    config_snapshot_discard(cfg);
+    return NULL;
+  }
+
+  return cfg;
+}
+
+/*
+ * The materialized tables for config_path if its cache was written from the
+ * same INI bytes by this build, else NULL. Keys are not in the cache; the
+ * caller loads them as it would after a parse.
+ */
+siglatch_config *config_snapshot_load(const char *config_path, const config_snapshot_source *source) {
+  char path[PATH_MAX];
+  struct stat st;
+  void *map = MAP_FAILED;
+  siglatch_config *cfg = NULL;
+  int fd = -1;
+
+  if (!config_path || !source || !config_snapshot_path(config_path, path, sizeof(path))) {
+    return NULL;
+  }
+
+  fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ConfigSnapshotHeader)) {
+    close(fd);
+    return NULL;
+  }
+
+  map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    return NULL;
+  }
+
+  if (!config_snapshot_header_ok(map, source)) {
+    LOGD("Config cache %s is stale; parsing %s\n", path, config_path);
+  } else {
+    cfg = config_snapshot_materialize(map, (size_t)st.st_size);
+    if (!cfg) {
+      LOGW("Config cache %s is damaged; parsing %s\n", path, config_path);
+    }
+  }
+
+  munmap(map, (size_t)st.st_size);
+  return cfg;
+}
+
+static int config_snapshot_write_body(FILE *fp, const siglatch_config *cfg) {
+  siglatch_config *copy = NULL;
+  int ok = 0;
+  int i = 0;
+
+  copy = malloc(sizeof(*copy));
+  if (!copy) {
+    return 0;
+  }
+
+  memcpy(copy, cfg, sizeof(*copy));
+  config_snapshot_reset_config(copy);
+  copy->refs = 0;
+  ok = config_snapshot_encode(fp, copy, sizeof(*copy));
+  free(copy);
+
+  for (i = 0; ok && i < cfg->user_count; ++i) {
+    ok = config_snapshot_put_user(fp, &cfg->users[i]);
+  }
+
+  if (ok && cfg->action_count > 0) {
+    ok = config_snapshot_encode(fp, cfg->actions, (size_t)cfg->action_count * sizeof(*cfg->actions));
+  }
+  if (ok && cfg->deaddrop_count > 0) {
+    ok = config_snapshot_encode(fp, cfg->deaddrops,
+                                (size_t)cfg->deaddrop_count * sizeof(*cfg->deaddrops));
+  }
+
+  return ok;
+}
+
+/*
+ * Save cfg, as parsed from source, beside config_path. Written to a temporary
+ * file and renamed into place. Failure only costs the next start a parse.
+ */
+int config_snapshot_write(const char *config_path,
+                          const siglatch_config *cfg,
+                          const config_snapshot_source *source) {
+  ConfigSnapshotHeader header;
+  char path[PATH_MAX];
+  char tmp_path[PATH_MAX];
+  FILE *fp = NULL;
+  int fd = -1;
+  int ok = 0;
+
+  if (!config_path || !cfg || !source ||
+      !config_snapshot_path(config_path, path, sizeof(path)) ||
+      snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+    return 0;
+  }
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CONFIG_SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.format = CONFIG_SNAPSHOT_FORMAT;
+  header.header_size = sizeof(header);
+  lib.str.lcpy(header.build, CONFIG_SNAPSHOT_BUILD, sizeof(header.build));
+  header.config_size = sizeof(siglatch_config);
+  header.user_size = sizeof(siglatch_user);
+  header.action_size = sizeof(siglatch_action);
+  header.deaddrop_size = sizeof(siglatch_deaddrop);
+  header.user_count = (uint32_t)cfg->user_count;
+  header.action_count = (uint32_t)cfg->action_count;
+  header.deaddrop_count = (uint32_t)cfg->deaddrop_count;
+  header.source_size = source->size;
+  memcpy(header.source_digest, source->digest, sizeof(header.source_digest));
+
+  fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  fp = fd >= 0 ? fdopen(fd, "wb") : NULL;
+  if (!fp) {
+    LOGW("Cannot write config cache %s: %s\n", tmp_path, strerror(errno));
+    if (fd >= 0) {
+      close(fd);
+    }
+    return 0;
+  }
+
+  ok = fwrite(&header, sizeof(header), 1, fp) == 1 && config_snapshot_write_body(fp, cfg);
+  if (fclose(fp) != 0) {
+    ok = 0;
+  }
+
+  if (ok && rename(tmp_path, path) != 0) {
+    ok = 0;
+  }
+
+  if (!ok) {
+    LOGW("Cannot write config cache %s: %s\n", path, strerror(errno));
+    unlink(tmp_path);
+    return 0;
+  }
+
+  LOGD("Wrote config cache %s\n", path);
+  return 1;
+}
+
+void config_snapshot_remove(const char *config_path) {
+  char path[PATH_MAX];
+
+  if (config_path && config_snapshot_path(config_path, path, sizeof(path)) &&
+      unlink(path) == 0) {
+    LOGD("Removed config cache %s\n", path);
+  }
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef SIGLATCH_SERVER_APP_CONFIG_SNAPSHOT_H
+#define SIGLATCH_SERVER_APP_CONFIG_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "config.h"
+
+/*
+ * With config_cache set, the parsed config tables are saved beside the INI
+ * file as <config>.cache and reused while the INI file's SHA-256 still
+ * matches. The cache belongs to one siglatchd build; any other build, or a
+ * changed INI file, falls back to a full parse.
+ */
+#define CONFIG_SNAPSHOT_SUFFIX ".cache"
+#define CONFIG_SNAPSHOT_DIGEST_LEN 32u
+
+typedef struct {
+  uint8_t digest[CONFIG_SNAPSHOT_DIGEST_LEN];
+  uint64_t size;
+} config_snapshot_source;
+
+int config_snapshot_fingerprint(const char *config_path, config_snapshot_source *out);
+int config_snapshot_same_source(const config_snapshot_source *a, const config_snapshot_source *b);
+siglatch_config *config_snapshot_load(const char *config_path, const config_snapshot_source *source);
+int config_snapshot_write(const char *config_path,
+                          const siglatch_config *cfg,
+                          const config_snapshot_source *source);
+void config_snapshot_remove(const char *config_path);
+
+#endif
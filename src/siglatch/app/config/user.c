@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "user.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../lib.h"
+
+int config_user_set_path(char **path, const char *value) {
+  char *copy = NULL;
+
+  if (!path || !value) {
+    return 0;
+  }
+
+  copy = lib.str.dup(value);
+  if (!copy) {
+    return 0;
+  }
+
+  free(*path);
+  *path = copy;
+  return 1;
+}
+
+/*
+ * Append the comma-separated items in value, as parse_csv_fixed would to an
+ * inline array, then trim the allocation to what was kept.
+ */
+int config_user_add_list(void **items, int *count, int max_items, size_t item_size, const char *value) {
+  char *grown = NULL;
+  void *trimmed = NULL;
+  int next = 0;
+
+  if (!items || !count || max_items <= 0 || item_size == 0 || !value) {
+    return 0;
+  }
+
+  grown = calloc((size_t)max_items, item_size);
+  if (!grown) {
+    return 0;
+  }
+
+  next = *count;
+  if (next > 0 && *items) {
+    memcpy(grown, *items, (size_t)next * item_size);
+  }
+  lib.str.parse_csv_fixed(grown, &next, max_items, item_size, value);
+
+  if (next == 0) {
+    free(grown);
+    return 1;
+  }
+
+  trimmed = realloc(grown, (size_t)next * item_size);
+  free(*items);
+  *items = trimmed ? trimmed : grown;
+  *count = next;
+  return 1;
+}
+
+void config_user_free_storage(siglatch_user *u) {
+  if (!u) {
+    return;
+  }
+
+  free(u->key_file);
+  free(u->hmac_file);
+  free(u->actions);
+  free(u->allowed_ips);
+  u->key_file = NULL;
+  u->hmac_file = NULL;
+  u->actions = NULL;
+  u->allowed_ips = NULL;
+  u->action_count = 0;
+  u->allowed_ip_count = 0;
+}
@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef SIGLATCH_SERVER_APP_CONFIG_USER_H
+#define SIGLATCH_SERVER_APP_CONFIG_USER_H
+
+#include <stddef.h>
+
+#include "config.h"
+
+/*
+ * A user's key paths and its action and IP lists live on the heap, sized to
+ * what the INI sets, rather than inline at their maximums. The table that
+ * holds the user owns them; free them with config_user_free_storage().
+ */
+int config_user_set_path(char **path, const char *value);
+int config_user_add_list(void **items, int *count, int max_items, size_t item_size, const char *value);
+void config_user_free_storage(siglatch_user *u);
+
+#endif
@@ -32,6 +32,8 @@ static int app_daemon_auth_authorize(SiglatchOpenSSLSession *session,
     return 1;
   }
 
+  job->auth_result = -1;
+
   if (!session) {
     LOGE("[daemon.auth] Null session for structured job (user_id=%u action_id=%u)\n",
          job->request.user_id,
@@ -55,6 +57,7 @@ static int app_daemon_auth_authorize(SiglatchOpenSSLSession *session,
   }
 
   job->wire_auth = 1;
+  job->auth_result = 1;
   return 1;
 }
 
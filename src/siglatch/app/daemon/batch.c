@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "batch.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../app.h"
+#include "../../lib.h"
+#include "../../../shared/shared.h"
+
+static int app_daemon_batch_init(void) {
+  return 1;
+}
+
+static void app_daemon_batch_shutdown(void) {
+}
+
+static int app_daemon_batch_is_batch(const AppConnectionJob *job) {
+  return job && job->wire_version != 0u &&
+         job->request.action_id == SL_KNOCK_BATCH_ACTION_ID;
+}
+
+/* Builtins touch loop-owned state, so a batch only carries worker-safe handlers. */
+static int app_daemon_batch_step_supported(const siglatch_action *action) {
+  if (!action) {
+    return 0;
+  }
+
+  if (action->handler == SL_ACTION_HANDLER_STATIC ||
+      action->handler == SL_ACTION_HANDLER_DYNAMIC) {
+    return 1;
+  }
+
+  return action->handler == SL_ACTION_HANDLER_SHELL && action->constructor[0] != '\0';
+}
+
+/*
+ * Authenticate a batch request once and resolve every entry against the
+ * user's policy. Entries that fail resolution stay in the plan so the reply
+ * can report them in order. The plan replaces anything left in the job's
+ * arena from an earlier, deferred attempt.
+ */
+static int app_daemon_batch_prepare(const AppRuntimeListenerState *listener,
+                                    AppConnectionJob *job,
+                                    SiglatchOpenSSLSession *session,
+                                    const siglatch_user **out_user) {
+  SharedKnockBatchView view = {0};
+  AppDaemonBatchPlan *plan = NULL;
+  const siglatch_user *user = NULL;
+  size_t i = 0;
+
+  if (!listener || !listener->server || !job || !session || !out_user) {
+    return 0;
+  }
+
+  user = app.config.user_by_id(job->request.user_id);
+  if (!user) {
+    LOGW("[daemon.batch] No matching enabled user for user_id %u\n", job->request.user_id);
+    return 0;
+  }
+
+  if (!app.daemon.auth.authorize(session, job)) {
+    LOGE("[daemon.batch] Signature authorization failed for user_id=%u\n",
+         job->request.user_id);
+    return 0;
+  }
+
+  if (!shared.knock.batch.parse(job->request.payload_buffer, job->request.payload_len, &view)) {
+    LOGW("[daemon.batch] Malformed batch envelope from %s (user_id=%u, %zu bytes)\n",
+         job->ip,
+         job->request.user_id,
+         job->request.payload_len);
+    return 0;
+  }
+
+  job->batch = NULL;
+  lib.arena.reset(job->arena);
+  plan = (AppDaemonBatchPlan *)lib.arena.calloc(job->arena, 1u, sizeof(*plan));
+  if (!plan) {
+    LOGE("[daemon.batch] Failed to allocate batch plan (%zu entries)\n", view.count);
+    return 0;
+  }
+
+  plan->flags = view.flags;
+  plan->count = view.count;
+
+  for (i = 0; i < view.count; ++i) {
+    const SharedKnockBatchEntry *entry = &view.entries[i];
+    AppBatchStep *step = &plan->steps[i];
+    const siglatch_action *action = app.config.action_by_id(entry->action_id);
+
+    step->action_id = entry->action_id;
+    step->payload = entry->payload;
+    step->payload_len = entry->payload_len;
+
+    if (!action) {
+      LOGW("[daemon.batch] Unknown action ID %u in batch entry %zu\n", entry->action_id, i);
+      step->state = APP_BATCH_STEP_UNKNOWN;
+      continue;
+    }
+
+    step->action = *action;
+    /* One aggregated reply per batch; per-entry output is not streamed. */
+    step->action.stream_reply = 0;
+
+    if (!app.daemon.policy.enforce(listener, job, user, action)) {
+      step->state = APP_BATCH_STEP_DENIED;
+      continue;
+    }
+
+    if (!app_daemon_batch_step_supported(action)) {
+      LOGW("[daemon.batch] Action (%s) cannot run inside a batch\n", action->name);
+      step->state = APP_BATCH_STEP_UNSUPPORTED;
+      continue;
+    }
+
+    step->state = APP_BATCH_STEP_RUN;
+  }
+
+  LOGD("[daemon.batch] Prepared %zu entries for user %s (flags=0x%02x)\n",
+       plan->count,
+       user->name,
+       (unsigned)plan->flags);
+
+  job->batch = plan;
+  *out_user = user;
+  return 1;
+}
+
+/*
+ * The action a batch is submitted under. The executor also reserves a
+ * concurrency slot for every other distinct action in the plan, so each
+ * one's limit applies. NULL means nothing in the plan needs a worker.
+ */
+static const siglatch_action *app_daemon_batch_lead_action(const AppConnectionJob *job) {
+  size_t i = 0;
+
+  if (!job || !job->batch) {
+    return NULL;
+  }
+
+  for (i = 0; i < job->batch->count; ++i) {
+    if (job->batch->steps[i].state == APP_BATCH_STEP_RUN) {
+      return &job->batch->steps[i].action;
+    }
+  }
+
+  return NULL;
+}
+
+static void app_daemon_batch_append_line(AppActionReply *reply,
+                                         size_t *inout_len,
+                                         const AppBatchStep *step,
+                                         const char *text) {
+  char prefix[MAX_ACTION_NAME + 8];
+  int written = 0;
+
+  if (step->action.label[0] != '\0') {
+    snprintf(prefix, sizeof(prefix), "%s", step->action.label);
+  } else {
+    snprintf(prefix, sizeof(prefix), "%u", (unsigned int)step->action_id);
+  }
+
+  if (*inout_len >= sizeof(reply->message) - 1u) {
+    reply->truncated = 1;
+    return;
+  }
+
+  written = snprintf(reply->message + *inout_len,
+                     sizeof(reply->message) - *inout_len,
+                     "%s%s: %s",
+                     *inout_len > 0u ? "\n" : "",
+                     prefix,
+                     text);
+  if (written < 0) {
+    return;
+  }
+
+  if ((size_t)written >= sizeof(reply->message) - *inout_len) {
+    reply->truncated = 1;
+    *inout_len = sizeof(reply->message) - 1u;
+    return;
+  }
+
+  *inout_len += (size_t)written;
+}
+
+/*
+ * Run a prepared plan in order and fold each entry's outcome into one reply,
+ * one line per entry. Safe on executor workers: it only reads the plan and
+ * hands each entry to payload.execute() as its own request.
+ */
+static int app_daemon_batch_execute(const AppConnectionJob *job,
+                                    const siglatch_user *user,
+                                    int secure,
+                                    AppActionReply *reply) {
+  const AppDaemonBatchPlan *plan = NULL;
+  size_t message_len = 0;
+  size_t succeeded = 0;
+  int failed = 0;
+  size_t i = 0;
+
+  if (!job || !job->batch || !user || !reply) {
+    return 0;
+  }
+
+  plan = job->batch;
+  app.payload.reply.reset(reply);
+  reply->should_reply = 1;
+
+  for (i = 0; i < plan->count; ++i) {
+    const AppBatchStep *step = &plan->steps[i];
+    AppConnectionJob entry_job;
+    AppActionReply entry_reply = {0};
+    int ok = 0;
+
+    if (failed && (plan->flags & SL_KNOCK_BATCH_FLAG_STOP_ON_ERROR)) {
+      app_daemon_batch_append_line(reply, &message_len, step, "SKIPPED");
+      continue;
+    }
+
+    switch (step->state) {
+    case APP_BATCH_STEP_UNKNOWN:
+      app_daemon_batch_append_line(reply, &message_len, step, "ERROR unknown_action");
+      failed = 1;
+      continue;
+    case APP_BATCH_STEP_DENIED:
+      app_daemon_batch_append_line(reply, &message_len, step, "ERROR denied");
+      failed = 1;
+      continue;
+    case APP_BATCH_STEP_UNSUPPORTED:
+      app_daemon_batch_append_line(reply, &message_len, step, "ERROR unsupported_in_batch");
+      failed = 1;
+      continue;
+    case APP_BATCH_STEP_RUN:
+    default:
+      break;
+    }
+
+    entry_job = *job;
+    entry_job.batch = NULL;
+    entry_job.request.action_id = step->action_id;
+    entry_job.request.payload_buffer = (uint8_t *)step->payload;
+    entry_job.request.payload_len = step->payload_len;
+    entry_job.request.payload_cap = step->payload_len;
+
+    ok = app.daemon.payload.execute(&entry_job, user, &step->action, secure, &entry_reply);
+    app_daemon_batch_append_line(reply,
+                                 &message_len,
+                                 step,
+                                 entry_reply.message[0] != '\0' ? entry_reply.message
+                                                                : (ok ? "OK" : "ERROR"));
+    if (entry_reply.truncated) {
+      reply->truncated = 1;
+    }
+
+    if (ok) {
+      succeeded++;
+    } else {
+      failed = 1;
+    }
+  }
+
+  reply->ok = !failed;
+  LOGD("[daemon.batch] Batch for user %s finished: %zu/%zu entries ok\n",
+       user->name,
+       succeeded,
+       plan->count);
+  return reply->ok;
+}
+
+static const AppDaemonBatchLib app_daemon_batch_instance = {
+  .init = app_daemon_batch_init,
+  .shutdown = app_daemon_batch_shutdown,
+  .is_batch = app_daemon_batch_is_batch,
+  .prepare = app_daemon_batch_prepare,
+  .lead_action = app_daemon_batch_lead_action,
+  .execute = app_daemon_batch_execute
+};
+
+const AppDaemonBatchLib *get_app_daemon_batch_lib(void) {
+  return &app_daemon_batch_instance;
+}
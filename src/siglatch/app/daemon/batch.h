@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef SIGLATCH_SERVER_APP_DAEMON_BATCH_H
+#define SIGLATCH_SERVER_APP_DAEMON_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "job.h"
+#include "../config/config.h"
+#include "../payload/reply.h"
+#include "../runtime/runtime.h"
+#include "../../../shared/knock/batch.h"
+#include "../../../stdlib/openssl/session/session.h"
+
+typedef enum {
+  APP_BATCH_STEP_RUN = 0,
+  APP_BATCH_STEP_UNKNOWN = 1,
+  APP_BATCH_STEP_DENIED = 2,
+  APP_BATCH_STEP_UNSUPPORTED = 3
+} AppBatchStepState;
+
+/*
+ * One resolved batch entry. The action is a private copy so the plan can run
+ * on an executor worker; payload points into the job's request buffer.
+ */
+typedef struct {
+  uint8_t action_id;
+  AppBatchStepState state;
+  siglatch_action action;
+  const uint8_t *payload;
+  size_t payload_len;
+} AppBatchStep;
+
+/* Lives in the job's arena and goes away with the job. */
+typedef struct AppDaemonBatchPlan {
+  uint8_t flags;
+  size_t count;
+  AppBatchStep steps[SL_KNOCK_BATCH_ENTRY_MAX];
+} AppDaemonBatchPlan;
+
+typedef struct {
+  int (*init)(void);
+  void (*shutdown)(void);
+  int (*is_batch)(const AppConnectionJob *job);
+  int (*prepare)(const AppRuntimeListenerState *listener,
+                 AppConnectionJob *job,
+                 SiglatchOpenSSLSession *session,
+                 const siglatch_user **out_user);
+  const siglatch_action *(*lead_action)(const AppConnectionJob *job);
+  int (*execute)(const AppConnectionJob *job,
+                 const siglatch_user *user,
+                 int secure,
+                 AppActionReply *reply);
+} AppDaemonBatchLib;
+
+const AppDaemonBatchLib *get_app_daemon_batch_lib(void);
+
+#endif
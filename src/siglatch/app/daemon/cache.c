@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "cache.h"
+
+#include <string.h>
+
+#include "../../lib.h"
+
+/*
+ * Loop-thread only: lookups happen during dispatch and stores when a reply is
+ * staged, both on the daemon loop, so the table needs no lock.
+ *
+ * The epoch moves on every invalidation. A lookup miss stamps the job with
+ * the current epoch, and store() drops replies whose job was dispatched under
+ * an older config, so a request still running across a reload cannot refill
+ * the cache with a stale answer.
+ */
+typedef struct {
+  uint32_t epoch;
+  AppDaemonCacheEntry entries[APP_DAEMON_CACHE_SLOTS];
+  AppDaemonCacheStats stats;
+} AppDaemonCacheState;
+
+static AppDaemonCacheState g_app_daemon_cache = {0};
+
+static void app_daemon_cache_log_stats(void) {
+  LOGD("[daemon.cache] Action reply cache: hits=%llu misses=%llu stores=%llu evictions=%llu invalidations=%llu entries=%zu\n",
+       (unsigned long long)g_app_daemon_cache.stats.hits,
+       (unsigned long long)g_app_daemon_cache.stats.misses,
+       (unsigned long long)g_app_daemon_cache.stats.stores,
+       (unsigned long long)g_app_daemon_cache.stats.evictions,
+       (unsigned long long)g_app_daemon_cache.stats.invalidations,
+       g_app_daemon_cache.stats.entries);
+}
+
+static int app_daemon_cache_init(void) {
+  memset(&g_app_daemon_cache, 0, sizeof(g_app_daemon_cache));
+  g_app_daemon_cache.epoch = 1u;
+  return 1;
+}
+
+static void app_daemon_cache_shutdown(void) {
+  if (g_app_daemon_cache.stats.hits > 0u || g_app_daemon_cache.stats.misses > 0u) {
+    app_daemon_cache_log_stats();
+  }
+  memset(&g_app_daemon_cache, 0, sizeof(g_app_daemon_cache));
+}
+
+/* Streamed requests and replies never produce one reusable AppActionReply. */
+static int app_daemon_cache_eligible(const AppConnectionJob *job, const siglatch_action *action) {
+  if (!job || !action || action->cache_ttl_ms <= 0) {
+    return 0;
+  }
+
+  if (action->stream_reply || action->stream_payload) {
+    return 0;
+  }
+
+  if (job->request.payload_len > APP_DAEMON_CACHE_PAYLOAD_MAX ||
+      (job->request.payload_len > 0u && !job->request.payload_buffer)) {
+    return 0;
+  }
+
+  return 1;
+}
+
+static uint64_t app_daemon_cache_key(const AppConnectionJob *job) {
+  uint64_t hash = 1469598103934665603ULL;
+  uint8_t head[3];
+  size_t i = 0;
+
+  head[0] = (uint8_t)((job->request.user_id >> 8) & 0xFFu);
+  head[1] = (uint8_t)(job->request.user_id & 0xFFu);
+  head[2] = job->request.action_id;
+
+  for (i = 0; i < sizeof(head); ++i) {
+    hash ^= head[i];
+    hash *= 1099511628211ULL;
+  }
+
+  for (i = 0; i < job->request.payload_len; ++i) {
+    hash ^= job->request.payload_buffer[i];
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+static int app_daemon_cache_matches(const AppDaemonCacheEntry *entry,
+                                    const AppConnectionJob *job,
+                                    uint64_t key) {
+  if (!entry->used || entry->key != key || entry->epoch != g_app_daemon_cache.epoch) {
+    return 0;
+  }
+
+  if (entry->user_id != job->request.user_id ||
+      entry->action_id != job->request.action_id ||
+      entry->payload_len != job->request.payload_len) {
+    return 0;
+  }
+
+  return entry->payload_len == 0u ||
+         memcmp(entry->payload, job->request.payload_buffer, entry->payload_len) == 0;
+}
+
+static void app_daemon_cache_drop(AppDaemonCacheEntry *entry) {
+  if (!entry->used) {
+    return;
+  }
+
+  memset(entry, 0, sizeof(*entry));
+  if (g_app_daemon_cache.stats.entries > 0u) {
+    g_app_daemon_cache.stats.entries--;
+  }
+}
+
+/*
+ * Copy a live reply for this request into out. Returns 1 on a hit. On a miss
+ * the job is stamped with the current epoch so its reply may be stored later.
+ */
+static int app_daemon_cache_lookup(AppConnectionJob *job,
+                                   const siglatch_action *action,
+                                   AppActionReply *out) {
+  AppDaemonCacheEntry *entry = NULL;
+  uint64_t key = 0;
+
+  if (!out || !app_daemon_cache_eligible(job, action)) {
+    return 0;
+  }
+
+  key = app_daemon_cache_key(job);
+  entry = &g_app_daemon_cache.entries[key % APP_DAEMON_CACHE_SLOTS];
+
+  if (app_daemon_cache_matches(entry, job, key)) {
+    if (lib.time.monotonic_ms() < entry->expires_at_ms) {
+      *out = entry->reply;
+      g_app_daemon_cache.stats.hits++;
+      return 1;
+    }
+
+    app_daemon_cache_drop(entry);
+  }
+
+  job->cache_epoch = g_app_daemon_cache.epoch;
+  g_app_daemon_cache.stats.misses++;
+  return 0;
+}
+
+/*
+ * Only successful replies are kept, so a failing check is retried every time.
+ * The epoch is checked first: after a reload inside the request itself,
+ * action may point into the config that was just released.
+ */
+static void app_daemon_cache_store(const AppConnectionJob *job,
+                                   const siglatch_action *action,
+                                   const AppActionReply *reply) {
+  AppDaemonCacheEntry *entry = NULL;
+  uint64_t key = 0;
+
+  if (!job || job->cache_epoch == 0u || job->cache_epoch != g_app_daemon_cache.epoch) {
+    return;
+  }
+
+  if (!reply || !reply->ok || !reply->should_reply || !app_daemon_cache_eligible(job, action)) {
+    return;
+  }
+
+  key = app_daemon_cache_key(job);
+  entry = &g_app_daemon_cache.entries[key % APP_DAEMON_CACHE_SLOTS];
+
+  if (entry->used && !app_daemon_cache_matches(entry, job, key)) {
+    g_app_daemon_cache.stats.evictions++;
+  }
+  app_daemon_cache_drop(entry);
+
+  entry->used = 1;
+  entry->key = key;
+  entry->epoch = g_app_daemon_cache.epoch;
+  entry->user_id = job->request.user_id;
+  entry->action_id = job->request.action_id;
+  entry->expires_at_ms = lib.time.monotonic_ms() + (uint64_t)action->cache_ttl_ms;
+  entry->payload_len = job->request.payload_len;
+  if (entry->payload_len > 0u) {
+    memcpy(entry->payload, job->request.payload_buffer, entry->payload_len);
+  }
+  entry->reply = *reply;
+
+  g_app_daemon_cache.stats.stores++;
+  g_app_daemon_cache.stats.entries++;
+}
+
+/* Called whenever the action table or server settings change. */
+static void app_daemon_cache_invalidate(void) {
+  size_t i = 0;
+
+  for (i = 0; i < APP_DAEMON_CACHE_SLOTS; ++i) {
+    app_daemon_cache_drop(&g_app_daemon_cache.entries[i]);
+  }
+
+  g_app_daemon_cache.epoch++;
+  if (g_app_daemon_cache.epoch == 0u) {
+    g_app_daemon_cache.epoch = 1u;
+  }
+  g_app_daemon_cache.stats.invalidations++;
+  app_daemon_cache_log_stats();
+}
+
+static void app_daemon_cache_stats(AppDaemonCacheStats *out) {
+  if (!out) {
+    return;
+  }
+
+  *out = g_app_daemon_cache.stats;
+}
+
+static const AppDaemonCacheLib app_daemon_cache_instance = {
+  .init = app_daemon_cache_init,
+  .shutdown = app_daemon_cache_shutdown,
+  .lookup = app_daemon_cache_lookup,
+  .store = app_daemon_cache_store,
+  .invalidate = app_daemon_cache_invalidate,
+  .stats = app_daemon_cache_stats
+};
+
+const AppDaemonCacheLib *get_app_daemon_cache_lib(void) {
+  return &app_daemon_cache_instance;
+}
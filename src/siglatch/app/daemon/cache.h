@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef SIGLATCH_SERVER_APP_DAEMON_CACHE_H
+#define SIGLATCH_SERVER_APP_DAEMON_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "job.h"
+#include "../config/config.h"
+#include "../payload/reply.h"
+
+/*
+ * Replies of actions with cache_ttl_ms set are kept in a small direct-mapped
+ * table keyed by (user, action, payload). Requests whose payload is larger
+ * than APP_DAEMON_CACHE_PAYLOAD_MAX are never cached.
+ */
+#define APP_DAEMON_CACHE_SLOTS 64u
+#define APP_DAEMON_CACHE_PAYLOAD_MAX 256u
+
+typedef struct {
+  int used;
+  uint64_t key;
+  uint32_t epoch;
+  uint16_t user_id;
+  uint8_t action_id;
+  uint64_t expires_at_ms;
+  size_t payload_len;
+  uint8_t payload[APP_DAEMON_CACHE_PAYLOAD_MAX];
+  AppActionReply reply;
+} AppDaemonCacheEntry;
+
+typedef struct {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t stores;
+  uint64_t evictions;
+  uint64_t invalidations;
+  size_t entries;
+} AppDaemonCacheStats;
+
+typedef struct {
+  int (*init)(void);
+  void (*shutdown)(void);
+  int (*lookup)(AppConnectionJob *job, const siglatch_action *action, AppActionReply *out);
+  void (*store)(const AppConnectionJob *job,
+                const siglatch_action *action,
+                const AppActionReply *reply);
+  void (*invalidate)(void);
+  void (*stats)(AppDaemonCacheStats *out);
+} AppDaemonCacheLib;
+
+const AppDaemonCacheLib *get_app_daemon_cache_lib(void);
+
+#endif
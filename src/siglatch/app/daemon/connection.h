@@ -10,9 +10,12 @@
 #include <stdint.h>
 
 #include "packet.h"
+#include "../../../stdlib/arena.h"
 
 #define APP_CONNECTION_SESSION_CAPACITY 64u
 
+struct AppDaemonBatchPlan;
+
 typedef struct {
   uint64_t expires_at_ms;
   int active;
@@ -22,6 +25,7 @@ typedef struct {
   int complete;
   int should_reply;
   int available;
+  int deferred;
   int synthetic_session;
   uint32_t wire_version;
   uint8_t wire_form;
@@ -35,10 +39,17 @@ typedef struct {
   uint16_t client_port;
   int encrypted;
   int wire_auth;
+  int auth_result;                      /* signature check: 1 passed, -1 failed, 0 not run */
+  uint64_t request_key;                 /* mux reply-cache handle, 0 if none */
+  uint32_t cache_epoch;                 /* action reply cache epoch at dispatch, 0 if none */
   AppDaemonRequestPacket request;
   uint8_t *response_buffer;
   size_t response_len;
   size_t response_cap;
+  /* Per-request scratch; reset and returned to the job pool on dispose. */
+  Arena *arena;
+  /* Resolved batch entries (in arena), set only for batch requests. */
+  struct AppDaemonBatchPlan *batch;
 } AppConnectionJob;
 
 typedef struct {
@@ -28,11 +28,15 @@ const AppDaemon *get_app_daemon_lib(void) {
   lib.process = app_daemon_process;
   lib.helper = *get_app_daemon_helper_lib();
   lib.auth = *get_app_daemon_auth_lib();
+  lib.batch = *get_app_daemon_batch_lib();
+  lib.cache = *get_app_daemon_cache_lib();
   lib.request = *get_app_daemon_request_lib();
   lib.policy = *get_app_daemon_policy_lib();
   lib.runner = *get_app_daemon_runner_lib();
   lib.job = *get_app_daemon_job_lib();
   lib.payload = *get_app_daemon_payload_lib();
+  lib.stream = *get_app_daemon_stream_lib();
+  lib.executor = *get_app_daemon_executor_lib();
   lib.tick = *get_app_daemon_tick_lib();
 
   return &lib;
@@ -8,11 +8,15 @@
 
 #include "helper.h"
 #include "auth.h"
+#include "batch.h"
+#include "cache.h"
+#include "executor.h"
 #include "job.h"
 #include "request.h"
 #include "policy.h"
 #include "payload.h"
 #include "runner.h"
+#include "stream.h"
 #include "tick.h"
 
 typedef struct {
@@ -21,11 +25,15 @@ typedef struct {
   void (*process)(AppRuntimeListenerState *listener);
   AppDaemonHelperLib helper;
   AppDaemonAuthLib auth;
+  AppDaemonBatchLib batch;
+  AppDaemonCacheLib cache;
   AppDaemonRequestLib request;
   AppDaemonPolicyLib policy;
   AppDaemonRunnerLib runner;
   AppJobLib job;
   AppDaemonPayloadLib payload;
+  AppDaemonStreamLib stream;
+  AppDaemonExecutorLib executor;
   AppTickLib tick;
 } AppDaemon;
 
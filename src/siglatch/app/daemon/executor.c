@@ -0,0 +1,732 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "executor.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+#include "../app.h"
+#include "../../lib.h"
+
+#define APP_EXECUTOR_DONE_CAPACITY (APP_EXECUTOR_QUEUE_CAPACITY + APP_EXECUTOR_CHUNK_CAPACITY)
+/* Retired tasks kept for reuse; enough to cover every queue at once. */
+#define APP_EXECUTOR_SPARE_CAPACITY (APP_EXECUTOR_DONE_CAPACITY + APP_EXECUTOR_WORKER_COUNT)
+
+typedef struct {
+  unsigned int action_id;
+  size_t count;
+} AppExecutorActionCount;
+
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t work_ready;
+  pthread_cond_t chunk_space;
+  pthread_t workers[APP_EXECUTOR_WORKER_COUNT];
+  size_t worker_count;
+  int running;
+  int stopping;
+  int wake_read_fd;
+  int wake_write_fd;
+  AppExecutorTask *pending[APP_EXECUTOR_QUEUE_CAPACITY];
+  size_t pending_head;
+  size_t pending_count;
+  /* Finished tasks and streamed chunks, in the order workers produced them. */
+  AppExecutorTask *done[APP_EXECUTOR_DONE_CAPACITY];
+  size_t done_head;
+  size_t done_count;
+  size_t chunk_count;
+  AppExecutorTask *spare[APP_EXECUTOR_SPARE_CAPACITY];
+  size_t spare_count;
+  /* Loop-thread only: submitted minus drained, total and per action. */
+  size_t outstanding;
+  AppExecutorActionCount action_counts[APP_EXECUTOR_QUEUE_CAPACITY];
+} AppExecutorState;
+
+static AppExecutorState g_app_executor = {
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+  .work_ready = PTHREAD_COND_INITIALIZER,
+  .chunk_space = PTHREAD_COND_INITIALIZER,
+  .wake_read_fd = -1,
+  .wake_write_fd = -1
+};
+
+static void app_daemon_executor_stop(void);
+
+static int app_daemon_executor_init(void) {
+  return 1;
+}
+
+static void app_daemon_executor_shutdown(void) {
+  app_daemon_executor_stop();
+}
+
+#ifndef __linux__
+static int app_daemon_executor_set_nonblock_cloexec(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+
+  if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+    return 0;
+  }
+
+  return fcntl(fd, F_SETFD, FD_CLOEXEC) == 0;
+}
+#endif
+
+static int app_daemon_executor_open_wake(void) {
+#ifdef __linux__
+  int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+  if (fd < 0) {
+    LOGPERR("eventfd");
+    return 0;
+  }
+
+  g_app_executor.wake_read_fd = fd;
+  g_app_executor.wake_write_fd = fd;
+  return 1;
+#else
+  int pipefd[2] = {-1, -1};
+
+  if (pipe(pipefd) != 0) {
+    LOGPERR("pipe");
+    return 0;
+  }
+
+  if (!app_daemon_executor_set_nonblock_cloexec(pipefd[0]) ||
+      !app_daemon_executor_set_nonblock_cloexec(pipefd[1])) {
+    LOGPERR("fcntl");
+    close(pipefd[0]);
+    close(pipefd[1]);
+    return 0;
+  }
+
+  g_app_executor.wake_read_fd = pipefd[0];
+  g_app_executor.wake_write_fd = pipefd[1];
+  return 1;
+#endif
+}
+
+static void app_daemon_executor_close_wake(void) {
+  if (g_app_executor.wake_write_fd >= 0 &&
+      g_app_executor.wake_write_fd != g_app_executor.wake_read_fd) {
+    close(g_app_executor.wake_write_fd);
+  }
+
+  if (g_app_executor.wake_read_fd >= 0) {
+    close(g_app_executor.wake_read_fd);
+  }
+
+  g_app_executor.wake_read_fd = -1;
+  g_app_executor.wake_write_fd = -1;
+}
+
+static void app_daemon_executor_signal_wake(void) {
+#ifdef __linux__
+  uint64_t one = 1u;
+  ssize_t rc = 0;
+
+  do {
+    rc = write(g_app_executor.wake_write_fd, &one, sizeof(one));
+  } while (rc < 0 && errno == EINTR);
+#else
+  uint8_t one = 1u;
+  ssize_t rc = 0;
+
+  do {
+    rc = write(g_app_executor.wake_write_fd, &one, sizeof(one));
+  } while (rc < 0 && errno == EINTR);
+#endif
+  /* EAGAIN means a wake is already pending, which is all we need. */
+  (void)rc;
+}
+
+static void app_daemon_executor_clear_wake(void) {
+  uint8_t sink[64];
+
+  if (g_app_executor.wake_read_fd < 0) {
+    return;
+  }
+
+  while (read(g_app_executor.wake_read_fd, sink, sizeof(sink)) > 0) {
+  }
+}
+
+static AppExecutorTask *app_daemon_executor_alloc_task(void) {
+  AppExecutorTask *task = NULL;
+
+  pthread_mutex_lock(&g_app_executor.lock);
+  if (g_app_executor.spare_count > 0u) {
+    task = g_app_executor.spare[--g_app_executor.spare_count];
+  }
+  pthread_mutex_unlock(&g_app_executor.lock);
+
+  if (!task) {
+    return (AppExecutorTask *)calloc(1, sizeof(*task));
+  }
+
+  memset(task, 0, sizeof(*task));
+  return task;
+}
+
+/* Return a task shell whose job buffers have already moved on. */
+static void app_daemon_executor_retire_task(AppExecutorTask *task) {
+  if (!task) {
+    return;
+  }
+
+  pthread_mutex_lock(&g_app_executor.lock);
+  if (g_app_executor.spare_count < APP_EXECUTOR_SPARE_CAPACITY) {
+    g_app_executor.spare[g_app_executor.spare_count++] = task;
+    task = NULL;
+  }
+  pthread_mutex_unlock(&g_app_executor.lock);
+
+  free(task);
+}
+
+static void app_daemon_executor_free_task(AppExecutorTask *task) {
+  if (!task) {
+    return;
+  }
+
+  app.daemon.job.dispose(NULL, &task->job);
+  app_daemon_executor_retire_task(task);
+}
+
+static void *app_daemon_executor_worker(void *arg) {
+  AppExecutorTask *task = NULL;
+
+  (void)arg;
+
+  for (;;) {
+    pthread_mutex_lock(&g_app_executor.lock);
+    while (!g_app_executor.stopping && g_app_executor.pending_count == 0u) {
+      pthread_cond_wait(&g_app_executor.work_ready, &g_app_executor.lock);
+    }
+
+    if (g_app_executor.stopping) {
+      pthread_mutex_unlock(&g_app_executor.lock);
+      break;
+    }
+
+    task = g_app_executor.pending[g_app_executor.pending_head];
+    g_app_executor.pending[g_app_executor.pending_head] = NULL;
+    g_app_executor.pending_head =
+        (g_app_executor.pending_head + 1u) % APP_EXECUTOR_QUEUE_CAPACITY;
+    g_app_executor.pending_count--;
+    pthread_mutex_unlock(&g_app_executor.lock);
+
+    if (task->is_deaddrop) {
+      app.payload.unstructured.run(&task->job, &task->deaddrop, task->match_len, task->secure);
+      task->ok = 1;
+    } else {
+      task->ok = app.daemon.payload.execute(&task->job,
+                                            &task->user,
+                                            &task->action,
+                                            task->secure,
+                                            &task->reply);
+    }
+
+    pthread_mutex_lock(&g_app_executor.lock);
+    g_app_executor.done[(g_app_executor.done_head + g_app_executor.done_count) %
+                        APP_EXECUTOR_DONE_CAPACITY] = task;
+    g_app_executor.done_count++;
+    pthread_mutex_unlock(&g_app_executor.lock);
+
+    app_daemon_executor_signal_wake();
+  }
+
+  return NULL;
+}
+
+/*
+ * Start the worker pool.
+ *
+ * Handlers that only fork/exec or run an object child are pushed here so a
+ * slow action no longer holds up packet reception. Completions come back to
+ * the loop through wake_fd(), which the runner polls next to its socket.
+ */
+static int app_daemon_executor_start(void) {
+  size_t i = 0;
+
+  if (g_app_executor.running) {
+    return 1;
+  }
+
+  g_app_executor.stopping = 0;
+  g_app_executor.pending_head = 0u;
+  g_app_executor.pending_count = 0u;
+  g_app_executor.done_head = 0u;
+  g_app_executor.done_count = 0u;
+  g_app_executor.chunk_count = 0u;
+  g_app_executor.outstanding = 0u;
+  memset(g_app_executor.action_counts, 0, sizeof(g_app_executor.action_counts));
+
+  if (!app_daemon_executor_open_wake()) {
+    return 0;
+  }
+
+  g_app_executor.worker_count = 0u;
+  for (i = 0; i < APP_EXECUTOR_WORKER_COUNT; ++i) {
+    if (pthread_create(&g_app_executor.workers[i], NULL, app_daemon_executor_worker, NULL) != 0) {
+      LOGE("[daemon.executor] Failed to start worker %zu\n", i);
+      break;
+    }
+    g_app_executor.worker_count++;
+  }
+
+  if (g_app_executor.worker_count == 0u) {
+    app_daemon_executor_close_wake();
+    return 0;
+  }
+
+  g_app_executor.running = 1;
+  LOGD("[daemon.executor] Started %zu workers\n", g_app_executor.worker_count);
+  return 1;
+}
+
+static void app_daemon_executor_stop(void) {
+  size_t i = 0;
+
+  if (!g_app_executor.running) {
+    return;
+  }
+
+  pthread_mutex_lock(&g_app_executor.lock);
+  g_app_executor.stopping = 1;
+  pthread_cond_broadcast(&g_app_executor.work_ready);
+  pthread_cond_broadcast(&g_app_executor.chunk_space);
+  pthread_mutex_unlock(&g_app_executor.lock);
+
+  for (i = 0; i < g_app_executor.worker_count; ++i) {
+    pthread_join(g_app_executor.workers[i], NULL);
+  }
+  g_app_executor.worker_count = 0u;
+
+  while (g_app_executor.pending_count > 0u) {
+    app_daemon_executor_free_task(g_app_executor.pending[g_app_executor.pending_head]);
+    g_app_executor.pending[g_app_executor.pending_head] = NULL;
+    g_app_executor.pending_head =
+        (g_app_executor.pending_head + 1u) % APP_EXECUTOR_QUEUE_CAPACITY;
+    g_app_executor.pending_count--;
+  }
+
+  while (g_app_executor.done_count > 0u) {
+    app_daemon_executor_free_task(g_app_executor.done[g_app_executor.done_head]);
+    g_app_executor.done[g_app_executor.done_head] = NULL;
+    g_app_executor.done_head = (g_app_executor.done_head + 1u) % APP_EXECUTOR_DONE_CAPACITY;
+    g_app_executor.done_count--;
+  }
+  g_app_executor.chunk_count = 0u;
+
+  while (g_app_executor.spare_count > 0u) {
+    free(g_app_executor.spare[--g_app_executor.spare_count]);
+  }
+
+  app_daemon_executor_close_wake();
+  g_app_executor.outstanding = 0u;
+  memset(g_app_executor.action_counts, 0, sizeof(g_app_executor.action_counts));
+  g_app_executor.stopping = 0;
+  g_app_executor.running = 0;
+}
+
+static int app_daemon_executor_is_running(void) {
+  return g_app_executor.running;
+}
+
+static int app_daemon_executor_wake_fd(void) {
+  return g_app_executor.running ? g_app_executor.wake_read_fd : -1;
+}
+
+static AppExecutorActionCount *app_daemon_executor_action_count(unsigned int action_id,
+                                                                int create) {
+  AppExecutorActionCount *free_slot = NULL;
+  size_t i = 0;
+
+  for (i = 0; i < APP_EXECUTOR_QUEUE_CAPACITY; ++i) {
+    AppExecutorActionCount *slot = &g_app_executor.action_counts[i];
+
+    if (slot->count > 0u && slot->action_id == action_id) {
+      return slot;
+    }
+
+    if (create && !free_slot && slot->count == 0u) {
+      free_slot = slot;
+    }
+  }
+
+  if (free_slot) {
+    free_slot->action_id = action_id;
+  }
+
+  return free_slot;
+}
+
+/*
+ * Builtins stay on the loop thread: they rebind sockets, swap config and
+ * refresh mux policy, none of which is synchronized. Streamed shell actions
+ * also stay inline because their pipe state belongs to the loop.
+ */
+static int app_daemon_executor_accepts(const AppConnectionJob *job,
+                                       const siglatch_action *action) {
+  if (!g_app_executor.running || !job || !action) {
+    return 0;
+  }
+
+  if (action->handler == SL_ACTION_HANDLER_STATIC ||
+      action->handler == SL_ACTION_HANDLER_DYNAMIC) {
+    return 1;
+  }
+
+  if (action->handler != SL_ACTION_HANDLER_SHELL) {
+    return 0;
+  }
+
+  return !app.daemon.stream.wants(job, action);
+}
+
+static int app_daemon_executor_at_limit(const siglatch_action *action) {
+  const AppExecutorActionCount *slot = NULL;
+
+  if (!action) {
+    return 1;
+  }
+
+  if (g_app_executor.outstanding >= APP_EXECUTOR_QUEUE_CAPACITY) {
+    return 1;
+  }
+
+  if (action->max_concurrency <= 0) {
+    return 0;
+  }
+
+  slot = app_daemon_executor_action_count(action->id, 0);
+  return slot && slot->count >= (size_t)action->max_concurrency;
+}
+
+/*
+ * The actions a task counts against: its own, or for a batch every distinct
+ * action the plan runs, so each one's max_concurrency holds for the batch as
+ * a whole. The plan is read-only once prepared, so drain() gets the same list.
+ */
+static size_t app_daemon_executor_held_actions(const AppConnectionJob *job,
+                                               const siglatch_action *action,
+                                               const siglatch_action **out) {
+  size_t held = 0;
+  size_t i = 0;
+  size_t j = 0;
+
+  if (!job->batch) {
+    out[0] = action;
+    return 1u;
+  }
+
+  for (i = 0; i < job->batch->count; ++i) {
+    const AppBatchStep *step = &job->batch->steps[i];
+
+    if (step->state != APP_BATCH_STEP_RUN) {
+      continue;
+    }
+
+    for (j = 0; j < held && out[j]->id != step->action.id; ++j) {
+    }
+    if (j == held) {
+      out[held++] = &step->action;
+    }
+  }
+
+  return held;
+}
+
+static void app_daemon_executor_release_actions(const siglatch_action **held, size_t held_count) {
+  AppExecutorActionCount *count = NULL;
+  size_t i = 0;
+
+  for (i = 0; i < held_count; ++i) {
+    count = app_daemon_executor_action_count(held[i]->id, 0);
+    if (count && count->count > 0u) {
+      count->count--;
+    }
+  }
+}
+
+/* Take a slot for every held action, or none of them. */
+static int app_daemon_executor_reserve_actions(const siglatch_action **held, size_t held_count) {
+  AppExecutorActionCount *count = NULL;
+  size_t i = 0;
+
+  for (i = 0; i < held_count; ++i) {
+    if (app_daemon_executor_at_limit(held[i])) {
+      break;
+    }
+
+    count = app_daemon_executor_action_count(held[i]->id, 1);
+    if (!count) {
+      break;
+    }
+    count->count++;
+  }
+
+  if (i < held_count) {
+    app_daemon_executor_release_actions(held, i);
+    return 0;
+  }
+
+  return 1;
+}
+
+static int app_daemon_executor_submit(AppConnectionJob *job,
+                                      const siglatch_user *user,
+                                      const siglatch_action *action,
+                                      int secure) {
+  AppExecutorTask *task = NULL;
+  const siglatch_action *held[SL_KNOCK_BATCH_ENTRY_MAX];
+  size_t held_count = 0;
+
+  if (!g_app_executor.running || !job || !user || !action) {
+    return 0;
+  }
+
+  held_count = app_daemon_executor_held_actions(job, action, held);
+  if (!app_daemon_executor_reserve_actions(held, held_count)) {
+    return 0;
+  }
+
+  task = app_daemon_executor_alloc_task();
+  if (!task) {
+    LOGE("[daemon.executor] Failed to allocate task for action (%s)\n", action->name);
+    app_daemon_executor_release_actions(held, held_count);
+    return 0;
+  }
+
+  memcpy(&task->job, job, sizeof(task->job));
+  memset(job, 0, sizeof(*job));
+  task->is_deaddrop = 0;
+  task->user = *user;
+  task->user.pubkey = NULL;
+  task->user.keyring_der = NULL;
+  task->user.key_file = NULL;
+  task->user.hmac_file = NULL;
+  task->user.actions = NULL;
+  task->user.action_count = 0;
+  task->user.allowed_ips = NULL;
+  task->user.allowed_ip_count = 0;
+  task->action = *action;
+  task->secure = secure ? 1 : 0;
+
+  pthread_mutex_lock(&g_app_executor.lock);
+  g_app_executor.pending[(g_app_executor.pending_head + g_app_executor.pending_count) %
+                         APP_EXECUTOR_QUEUE_CAPACITY] = task;
+  g_app_executor.pending_count++;
+  pthread_cond_signal(&g_app_executor.work_ready);
+  pthread_mutex_unlock(&g_app_executor.lock);
+
+  g_app_executor.outstanding++;
+  return 1;
+}
+
+/*
+ * Dead-drop scripts run on the pool like shell actions. They count against
+ * the pool's queue but have no per-action limit. Returns 0 when the pool is
+ * full, and the caller defers the job.
+ */
+static int app_daemon_executor_submit_deaddrop(AppConnectionJob *job,
+                                               const siglatch_deaddrop *deaddrop,
+                                               size_t match_len,
+                                               int secure) {
+  AppExecutorTask *task = NULL;
+
+  if (!g_app_executor.running || !job || !deaddrop) {
+    return 0;
+  }
+
+  if (g_app_executor.outstanding >= APP_EXECUTOR_QUEUE_CAPACITY) {
+    return 0;
+  }
+
+  task = app_daemon_executor_alloc_task();
+  if (!task) {
+    LOGE("[daemon.executor] Failed to allocate task for dead-drop (%s)\n", deaddrop->name);
+    return 0;
+  }
+
+  memcpy(&task->job, job, sizeof(task->job));
+  memset(job, 0, sizeof(*job));
+  task->is_deaddrop = 1;
+  task->deaddrop = *deaddrop;
+  task->match_len = match_len;
+  task->secure = secure ? 1 : 0;
+
+  pthread_mutex_lock(&g_app_executor.lock);
+  g_app_executor.pending[(g_app_executor.pending_head + g_app_executor.pending_count) %
+                         APP_EXECUTOR_QUEUE_CAPACITY] = task;
+  g_app_executor.pending_count++;
+  pthread_cond_signal(&g_app_executor.work_ready);
+  pthread_mutex_unlock(&g_app_executor.lock);
+
+  g_app_executor.outstanding++;
+  return 1;
+}
+
+/*
+ * Queue one chunk of a streamed reply from a worker thread.
+ *
+ * response is the encoded reply payload for the chunk. seq numbers the chunks
+ * of one request from 1 and keeps their message ids apart from each other and
+ * from the final reply. Blocks while the loop is APP_EXECUTOR_CHUNK_CAPACITY
+ * chunks behind, so a chatty action is paced by the socket instead of
+ * buffering its whole output. Returns 0 if the chunk was not queued.
+ */
+static int app_daemon_executor_emit(const AppConnectionJob *job,
+                                    uint32_t seq,
+                                    const uint8_t *response,
+                                    size_t response_len) {
+  AppExecutorTask *task = NULL;
+
+  if (!job || !response || response_len == 0u) {
+    return 0;
+  }
+
+  task = app_daemon_executor_alloc_task();
+  if (!task) {
+    LOGE("[daemon.executor] Failed to allocate reply chunk\n");
+    return 0;
+  }
+
+  task->job = *job;
+  task->job.request.payload_buffer = NULL;
+  task->job.request.payload_len = 0u;
+  task->job.request.payload_cap = 0u;
+  task->job.arena = NULL;
+  task->job.batch = NULL;
+  task->job.fragment_index += seq;
+  task->job.should_reply = 1;
+  task->job.response_buffer = NULL;
+  task->job.response_len = 0u;
+  task->job.response_cap = 0u;
+  if (!app.daemon.job.reserve_response(&task->job, response_len)) {
+    LOGE("[daemon.executor] Failed to allocate reply chunk\n");
+    app_daemon_executor_retire_task(task);
+    return 0;
+  }
+  memcpy(task->job.response_buffer, response, response_len);
+  task->job.response_len = response_len;
+  task->ok = 1;
+  task->partial = 1;
+
+  pthread_mutex_lock(&g_app_executor.lock);
+  while (!g_app_executor.stopping &&
+         g_app_executor.chunk_count >= APP_EXECUTOR_CHUNK_CAPACITY) {
+    pthread_cond_wait(&g_app_executor.chunk_space, &g_app_executor.lock);
+  }
+
+  if (g_app_executor.stopping) {
+    pthread_mutex_unlock(&g_app_executor.lock);
+    app_daemon_executor_free_task(task);
+    return 0;
+  }
+
+  g_app_executor.done[(g_app_executor.done_head + g_app_executor.done_count) %
+                      APP_EXECUTOR_DONE_CAPACITY] = task;
+  g_app_executor.done_count++;
+  g_app_executor.chunk_count++;
+  pthread_mutex_unlock(&g_app_executor.lock);
+
+  app_daemon_executor_signal_wake();
+  return 1;
+}
+
+/*
+ * Pop one finished task or streamed chunk. The job buffers move back to the
+ * caller, who stages the reply with the loop's session and disposes the job
+ * as usual. A partial entry's job already holds its encoded reply.
+ */
+static int app_daemon_executor_drain(AppConnectionJob *out_job,
+                                     AppActionReply *out_reply,
+                                     int *out_ok,
+                                     int *out_partial) {
+  AppExecutorTask *task = NULL;
+  const siglatch_action *held[SL_KNOCK_BATCH_ENTRY_MAX];
+  size_t held_count = 0;
+
+  if (!g_app_executor.running || !out_job || !out_reply || !out_ok || !out_partial) {
+    return 0;
+  }
+
+  app_daemon_executor_clear_wake();
+
+  pthread_mutex_lock(&g_app_executor.lock);
+  if (g_app_executor.done_count > 0u) {
+    task = g_app_executor.done[g_app_executor.done_head];
+    g_app_executor.done[g_app_executor.done_head] = NULL;
+    g_app_executor.done_head = (g_app_executor.done_head + 1u) % APP_EXECUTOR_DONE_CAPACITY;
+    g_app_executor.done_count--;
+    if (task->partial) {
+      g_app_executor.chunk_count--;
+      pthread_cond_signal(&g_app_executor.chunk_space);
+    }
+  }
+  pthread_mutex_unlock(&g_app_executor.lock);
+
+  if (!task) {
+    return 0;
+  }
+
+  *out_partial = task->partial;
+  if (task->partial) {
+    memcpy(out_job, &task->job, sizeof(*out_job));
+    memset(out_reply, 0, sizeof(*out_reply));
+    *out_ok = 1;
+    app_daemon_executor_retire_task(task);
+    return 1;
+  }
+
+  if (!task->is_deaddrop) {
+    held_count = app_daemon_executor_held_actions(&task->job, &task->action, held);
+    app_daemon_executor_release_actions(held, held_count);
+  }
+  if (g_app_executor.outstanding > 0u) {
+    g_app_executor.outstanding--;
+  }
+
+  memcpy(out_job, &task->job, sizeof(*out_job));
+  *out_reply = task->reply;
+  *out_ok = task->ok;
+  app_daemon_executor_retire_task(task);
+  return 1;
+}
+
+static size_t app_daemon_executor_in_flight(void) {
+  return g_app_executor.outstanding;
+}
+
+static const AppDaemonExecutorLib app_daemon_executor_instance = {
+  .init = app_daemon_executor_init,
+  .shutdown = app_daemon_executor_shutdown,
+  .start = app_daemon_executor_start,
+  .stop = app_daemon_executor_stop,
+  .is_running = app_daemon_executor_is_running,
+  .wake_fd = app_daemon_executor_wake_fd,
+  .accepts = app_daemon_executor_accepts,
+  .at_limit = app_daemon_executor_at_limit,
+  .submit = app_daemon_executor_submit,
+  .submit_deaddrop = app_daemon_executor_submit_deaddrop,
+  .emit = app_daemon_executor_emit,
+  .drain = app_daemon_executor_drain,
+  .in_flight = app_daemon_executor_in_flight
+};
+
+const AppDaemonExecutorLib *get_app_daemon_executor_lib(void) {
+  return &app_daemon_executor_instance;
+}
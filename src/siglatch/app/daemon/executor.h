@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef SIGLATCH_SERVER_APP_DAEMON_EXECUTOR_H
+#define SIGLATCH_SERVER_APP_DAEMON_EXECUTOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "job.h"
+#include "../config/config.h"
+#include "../payload/reply.h"
+
+#define APP_EXECUTOR_WORKER_COUNT 4u
+#define APP_EXECUTOR_QUEUE_CAPACITY 64u
+/* Streamed reply chunks waiting for the loop; emit() blocks past this. */
+#define APP_EXECUTOR_CHUNK_CAPACITY 64u
+
+/*
+ * One handler invocation owned by the executor.
+ *
+ * The job buffers move into the task on submit. User and action are copied
+ * by value so a config reload on the loop thread cannot pull them out from
+ * under a running worker.
+ *
+ * A partial task is one chunk of a streamed reply: job holds only the
+ * request's routing fields plus the encoded chunk in response_buffer, and the
+ * task that produced it is still running.
+ *
+ * A dead-drop task has no user or action; its script output is left raw in
+ * the job's response buffer.
+ */
+typedef struct {
+  AppConnectionJob job;
+  siglatch_user user;
+  siglatch_action action;
+  siglatch_deaddrop deaddrop;
+  size_t match_len;
+  int is_deaddrop;
+  int secure;
+  int ok;
+  int partial;
+  AppActionReply reply;
+} AppExecutorTask;
+
+typedef struct {
+  int (*init)(void);
+  void (*shutdown)(void);
+  int (*start)(void);
+  void (*stop)(void);
+  int (*is_running)(void);
+  int (*wake_fd)(void);
+  int (*accepts)(const AppConnectionJob *job, const siglatch_action *action);
+  int (*at_limit)(const siglatch_action *action);
+  int (*submit)(AppConnectionJob *job,
+                const siglatch_user *user,
+                const siglatch_action *action,
+                int secure);
+  int (*submit_deaddrop)(AppConnectionJob *job,
+                         const siglatch_deaddrop *deaddrop,
+                         size_t match_len,
+                         int secure);
+  int (*emit)(const AppConnectionJob *job,
+              uint32_t seq,
+              const uint8_t *response,
+              size_t response_len);
+  int (*drain)(AppConnectionJob *out_job,
+               AppActionReply *out_reply,
+               int *out_ok,
+               int *out_partial);
+  size_t (*in_flight)(void);
+} AppDaemonExecutorLib;
+
+const AppDaemonExecutorLib *get_app_daemon_executor_lib(void);
+
+#endif
@@ -9,6 +9,10 @@
 #include <string.h>
 
 #include "../app.h"
+#include "../../../shared/knock/codec/v1/v1_packet.h"
+#include "../../../shared/knock/codec/v2/v2_form1.h"
+#include "../../../shared/knock/codec/v3/v3_form1.h"
+#include "../../../shared/knock/codec/v4/v4_form1.h"
 #include "../../../shared/knock/response.h"
 #include "../../../stdlib/protocol/udp/m7mux/normalize/normalize.h"
 
@@ -60,6 +64,7 @@ static int app_daemon_copy_job_reply_to_send(const AppConnectionJob *job,
   out_send->client_port = job->client_port;
   out_send->encrypted = job->encrypted;
   out_send->wire_auth = job->wire_auth;
+  out_send->request_key = job->request_key;
 
   out_user->user_id = job->request.user_id;
   out_user->action_id = SL_KNOCK_RESPONSE_ACTION_ID;
@@ -81,11 +86,39 @@ static uint64_t app_daemon_time_until_ms(uint64_t next_tick_at, uint64_t now_ms)
   return next_tick_at - now_ms;
 }
 
+/*
+ * Largest reply payload one packet of the given wire family carries. Replies
+ * pass through M7MuxUserSendData, so that buffer bounds every family.
+ */
+static size_t app_daemon_reply_payload_max(uint32_t wire_version) {
+  size_t max = 0u;
+
+  switch (wire_version) {
+  case SHARED_KNOCK_CODEC_V1_VERSION:
+    max = SHARED_KNOCK_CODEC_V1_PAYLOAD_MAX;
+    break;
+  case SHARED_KNOCK_CODEC_V2_WIRE_VERSION:
+    max = SHARED_KNOCK_CODEC_V2_FORM1_PAYLOAD_MAX;
+    break;
+  case SHARED_KNOCK_CODEC_V3_WIRE_VERSION:
+    max = SHARED_KNOCK_CODEC_V3_FORM1_PAYLOAD_MAX;
+    break;
+  case SHARED_KNOCK_CODEC_V4_WIRE_VERSION:
+    max = SHARED_KNOCK_CODEC_V4_FORM1_PAYLOAD_MAX;
+    break;
+  default:
+    return 0u;
+  }
+
+  return max < M7MUX_USER_DATA_PAYLOAD_MAX ? max : M7MUX_USER_DATA_PAYLOAD_MAX;
+}
+
 static const AppDaemonHelperLib app_daemon_helper_instance = {
   .init = app_daemon_helper_init,
   .shutdown = app_daemon_helper_shutdown,
   .copy_job_reply_to_send = app_daemon_copy_job_reply_to_send,
-  .time_until_ms = app_daemon_time_until_ms
+  .time_until_ms = app_daemon_time_until_ms,
+  .reply_payload_max = app_daemon_reply_payload_max
 };
 
 const AppDaemonHelperLib *get_app_daemon_helper_lib(void) {
@@ -6,6 +6,7 @@
 #ifndef SIGLATCH_SERVER_APP_DAEMON_HELPER_H
 #define SIGLATCH_SERVER_APP_DAEMON_HELPER_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "job.h"
@@ -20,6 +21,7 @@ typedef struct {
                                 M7MuxSendPacket *out_send,
                                 M7MuxUserSendData *out_user);
   uint64_t (*time_until_ms)(uint64_t next_tick_at, uint64_t now_ms);
+  size_t (*reply_payload_max)(uint32_t wire_version);
 } AppDaemonHelperLib;
 
 const AppDaemonHelperLib *get_app_daemon_helper_lib(void);
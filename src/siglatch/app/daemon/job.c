@@ -5,20 +5,258 @@
 
 #include "job.h"
 
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "../app.h"
+#include "../../lib.h"
 #include "../../../shared/knock/codec/user.h"
 #include "../../../stdlib/protocol/udp/m7mux/normalize/normalize.h"
 
-#define APP_JOB_READY_QUEUE_CAPACITY 64u
+#define APP_JOB_BUFFER_SLAB_MAX 64u
+
+typedef struct {
+  uint8_t *slab;
+  uint8_t *free_list[APP_JOB_BUFFER_SLAB_MAX];
+  size_t free_count;
+} AppJobBufferClass;
+
+/*
+ * Buffers are handed out on the loop thread and, for streamed reply chunks,
+ * on executor workers, so the free lists sit behind one lock. Slabs are laid
+ * down when a runner starts and dropped once every buffer has come home.
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  AppJobBufferClass classes[APP_JOB_BUFFER_CLASS_COUNT];
+  Arena *arenas[APP_JOB_ARENA_POOL_MAX];
+  size_t arena_count;
+  AppJobPoolStats stats;
+} AppJobPool;
+
+static const size_t g_app_job_slab_counts[APP_JOB_BUFFER_CLASS_COUNT] = {64u, 16u, 8u, 4u, 2u};
+
+static AppJobPool g_app_job_pool = {
+  .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+static size_t app_job_class_size(size_t index) {
+  return (size_t)APP_JOB_PAYLOAD_BLOCK_SIZE << index;
+}
+
+static int app_job_class_for(size_t cap, size_t *out_index) {
+  size_t i = 0;
+
+  for (i = 0; i < APP_JOB_BUFFER_CLASS_COUNT; ++i) {
+    if (cap <= app_job_class_size(i)) {
+      *out_index = i;
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static int app_job_in_slab(const AppJobBufferClass *cls, size_t index, const uint8_t *buffer) {
+  const uint8_t *end = NULL;
+
+  if (!cls->slab || !buffer) {
+    return 0;
+  }
+
+  end = cls->slab + app_job_class_size(index) * g_app_job_slab_counts[index];
+  return buffer >= cls->slab && buffer < end;
+}
+
+static void app_job_pool_prepare(void) {
+  size_t i = 0;
+  size_t j = 0;
+
+  pthread_mutex_lock(&g_app_job_pool.lock);
+  for (i = 0; i < APP_JOB_BUFFER_CLASS_COUNT; ++i) {
+    AppJobBufferClass *cls = &g_app_job_pool.classes[i];
+    size_t size = app_job_class_size(i);
+
+    g_app_job_pool.stats.class_size[i] = size;
+    if (cls->slab) {
+      continue;
+    }
+
+    cls->slab = (uint8_t *)malloc(size * g_app_job_slab_counts[i]);
+    if (!cls->slab) {
+      LOGW("[daemon.job] No slab for %zu-byte buffers; class will use the heap\n", size);
+      continue;
+    }
+
+    for (j = 0; j < g_app_job_slab_counts[i]; ++j) {
+      cls->free_list[j] = cls->slab + size * j;
+    }
+    cls->free_count = g_app_job_slab_counts[i];
+    g_app_job_pool.stats.slab_count[i] = g_app_job_slab_counts[i];
+  }
+  pthread_mutex_unlock(&g_app_job_pool.lock);
+}
+
+static void app_job_pool_teardown(void) {
+  size_t i = 0;
+
+  pthread_mutex_lock(&g_app_job_pool.lock);
+  while (g_app_job_pool.arena_count > 0u) {
+    Arena *arena = g_app_job_pool.arenas[--g_app_job_pool.arena_count];
+
+    lib.arena.arena_release(arena);
+    free(arena);
+  }
+
+  for (i = 0; i < APP_JOB_BUFFER_CLASS_COUNT; ++i) {
+    AppJobBufferClass *cls = &g_app_job_pool.classes[i];
+
+    if (!cls->slab) {
+      continue;
+    }
+
+    /* A buffer still out would be returned into freed memory; keep the slab. */
+    if (cls->free_count != g_app_job_slab_counts[i]) {
+      LOGW("[daemon.job] %zu-byte slab still has %zu buffers out; keeping it\n",
+           app_job_class_size(i),
+           g_app_job_slab_counts[i] - cls->free_count);
+      continue;
+    }
+
+    free(cls->slab);
+    cls->slab = NULL;
+    cls->free_count = 0u;
+    g_app_job_pool.stats.slab_count[i] = 0u;
+  }
+  pthread_mutex_unlock(&g_app_job_pool.lock);
+}
+
+static uint8_t *app_job_pool_acquire(size_t cap) {
+  AppJobBufferClass *cls = NULL;
+  uint8_t *buffer = NULL;
+  size_t index = 0;
+
+  if (!app_job_class_for(cap, &index)) {
+    pthread_mutex_lock(&g_app_job_pool.lock);
+    g_app_job_pool.stats.oversize++;
+    pthread_mutex_unlock(&g_app_job_pool.lock);
+    return (uint8_t *)malloc(cap);
+  }
+
+  cls = &g_app_job_pool.classes[index];
+  pthread_mutex_lock(&g_app_job_pool.lock);
+  if (cls->free_count > 0u) {
+    buffer = cls->free_list[--cls->free_count];
+    g_app_job_pool.stats.hits[index]++;
+  } else {
+    g_app_job_pool.stats.misses[index]++;
+  }
+  g_app_job_pool.stats.in_use[index]++;
+  if (g_app_job_pool.stats.in_use[index] > g_app_job_pool.stats.in_use_high[index]) {
+    g_app_job_pool.stats.in_use_high[index] = g_app_job_pool.stats.in_use[index];
+  }
+  pthread_mutex_unlock(&g_app_job_pool.lock);
+
+  if (!buffer) {
+    buffer = (uint8_t *)malloc(app_job_class_size(index));
+    if (!buffer) {
+      pthread_mutex_lock(&g_app_job_pool.lock);
+      g_app_job_pool.stats.in_use[index]--;
+      pthread_mutex_unlock(&g_app_job_pool.lock);
+    }
+  }
+
+  return buffer;
+}
+
+static void app_job_pool_release(uint8_t *buffer, size_t cap) {
+  AppJobBufferClass *cls = NULL;
+  size_t index = 0;
+  int pooled = 0;
+
+  if (!buffer) {
+    return;
+  }
+
+  if (!app_job_class_for(cap, &index) || cap != app_job_class_size(index)) {
+    free(buffer);
+    return;
+  }
+
+  cls = &g_app_job_pool.classes[index];
+  pthread_mutex_lock(&g_app_job_pool.lock);
+  if (g_app_job_pool.stats.in_use[index] > 0u) {
+    g_app_job_pool.stats.in_use[index]--;
+  }
+  if (app_job_in_slab(cls, index, buffer)) {
+    cls->free_list[cls->free_count++] = buffer;
+    pooled = 1;
+  }
+  pthread_mutex_unlock(&g_app_job_pool.lock);
+
+  if (!pooled) {
+    free(buffer);
+  }
+}
+
+static Arena *app_job_arena_acquire(void) {
+  Arena *arena = NULL;
+
+  pthread_mutex_lock(&g_app_job_pool.lock);
+  if (g_app_job_pool.arena_count > 0u) {
+    arena = g_app_job_pool.arenas[--g_app_job_pool.arena_count];
+    g_app_job_pool.stats.arena_hits++;
+  } else {
+    g_app_job_pool.stats.arena_misses++;
+  }
+  pthread_mutex_unlock(&g_app_job_pool.lock);
+
+  if (arena) {
+    return arena;
+  }
+
+  arena = (Arena *)calloc(1u, sizeof(*arena));
+  if (!arena || !lib.arena.arena_init(arena, APP_JOB_ARENA_BLOCK_SIZE)) {
+    free(arena);
+    return NULL;
+  }
+
+  return arena;
+}
+
+static void app_job_arena_release(Arena *arena) {
+  size_t used = 0u;
+
+  if (!arena) {
+    return;
+  }
+
+  used = arena->used;
+  lib.arena.reset(arena);
+
+  pthread_mutex_lock(&g_app_job_pool.lock);
+  if (used > g_app_job_pool.stats.arena_high) {
+    g_app_job_pool.stats.arena_high = used;
+  }
+  if (g_app_job_pool.arena_count < APP_JOB_ARENA_POOL_MAX) {
+    g_app_job_pool.arenas[g_app_job_pool.arena_count++] = arena;
+    arena = NULL;
+  }
+  pthread_mutex_unlock(&g_app_job_pool.lock);
+
+  if (arena) {
+    lib.arena.arena_release(arena);
+    free(arena);
+  }
+}
 
 static int app_job_init(void) {
   return 1;
 }
 
 static void app_job_shutdown(void) {
+  app_job_pool_teardown();
 }
 
 static void app_job_release_owned_buffer(uint8_t **buffer,
@@ -28,7 +266,7 @@ static void app_job_release_owned_buffer(uint8_t **buffer,
     return;
   }
 
-  free(*buffer);
+  app_job_pool_release(*buffer, cap ? *cap : 0u);
   *buffer = NULL;
 
   if (len) {
@@ -65,6 +303,9 @@ static void app_job_release_job(AppConnectionJob *job) {
 
   app_job_release_payload(job);
   app_job_release_response(job);
+  app_job_arena_release(job->arena);
+  job->arena = NULL;
+  job->batch = NULL;
 }
 
 static size_t app_job_next_buffer_cap(size_t current_cap, size_t min_cap, size_t block_size) {
@@ -113,11 +354,16 @@ static int app_job_reserve_buffer(uint8_t **buffer,
     return 0;
   }
 
-  next_buffer = realloc(*buffer, next_cap);
+  next_buffer = app_job_pool_acquire(next_cap);
   if (!next_buffer) {
     return 0;
   }
 
+  if (*buffer) {
+    memcpy(next_buffer, *buffer, *cap);
+    app_job_pool_release(*buffer, *cap);
+  }
+
   *buffer = next_buffer;
   *cap = next_cap;
   return 1;
@@ -189,6 +435,8 @@ static int app_job_load_from_normal(AppConnectionJob *job,
   job->client_port = normal->client_port;
   job->encrypted = normal->encrypted;
   job->wire_auth = normal->wire_auth;
+  job->request_key = normal->request_key;
+  job->arena = app_job_arena_acquire();
 
   if (normal->wire_version == 0u) {
     job->request.user_id = 0u;
@@ -232,9 +480,63 @@ static int app_job_state_init(AppJobState *state) {
   }
 
   memset(state, 0, sizeof(*state));
+  state->ready_queue = (AppConnectionJob *)calloc(APP_JOB_READY_QUEUE_INITIAL,
+                                                  sizeof(*state->ready_queue));
+  if (!state->ready_queue) {
+    LOGE("[daemon.job] Failed to allocate ready queue\n");
+    return 0;
+  }
+  state->ready_cap = APP_JOB_READY_QUEUE_INITIAL;
+
+  app_job_pool_prepare();
   return 1;
 }
 
+static void app_job_stats(const AppJobState *state, AppJobPoolStats *out) {
+  if (!out) {
+    return;
+  }
+
+  pthread_mutex_lock(&g_app_job_pool.lock);
+  *out = g_app_job_pool.stats;
+  pthread_mutex_unlock(&g_app_job_pool.lock);
+
+  if (state) {
+    out->queue_capacity = state->ready_cap;
+    out->queue_high = state->ready_high;
+    out->queue_grows = state->ready_grows;
+  }
+}
+
+static void app_job_log_stats(const AppJobState *state) {
+  AppJobPoolStats stats = {0};
+  size_t i = 0;
+
+  app_job_stats(state, &stats);
+  for (i = 0; i < APP_JOB_BUFFER_CLASS_COUNT; ++i) {
+    if (stats.hits[i] == 0u && stats.misses[i] == 0u) {
+      continue;
+    }
+
+    LOGD("[daemon.job] %zu-byte buffers: hits=%llu misses=%llu high=%zu slab=%zu\n",
+         stats.class_size[i],
+         (unsigned long long)stats.hits[i],
+         (unsigned long long)stats.misses[i],
+         stats.in_use_high[i],
+         stats.slab_count[i]);
+  }
+
+  LOGD("[daemon.job] Ready queue: capacity=%zu high=%zu grows=%llu oversize=%llu\n",
+       stats.queue_capacity,
+       stats.queue_high,
+       (unsigned long long)stats.queue_grows,
+       (unsigned long long)stats.oversize);
+  LOGD("[daemon.job] Scratch arenas: hits=%llu misses=%llu high=%zu bytes\n",
+       (unsigned long long)stats.arena_hits,
+       (unsigned long long)stats.arena_misses,
+       stats.arena_high);
+}
+
 static void app_job_state_reset(AppJobState *state) {
   size_t i = 0;
 
@@ -242,11 +544,62 @@ static void app_job_state_reset(AppJobState *state) {
     return;
   }
 
-  for (i = 0; i < APP_JOB_READY_QUEUE_CAPACITY; ++i) {
+  for (i = 0; i < state->ready_cap; ++i) {
     app_job_release_job(&state->ready_queue[i]);
   }
 
+  app_job_log_stats(state);
+  free(state->ready_queue);
   memset(state, 0, sizeof(*state));
+  app_job_pool_teardown();
+}
+
+/*
+ * Make room for one more ready job, doubling the ring up to
+ * APP_JOB_READY_QUEUE_MAX. Entries are moved, not copied, so buffer ownership
+ * follows them into the new ring.
+ */
+static int app_job_reserve_slot(AppJobState *state) {
+  AppConnectionJob *next = NULL;
+  size_t next_cap = 0u;
+  size_t i = 0;
+
+  if (state->ready_count < state->ready_cap) {
+    return 1;
+  }
+
+  next_cap = state->ready_cap ? state->ready_cap * 2u : APP_JOB_READY_QUEUE_INITIAL;
+  if (next_cap > APP_JOB_READY_QUEUE_MAX) {
+    return 0;
+  }
+
+  next = (AppConnectionJob *)calloc(next_cap, sizeof(*next));
+  if (!next) {
+    return 0;
+  }
+
+  for (i = 0; i < state->ready_count; ++i) {
+    memcpy(&next[i],
+           &state->ready_queue[(state->ready_head + i) % state->ready_cap],
+           sizeof(*next));
+  }
+
+  free(state->ready_queue);
+  state->ready_queue = next;
+  state->ready_cap = next_cap;
+  state->ready_head = 0u;
+  state->ready_tail = state->ready_count;
+  state->ready_grows++;
+  LOGD("[daemon.job] Ready queue grown to %zu slots\n", next_cap);
+  return 1;
+}
+
+static void app_job_note_push(AppJobState *state) {
+  state->ready_tail = (state->ready_tail + 1u) % state->ready_cap;
+  state->ready_count++;
+  if (state->ready_count > state->ready_high) {
+    state->ready_high = state->ready_count;
+  }
 }
 
 /*
@@ -264,20 +617,16 @@ static int app_job_enqueue(AppJobState *state, const struct M7MuxRecvPacket *nor
     return 0;
   }
 
-  if (state->ready_count >= APP_JOB_READY_QUEUE_CAPACITY) {
+  if (!app_job_reserve_slot(state)) {
     return 0;
   }
 
   slot = &state->ready_queue[state->ready_tail];
-  app_job_release_job(slot);
-  memset(slot, 0, sizeof(*slot));
-
   if (!app_job_load_from_normal(slot, normal)) {
     return 0;
   }
 
-  state->ready_tail = (state->ready_tail + 1u) % APP_JOB_READY_QUEUE_CAPACITY;
-  state->ready_count++;
+  app_job_note_push(state);
 
   return 1;
 }
@@ -301,12 +650,40 @@ static int app_job_drain(AppJobState *state, AppConnectionJob *out_job) {
   memcpy(out_job, slot, sizeof(*out_job));
   memset(slot, 0, sizeof(*slot));
 
-  state->ready_head = (state->ready_head + 1u) % APP_JOB_READY_QUEUE_CAPACITY;
+  state->ready_head = (state->ready_head + 1u) % state->ready_cap;
   state->ready_count--;
 
   return 1;
 }
 
+/*
+ * Hand a drained job back to the tail of the queue.
+ *
+ * Ownership of the job buffers moves back into the queue slot; the caller's
+ * copy is cleared so it cannot be disposed twice.
+ */
+static int app_job_requeue(AppJobState *state, AppConnectionJob *job) {
+  AppConnectionJob *slot = NULL;
+
+  if (!state || !job) {
+    return 0;
+  }
+
+  if (!app_job_reserve_slot(state)) {
+    return 0;
+  }
+
+  slot = &state->ready_queue[state->ready_tail];
+  app_job_release_job(slot);
+  memcpy(slot, job, sizeof(*slot));
+  slot->deferred = 0;
+  memset(job, 0, sizeof(*job));
+
+  app_job_note_push(state);
+
+  return 1;
+}
+
 static int app_job_consume(AppRuntimeListenerState *listener,
                            AppConnectionJob *job,
                            SiglatchOpenSSLSession *session) {
@@ -345,10 +722,12 @@ static const AppJobLib app_job_instance = {
   .state_reset = app_job_state_reset,
   .enqueue = app_job_enqueue,
   .drain = app_job_drain,
+  .requeue = app_job_requeue,
   .consume = app_job_consume,
   .reserve_response = app_job_reserve_response,
   .dispose = app_job_dispose,
-  .flush_buffer = app_job_flush_buffer
+  .flush_buffer = app_job_flush_buffer,
+  .stats = app_job_stats
 };
 
 const AppJobLib *get_app_daemon_job_lib(void) {
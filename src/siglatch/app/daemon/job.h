@@ -13,13 +13,47 @@
 #define APP_JOB_PAYLOAD_BLOCK_SIZE 1280u
 #define APP_JOB_RESPONSE_BLOCK_SIZE 1280u
 
+/* Ready ring starts at INITIAL slots and doubles on demand up to MAX. */
+#define APP_JOB_READY_QUEUE_INITIAL 64u
+#define APP_JOB_READY_QUEUE_MAX 1024u
+
+/*
+ * Job buffers come from per-class slabs sized BLOCK_SIZE << class. Requests
+ * that fit a class reuse a slab buffer; an empty class falls back to malloc
+ * (counted as a miss) and anything past the largest class is plain heap.
+ */
+#define APP_JOB_BUFFER_CLASS_COUNT 5u
+
+/* Per-job scratch arenas kept for reuse, and their first block size. */
+#define APP_JOB_ARENA_POOL_MAX 64u
+#define APP_JOB_ARENA_BLOCK_SIZE 4096u
+
 struct M7MuxRecvPacket;
 
+typedef struct {
+  size_t class_size[APP_JOB_BUFFER_CLASS_COUNT];
+  size_t slab_count[APP_JOB_BUFFER_CLASS_COUNT];
+  size_t in_use[APP_JOB_BUFFER_CLASS_COUNT];
+  size_t in_use_high[APP_JOB_BUFFER_CLASS_COUNT];
+  uint64_t hits[APP_JOB_BUFFER_CLASS_COUNT];
+  uint64_t misses[APP_JOB_BUFFER_CLASS_COUNT];
+  uint64_t oversize;
+  uint64_t arena_hits;
+  uint64_t arena_misses;
+  size_t arena_high;
+  size_t queue_capacity;
+  size_t queue_high;
+  uint64_t queue_grows;
+} AppJobPoolStats;
+
 typedef struct AppJobState {
-  AppConnectionJob ready_queue[64];
+  AppConnectionJob *ready_queue;
+  size_t ready_cap;
   size_t ready_head;
   size_t ready_tail;
   size_t ready_count;
+  size_t ready_high;
+  uint64_t ready_grows;
 } AppJobState;
 
 typedef struct {
@@ -29,12 +63,14 @@ typedef struct {
   void (*state_reset)(AppJobState *state);
   int (*enqueue)(AppJobState *state, const struct M7MuxRecvPacket *normal);
   int (*drain)(AppJobState *state, AppConnectionJob *out_job);
+  int (*requeue)(AppJobState *state, AppConnectionJob *job);
   int (*consume)(AppRuntimeListenerState *listener,
                  AppConnectionJob *job,
                  SiglatchOpenSSLSession *session);
   int (*reserve_response)(AppConnectionJob *job, size_t min_cap);
   void (*dispose)(AppJobState *state, AppConnectionJob *job);
   int (*flush_buffer)(AppConnectionJob *job);
+  void (*stats)(const AppJobState *state, AppJobPoolStats *out);
 } AppJobLib;
 
 const AppJobLib *get_app_daemon_job_lib(void);
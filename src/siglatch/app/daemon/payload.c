@@ -5,16 +5,32 @@
 
 #include "payload.h"
 
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <unistd.h>
 
 #include "../app.h"
 #include "../../lib.h"
+#include "../../../shared/knock/codec/v2/v2_form1.h"
 #include "../../../shared/knock/response.h"
 #include "../../../stdlib/base64.h"
 
+/* Output bytes per streamed reply packet; sized for the smallest codec (v2). */
+#define APP_DAEMON_PAYLOAD_STREAM_CHUNK_MAX \
+  (SHARED_KNOCK_CODEC_V2_FORM1_PAYLOAD_MAX - SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE - \
+   SL_KNOCK_RESPONSE_SEQ_SIZE)
+/* Chunks sent back to back before pacing starts, then one per interval. */
+#define APP_DAEMON_PAYLOAD_STREAM_BURST 32u
+#define APP_DAEMON_PAYLOAD_STREAM_PACE_US 1000u
+
+typedef struct {
+  const AppConnectionJob *job;
+  uint32_t seq;
+} AppDaemonPayloadStream;
+
 static int app_daemon_payload_reply_action_prefix(uint8_t action_id,
                                                    char *out,
                                                    size_t out_size);
@@ -37,6 +53,15 @@ static int app_daemon_payload_dispatch_action(
     const siglatch_user *user,
     const siglatch_action *action,
     AppConnectionJob *out_job);
+static int app_daemon_payload_dispatch_batch(
+    AppRuntimeListenerState *listener,
+    AppConnectionJob *job,
+    SiglatchOpenSSLSession *session);
+static int app_daemon_payload_execute_shell(const AppConnectionJob *job,
+                                            const siglatch_user *user,
+                                            const siglatch_action *action,
+                                            int secure,
+                                            AppActionReply *reply);
 
 static int app_daemon_payload_init(void) {
   return 1;
@@ -84,6 +109,13 @@ static int app_daemon_payload_reply_action_prefix(uint8_t action_id,
   return 1;
 }
 
+static void app_daemon_payload_put_seq(uint8_t *out, uint32_t seq) {
+  out[0] = (uint8_t)((seq >> 24) & 0xFFu);
+  out[1] = (uint8_t)((seq >> 16) & 0xFFu);
+  out[2] = (uint8_t)((seq >> 8) & 0xFFu);
+  out[3] = (uint8_t)(seq & 0xFFu);
+}
+
 static int app_daemon_payload_build_semantic_reply(
     const AppConnectionJob *job,
     const AppActionReply *reply,
@@ -96,6 +128,7 @@ static int app_daemon_payload_build_semantic_reply(
   size_t rendered_len = 0;
   size_t max_text_len = 0;
   size_t message_len = 0;
+  size_t header_len = SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE;
 
   if (!job || !reply || !out_buf || !out_len) {
     return 0;
@@ -114,6 +147,17 @@ static int app_daemon_payload_build_semantic_reply(
   out_buf[0] = reply->ok ? SL_KNOCK_RESPONSE_STATUS_OK : SL_KNOCK_RESPONSE_STATUS_ERROR;
   out_buf[1] = job->request.action_id;
 
+  /* After streamed output, say how many chunks came first. */
+  if (reply->chunk_count > 0u) {
+    if (out_size < header_len + SL_KNOCK_RESPONSE_SEQ_SIZE) {
+      return 0;
+    }
+
+    app_daemon_payload_put_seq(out_buf + header_len, reply->chunk_count);
+    header_len += SL_KNOCK_RESPONSE_SEQ_SIZE;
+    flags |= SL_KNOCK_RESPONSE_FLAG_SEQ;
+  }
+
   if (app_daemon_payload_reply_action_prefix(job->request.action_id,
                                               action_prefix,
                                               sizeof(action_prefix))) {
@@ -128,7 +172,7 @@ static int app_daemon_payload_build_semantic_reply(
   }
 
   rendered_len = strnlen(rendered_message, sizeof(rendered_message));
-  max_text_len = out_size - SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE;
+  max_text_len = out_size - header_len;
   /*
    * Keep daemon replies bounded by the app-level reply buffer, not a transport
    * packet size from one codec family.
@@ -149,16 +193,46 @@ static int app_daemon_payload_build_semantic_reply(
   out_buf[2] = flags;
 
   if (message_len > 0u) {
-    memcpy(out_buf + SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE, rendered_message, message_len);
+    memcpy(out_buf + header_len, rendered_message, message_len);
   }
 
-  *out_len = SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE + message_len;
+  *out_len = header_len + message_len;
   return 1;
 }
 
-static int app_daemon_payload_consume(AppRuntimeListenerState *listener,
-                                       AppConnectionJob *job,
-                                       SiglatchOpenSSLSession *session) {
+/*
+ * Dead-drop scripts are fork/exec like shell actions and go to the executor
+ * pool too; only the prefix match runs on the loop. The script runs inline
+ * when the pool is not started.
+ */
+static int app_daemon_payload_dispatch_deaddrop(AppRuntimeListenerState *listener,
+                                                AppConnectionJob *job) {
+  const siglatch_deaddrop *deaddrop = NULL;
+  size_t match_len = 0;
+
+  deaddrop = app.payload.unstructured.match(listener, job, &match_len);
+  if (!deaddrop) {
+    return 1;
+  }
+
+  if (app.daemon.executor.is_running()) {
+    if (!app.daemon.executor.submit_deaddrop(job,
+                                             deaddrop,
+                                             match_len,
+                                             listener->server->secure)) {
+      job->deferred = 1;
+      job->should_reply = 0;
+    }
+    return 1;
+  }
+
+  app.payload.unstructured.run(job, deaddrop, match_len, listener->server->secure);
+  return 1;
+}
+
+static int app_daemon_payload_consume_pinned(AppRuntimeListenerState *listener,
+                                              AppConnectionJob *job,
+                                              SiglatchOpenSSLSession *session) {
   const siglatch_user *user = NULL;
   const siglatch_action *action = NULL;
 
@@ -175,10 +249,24 @@ static int app_daemon_payload_consume(AppRuntimeListenerState *listener,
 
   if (job->wire_version == 0u) {
     LOGD("[daemon.payload] Routing raw unstructured payload to fallback handler\n");
-    app.payload.unstructured.handle(listener, job);
+    return app_daemon_payload_dispatch_deaddrop(listener, job);
+  }
+
+  /*
+   * Under lazy_user_keys a request can arrive while a warm thread is parsing
+   * its user's public key. It waits in the queue for a pass or two rather
+   * than failing on a missing key.
+   */
+  if (!app.keys.user.resolve(app.config.user_by_id(job->request.user_id))) {
+    job->deferred = 1;
+    job->should_reply = 0;
     return 1;
   }
 
+  if (app.daemon.batch.is_batch(job)) {
+    return app_daemon_payload_dispatch_batch(listener, job, session);
+  }
+
   if (!app.daemon.request.bind_user_action(listener, job, session, &user, &action)) {
     return 0;
   }
@@ -197,6 +285,21 @@ static int app_daemon_payload_consume(AppRuntimeListenerState *listener,
   return app_daemon_payload_dispatch_action(listener, job, session, user, action, job);
 }
 
+/*
+ * The user and action found for a request point into the config snapshot
+ * current at dispatch. Pin it so a reload committed by the request itself
+ * cannot free them before dispatch returns.
+ */
+static int app_daemon_payload_consume(AppRuntimeListenerState *listener,
+                                       AppConnectionJob *job,
+                                       SiglatchOpenSSLSession *session) {
+  const siglatch_config *snapshot = app.config.acquire();
+  int ok = app_daemon_payload_consume_pinned(listener, job, session);
+
+  app.config.release(snapshot);
+  return ok;
+}
+
 static int app_daemon_payload_stage_reply(
     AppRuntimeListenerState *listener,
     SiglatchOpenSSLSession *session,
@@ -253,16 +356,8 @@ static int app_daemon_payload_dispatch_action(
   AppObjectContext object_ctx = {0};
   AppActionReply object_reply = {0};
   AppActionReply shell_reply = {0};
-  char empty_payload_b64[1] = {0};
-  char *payload_b64 = empty_payload_b64;
-  char user_id_str[16];
-  char action_id_str[16];
-  char encrypted_str[8];
-  char *argv[8] = {0};
-  int shell_exit_code = 127;
+  AppActionReply cached_reply = {0};
   int ok = 0;
-  size_t payload_b64_size = 0;
-  int payload_b64_allocated = 0;
 
   LOGD("[daemon.payload] Routing normalized unit to action handlers\n");
 
@@ -271,6 +366,16 @@ static int app_daemon_payload_dispatch_action(
     return 0;
   }
 
+  /* Read-only actions with cache_ttl_ms answer repeats without dispatching. */
+  if (app.daemon.cache.lookup(out_job, action, &cached_reply)) {
+    LOGD("[daemon.payload] Answering action (%s) from reply cache\n", action->name);
+    if (!app_daemon_payload_stage_reply(listener, session, out_job, &cached_reply)) {
+      LOGE("[daemon.payload] Cached reply stage failed for action (%s)\n", action->name);
+      return 0;
+    }
+    return cached_reply.ok;
+  }
+
   if (app.builtin.is_action(action)) {
     const siglatch_user *reply_user = user;
 
@@ -287,6 +392,12 @@ static int app_daemon_payload_dispatch_action(
          action->name);
 
     ok = app.builtin.handle(builtin_ctx_ptr, &builtin_reply);
+    if (builtin_reply.deferred) {
+      out_job->deferred = 1;
+      out_job->should_reply = 0;
+      return 1;
+    }
+
     if (!ok) {
       if (builtin_reply.should_reply) {
         reply_user = app.config.user_by_id(job->request.user_id);
@@ -318,6 +429,20 @@ static int app_daemon_payload_dispatch_action(
       return 0;
     }
 
+    app.daemon.cache.store(out_job, action, &builtin_reply);
+    return 1;
+  }
+
+  /*
+   * Fork/exec and object handlers run on the executor pool so their latency
+   * does not hold up the loop. When the pool or the action's concurrency
+   * limit is saturated the job is deferred and retried after a completion.
+   */
+  if (app.daemon.executor.accepts(job, action)) {
+    if (!app.daemon.executor.submit(out_job, user, action, listener->server->secure)) {
+      out_job->deferred = 1;
+      out_job->should_reply = 0;
+    }
     return 1;
   }
 
@@ -347,6 +472,8 @@ static int app_daemon_payload_dispatch_action(
       return 0;
     }
 
+    app.daemon.cache.store(out_job, action, &object_reply);
+
     return ok;
   }
 
@@ -356,32 +483,173 @@ static int app_daemon_payload_dispatch_action(
   }
 
   /*
-   * The shell path sizes its temporary base64 buffer from the actual payload
-   * length so it can handle heap-backed requests without truncation.
+   * Streamed shell actions receive fragments on stdin as they arrive instead
+   * of one base64 argv after full buffering. The stream keeps the final
+   * fragment's job and hands it back through drain() once the action exits.
+   */
+  if (app.daemon.stream.wants(job, action)) {
+    AppStreamFeedResult feed = app.daemon.stream.feed(
+        out_job, user, action, listener->server->secure, &shell_reply);
+
+    if (feed == APP_STREAM_FEED_DEFERRED) {
+      out_job->deferred = 1;
+      out_job->should_reply = 0;
+      return 1;
+    }
+
+    if (feed != APP_STREAM_FEED_ERROR) {
+      out_job->should_reply = 0;
+      return 1;
+    }
+
+    if (!app_daemon_payload_stage_reply(listener, session, out_job, &shell_reply)) {
+      LOGE("[daemon.payload] Stream reply stage failed for action (%s)\n", action->name);
+    }
+    return 0;
+  }
+
+  ok = app_daemon_payload_execute_shell(job, user, action, listener->server->secure, &shell_reply);
+  if (!app_daemon_payload_stage_reply(listener, session, out_job, &shell_reply)) {
+    LOGE("[daemon.payload] Shell reply stage failed for action (%s)\n", action->name);
+    return 0;
+  }
+
+  app.daemon.cache.store(out_job, action, &shell_reply);
+
+  return ok;
+}
+
+/*
+ * A batch is authenticated and authorized once, then runs as a single
+ * executor task that works through its entries in order. With no executor,
+ * or nothing runnable in the plan, it is answered inline.
+ */
+static int app_daemon_payload_dispatch_batch(
+    AppRuntimeListenerState *listener,
+    AppConnectionJob *job,
+    SiglatchOpenSSLSession *session) {
+  const siglatch_user *user = NULL;
+  const siglatch_action *lead = NULL;
+  AppActionReply batch_reply = {0};
+  int ok = 0;
+
+  if (!app.daemon.batch.prepare(listener, job, session, &user)) {
+    return 0;
+  }
+
+  lead = app.daemon.batch.lead_action(job);
+  if (lead && app.daemon.executor.is_running()) {
+    if (!app.daemon.executor.submit(job, user, lead, listener->server->secure)) {
+      job->deferred = 1;
+      job->should_reply = 0;
+    }
+    return 1;
+  }
+
+  ok = app.daemon.batch.execute(job, user, listener->server->secure, &batch_reply);
+  if (!app_daemon_payload_stage_reply(listener, session, job, &batch_reply)) {
+    LOGE("[daemon.payload] Batch reply stage failed for user_id=%u\n", job->request.user_id);
+    return 0;
+  }
+
+  return ok;
+}
+
+/*
+ * Output sink for stream_reply actions. Each chunk goes out as an OK reply
+ * flagged MORE, carrying its sequence number and the raw bytes after the
+ * usual response header.
+ */
+static int app_daemon_payload_stream_chunk(void *ctx, const uint8_t *data, size_t len) {
+  AppDaemonPayloadStream *stream = (AppDaemonPayloadStream *)ctx;
+  uint8_t response[SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE + SL_KNOCK_RESPONSE_SEQ_SIZE +
+                   APP_DAEMON_PAYLOAD_STREAM_CHUNK_MAX];
+  size_t header_len = SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE + SL_KNOCK_RESPONSE_SEQ_SIZE;
+
+  if (!stream || !stream->job || !data || len == 0u ||
+      len > APP_DAEMON_PAYLOAD_STREAM_CHUNK_MAX) {
+    return 0;
+  }
+
+  /*
+   * There is no acknowledgement on the reply path, so pace long outputs to a
+   * rate a client decrypting every packet keeps up with.
+   */
+  stream->seq++;
+  if (stream->seq > APP_DAEMON_PAYLOAD_STREAM_BURST) {
+    usleep(APP_DAEMON_PAYLOAD_STREAM_PACE_US);
+  }
+
+  response[0] = SL_KNOCK_RESPONSE_STATUS_OK;
+  response[1] = stream->job->request.action_id;
+  response[2] = SL_KNOCK_RESPONSE_FLAG_MORE | SL_KNOCK_RESPONSE_FLAG_SEQ;
+  app_daemon_payload_put_seq(response + SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE, stream->seq);
+  memcpy(response + header_len, data, len);
+
+  return app.daemon.executor.emit(stream->job, stream->seq, response, header_len + len);
+}
+
+/*
+ * Run a buffered shell action to completion and describe the outcome in
+ * reply. Touches no loop-owned state, so it is safe on executor workers.
+ * For stream_reply actions on a worker, stdout is sent back as it is read
+ * and reply only carries the final status.
+ */
+static int app_daemon_payload_execute_shell(const AppConnectionJob *job,
+                                            const siglatch_user *user,
+                                            const siglatch_action *action,
+                                            int secure,
+                                            AppActionReply *reply) {
+  char empty_payload_b64[1] = {0};
+  char payload_stdin[] = "/dev/stdin";
+  char *payload_b64 = empty_payload_b64;
+  char user_id_str[16];
+  char action_id_str[16];
+  char encrypted_str[8];
+  char *argv[8] = {0};
+  const uint8_t *input = NULL;
+  size_t input_len = 0;
+  AppDaemonPayloadStream stream = {0};
+  int shell_exit_code = 127;
+  int ran = 0;
+  size_t payload_b64_size = 0;
+
+  if (!job || !user || !action || !reply) {
+    return 0;
+  }
+
+  if (action->constructor[0] == '\0') {
+    LOGW("[daemon.payload] Shell action ID %u has no constructor\n", job->request.action_id);
+    app.payload.reply.set(reply, 0, "ERROR %s exec_failed", action->name);
+    return 0;
+  }
+
+  /*
+   * payload_memfd hands the raw bytes over as a sealed memfd on stdin and
+   * passes /dev/stdin as the payload argument. Otherwise the shell path sizes
+   * its temporary base64 buffer from the actual payload length so it can
+   * handle heap-backed requests without truncation.
    */
-  if (job->request.payload_len > 0u) {
+  if (action->payload_memfd) {
+    input = job->request.payload_buffer ? job->request.payload_buffer : (const uint8_t *)"";
+    input_len = job->request.payload_buffer ? job->request.payload_len : 0u;
+    payload_b64 = payload_stdin;
+  } else if (job->request.payload_len > 0u) {
     if (!app_daemon_payload_base64_size(job->request.payload_len, &payload_b64_size)) {
       LOGE("[daemon.payload] Shell payload too large for base64 buffer (payload_len=%zu)\n",
            job->request.payload_len);
-      app.payload.reply.set(&shell_reply, 0, "ERROR %s payload_too_large", action->name);
-      if (!app_daemon_payload_stage_reply(listener, session, out_job, &shell_reply)) {
-        LOGE("[daemon.payload] Shell overflow reply stage failed for action (%s)\n", action->name);
-      }
+      app.payload.reply.set(reply, 0, "ERROR %s payload_too_large", action->name);
       return 0;
     }
 
-    payload_b64 = (char *)malloc(payload_b64_size);
+    /* Scratch lives in the job's arena and goes away when the job is disposed. */
+    payload_b64 = (char *)lib.arena.alloc(job->arena, payload_b64_size);
     if (!payload_b64) {
       LOGE("[daemon.payload] Failed to allocate base64 buffer for shell payload (payload_len=%zu)\n",
            job->request.payload_len);
-      app.payload.reply.set(&shell_reply, 0, "ERROR %s payload_alloc_failed", action->name);
-      if (!app_daemon_payload_stage_reply(listener, session, out_job, &shell_reply)) {
-        LOGE("[daemon.payload] Shell alloc-failure reply stage failed for action (%s)\n",
-             action->name);
-      }
+      app.payload.reply.set(reply, 0, "ERROR %s payload_alloc_failed", action->name);
       return 0;
     }
-    payload_b64_allocated = 1;
 
     if (base64_encode(job->request.payload_buffer,
                       job->request.payload_len,
@@ -389,18 +657,14 @@ static int app_daemon_payload_dispatch_action(
                       payload_b64_size) < 0) {
       LOGE("[daemon.payload] Shell payload too large for base64 buffer (payload_len=%zu)\n",
            job->request.payload_len);
-      app.payload.reply.set(&shell_reply, 0, "ERROR %s payload_too_large", action->name);
-      if (!app_daemon_payload_stage_reply(listener, session, out_job, &shell_reply)) {
-        LOGE("[daemon.payload] Shell overflow reply stage failed for action (%s)\n", action->name);
-      }
-      free(payload_b64);
+      app.payload.reply.set(reply, 0, "ERROR %s payload_too_large", action->name);
       return 0;
     }
   }
 
   snprintf(user_id_str, sizeof(user_id_str), "%u", job->request.user_id);
   snprintf(action_id_str, sizeof(action_id_str), "%u", job->request.action_id);
-  snprintf(encrypted_str, sizeof(encrypted_str), "%d", listener->server->secure ? 1 : 0);
+  snprintf(encrypted_str, sizeof(encrypted_str), "%d", secure ? 1 : 0);
 
   argv[0] = (char *)job->ip;
   argv[1] = user_id_str;
@@ -418,50 +682,159 @@ static int app_daemon_payload_dispatch_action(
        action->name,
        action->exec_split);
 
-  if (!app.payload.run_shell_wait(
-          action->constructor,
-          7,
-          argv,
-          action->exec_split,
-          action->run_as[0] ? action->run_as : NULL,
-          &shell_exit_code)) {
-    app.payload.reply.set(&shell_reply, 0, "ERROR %s exec_failed", action->name);
-    if (!app_daemon_payload_stage_reply(listener, session, out_job, &shell_reply)) {
-      LOGE("[daemon.payload] Shell error reply stage failed for action (%s)\n", action->name);
-    }
-    if (payload_b64_allocated) {
-      free(payload_b64);
-    }
+  if (action->stream_reply && app.daemon.executor.is_running()) {
+    stream.job = job;
+    ran = app.payload.run_shell_stream(action->constructor,
+                                       7,
+                                       argv,
+                                       action->exec_split,
+                                       action->run_as[0] ? action->run_as : NULL,
+                                       input,
+                                       input_len,
+                                       action->timeout_ms,
+                                       APP_DAEMON_PAYLOAD_STREAM_CHUNK_MAX,
+                                       app_daemon_payload_stream_chunk,
+                                       &stream,
+                                       &shell_exit_code);
+  } else {
+    ran = app.payload.run_shell_wait(action->constructor,
+                                     7,
+                                     argv,
+                                     action->exec_split,
+                                     action->run_as[0] ? action->run_as : NULL,
+                                     input,
+                                     input_len,
+                                     action->timeout_ms,
+                                     &shell_exit_code);
+  }
+
+  if (!ran) {
+    app.payload.reply.set(reply, 0, "ERROR %s exec_failed", action->name);
     return 0;
   }
 
   if (shell_exit_code == 0) {
-    app.payload.reply.set(&shell_reply, 1, "OK %s", action->name);
+    app.payload.reply.set(reply, 1, "OK %s", action->name);
+  } else if (action->timeout_ms > 0 && shell_exit_code == 128 + SIGKILL) {
+    app.payload.reply.set(reply, 0, "ERROR %s timeout", action->name);
   } else if (shell_exit_code == 126 && action->run_as[0] != '\0') {
-    app.payload.reply.set(&shell_reply, 0, "ERROR %s run_as_failed", action->name);
+    app.payload.reply.set(reply, 0, "ERROR %s run_as_failed", action->name);
   } else {
-    app.payload.reply.set(&shell_reply, 0, "ERROR %s rc=%d", action->name, shell_exit_code);
+    app.payload.reply.set(reply, 0, "ERROR %s rc=%d", action->name, shell_exit_code);
   }
+  reply->chunk_count = stream.seq;
 
-  if (!app_daemon_payload_stage_reply(listener, session, out_job, &shell_reply)) {
-    LOGE("[daemon.payload] Shell reply stage failed for action (%s)\n", action->name);
-    if (payload_b64_allocated) {
-      free(payload_b64);
+  return shell_exit_code == 0;
+}
+
+/*
+ * Executor entry point. Runs on a worker thread with private copies of the
+ * user and action; there is no listener or session here.
+ */
+static int app_daemon_payload_execute(const AppConnectionJob *job,
+                                      const siglatch_user *user,
+                                      const siglatch_action *action,
+                                      int secure,
+                                      AppActionReply *reply) {
+  AppObjectContext object_ctx = {0};
+
+  if (!job || !user || !action || !reply) {
+    return 0;
+  }
+
+  if (job->batch) {
+    return app.daemon.batch.execute(job, user, secure, reply);
+  }
+
+  if (action->handler == SL_ACTION_HANDLER_STATIC ||
+      action->handler == SL_ACTION_HANDLER_DYNAMIC) {
+    object_ctx = (AppObjectContext){
+      .listener = NULL,
+      .job = job,
+      .session = NULL,
+      .user = user,
+      .action = action,
+      .ip_addr = job->ip
+    };
+
+    if (action->handler == SL_ACTION_HANDLER_STATIC) {
+      return app.object.run_static(&object_ctx, reply);
     }
+
+    return app.object.run_dynamic(&object_ctx, reply);
+  }
+
+  return app_daemon_payload_execute_shell(job, user, action, secure, reply);
+}
+
+/*
+ * Stage the reply for a job that finished on the executor. Back on the loop
+ * thread, the session is re-attached to the requesting user before the reply
+ * is encoded, since other requests have used it in the meantime.
+ */
+static int app_daemon_payload_reattach_session(AppConnectionJob *job,
+                                               SiglatchOpenSSLSession *session) {
+  const siglatch_user *user = app.config.user_by_id(job->request.user_id);
+
+  if (!user || !app.inbound.crypto.assign_session_to_user(session, user)) {
+    LOGW("[daemon.payload] Dropping executor reply; user_id %u is no longer available\n",
+         job->request.user_id);
+    job->should_reply = 0;
+    job->response_len = 0u;
+    return 0;
+  }
+
+  return 1;
+}
+
+static int app_daemon_payload_complete(AppRuntimeListenerState *listener,
+                                       AppConnectionJob *job,
+                                       SiglatchOpenSSLSession *session,
+                                       const AppActionReply *reply) {
+  if (!listener || !job || !session || !reply) {
     return 0;
   }
 
-  if (payload_b64_allocated) {
-    free(payload_b64);
+  /* Dead-drop output is the raw reply; there is nothing to encode. */
+  if (job->wire_version == 0u) {
+    return 1;
   }
 
-  return shell_exit_code == 0;
+  if (reply->should_reply && !app_daemon_payload_reattach_session(job, session)) {
+    return 0;
+  }
+
+  if (!app_daemon_payload_stage_reply(listener, session, job, reply)) {
+    return 0;
+  }
+
+  if (job->cache_epoch != 0u) {
+    app.daemon.cache.store(job, app.config.action_by_id(job->request.action_id), reply);
+  }
+  return 1;
+}
+
+/*
+ * Same as complete() for one chunk of a streamed reply. The chunk was encoded
+ * on the worker, so only the session needs re-attaching.
+ */
+static int app_daemon_payload_complete_chunk(AppRuntimeListenerState *listener,
+                                             AppConnectionJob *job,
+                                             SiglatchOpenSSLSession *session) {
+  if (!listener || !job || !session || job->response_len == 0u) {
+    return 0;
+  }
+
+  return app_daemon_payload_reattach_session(job, session);
 }
 
 static const AppDaemonPayloadLib app_payload_instance = {
   .init = app_daemon_payload_init,
   .shutdown = app_daemon_payload_shutdown,
-  .consume = app_daemon_payload_consume
+  .consume = app_daemon_payload_consume,
+  .execute = app_daemon_payload_execute,
+  .complete = app_daemon_payload_complete,
+  .complete_chunk = app_daemon_payload_complete_chunk
 };
 
 const AppDaemonPayloadLib *get_app_daemon_payload_lib(void) {
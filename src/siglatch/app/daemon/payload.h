@@ -8,6 +8,8 @@
 
 #include "job.h"
 #include "../runtime/runtime.h"
+#include "../config/config.h"
+#include "../payload/reply.h"
 #include "../../../stdlib/openssl/session/session.h"
 
 typedef struct {
@@ -16,6 +18,18 @@ typedef struct {
   int (*consume)(AppRuntimeListenerState *listener,
                  AppConnectionJob *job,
                  SiglatchOpenSSLSession *session);
+  int (*execute)(const AppConnectionJob *job,
+                 const siglatch_user *user,
+                 const siglatch_action *action,
+                 int secure,
+                 AppActionReply *reply);
+  int (*complete)(AppRuntimeListenerState *listener,
+                  AppConnectionJob *job,
+                  SiglatchOpenSSLSession *session,
+                  const AppActionReply *reply);
+  int (*complete_chunk)(AppRuntimeListenerState *listener,
+                        AppConnectionJob *job,
+                        SiglatchOpenSSLSession *session);
 } AppDaemonPayloadLib;
 
 const AppDaemonPayloadLib *get_app_daemon_payload_lib(void);
@@ -23,12 +23,12 @@ static int app_daemon_policy_enforce(const AppRuntimeListenerState *listener,
     return 0;
   }
 
-  if (!app.server.action_available(listener->server, action->name)) {
+  if (!app.server.action_granted(listener->server, action->id)) {
     LOGE("[daemon.policy] Action (%s) not permitted on this server.\n", action->name);
     return 0;
   }
 
-  if (!app.config.action_available_by_user(job->request.user_id, action->name)) {
+  if (!app.config.user_action_granted(user, action->id)) {
     LOGE("[daemon.policy] Action (%s) not permitted by this user(%s).\n",
          action->name,
          user->name);
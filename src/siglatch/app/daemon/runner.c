@@ -17,6 +17,33 @@
 #include "../../../shared/shared.h"
 #include "../../../stdlib/protocol/udp/m7mux/internal.h"
 #include "../../../stdlib/protocol/udp/m7mux/normalize/normalize.h"
+#include "../../../shared/knock/codec/user.h"
+
+/* helper.reply_payload_max() narrows this per wire family. */
+#define APP_DAEMON_REPLY_BUNDLE_MAX M7MUX_USER_DATA_PAYLOAD_MAX
+#define APP_DAEMON_LIMIT_REPORT_MS 5000u
+/* The most entries a bundle can frame: each carries at least a response header. */
+#define APP_DAEMON_REPLY_BUNDLE_ENTRIES \
+  (APP_DAEMON_REPLY_BUNDLE_MAX /        \
+   (SL_KNOCK_RESPONSE_BUNDLE_ENTRY_HEADER_SIZE + SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE))
+
+/*
+ * Replies for one peer collected during a drain pass. head keeps the routing
+ * fields of the first reply; payload holds the framed entries after room for
+ * the outer response header. shared_keys are the reply-cache handles of the
+ * entries after the head, so a retransmit of any of them is answered too.
+ */
+typedef struct {
+  AppConnectionJob head;
+  uint8_t payload[APP_DAEMON_REPLY_BUNDLE_MAX];
+  uint64_t shared_keys[APP_DAEMON_REPLY_BUNDLE_ENTRIES];
+  size_t shared_key_count;
+  size_t len;
+  size_t count;
+  size_t cap;
+  uint8_t last_status;
+  uint8_t last_flags;
+} AppDaemonReplyBundle;
 
 static void app_daemon_configure_mux_policy(const AppRuntimeListenerState *listener,
                                             M7MuxState *mux_state) {
@@ -63,6 +90,7 @@ static int app_daemon_stage_raw_outbox_reply(M7MuxState *mux_state,
   raw_send.received_ms = job->timestamp;
   raw_send.bytes = job->response_buffer;
   raw_send.bytes_len = response_len;
+  raw_send.request_key = job->request_key;
 
   if (lib.m7mux.outbox.stage_bytes(mux_state, &raw_send)) {
     return 1;
@@ -81,9 +109,11 @@ static int app_daemon_stage_raw_outbox_reply(M7MuxState *mux_state,
   return 0;
 }
 
-static int app_daemon_stage_outbox_reply(M7MuxState *mux_state,
-                                          AppRuntimeListenerState *listener,
-                                          const AppConnectionJob *job) {
+static int app_daemon_stage_outbox_reply_shared(M7MuxState *mux_state,
+                                                 AppRuntimeListenerState *listener,
+                                                 const AppConnectionJob *job,
+                                                 const uint64_t *shared_keys,
+                                                 size_t shared_key_count) {
   if (!mux_state || !listener || !job) {
     return 0;
   }
@@ -99,6 +129,8 @@ static int app_daemon_stage_outbox_reply(M7MuxState *mux_state,
   if (!app.daemon.helper.copy_job_reply_to_send(job, &send, &user)) {
     return 0;
   }
+  send.shared_keys = shared_keys;
+  send.shared_key_count = shared_key_count;
 
   if (lib.m7mux.outbox.stage(mux_state, &send)) {
     return 1;
@@ -117,18 +149,240 @@ static int app_daemon_stage_outbox_reply(M7MuxState *mux_state,
   return 0;
 }
 
+static int app_daemon_stage_outbox_reply(M7MuxState *mux_state,
+                                          AppRuntimeListenerState *listener,
+                                          const AppConnectionJob *job) {
+  return app_daemon_stage_outbox_reply_shared(mux_state, listener, job, NULL, 0u);
+}
+
+static int app_daemon_bundle_same_peer(const AppDaemonReplyBundle *bundle,
+                                       const AppConnectionJob *job) {
+  return bundle->head.wire_version == job->wire_version &&
+         bundle->head.wire_form == job->wire_form &&
+         bundle->head.session_id == job->session_id &&
+         bundle->head.client_port == job->client_port &&
+         bundle->head.encrypted == job->encrypted &&
+         bundle->head.request.user_id == job->request.user_id &&
+         strncmp(bundle->head.ip, job->ip, sizeof(bundle->head.ip)) == 0;
+}
+
+/*
+ * Send whatever the bundle holds. A single reply goes out unchanged; more
+ * than one goes out as one BUNDLE response. The session is re-attached to the
+ * bundle's user first, since later jobs in the pass may have moved it, and
+ * put back afterwards for the job that caused the flush.
+ */
+static int app_daemon_bundle_flush(AppDaemonReplyBundle *bundle,
+                                   M7MuxState *mux_state,
+                                   AppRuntimeListenerState *listener,
+                                   SiglatchOpenSSLSession *session) {
+  const siglatch_user *user = NULL;
+  AppConnectionJob job = {0};
+  EVP_PKEY *prev_public_key = session->public_key;
+  uint8_t prev_hmac_key[sizeof(session->hmac_key)];
+  size_t prev_hmac_key_len = session->hmac_key_len;
+  int rc = 0;
+
+  if (bundle->count == 0u) {
+    return 1;
+  }
+
+  memcpy(prev_hmac_key, session->hmac_key, sizeof(prev_hmac_key));
+
+  user = app.config.user_by_id(bundle->head.request.user_id);
+  if (!user || !app.inbound.crypto.assign_session_to_user(session, user)) {
+    LOGW("[daemon.runner] Dropping %zu coalesced replies; user_id %u is no longer available\n",
+         bundle->count,
+         bundle->head.request.user_id);
+    bundle->count = 0u;
+    bundle->shared_key_count = 0u;
+    bundle->len = 0u;
+    return 1;
+  }
+
+  job = bundle->head;
+  job.should_reply = 1;
+  if (bundle->count == 1u) {
+    job.response_buffer = bundle->payload + SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE +
+                          SL_KNOCK_RESPONSE_BUNDLE_ENTRY_HEADER_SIZE;
+    job.response_len = bundle->len - SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE -
+                       SL_KNOCK_RESPONSE_BUNDLE_ENTRY_HEADER_SIZE;
+  } else {
+    bundle->payload[0] = bundle->last_status;
+    bundle->payload[1] = bundle->head.request.action_id;
+    bundle->payload[2] = (uint8_t)(SL_KNOCK_RESPONSE_FLAG_BUNDLE |
+                                   (bundle->last_flags & SL_KNOCK_RESPONSE_FLAG_MORE));
+    job.response_buffer = bundle->payload;
+    job.response_len = bundle->len;
+  }
+  job.response_cap = job.response_len;
+
+  rc = app_daemon_stage_outbox_reply_shared(mux_state,
+                                            listener,
+                                            &job,
+                                            bundle->shared_keys,
+                                            bundle->shared_key_count);
+  bundle->count = 0u;
+  bundle->shared_key_count = 0u;
+  bundle->len = 0u;
+
+  session->public_key = prev_public_key;
+  memcpy(session->hmac_key, prev_hmac_key, sizeof(session->hmac_key));
+  session->hmac_key_len = prev_hmac_key_len;
+  return rc;
+}
+
+/*
+ * Stage one finished reply, holding it back while later replies for the same
+ * peer and user can still share its packet. Raw replies, coalescing turned
+ * off, and replies too large to share go straight to the outbox.
+ */
+static int app_daemon_stage_or_coalesce(AppDaemonReplyBundle *bundle,
+                                        M7MuxState *mux_state,
+                                        AppRuntimeListenerState *listener,
+                                        SiglatchOpenSSLSession *session,
+                                        const AppConnectionJob *job) {
+  size_t cap = 0;
+  size_t need = 0;
+  int rc = 0;
+
+  if (!listener->server->coalesce_replies || job->wire_version == 0u ||
+      job->response_len < SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE) {
+    rc = app_daemon_bundle_flush(bundle, mux_state, listener, session);
+    if (rc <= 0) {
+      return rc;
+    }
+    return app_daemon_stage_outbox_reply(mux_state, listener, job);
+  }
+
+  cap = app.daemon.helper.reply_payload_max(job->wire_version);
+  if (cap > sizeof(bundle->payload)) {
+    cap = sizeof(bundle->payload);
+  }
+  need = SL_KNOCK_RESPONSE_BUNDLE_ENTRY_HEADER_SIZE + job->response_len;
+
+  if (bundle->count > 0u &&
+      (!app_daemon_bundle_same_peer(bundle, job) || bundle->len + need > bundle->cap)) {
+    rc = app_daemon_bundle_flush(bundle, mux_state, listener, session);
+    if (rc <= 0) {
+      return rc;
+    }
+  }
+
+  if (SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE + need > cap) {
+    return app_daemon_stage_outbox_reply(mux_state, listener, job);
+  }
+
+  if (bundle->count == 0u) {
+    bundle->head = *job;
+    bundle->head.response_buffer = NULL;
+    bundle->head.response_len = 0u;
+    bundle->head.response_cap = 0u;
+    bundle->head.request.payload_buffer = NULL;
+    bundle->head.arena = NULL;
+    bundle->head.batch = NULL;
+    bundle->len = SL_KNOCK_RESPONSE_PAYLOAD_HEADER_SIZE;
+    bundle->cap = cap;
+  } else if (job->request_key != 0u &&
+             bundle->shared_key_count < APP_DAEMON_REPLY_BUNDLE_ENTRIES) {
+    bundle->shared_keys[bundle->shared_key_count++] = job->request_key;
+  }
+
+  bundle->payload[bundle->len] = (uint8_t)((job->response_len >> 8) & 0xFFu);
+  bundle->payload[bundle->len + 1u] = (uint8_t)(job->response_len & 0xFFu);
+  memcpy(bundle->payload + bundle->len + SL_KNOCK_RESPONSE_BUNDLE_ENTRY_HEADER_SIZE,
+         job->response_buffer,
+         job->response_len);
+  bundle->len += need;
+  bundle->count++;
+  bundle->last_status = job->response_buffer[0];
+  bundle->last_flags = job->response_buffer[2];
+  return 1;
+}
+
+/*
+ * Tell the mux whether a request's sender signed correctly; under overload
+ * that decides who is let in first. Jobs handed to the executor report when
+ * they come back, since submitting one clears the runner's copy.
+ */
+static void app_daemon_note_auth(M7MuxState *mux_state, const AppConnectionJob *job) {
+  if (job->auth_result != 0) {
+    (void)lib.m7mux.inbox.note_peer(mux_state, job->ip, job->auth_result > 0);
+  }
+}
+
 static int app_daemon_drain_jobs_and_flush(AppRuntimeListenerState *listener,
                                             M7MuxState *mux_state,
                                             AppJobState *job_state,
                                             SiglatchOpenSSLSession *session) {
+  AppDaemonReplyBundle bundle = {0};
   AppConnectionJob job = {0};
+  AppActionReply reply = {0};
   uint64_t now_ms = 0;
+  size_t budget = job_state ? job_state->ready_count : 0u;
+  int ok = 0;
+  int partial = 0;
   int rc = 0;
 
-  while (app.daemon.job.drain(job_state, &job)) {
+  /*
+   * Finished executor tasks hand their job back here so the reply is encoded
+   * with the loop's session and staged on the loop's outbox. Streamed chunks
+   * come through the same queue ahead of their task's final reply.
+   */
+  while (app.daemon.executor.drain(&job, &reply, &ok, &partial)) {
+    (void)ok;
+    if (partial) {
+      (void)app.daemon.payload.complete_chunk(listener, &job, session);
+    } else {
+      app_daemon_note_auth(mux_state, &job);
+      (void)app.daemon.payload.complete(listener, &job, session, &reply);
+    }
+
+    if (job.should_reply || job.response_len > 0u) {
+      rc = app_daemon_stage_or_coalesce(&bundle, mux_state, listener, session, &job);
+      if (rc <= 0) {
+        app.daemon.job.dispose(job_state, &job);
+        return rc < 0 ? rc : -1;
+      }
+    }
+    app.daemon.job.dispose(job_state, &job);
+  }
+
+  /* Streamed actions that exited since the last pass reply the same way. */
+  while (app.daemon.stream.drain(&job, &reply)) {
+    (void)app.daemon.payload.complete(listener, &job, session, &reply);
+
+    if (job.should_reply || job.response_len > 0u) {
+      rc = app_daemon_stage_or_coalesce(&bundle, mux_state, listener, session, &job);
+      if (rc <= 0) {
+        app.daemon.job.dispose(job_state, &job);
+        return rc < 0 ? rc : -1;
+      }
+    }
+    app.daemon.job.dispose(job_state, &job);
+  }
+
+  /*
+   * Deferred jobs go back to the tail, so bound one pass to the
+   * jobs that were queued when it started.
+   */
+  while (budget > 0u && app.daemon.job.drain(job_state, &job)) {
+    budget--;
+
     (void)app.daemon.payload.consume(listener, &job, session);
+
+    app_daemon_note_auth(mux_state, &job);
+
+    if (job.deferred) {
+      if (!app.daemon.job.requeue(job_state, &job)) {
+        LOGW("[daemon.runner] Dropping deferred job; job queue is full\n");
+        app.daemon.job.dispose(job_state, &job);
+      }
+      continue;
+    }
+
     if (job.should_reply || job.response_len > 0u) {
-      rc = app_daemon_stage_outbox_reply(mux_state, listener, &job);
+      rc = app_daemon_stage_or_coalesce(&bundle, mux_state, listener, session, &job);
       if (rc <= 0) {
         app.daemon.job.dispose(job_state, &job);
         return rc < 0 ? rc : -1;
@@ -137,6 +391,11 @@ static int app_daemon_drain_jobs_and_flush(AppRuntimeListenerState *listener,
     app.daemon.job.dispose(job_state, &job);
   }
 
+  rc = app_daemon_bundle_flush(&bundle, mux_state, listener, session);
+  if (rc <= 0) {
+    return rc < 0 ? rc : -1;
+  }
+
   now_ms = lib.time.monotonic_ms();
   if (lib.m7mux.outbox.has_pending(mux_state)) {
     rc = lib.m7mux.outbox.flush(mux_state, listener->sock, now_ms);
@@ -155,6 +414,46 @@ static int app_daemon_init(void) {
 static void app_daemon_shutdown(void) {
 }
 
+/*
+ * Log what the mux's per-source rate limit and overload admission shed since
+ * the last call. Called at most every APP_DAEMON_LIMIT_REPORT_MS, so a flood
+ * costs a line or two per interval rather than one per datagram.
+ */
+static void app_daemon_report_limit(const M7MuxState *mux_state, M7MuxLimitStats *reported) {
+  M7MuxLimitStats stats = {0};
+  uint64_t shed_rate = 0u;
+  uint64_t shed_heavy = 0u;
+  uint64_t shed_failed = 0u;
+  uint64_t shed_sampled = 0u;
+
+  if (!lib.m7mux.inbox.limit_stats(mux_state, &stats)) {
+    return;
+  }
+
+  shed_rate = stats.shed_rate - reported->shed_rate;
+  shed_heavy = stats.shed_heavy - reported->shed_heavy;
+  if (shed_rate > 0u || shed_heavy > 0u) {
+    LOGW("[daemon.runner] Rate limit shed %llu packets over rate and %llu from new heavy hitters (last from %s; %u sources tracked, %llu evictions)\n",
+         (unsigned long long)shed_rate,
+         (unsigned long long)shed_heavy,
+         stats.last_shed_ip[0] ? stats.last_shed_ip : "?",
+         stats.tracked,
+         (unsigned long long)(stats.evictions - reported->evictions));
+  }
+
+  shed_failed = stats.shed_failed - reported->shed_failed;
+  shed_sampled = stats.shed_sampled - reported->shed_sampled;
+  if (shed_failed > 0u || shed_sampled > 0u) {
+    LOGW("[daemon.runner] Overloaded: shed %llu packets from peers that failed auth and %llu unknown by sampling; let %llu through from trusted peers (level %u)\n",
+         (unsigned long long)shed_failed,
+         (unsigned long long)shed_sampled,
+         (unsigned long long)(stats.trusted_admitted - reported->trusted_admitted),
+         stats.overload_level);
+  }
+
+  *reported = stats;
+}
+
 static void app_daemon_run(AppRuntimeListenerState *listener) {
   SiglatchOpenSSLSession session = {0};
   AppWorkspace *workspace = NULL;
@@ -162,8 +461,13 @@ static void app_daemon_run(AppRuntimeListenerState *listener) {
   AppJobState job_state = {0};
   M7MuxRecvPacket normal = {0};
   M7MuxUserRecvData user = {0};
+  M7MuxLimitStats limit_reported = {0};
   uint64_t now_ms = 0;
   uint64_t next_tick_at = 0;
+  uint64_t next_wake_at = 0;
+  uint64_t next_reload_at = 0;
+  uint64_t next_keys_at = 0;
+  uint64_t next_limit_report_at = 0;
   uint64_t timeout_ms = 0;
   int rc = 0;
   int tracked_sock = -1;
@@ -207,6 +511,11 @@ static void app_daemon_run(AppRuntimeListenerState *listener) {
     goto cleanup;
   }
 
+  if (!app.daemon.executor.start()) {
+    goto cleanup;
+  }
+  (void)lib.m7mux.connect.set_wake_fd(mux_state, app.daemon.executor.wake_fd());
+
   (void)user;
 
   while (!app.signal.should_exit(listener->process)) {
@@ -217,16 +526,34 @@ static void app_daemon_run(AppRuntimeListenerState *listener) {
         goto cleanup;
       }
 
+      app_daemon_report_limit(mux_state, &limit_reported);
       lib.m7mux.connect.disconnect(mux_state);
       mux_state = next_mux_state;
+      memset(&limit_reported, 0, sizeof(limit_reported));
       app_daemon_configure_mux_policy(listener, mux_state);
+      (void)lib.m7mux.connect.set_wake_fd(mux_state, app.daemon.executor.wake_fd());
       tracked_sock = listener->sock;
     }
 
     now_ms = lib.time.monotonic_ms();
-    next_tick_at = app.daemon.tick.next_at(NULL, &job_state, now_ms);
-    timeout_ms = app.daemon.helper.time_until_ms(next_tick_at, now_ms);
+    if (next_tick_at == 0u) {
+      next_tick_at = app.daemon.tick.next_at(NULL, &job_state, now_ms);
+    }
+    next_wake_at = app.daemon.stream.next_at(now_ms);
+    next_reload_at = app.runtime.reload_next_at(now_ms);
+    next_keys_at = app.keys.user.next_at(now_ms);
+    if (next_wake_at > next_reload_at) {
+      next_wake_at = next_reload_at;
+    }
+    if (next_wake_at > next_keys_at) {
+      next_wake_at = next_keys_at;
+    }
+    if (next_wake_at > next_tick_at) {
+      next_wake_at = next_tick_at;
+    }
+    timeout_ms = app.daemon.helper.time_until_ms(next_wake_at, now_ms);
 
+    (void)lib.m7mux.inbox.set_backlog(mux_state, job_state.ready_count);
     rc = lib.m7mux.pump(mux_state, timeout_ms);
     if (rc < 0) {
       goto cleanup;
@@ -247,8 +574,17 @@ static void app_daemon_run(AppRuntimeListenerState *listener) {
 
     if (now_ms >= next_tick_at) {
       app.daemon.tick.run(NULL, &job_state, now_ms);
+      next_tick_at = 0u;
     }
 
+    if (now_ms >= next_limit_report_at) {
+      app_daemon_report_limit(mux_state, &limit_reported);
+      next_limit_report_at = now_ms + APP_DAEMON_LIMIT_REPORT_MS;
+    }
+
+    (void)app.daemon.stream.pump(lib.time.monotonic_ms());
+    app.runtime.poll(listener, &session, lib.time.monotonic_ms());
+
     rc = app_daemon_drain_jobs_and_flush(listener, mux_state, &job_state, &session);
     if (rc < 0) {
       goto cleanup;
@@ -264,8 +600,11 @@ cleanup:
   if (session_active) {
     app.runtime.invalidate_config_borrows(listener, &session);
   }
+  app.daemon.executor.stop();
+  app.daemon.stream.reset();
   app.daemon.job.state_reset(&job_state);
   if (mux_state) {
+    app_daemon_report_limit(mux_state, &limit_reported);
     lib.m7mux.connect.disconnect(mux_state);
   }
 }
@@ -0,0 +1,647 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "stream.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../app.h"
+#include "../../lib.h"
+
+static AppStreamSlot g_app_stream_slots[APP_STREAM_SLOT_CAPACITY];
+
+static void app_daemon_stream_clear_slot(AppStreamSlot *slot) {
+  if (!slot) {
+    return;
+  }
+
+  free(slot->backlog);
+  memset(slot, 0, sizeof(*slot));
+  slot->stdin_fd = -1;
+  slot->reap_handle = -1;
+  slot->pid = -1;
+}
+
+static int app_daemon_stream_init(void) {
+  size_t i = 0;
+
+  for (i = 0; i < APP_STREAM_SLOT_CAPACITY; ++i) {
+    app_daemon_stream_clear_slot(&g_app_stream_slots[i]);
+  }
+
+  return 1;
+}
+
+/*
+ * Drop every stream. Only used on shutdown and listener teardown, so waiting
+ * out the killed children here is fine.
+ */
+static void app_daemon_stream_reset(void) {
+  size_t i = 0;
+
+  for (i = 0; i < APP_STREAM_SLOT_CAPACITY; ++i) {
+    AppStreamSlot *slot = &g_app_stream_slots[i];
+    int exit_code = 0;
+
+    if (slot->state == APP_STREAM_SLOT_IDLE) {
+      continue;
+    }
+
+    if (slot->stdin_fd >= 0) {
+      close(slot->stdin_fd);
+    }
+
+    if (slot->state != APP_STREAM_SLOT_DONE && slot->pid > 0) {
+      (void)kill(-slot->pid, SIGKILL);
+      (void)kill(slot->pid, SIGKILL);
+      while (app.payload.try_reap(slot->pid, slot->reap_handle, &exit_code) == 0) {
+        usleep(1000u);
+      }
+    }
+
+    if (slot->has_job) {
+      app.daemon.job.dispose(NULL, &slot->job);
+    }
+    app_daemon_stream_clear_slot(slot);
+  }
+}
+
+static void app_daemon_stream_shutdown(void) {
+  app_daemon_stream_reset();
+}
+
+static void app_daemon_stream_close_stdin(AppStreamSlot *slot) {
+  if (slot->stdin_fd >= 0) {
+    close(slot->stdin_fd);
+    slot->stdin_fd = -1;
+  }
+
+  slot->backlog_off = 0u;
+  slot->backlog_len = 0u;
+  slot->state = APP_STREAM_SLOT_REAPING;
+}
+
+/*
+ * Give up on a stream. The action is killed and reaped from pump() like any
+ * other; if the final fragment is already held, reason becomes its reply.
+ */
+static void app_daemon_stream_abort_slot(AppStreamSlot *slot, const char *reason) {
+  if (!slot || slot->state == APP_STREAM_SLOT_IDLE || slot->state == APP_STREAM_SLOT_DONE) {
+    return;
+  }
+
+  LOGW("[daemon.stream] Aborting stream session=%llu stream=%u message=%llu (%s)\n",
+       (unsigned long long)slot->session_id,
+       (unsigned)slot->stream_id,
+       (unsigned long long)slot->message_id,
+       reason ? reason : "unknown");
+
+  app_daemon_stream_close_stdin(slot);
+  if (slot->pid > 0) {
+    (void)kill(-slot->pid, SIGKILL);
+    (void)kill(slot->pid, SIGKILL);
+  }
+
+  if (slot->has_job) {
+    app.payload.reply.set(&slot->reply, 0, "ERROR %s %s", slot->action_name,
+                          reason ? reason : "stream_failed");
+  }
+}
+
+static int app_daemon_stream_slot_matches(const AppStreamSlot *slot, const AppConnectionJob *job) {
+  if (!slot || !job || slot->state != APP_STREAM_SLOT_FEEDING) {
+    return 0;
+  }
+
+  return slot->session_id == job->session_id &&
+         slot->stream_id == job->stream_id &&
+         slot->message_id == job->message_id;
+}
+
+static AppStreamSlot *app_daemon_stream_find_slot(const AppConnectionJob *job) {
+  size_t i = 0;
+
+  for (i = 0; i < APP_STREAM_SLOT_CAPACITY; ++i) {
+    if (app_daemon_stream_slot_matches(&g_app_stream_slots[i], job)) {
+      return &g_app_stream_slots[i];
+    }
+  }
+
+  return NULL;
+}
+
+static AppStreamSlot *app_daemon_stream_free_slot(void) {
+  size_t i = 0;
+
+  for (i = 0; i < APP_STREAM_SLOT_CAPACITY; ++i) {
+    if (g_app_stream_slots[i].state == APP_STREAM_SLOT_IDLE) {
+      return &g_app_stream_slots[i];
+    }
+  }
+
+  return NULL;
+}
+
+static int app_daemon_stream_slot_blocked(const AppStreamSlot *slot) {
+  return slot && slot->stdin_fd >= 0 && slot->backlog_off < slot->backlog_len;
+}
+
+/*
+ * write(2) to a pipe whose reader is gone raises SIGPIPE. Block it around the
+ * write and consume any instance we caused so a dead action only fails its own
+ * stream instead of taking the daemon down.
+ */
+static ssize_t app_daemon_stream_write_nosigpipe(int fd, const uint8_t *buf, size_t len) {
+  sigset_t block;
+  sigset_t previous;
+  sigset_t pending;
+  struct timespec no_wait = {0, 0};
+  int already_pending = 0;
+  int saved_errno = 0;
+  ssize_t written = -1;
+
+  sigemptyset(&block);
+  sigaddset(&block, SIGPIPE);
+  sigemptyset(&pending);
+
+  if (sigprocmask(SIG_BLOCK, &block, &previous) != 0) {
+    return -1;
+  }
+
+  if (sigpending(&pending) == 0) {
+    already_pending = sigismember(&pending, SIGPIPE);
+  }
+
+  do {
+    written = write(fd, buf, len);
+  } while (written < 0 && errno == EINTR);
+  saved_errno = errno;
+
+  if (written < 0 && saved_errno == EPIPE && !already_pending) {
+    while (sigtimedwait(&block, NULL, &no_wait) < 0 && errno == EINTR) {
+    }
+  }
+
+  (void)sigprocmask(SIG_SETMASK, &previous, NULL);
+  errno = saved_errno;
+  return written;
+}
+
+/*
+ * Push backlogged bytes into the action pipe without blocking.
+ *
+ * Returns 1 when drained, 0 when the pipe is full, and -1 when the action is
+ * gone or the pipe failed.
+ */
+static int app_daemon_stream_flush_slot(AppStreamSlot *slot) {
+  ssize_t written = 0;
+
+  if (!slot || slot->stdin_fd < 0) {
+    return -1;
+  }
+
+  while (slot->backlog_off < slot->backlog_len) {
+    written = app_daemon_stream_write_nosigpipe(slot->stdin_fd,
+                                                slot->backlog + slot->backlog_off,
+                                                slot->backlog_len - slot->backlog_off);
+    if (written < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return 0;
+      }
+
+      LOGPERR("write");
+      return -1;
+    }
+
+    slot->backlog_off += (size_t)written;
+  }
+
+  slot->backlog_off = 0u;
+  slot->backlog_len = 0u;
+  return 1;
+}
+
+/* Bytes parked for the pipes of every stream from ip. */
+static size_t app_daemon_stream_parked_for(const char *ip) {
+  size_t parked = 0;
+  size_t i = 0;
+
+  for (i = 0; i < APP_STREAM_SLOT_CAPACITY; ++i) {
+    const AppStreamSlot *slot = &g_app_stream_slots[i];
+
+    if (slot->state != APP_STREAM_SLOT_IDLE && strcmp(slot->ip, ip) == 0) {
+      parked += slot->backlog_len - slot->backlog_off;
+    }
+  }
+
+  return parked;
+}
+
+/* Queue a fragment behind whatever the pipe has not taken yet. */
+static int app_daemon_stream_backlog_append(AppStreamSlot *slot, const uint8_t *data, size_t len) {
+  uint8_t *grown = NULL;
+  size_t cap = 0;
+
+  if (slot->backlog_off > 0u) {
+    memmove(slot->backlog,
+            slot->backlog + slot->backlog_off,
+            slot->backlog_len - slot->backlog_off);
+    slot->backlog_len -= slot->backlog_off;
+    slot->backlog_off = 0u;
+  }
+
+  if (len > slot->backlog_cap - slot->backlog_len) {
+    cap = slot->backlog_cap ? slot->backlog_cap : 4096u;
+    while (cap - slot->backlog_len < len) {
+      cap *= 2u;
+    }
+
+    grown = (uint8_t *)realloc(slot->backlog, cap);
+    if (!grown) {
+      return 0;
+    }
+    slot->backlog = grown;
+    slot->backlog_cap = cap;
+  }
+
+  if (len > 0u) {
+    memcpy(slot->backlog + slot->backlog_len, data, len);
+  }
+  slot->backlog_len += len;
+  return 1;
+}
+
+static int app_daemon_stream_wants(const AppConnectionJob *job, const siglatch_action *action) {
+  if (!job || !action) {
+    return 0;
+  }
+
+  return action->stream_payload &&
+         action->handler == SL_ACTION_HANDLER_SHELL &&
+         job->fragment_count > 1u;
+}
+
+static int app_daemon_stream_has_pending(void) {
+  size_t i = 0;
+
+  for (i = 0; i < APP_STREAM_SLOT_CAPACITY; ++i) {
+    if (app_daemon_stream_slot_blocked(&g_app_stream_slots[i])) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static AppStreamSlot *app_daemon_stream_open_slot(const AppConnectionJob *job,
+                                                  const siglatch_user *user,
+                                                  const siglatch_action *action,
+                                                  int encrypted) {
+  AppStreamSlot *slot = NULL;
+  char empty_payload[1] = {0};
+  char user_id_str[16];
+  char action_id_str[16];
+  char encrypted_str[8];
+  char *argv[8] = {0};
+  pid_t pid = -1;
+  int reap_handle = -1;
+  int stdin_fd = -1;
+  uint64_t now_ms = 0;
+
+  slot = app_daemon_stream_free_slot();
+  if (!slot) {
+    LOGW("[daemon.stream] No free stream slot for action (%s)\n", action->name);
+    return NULL;
+  }
+
+  snprintf(user_id_str, sizeof(user_id_str), "%u", job->request.user_id);
+  snprintf(action_id_str, sizeof(action_id_str), "%u", job->request.action_id);
+  snprintf(encrypted_str, sizeof(encrypted_str), "%d", encrypted ? 1 : 0);
+
+  /*
+   * Same argv contract as buffered shell actions, except the payload argument
+   * is empty: the raw request bytes arrive on stdin in fragment order.
+   */
+  argv[0] = (char *)job->ip;
+  argv[1] = user_id_str;
+  argv[2] = (char *)user->name;
+  argv[3] = action_id_str;
+  argv[4] = (char *)action->name;
+  argv[5] = encrypted_str;
+  argv[6] = empty_payload;
+  argv[7] = NULL;
+
+  if (!app.payload.spawn_shell_stdin(action->constructor,
+                                     7,
+                                     argv,
+                                     action->exec_split,
+                                     action->run_as[0] ? action->run_as : NULL,
+                                     &pid,
+                                     &reap_handle,
+                                     &stdin_fd)) {
+    return NULL;
+  }
+
+  now_ms = lib.time.monotonic_ms();
+  app_daemon_stream_clear_slot(slot);
+  slot->state = APP_STREAM_SLOT_FEEDING;
+  slot->session_id = job->session_id;
+  slot->stream_id = job->stream_id;
+  slot->message_id = job->message_id;
+  slot->user_id = job->request.user_id;
+  slot->action_id = job->request.action_id;
+  slot->fragment_count = job->fragment_count;
+  lib.str.lcpy(slot->ip, job->ip, sizeof(slot->ip));
+  slot->touched_ms = now_ms;
+  slot->idle_ms = action->stream_idle_ms > 0 ? (uint64_t)action->stream_idle_ms : 0u;
+  slot->timeout_ms = action->timeout_ms;
+  slot->deadline_ms = action->timeout_ms > 0 ? now_ms + (uint64_t)action->timeout_ms : 0u;
+  slot->run_as = action->run_as[0] != '\0';
+  lib.str.lcpy(slot->action_name, action->name, sizeof(slot->action_name));
+  slot->pid = pid;
+  slot->reap_handle = reap_handle;
+  slot->stdin_fd = stdin_fd;
+
+  LOGD("[daemon.stream] Opened stream for action (%s) pid=%d fragments=%u\n",
+       action->name,
+       (int)pid,
+       (unsigned)job->fragment_count);
+  return slot;
+}
+
+/* Describe the action's exit the same way buffered shell actions do. */
+static void app_daemon_stream_set_exit_reply(AppStreamSlot *slot, int reaped, int exit_code) {
+  if (reaped <= 0) {
+    app.payload.reply.set(&slot->reply, 0, "ERROR %s exec_failed", slot->action_name);
+  } else if (exit_code == 0) {
+    app.payload.reply.set(&slot->reply, 1, "OK %s", slot->action_name);
+  } else if (slot->timed_out) {
+    app.payload.reply.set(&slot->reply, 0, "ERROR %s timeout", slot->action_name);
+  } else if (exit_code == 126 && slot->run_as) {
+    app.payload.reply.set(&slot->reply, 0, "ERROR %s run_as_failed", slot->action_name);
+  } else {
+    app.payload.reply.set(&slot->reply, 0, "ERROR %s rc=%d", slot->action_name, exit_code);
+  }
+}
+
+/*
+ * Move a slot along without blocking: feed the pipe, close stdin once the
+ * final fragment is through, and collect the exit status. Returns 1 while
+ * the slot still waits on its pipe or child.
+ */
+static int app_daemon_stream_advance(AppStreamSlot *slot, uint64_t now_ms) {
+  int exit_code = 127;
+  int reaped = 0;
+
+  if (slot->deadline_ms != 0u && now_ms >= slot->deadline_ms && !slot->timed_out &&
+      slot->state != APP_STREAM_SLOT_DONE) {
+    app.payload.kill_child(slot->pid, slot->timeout_ms);
+    slot->timed_out = 1;
+    if (slot->state != APP_STREAM_SLOT_REAPING) {
+      app_daemon_stream_abort_slot(slot, "timeout");
+    }
+  }
+
+  if (slot->state == APP_STREAM_SLOT_FEEDING || slot->state == APP_STREAM_SLOT_CLOSING) {
+    if (app_daemon_stream_slot_blocked(slot) && app_daemon_stream_flush_slot(slot) < 0) {
+      app_daemon_stream_abort_slot(slot, "stream_write_failed");
+    } else if (slot->state == APP_STREAM_SLOT_CLOSING && !app_daemon_stream_slot_blocked(slot)) {
+      app_daemon_stream_close_stdin(slot);
+    }
+  }
+
+  if (slot->state != APP_STREAM_SLOT_REAPING) {
+    return slot->state != APP_STREAM_SLOT_DONE && app_daemon_stream_slot_blocked(slot);
+  }
+
+  reaped = app.payload.try_reap(slot->pid, slot->reap_handle, &exit_code);
+  if (reaped == 0) {
+    return 1;
+  }
+
+  slot->pid = -1;
+  slot->reap_handle = -1;
+  if (!slot->has_job) {
+    app_daemon_stream_clear_slot(slot);
+    return 0;
+  }
+
+  /* An abort already left its reason in the reply. */
+  if (!slot->reply.should_reply) {
+    app_daemon_stream_set_exit_reply(slot, reaped, exit_code);
+  }
+  slot->state = APP_STREAM_SLOT_DONE;
+  return 0;
+}
+
+/*
+ * Feed one delivered fragment into its action.
+ *
+ * Fragment 0 spawns the action and every fragment is written to the action's
+ * stdin, or parked in the slot's backlog while the pipe is full. Past the
+ * peer's parking limit the fragment is deferred instead, and so is every
+ * later fragment until it has gone through. Intermediate fragments do not
+ * produce a reply. The final fragment's job is held by the slot; stdin
+ * closes once the backlog drains and the reply is handed back by drain()
+ * after the action exits, so the loop never waits on the child.
+ */
+static AppStreamFeedResult app_daemon_stream_feed(AppConnectionJob *job,
+                                                  const siglatch_user *user,
+                                                  const siglatch_action *action,
+                                                  int encrypted,
+                                                  AppActionReply *reply) {
+  AppStreamSlot *slot = NULL;
+  int final_fragment = 0;
+
+  if (!job || !user || !action || !reply) {
+    return APP_STREAM_FEED_ERROR;
+  }
+
+  final_fragment = (job->fragment_index + 1u) >= job->fragment_count;
+  slot = app_daemon_stream_find_slot(job);
+
+  if (!slot) {
+    if (job->fragment_index != 0u) {
+      app.payload.reply.set(reply, 0, "ERROR %s stream_out_of_order", action->name);
+      return APP_STREAM_FEED_ERROR;
+    }
+
+    slot = app_daemon_stream_open_slot(job, user, action, encrypted);
+    if (!slot) {
+      app.payload.reply.set(reply, 0, "ERROR %s stream_unavailable", action->name);
+      return APP_STREAM_FEED_ERROR;
+    }
+  }
+
+  if (slot->user_id != job->request.user_id || slot->action_id != job->request.action_id) {
+    app_daemon_stream_abort_slot(slot, "identity_mismatch");
+    app.payload.reply.set(reply, 0, "ERROR %s stream_mismatch", action->name);
+    return APP_STREAM_FEED_ERROR;
+  }
+
+  /* Fragments behind a deferred one wait their turn in the job queue. */
+  if (slot->deferring && job->fragment_index > slot->next_fragment_index &&
+      job->fragment_index < slot->fragment_count) {
+    slot->touched_ms = lib.time.monotonic_ms();
+    return APP_STREAM_FEED_DEFERRED;
+  }
+
+  if (job->fragment_index != slot->next_fragment_index) {
+    app_daemon_stream_abort_slot(slot, "out_of_order");
+    app.payload.reply.set(reply, 0, "ERROR %s stream_out_of_order", action->name);
+    return APP_STREAM_FEED_ERROR;
+  }
+
+  /*
+   * The peer is further ahead of its actions than it may park. A slot with
+   * nothing parked always takes the fragment, so every stream progresses.
+   */
+  if (app_daemon_stream_slot_blocked(slot) &&
+      app_daemon_stream_flush_slot(slot) == 0 &&
+      app_daemon_stream_parked_for(slot->ip) + job->request.payload_len >
+          APP_STREAM_PARK_PER_PEER_BYTES) {
+    slot->deferring = 1;
+    slot->touched_ms = lib.time.monotonic_ms();
+    return APP_STREAM_FEED_DEFERRED;
+  }
+
+  if (!app_daemon_stream_backlog_append(slot,
+                                        job->request.payload_buffer,
+                                        job->request.payload_len)) {
+    LOGE("[daemon.stream] Failed to park %zu bytes for action (%s)\n",
+         job->request.payload_len,
+         action->name);
+    slot->deferring = 1;
+    return APP_STREAM_FEED_DEFERRED;
+  }
+
+  slot->deferring = 0;
+  slot->touched_ms = lib.time.monotonic_ms();
+  slot->next_fragment_index++;
+
+  if (app_daemon_stream_flush_slot(slot) < 0) {
+    app_daemon_stream_abort_slot(slot, "write_failed");
+    app.payload.reply.set(reply, 0, "ERROR %s stream_write_failed", action->name);
+    return APP_STREAM_FEED_ERROR;
+  }
+
+  if (!final_fragment) {
+    return APP_STREAM_FEED_ACCEPTED;
+  }
+
+  memcpy(&slot->job, job, sizeof(slot->job));
+  memset(job, 0, sizeof(*job));
+  slot->has_job = 1;
+  slot->state = APP_STREAM_SLOT_CLOSING;
+  (void)app_daemon_stream_advance(slot, slot->touched_ms);
+  return APP_STREAM_FEED_HELD;
+}
+
+static uint64_t app_daemon_stream_next_at(uint64_t now_ms) {
+  uint64_t next_at = UINT64_MAX;
+  uint64_t expires_at = 0;
+  size_t i = 0;
+
+  for (i = 0; i < APP_STREAM_SLOT_CAPACITY; ++i) {
+    const AppStreamSlot *slot = &g_app_stream_slots[i];
+
+    if (slot->state == APP_STREAM_SLOT_IDLE) {
+      continue;
+    }
+
+    if (slot->state == APP_STREAM_SLOT_DONE) {
+      return now_ms;
+    }
+
+    /* Full pipes and exiting children are checked on a short cadence. */
+    if (slot->state != APP_STREAM_SLOT_FEEDING || app_daemon_stream_slot_blocked(slot)) {
+      return now_ms + APP_STREAM_RETRY_MS;
+    }
+
+    expires_at = slot->idle_ms != 0u ? slot->touched_ms + slot->idle_ms : UINT64_MAX;
+    if (slot->deadline_ms != 0u && slot->deadline_ms < expires_at) {
+      expires_at = slot->deadline_ms;
+    }
+    if (expires_at < next_at) {
+      next_at = expires_at;
+    }
+  }
+
+  return next_at;
+}
+
+/*
+ * Retry blocked pipes, reap finished actions, enforce timeouts and drop
+ * streams whose peer went quiet. Returns the number of streams still waiting
+ * on a pipe or child.
+ */
+static int app_daemon_stream_pump(uint64_t now_ms) {
+  size_t i = 0;
+  int waiting = 0;
+
+  for (i = 0; i < APP_STREAM_SLOT_CAPACITY; ++i) {
+    AppStreamSlot *slot = &g_app_stream_slots[i];
+
+    if (slot->state == APP_STREAM_SLOT_IDLE) {
+      continue;
+    }
+
+    if (slot->state == APP_STREAM_SLOT_FEEDING &&
+        slot->idle_ms != 0u &&
+        now_ms >= slot->touched_ms &&
+        now_ms - slot->touched_ms >= slot->idle_ms) {
+      app_daemon_stream_abort_slot(slot, "expired");
+    }
+
+    waiting += app_daemon_stream_advance(slot, now_ms);
+  }
+
+  return waiting;
+}
+
+static int app_daemon_stream_drain(AppConnectionJob *out_job, AppActionReply *out_reply) {
+  size_t i = 0;
+
+  if (!out_job || !out_reply) {
+    return 0;
+  }
+
+  for (i = 0; i < APP_STREAM_SLOT_CAPACITY; ++i) {
+    AppStreamSlot *slot = &g_app_stream_slots[i];
+
+    if (slot->state != APP_STREAM_SLOT_DONE) {
+      continue;
+    }
+
+    memcpy(out_job, &slot->job, sizeof(*out_job));
+    *out_reply = slot->reply;
+    app_daemon_stream_clear_slot(slot);
+    return 1;
+  }
+
+  return 0;
+}
+
+static const AppDaemonStreamLib app_daemon_stream_instance = {
+  .init = app_daemon_stream_init,
+  .shutdown = app_daemon_stream_shutdown,
+  .wants = app_daemon_stream_wants,
+  .has_pending = app_daemon_stream_has_pending,
+  .feed = app_daemon_stream_feed,
+  .next_at = app_daemon_stream_next_at,
+  .pump = app_daemon_stream_pump,
+  .drain = app_daemon_stream_drain,
+  .reset = app_daemon_stream_reset
+};
+
+const AppDaemonStreamLib *get_app_daemon_stream_lib(void) {
+  return &app_daemon_stream_instance;
+}
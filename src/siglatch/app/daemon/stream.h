@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef SIGLATCH_SERVER_APP_DAEMON_STREAM_H
+#define SIGLATCH_SERVER_APP_DAEMON_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "job.h"
+#include "../config/config.h"
+#include "../payload/reply.h"
+
+#define APP_STREAM_SLOT_CAPACITY 16u
+/* Fragment bytes one peer address may have parked across its streams. */
+#define APP_STREAM_PARK_PER_PEER_BYTES (256u * 1024u)
+#define APP_STREAM_RETRY_MS 10u
+
+typedef enum {
+  APP_STREAM_FEED_ERROR = 0,
+  APP_STREAM_FEED_ACCEPTED = 1,
+  APP_STREAM_FEED_HELD = 2,
+  APP_STREAM_FEED_DEFERRED = 3
+} AppStreamFeedResult;
+
+typedef enum {
+  APP_STREAM_SLOT_IDLE = 0,
+  APP_STREAM_SLOT_FEEDING,        /* Taking fragments */
+  APP_STREAM_SLOT_CLOSING,        /* Final fragment in; stdin closes once the backlog drains */
+  APP_STREAM_SLOT_REAPING,        /* stdin closed; waiting for the action to exit */
+  APP_STREAM_SLOT_DONE            /* Reply ready for drain() */
+} AppStreamSlotState;
+
+/*
+ * One in-flight streamed request.
+ *
+ * A slot owns the action child and the write end of its stdin pipe. Fragments
+ * that arrive while the pipe is full are parked in the slot's backlog. Once a
+ * peer address has APP_STREAM_PARK_PER_PEER_BYTES parked, its next fragments
+ * are deferred back to the job queue in order and retried after the pipe
+ * drains. They then count against the mux's backlog admission like any other
+ * queued work, and the stream itself is never failed for running ahead. The
+ * final fragment's job moves into the slot and its reply comes back through
+ * drain() once the action has been reaped.
+ */
+typedef struct {
+  AppStreamSlotState state;
+  int timed_out;
+  uint64_t session_id;
+  uint64_t message_id;
+  uint32_t stream_id;
+  uint16_t user_id;
+  uint8_t action_id;
+  uint32_t next_fragment_index;
+  uint32_t fragment_count;
+  int deferring;                  /* A fragment went back to the job queue */
+  char ip[64];
+  uint64_t touched_ms;
+  uint64_t idle_ms;               /* Action's stream_idle_ms; 0 = never expire */
+  uint64_t deadline_ms;           /* 0 = no timeout */
+  int timeout_ms;
+  int run_as;
+  char action_name[MAX_ACTION_NAME];
+  pid_t pid;
+  int reap_handle;                /* Zygote handle, or -1 for a direct child */
+  int stdin_fd;
+  int has_job;
+  AppConnectionJob job;
+  AppActionReply reply;
+  uint8_t *backlog;
+  size_t backlog_cap;
+  size_t backlog_len;
+  size_t backlog_off;
+} AppStreamSlot;
+
+typedef struct {
+  int (*init)(void);
+  void (*shutdown)(void);
+  int (*wants)(const AppConnectionJob *job, const siglatch_action *action);
+  int (*has_pending)(void);
+  /*
+   * HELD means job was the final fragment and now belongs to the stream; the
+   * caller's copy is cleared. DEFERRED means the peer has too much parked and
+   * job must be requeued untouched. ERROR leaves a reply to send for job.
+   */
+  AppStreamFeedResult (*feed)(AppConnectionJob *job,
+                              const siglatch_user *user,
+                              const siglatch_action *action,
+                              int encrypted,
+                              AppActionReply *reply);
+  uint64_t (*next_at)(uint64_t now_ms);
+  int (*pump)(uint64_t now_ms);
+  /* Hand back one finished stream's final job and reply, like executor drain. */
+  int (*drain)(AppConnectionJob *out_job, AppActionReply *out_reply);
+  void (*reset)(void);
+} AppDaemonStreamLib;
+
+const AppDaemonStreamLib *get_app_daemon_stream_lib(void);
+
+#endif
@@ -5,6 +5,8 @@
 
 #include "tick.h"
 
+#include "../app.h"
+
 #define APP_TICK_DEFAULT_MS 6000u
 
 static int app_tick_init(void) {
@@ -43,24 +45,24 @@ static uint64_t app_tick_next_at(const AppConnectionState *connection_state,
 }
 
 /*
- * Placeholder only.
- *
  * Tick coordination is intentionally app-level rather than connection-specific.
- * Real work will land here later, for example:
+ * Currently this recycles idle persistent object workers and reaps detached
+ * action children so they do not linger as zombies. Further work
+ * will land here later, for example:
  *
  * - session expiry / stale cleanup
- * - heartbeat / keepalive scheduling
+ * - heartbeat scheduling
  * - background promotion or maintenance across connection/job state
  * - proactive outbound scheduling
- *
- * For now it is intentionally a no-op.
  */
 static void app_tick_run(AppConnectionState *connection_state,
                          AppJobState *job_state,
                          uint64_t now_ms) {
   (void)connection_state;
   (void)job_state;
-  (void)now_ms;
+
+  app.object.sweep(now_ms);
+  (void)app.payload.reap_detached();
 }
 
 static const AppTickLib app_tick_instance = {
@@ -25,7 +25,7 @@ static void app_help_show(int argc, char *argv[]) {
   const char *progname = (argc > 0 && argv[0]) ? argv[0] : "siglatchd";
 
   app_help_show_version();
-  lib.log.console("Usage: %s [--config <path>] [--dump-config] [--help] [--output-mode unicode|ascii] [--server <name>]\n",
+  lib.log.console("Usage: %s [--config <path>] [--dump-config] [--help] [--output-mode unicode|ascii] [--server <name>] [--write-keyring <path>]\n",
                   progname);
   lib.log.console("Options:\n");
   lib.log.console("  --config          Override config file path\n");
@@ -34,6 +34,7 @@ static void app_help_show(int argc, char *argv[]) {
   lib.log.console("  --output-mode     Override output mode at runtime\n");
   lib.log.console("  --server          Select server block by name\n");
   lib.log.console("  --version         Print server version and exit\n");
+  lib.log.console("  --write-keyring   Write the config's user keys to a keyring file and exit\n");
 }
 
 static const AppHelpLib app_help_instance = {
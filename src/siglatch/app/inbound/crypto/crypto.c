@@ -69,7 +69,7 @@ int app_inbound_crypto_assign_session_to_user(
 
   memcpy(session->hmac_key, user->hmac_key, sizeof(session->hmac_key));
   session->hmac_key_len = 32;
-  session->public_key = user->pubkey;
+  session->public_key = app.keys.user.pubkey(user);
 
   LOGT("Session now attached to user: %s\n", user->name);
   return 1;
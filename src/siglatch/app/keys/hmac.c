@@ -4,8 +4,12 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "hmac.h"
+#include "pool.h"
+#include "stamp.h"
+#include "user.h"
 #include "../../lib.h"
 
 int app_keys_hmac_init(void) {
@@ -15,46 +19,82 @@ int app_keys_hmac_init(void) {
 void app_keys_hmac_shutdown(void) {
 }
 
-int app_keys_hmac_load_all(siglatch_config *cfg) {
-  int i = 0;
+typedef struct {
+  siglatch_config *cfg;
+  const siglatch_config *previous;
+  int loaded;
+  int reused;
+} AppKeysHmacLoad;
 
-  if (!cfg) {
+static int app_keys_hmac_load_one(int index, void *arg) {
+  AppKeysHmacLoad *load = arg;
+  FILE *fp = NULL;
+  uint8_t file_buf[128] = {0};
+  size_t bytes_read = 0;
+  siglatch_user *u = &load->cfg->users[index];
+  const siglatch_user *old = NULL;
+
+  if (!u->enabled || u->keyring_der) {
+    return 1;
+  }
+
+  if (!u->hmac_file) {
+    LOGE("No hmac_file set for user '%s'\n", u->name);
+    return 0;
+  }
+
+  old = app_keys_user_previous(load->previous, u);
+  if (old && app_keys_stamp_unchanged(u->hmac_file, old->hmac_file, &old->hmac_stamp)) {
+    memcpy(u->hmac_key, old->hmac_key, sizeof(u->hmac_key));
+    u->hmac_stamp = old->hmac_stamp;
+    __atomic_fetch_add(&load->reused, 1, __ATOMIC_RELAXED);
+    return 1;
+  }
+
+  fp = fopen(u->hmac_file, "rb");
+  if (!fp) {
+    LOGE("Failed to open HMAC key file for user '%s': %s\n", u->name, u->hmac_file);
+    return 0;
+  }
+
+  (void)app_keys_stamp_file(fp, &u->hmac_stamp);
+  bytes_read = fread(file_buf, 1, sizeof(file_buf), fp);
+  fclose(fp);
+
+  if (bytes_read != 32 && bytes_read == sizeof(file_buf)) {
+    LOGE("Invalid HMAC key file size for user '%s' (%s): read %zu bytes\n",
+         u->name,
+         u->hmac_file,
+         bytes_read);
     return 0;
   }
 
-  for (i = 0; i < cfg->user_count; ++i) {
-    FILE *fp = NULL;
-    uint8_t file_buf[128] = {0};
-    size_t bytes_read = 0;
-    siglatch_user *u = &cfg->users[i];
+  if (!lib.hmac.normalize(file_buf, bytes_read, u->hmac_key)) {
+    LOGE("Failed to normalize HMAC key for user '%s'\n", u->name);
+    return 0;
+  }
 
-    if (!u->enabled) {
-      continue;
-    }
+  __atomic_fetch_add(&load->loaded, 1, __ATOMIC_RELAXED);
+  LOGD("Loaded and normalized HMAC key for user '%s'\n", u->name);
+  return 1;
+}
 
-    fp = fopen(u->hmac_file, "rb");
-    if (!fp) {
-      LOGE("Failed to open HMAC key file for user '%s': %s\n", u->name, u->hmac_file);
-      return 0;
-    }
+int app_keys_hmac_load_all(siglatch_config *cfg, const siglatch_config *previous) {
+  AppKeysHmacLoad load = {0};
 
-    bytes_read = fread(file_buf, 1, sizeof(file_buf), fp);
-    fclose(fp);
+  if (!cfg) {
+    return 0;
+  }
 
-    if (bytes_read != 32 && bytes_read == sizeof(file_buf)) {
-      LOGE("Invalid HMAC key file size for user '%s' (%s): read %zu bytes\n",
-           u->name,
-           u->hmac_file,
-           bytes_read);
-      return 0;
-    }
+  load.cfg = cfg;
+  load.previous = previous;
 
-    if (!lib.hmac.normalize(file_buf, bytes_read, u->hmac_key)) {
-      LOGE("Failed to normalize HMAC key for user '%s'\n", u->name);
-      return 0;
-    }
+  if (!app_keys_pool_run(cfg->user_count, app_keys_hmac_load_one, &load)) {
+    return 0;
+  }
 
-    LOGD("Loaded and normalized HMAC key for user '%s'\n", u->name);
+  if (previous) {
+    LOGD("User HMAC keys: %d loaded, %d unchanged and reused\n", load.loaded, load.reused);
   }
 
   return 1;
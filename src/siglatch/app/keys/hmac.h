@@ -11,11 +11,11 @@
 typedef struct {
   int (*init)(void);
   void (*shutdown)(void);
-  int (*load_all)(siglatch_config *cfg);
+  int (*load_all)(siglatch_config *cfg, const siglatch_config *previous);
 } AppKeysHmacLib;
 
 int app_keys_hmac_init(void);
 void app_keys_hmac_shutdown(void);
-int app_keys_hmac_load_all(siglatch_config *cfg);
+int app_keys_hmac_load_all(siglatch_config *cfg, const siglatch_config *previous);
 
 #endif
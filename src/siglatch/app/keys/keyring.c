@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "keyring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <openssl/x509.h>
+
+#include "user.h"
+#include "../../lib.h"
+
+typedef struct {
+  const siglatch_user *user;
+  int position;
+  unsigned char *der;
+  int der_len;
+} AppKeysKeyringRecord;
+
+int app_keys_keyring_init(void) {
+  return 1;
+}
+
+void app_keys_keyring_shutdown(void) {
+}
+
+static uint32_t app_keys_keyring_get_u32(const uint8_t *p) {
+  return (uint32_t)p[0] |
+         ((uint32_t)p[1] << 8) |
+         ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+static void app_keys_keyring_put_u32(uint8_t *p, uint32_t value) {
+  p[0] = (uint8_t)(value & 0xFFu);
+  p[1] = (uint8_t)((value >> 8) & 0xFFu);
+  p[2] = (uint8_t)((value >> 16) & 0xFFu);
+  p[3] = (uint8_t)((value >> 24) & 0xFFu);
+}
+
+static int app_keys_keyring_check_header(const uint8_t *map, size_t len, uint32_t *out_count) {
+  uint32_t count = 0;
+
+  if (len < APP_KEYS_KEYRING_HEADER_SIZE ||
+      memcmp(map, APP_KEYS_KEYRING_MAGIC, 8) != 0) {
+    LOGE("Keyring is not a siglatch keyring\n");
+    return 0;
+  }
+
+  if (app_keys_keyring_get_u32(map + 8) != APP_KEYS_KEYRING_VERSION ||
+      app_keys_keyring_get_u32(map + 16) != APP_KEYS_KEYRING_ENTRY_SIZE) {
+    LOGE("Keyring version %u is not supported\n", app_keys_keyring_get_u32(map + 8));
+    return 0;
+  }
+
+  count = app_keys_keyring_get_u32(map + 12);
+  if ((uint64_t)count * APP_KEYS_KEYRING_ENTRY_SIZE > len - APP_KEYS_KEYRING_HEADER_SIZE) {
+    LOGE("Keyring index is truncated (%u entries)\n", count);
+    return 0;
+  }
+
+  *out_count = count;
+  return 1;
+}
+
+/* Entries are sorted by user id, so this is a binary search over the map. */
+static const uint8_t *app_keys_keyring_find(const uint8_t *map, uint32_t count, uint32_t user_id) {
+  const uint8_t *entries = map + APP_KEYS_KEYRING_HEADER_SIZE;
+  uint32_t lo = 0;
+  uint32_t hi = count;
+
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2u;
+    const uint8_t *entry = entries + (size_t)mid * APP_KEYS_KEYRING_ENTRY_SIZE;
+    uint32_t id = app_keys_keyring_get_u32(entry);
+
+    if (id == user_id) {
+      return entry;
+    }
+    if (id < user_id) {
+      lo = mid + 1u;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * Bind enabled users found in the keyring to their entries. HMAC keys are
+ * copied out now; public keys stay DER in the map until the user first
+ * authenticates (see app_keys_user_pubkey). Users the keyring does not hold
+ * keep loading from key_file and hmac_file.
+ */
+static int app_keys_keyring_bind(siglatch_config *cfg, uint32_t count) {
+  const uint8_t *map = cfg->keyring_map;
+  int bound = 0;
+  int i = 0;
+
+  for (i = 0; i < cfg->user_count; ++i) {
+    siglatch_user *u = &cfg->users[i];
+    const uint8_t *entry = NULL;
+    uint32_t der_offset = 0;
+    uint32_t der_len = 0;
+    const char *name = NULL;
+
+    if (!u->enabled) {
+      continue;
+    }
+
+    entry = app_keys_keyring_find(map, count, u->id);
+    if (!entry) {
+      continue;
+    }
+
+    name = (const char *)(entry + 48);
+    if (strnlen(name, APP_KEYS_KEYRING_NAME_LEN) >= APP_KEYS_KEYRING_NAME_LEN ||
+        strcmp(name, u->name) != 0) {
+      LOGW("Keyring entry for user id %u does not belong to '%s'; using key files\n",
+           u->id, u->name);
+      continue;
+    }
+
+    der_offset = app_keys_keyring_get_u32(entry + 4);
+    der_len = app_keys_keyring_get_u32(entry + 8);
+    if (der_len == 0u || der_offset > cfg->keyring_map_len ||
+        der_len > cfg->keyring_map_len - der_offset) {
+      LOGE("Keyring entry for user '%s' points outside the file\n", u->name);
+      return 0;
+    }
+
+    u->keyring_der = map + der_offset;
+    u->keyring_der_len = der_len;
+    memcpy(u->hmac_key, entry + 16, sizeof(u->hmac_key));
+    bound++;
+  }
+
+  LOGD("Keyring %s: %u entries, %d users bound\n", cfg->keyring_path, count, bound);
+  return 1;
+}
+
+int app_keys_keyring_open(siglatch_config *cfg, const siglatch_config *previous) {
+  struct stat st;
+  void *map = MAP_FAILED;
+  uint32_t count = 0;
+  int fd = -1;
+
+  (void)previous;
+
+  if (!cfg) {
+    return 0;
+  }
+
+  if (cfg->keyring_path[0] == '\0') {
+    return 1;
+  }
+
+  fd = open(cfg->keyring_path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    LOGE("Failed to open keyring %s: %s\n", cfg->keyring_path, strerror(errno));
+    return 0;
+  }
+
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    LOGE("Keyring %s is empty or unreadable\n", cfg->keyring_path);
+    close(fd);
+    return 0;
+  }
+
+  map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    LOGE("Failed to map keyring %s: %s\n", cfg->keyring_path, strerror(errno));
+    return 0;
+  }
+
+  cfg->keyring_map = map;
+  cfg->keyring_map_len = (size_t)st.st_size;
+
+  if (!app_keys_keyring_check_header(cfg->keyring_map, cfg->keyring_map_len, &count)) {
+    LOGE("Rejecting keyring %s\n", cfg->keyring_path);
+    app_keys_keyring_close(cfg);
+    return 0;
+  }
+
+  if (!app_keys_keyring_bind(cfg, count)) {
+    app_keys_keyring_close(cfg);
+    return 0;
+  }
+
+  return 1;
+}
+
+/* Users still pointing into the map are unbound first; their keys go with it. */
+void app_keys_keyring_close(siglatch_config *cfg) {
+  int i = 0;
+
+  if (!cfg || !cfg->keyring_map) {
+    return;
+  }
+
+  for (i = 0; i < cfg->user_count; ++i) {
+    cfg->users[i].keyring_der = NULL;
+    cfg->users[i].keyring_der_len = 0;
+  }
+
+  munmap((void *)cfg->keyring_map, cfg->keyring_map_len);
+  cfg->keyring_map = NULL;
+  cfg->keyring_map_len = 0;
+}
+
+/* By id, then by table position so the first of a duplicated id wins. */
+static int app_keys_keyring_compare(const void *a, const void *b) {
+  const AppKeysKeyringRecord *left = a;
+  const AppKeysKeyringRecord *right = b;
+
+  if (left->user->id != right->user->id) {
+    return left->user->id < right->user->id ? -1 : 1;
+  }
+
+  return left->position - right->position;
+}
+
+static void app_keys_keyring_free_records(AppKeysKeyringRecord *records, int count) {
+  int i = 0;
+
+  for (i = 0; i < count; ++i) {
+    OPENSSL_free(records[i].der);
+  }
+  free(records);
+}
+
+static int app_keys_keyring_write_file(FILE *fp,
+                                       const AppKeysKeyringRecord *records,
+                                       int count) {
+  uint8_t header[APP_KEYS_KEYRING_HEADER_SIZE] = {0};
+  uint32_t offset = APP_KEYS_KEYRING_HEADER_SIZE + (uint32_t)count * APP_KEYS_KEYRING_ENTRY_SIZE;
+  int i = 0;
+
+  memcpy(header, APP_KEYS_KEYRING_MAGIC, 8);
+  app_keys_keyring_put_u32(header + 8, APP_KEYS_KEYRING_VERSION);
+  app_keys_keyring_put_u32(header + 12, (uint32_t)count);
+  app_keys_keyring_put_u32(header + 16, APP_KEYS_KEYRING_ENTRY_SIZE);
+  if (fwrite(header, 1, sizeof(header), fp) != sizeof(header)) {
+    return 0;
+  }
+
+  for (i = 0; i < count; ++i) {
+    uint8_t entry[APP_KEYS_KEYRING_ENTRY_SIZE] = {0};
+
+    app_keys_keyring_put_u32(entry, records[i].user->id);
+    app_keys_keyring_put_u32(entry + 4, offset);
+    app_keys_keyring_put_u32(entry + 8, (uint32_t)records[i].der_len);
+    memcpy(entry + 16, records[i].user->hmac_key, sizeof(records[i].user->hmac_key));
+    lib.str.lcpy((char *)(entry + 48), records[i].user->name, APP_KEYS_KEYRING_NAME_LEN);
+    if (fwrite(entry, 1, sizeof(entry), fp) != sizeof(entry)) {
+      return 0;
+    }
+    offset += (uint32_t)records[i].der_len;
+  }
+
+  for (i = 0; i < count; ++i) {
+    if (fwrite(records[i].der, 1, (size_t)records[i].der_len, fp) != (size_t)records[i].der_len) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+/*
+ * Write every enabled user's keys, as cfg loaded them, to a keyring at path.
+ * The file is written beside path and renamed into place, so a daemon
+ * watching or reloading never maps a half-written keyring.
+ */
+int app_keys_keyring_write(const siglatch_config *cfg, const char *path) {
+  AppKeysKeyringRecord *records = NULL;
+  char tmp_path[PATH_MAX];
+  FILE *fp = NULL;
+  int count = 0;
+  int kept = 0;
+  int fd = -1;
+  int ok = 0;
+  int i = 0;
+
+  if (!cfg || !path || path[0] == '\0') {
+    return 0;
+  }
+
+  if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+    LOGE("Keyring path is too long: %s\n", path);
+    return 0;
+  }
+
+  records = calloc(cfg->user_count > 0 ? (size_t)cfg->user_count : 1u, sizeof(*records));
+  if (!records) {
+    LOGE("Out of memory building keyring\n");
+    return 0;
+  }
+
+  for (i = 0; i < cfg->user_count; ++i) {
+    const siglatch_user *u = &cfg->users[i];
+    EVP_PKEY *pkey = NULL;
+    AppKeysKeyringRecord *record = &records[count];
+
+    if (!u->enabled) {
+      continue;
+    }
+
+    pkey = app_keys_user_pubkey(u);
+    if (!pkey) {
+      LOGE("User '%s' has no public key to write to the keyring\n", u->name);
+      app_keys_keyring_free_records(records, count);
+      return 0;
+    }
+
+    record->user = u;
+    record->position = i;
+    record->der_len = i2d_PUBKEY(pkey, &record->der);
+    if (record->der_len <= 0 || !record->der) {
+      LOGE("Failed to encode public key for user '%s'\n", u->name);
+      app_keys_keyring_free_records(records, count);
+      return 0;
+    }
+    count++;
+  }
+
+  qsort(records, (size_t)count, sizeof(*records), app_keys_keyring_compare);
+  for (i = 0; i < count; ++i) {
+    if (kept > 0 && records[kept - 1].user->id == records[i].user->id) {
+      LOGW("Duplicate user id %u: keeping '%s', skipping '%s'\n",
+           records[i].user->id, records[kept - 1].user->name, records[i].user->name);
+      OPENSSL_free(records[i].der);
+      continue;
+    }
+    records[kept++] = records[i];
+  }
+
+  fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  fp = fd >= 0 ? fdopen(fd, "wb") : NULL;
+  if (!fp) {
+    LOGE("Failed to create %s: %s\n", tmp_path, strerror(errno));
+    if (fd >= 0) {
+      close(fd);
+    }
+    app_keys_keyring_free_records(records, kept);
+    return 0;
+  }
+
+  ok = app_keys_keyring_write_file(fp, records, kept);
+  if (fflush(fp) != 0 || fsync(fileno(fp)) != 0) {
+    ok = 0;
+  }
+  if (fclose(fp) != 0) {
+    ok = 0;
+  }
+
+  if (ok && rename(tmp_path, path) != 0) {
+    LOGE("Failed to move keyring into place at %s: %s\n", path, strerror(errno));
+    ok = 0;
+  }
+
+  if (!ok) {
+    LOGE("Failed to write keyring %s\n", path);
+    unlink(tmp_path);
+  } else {
+    lib.log.console("Wrote keyring %s with %d users\n", path, kept);
+  }
+
+  app_keys_keyring_free_records(records, kept);
+  return ok;
+}
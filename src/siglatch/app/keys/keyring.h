@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef SIGLATCH_SERVER_APP_KEYS_KEYRING_H
+#define SIGLATCH_SERVER_APP_KEYS_KEYRING_H
+
+#include "../config/config.h"
+
+/*
+ * Keyring file layout, all integers little-endian:
+ *
+ *   header   magic "SLKEYRNG", u32 version, u32 entry count, u32 entry size,
+ *            12 reserved bytes
+ *   entries  sorted by user id: u32 user id, u32 DER offset, u32 DER length,
+ *            u32 reserved, 32-byte HMAC key, NUL-padded 64-byte user name
+ *   blobs    DER SubjectPublicKeyInfo for each entry, at its offset
+ */
+#define APP_KEYS_KEYRING_MAGIC "SLKEYRNG"
+#define APP_KEYS_KEYRING_VERSION 1u
+#define APP_KEYS_KEYRING_HEADER_SIZE 32u
+#define APP_KEYS_KEYRING_ENTRY_SIZE 112u
+#define APP_KEYS_KEYRING_NAME_LEN 64u
+
+typedef struct {
+  int (*init)(void);
+  void (*shutdown)(void);
+  int (*open)(siglatch_config *cfg, const siglatch_config *previous);
+  void (*close)(siglatch_config *cfg);
+  int (*write)(const siglatch_config *cfg, const char *path);
+} AppKeysKeyringLib;
+
+int app_keys_keyring_init(void);
+void app_keys_keyring_shutdown(void);
+int app_keys_keyring_open(siglatch_config *cfg, const siglatch_config *previous);
+void app_keys_keyring_close(siglatch_config *cfg);
+int app_keys_keyring_write(const siglatch_config *cfg, const char *path);
+
+#endif
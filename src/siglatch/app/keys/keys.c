@@ -13,6 +13,7 @@ static int keys_init(void) {
   int user_initialized = 0;
   int server_initialized = 0;
   int hmac_initialized = 0;
+  int keyring_initialized = 0;
 
   if (!app_keys_master_init()) {
     fprintf(stderr, "Failed to initialize app.keys.master\n");
@@ -38,9 +39,18 @@ static int keys_init(void) {
   }
   hmac_initialized = 1;
 
+  if (!app_keys_keyring_init()) {
+    fprintf(stderr, "Failed to initialize app.keys.keyring\n");
+    goto fail;
+  }
+  keyring_initialized = 1;
+
   return 1;
 
 fail:
+  if (keyring_initialized) {
+    app_keys_keyring_shutdown();
+  }
   if (hmac_initialized) {
     app_keys_hmac_shutdown();
   }
@@ -57,32 +67,47 @@ fail:
 }
 
 static void keys_shutdown(void) {
+  app_keys_keyring_shutdown();
   app_keys_hmac_shutdown();
   app_keys_server_shutdown();
   app_keys_user_shutdown();
   app_keys_master_shutdown();
 }
 
-static int keys_load(siglatch_config *cfg) {
+/*
+ * Load every key cfg names. With previous set, keys whose file path and
+ * stamp are unchanged are shared from it instead of being read and parsed
+ * again, so a reload costs what changed rather than what exists. With
+ * lazy_users set, user public keys are left for app_keys_user_warm().
+ */
+static int keys_load_with(siglatch_config *cfg, const siglatch_config *previous, int lazy_users) {
+  int users_ok = 0;
+
   if (!cfg) {
     return 0;
   }
 
-  if (!app_keys_master_load(cfg)) {
+  if (!app_keys_master_load(cfg, previous)) {
     return 0;
   }
 
-  if (!app_keys_user_load_all(cfg)) {
+  if (!app_keys_keyring_open(cfg, previous)) {
+    LOGE("Failed to open keyring\n");
+    return 0;
+  }
+
+  users_ok = lazy_users ? app_keys_user_load_lazy(cfg) : app_keys_user_load_all(cfg, previous);
+  if (!users_ok) {
     LOGE("Failed to load user keys\n");
     return 0;
   }
 
-  if (!app_keys_server_load_all(cfg)) {
+  if (!app_keys_server_load_all(cfg, previous)) {
     LOGE("Failed to load server keys\n");
     return 0;
   }
 
-  if (!app_keys_hmac_load_all(cfg)) {
+  if (!app_keys_hmac_load_all(cfg, previous)) {
     LOGE("Failed to load user HMAC keys\n");
     return 0;
   }
@@ -90,10 +115,23 @@ static int keys_load(siglatch_config *cfg) {
   return 1;
 }
 
+static int keys_reload(siglatch_config *cfg, const siglatch_config *previous) {
+  return keys_load_with(cfg, previous, 0);
+}
+
+/*
+ * Startup load. Reloads always parse every changed key up front so a bad key
+ * rejects the new config; only the first load may defer user public keys.
+ */
+static int keys_load(siglatch_config *cfg) {
+  return keys_load_with(cfg, NULL, cfg ? cfg->lazy_user_keys : 0);
+}
+
 static const AppKeysLib keys_instance = {
   .init = keys_init,
   .shutdown = keys_shutdown,
   .load = keys_load,
+  .reload = keys_reload,
   .master = {
     .init = app_keys_master_init,
     .shutdown = app_keys_master_shutdown,
@@ -103,6 +141,10 @@ static const AppKeysLib keys_instance = {
     .init = app_keys_user_init,
     .shutdown = app_keys_user_shutdown,
     .load_all = app_keys_user_load_all,
+    .pubkey = app_keys_user_pubkey,
+    .resolve = app_keys_user_resolve,
+    .warm = app_keys_user_warm,
+    .next_at = app_keys_user_next_at,
   },
   .server = {
     .init = app_keys_server_init,
@@ -114,6 +156,13 @@ static const AppKeysLib keys_instance = {
     .shutdown = app_keys_hmac_shutdown,
     .load_all = app_keys_hmac_load_all,
   },
+  .keyring = {
+    .init = app_keys_keyring_init,
+    .shutdown = app_keys_keyring_shutdown,
+    .open = app_keys_keyring_open,
+    .close = app_keys_keyring_close,
+    .write = app_keys_keyring_write,
+  },
 };
 
 const AppKeysLib *get_app_keys_lib(void) {
@@ -10,15 +10,18 @@
 #include "user.h"
 #include "server.h"
 #include "hmac.h"
+#include "keyring.h"
 
 typedef struct {
   int (*init)(void);
   void (*shutdown)(void);
   int (*load)(siglatch_config *cfg);
+  int (*reload)(siglatch_config *cfg, const siglatch_config *previous);
   AppKeysMasterLib master;
   AppKeysUserLib user;
   AppKeysServerLib server;
   AppKeysHmacLib hmac;
+  AppKeysKeyringLib keyring;
 } AppKeysLib;
 
 const AppKeysLib *get_app_keys_lib(void);
@@ -7,6 +7,7 @@
 #include <openssl/pem.h>
 
 #include "master.h"
+#include "stamp.h"
 #include "../../lib.h"
 
 int app_keys_master_init(void) {
@@ -16,7 +17,7 @@ int app_keys_master_init(void) {
 void app_keys_master_shutdown(void) {
 }
 
-int app_keys_master_load(siglatch_config *cfg) {
+int app_keys_master_load(siglatch_config *cfg, const siglatch_config *previous) {
   FILE *fp = NULL;
 
   if (!cfg) {
@@ -28,12 +29,24 @@ int app_keys_master_load(siglatch_config *cfg) {
     return 1;
   }
 
+  if (previous && previous->master_privkey &&
+      app_keys_stamp_unchanged(cfg->priv_key_path,
+                               previous->priv_key_path,
+                               &previous->master_key_stamp) &&
+      EVP_PKEY_up_ref(previous->master_privkey) == 1) {
+    cfg->master_privkey = previous->master_privkey;
+    cfg->master_key_stamp = previous->master_key_stamp;
+    LOGD("Reusing unchanged master private key\n");
+    return 1;
+  }
+
   fp = fopen(cfg->priv_key_path, "r");
   if (!fp) {
     LOGE("Could not open master private key: %s\n", cfg->priv_key_path);
     return 0;
   }
 
+  (void)app_keys_stamp_file(fp, &cfg->master_key_stamp);
   cfg->master_privkey = PEM_read_PrivateKey(fp, NULL, NULL, NULL);
   fclose(fp);
 
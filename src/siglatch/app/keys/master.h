@@ -11,11 +11,11 @@
 typedef struct {
   int (*init)(void);
   void (*shutdown)(void);
-  int (*load)(siglatch_config *cfg);
+  int (*load)(siglatch_config *cfg, const siglatch_config *previous);
 } AppKeysMasterLib;
 
 int app_keys_master_init(void);
 void app_keys_master_shutdown(void);
-int app_keys_master_load(siglatch_config *cfg);
+int app_keys_master_load(siglatch_config *cfg, const siglatch_config *previous);
 
 #endif
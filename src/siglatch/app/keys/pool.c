@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "pool.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../../lib.h"
+
+typedef struct {
+  int count;
+  int next;
+  int failed;
+  AppKeysPoolFn fn;
+  void *arg;
+} AppKeysPoolRun;
+
+int app_keys_pool_threads(int count) {
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  int threads = 0;
+
+  if (count < APP_KEYS_POOL_MIN_ITEMS || cpus <= 1) {
+    return 1;
+  }
+
+  threads = cpus > APP_KEYS_POOL_THREADS_MAX ? APP_KEYS_POOL_THREADS_MAX : (int)cpus;
+  return threads;
+}
+
+/* Claim items until the list runs out or any item fails. */
+static void *app_keys_pool_worker(void *opaque) {
+  AppKeysPoolRun *run = opaque;
+
+  for (;;) {
+    int index = 0;
+
+    if (__atomic_load_n(&run->failed, __ATOMIC_RELAXED)) {
+      break;
+    }
+
+    index = __atomic_fetch_add(&run->next, 1, __ATOMIC_RELAXED);
+    if (index >= run->count) {
+      break;
+    }
+
+    if (!run->fn(index, run->arg)) {
+      __atomic_store_n(&run->failed, 1, __ATOMIC_RELAXED);
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * Call fn for every index in [0, count) across the pool and wait for all of
+ * it. Returns 0 if any call failed; items not yet started are then skipped.
+ * A thread that cannot be started just leaves its share to the others.
+ */
+int app_keys_pool_run(int count, AppKeysPoolFn fn, void *arg) {
+  pthread_t threads[APP_KEYS_POOL_THREADS_MAX];
+  AppKeysPoolRun run = {0};
+  int started = 0;
+  int wanted = 0;
+  int i = 0;
+
+  if (!fn || count < 0) {
+    return 0;
+  }
+
+  run.count = count;
+  run.fn = fn;
+  run.arg = arg;
+
+  wanted = app_keys_pool_threads(count) - 1;
+  for (i = 0; i < wanted; ++i) {
+    if (pthread_create(&threads[started], NULL, app_keys_pool_worker, &run) != 0) {
+      LOGW("Key loader thread could not be started; continuing with %d\n", started + 1);
+      break;
+    }
+    started++;
+  }
+
+  (void)app_keys_pool_worker(&run);
+
+  for (i = 0; i < started; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  return run.failed ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef SIGLATCH_SERVER_APP_KEYS_POOL_H
+#define SIGLATCH_SERVER_APP_KEYS_POOL_H
+
+/*
+ * Per-user key loads are independent file reads and PEM parses, so they are
+ * spread over a few short-lived threads. Below APP_KEYS_POOL_MIN_ITEMS the
+ * caller's thread does the work alone.
+ */
+#define APP_KEYS_POOL_THREADS_MAX 8
+#define APP_KEYS_POOL_MIN_ITEMS 64
+
+typedef int (*AppKeysPoolFn)(int index, void *arg);
+
+int app_keys_pool_threads(int count);
+int app_keys_pool_run(int count, AppKeysPoolFn fn, void *arg);
+
+#endif
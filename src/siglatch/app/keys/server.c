@@ -7,6 +7,8 @@
 #include <openssl/pem.h>
 
 #include "server.h"
+#include "stamp.h"
+#include "../app.h"
 #include "../../lib.h"
 
 int app_keys_server_init(void) {
@@ -16,7 +18,7 @@ int app_keys_server_init(void) {
 void app_keys_server_shutdown(void) {
 }
 
-int app_keys_server_load_all(siglatch_config *cfg) {
+int app_keys_server_load_all(siglatch_config *cfg, const siglatch_config *previous) {
   int i = 0;
 
   if (!cfg) {
@@ -26,6 +28,7 @@ int app_keys_server_load_all(siglatch_config *cfg) {
   for (i = 0; i < cfg->server_count; ++i) {
     FILE *fp = NULL;
     siglatch_server *s = &cfg->servers[i];
+    const siglatch_server *old = NULL;
 
     if (!s->secure) {
       continue;
@@ -49,12 +52,24 @@ int app_keys_server_load_all(siglatch_config *cfg) {
       continue;
     }
 
+    old = previous ? app.config.server_by_name_from(previous, s->name) : NULL;
+    if (old && old->key_owned && old->priv_key &&
+        app_keys_stamp_unchanged(s->priv_key_path, old->priv_key_path, &old->priv_key_stamp) &&
+        EVP_PKEY_up_ref(old->priv_key) == 1) {
+      s->priv_key = old->priv_key;
+      s->priv_key_stamp = old->priv_key_stamp;
+      s->key_owned = 1;
+      LOGD("Reusing unchanged private key for server [%s]\n", s->name);
+      continue;
+    }
+
     fp = fopen(s->priv_key_path, "r");
     if (!fp) {
       LOGE("Could not open private key for server [%s]: %s\n", s->name, s->priv_key_path);
       return 0;
     }
 
+    (void)app_keys_stamp_file(fp, &s->priv_key_stamp);
     s->priv_key = PEM_read_PrivateKey(fp, NULL, NULL, NULL);
     fclose(fp);
 
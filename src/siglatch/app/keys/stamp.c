@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "stamp.h"
+
+#include <string.h>
+#include <sys/stat.h>
+
+static void app_keys_stamp_from_stat(const struct stat *st, siglatch_key_stamp *out) {
+  memset(out, 0, sizeof(*out));
+  out->valid = 1;
+  out->dev = (unsigned long long)st->st_dev;
+  out->ino = (unsigned long long)st->st_ino;
+  out->size = (long long)st->st_size;
+  out->mtime_sec = (long long)st->st_mtim.tv_sec;
+  out->mtime_nsec = st->st_mtim.tv_nsec;
+  out->ctime_sec = (long long)st->st_ctim.tv_sec;
+  out->ctime_nsec = st->st_ctim.tv_nsec;
+}
+
+int app_keys_stamp_path(const char *path, siglatch_key_stamp *out) {
+  struct stat st;
+
+  if (!path || !out || stat(path, &st) != 0) {
+    return 0;
+  }
+
+  app_keys_stamp_from_stat(&st, out);
+  return 1;
+}
+
+/* Stamp the file a key was actually read from, not whatever the path names now. */
+int app_keys_stamp_file(FILE *fp, siglatch_key_stamp *out) {
+  struct stat st;
+
+  if (!fp || !out || fstat(fileno(fp), &st) != 0) {
+    if (out) {
+      memset(out, 0, sizeof(*out));
+    }
+    return 0;
+  }
+
+  app_keys_stamp_from_stat(&st, out);
+  return 1;
+}
+
+/*
+ * True when path is the file previous was stamped from and it has not been
+ * replaced or written since. ctime catches rewrites that restore mtime.
+ */
+int app_keys_stamp_unchanged(const char *path,
+                             const char *previous_path,
+                             const siglatch_key_stamp *previous) {
+  siglatch_key_stamp current;
+
+  if (!path || !previous_path || !previous || !previous->valid) {
+    return 0;
+  }
+
+  if (strcmp(path, previous_path) != 0) {
+    return 0;
+  }
+
+  if (!app_keys_stamp_path(path, &current)) {
+    return 0;
+  }
+
+  return current.dev == previous->dev &&
+         current.ino == previous->ino &&
+         current.size == previous->size &&
+         current.mtime_sec == previous->mtime_sec &&
+         current.mtime_nsec == previous->mtime_nsec &&
+         current.ctime_sec == previous->ctime_sec &&
+         current.ctime_nsec == previous->ctime_nsec;
+}
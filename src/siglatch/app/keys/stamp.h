@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef SIGLATCH_SERVER_APP_KEYS_STAMP_H
+#define SIGLATCH_SERVER_APP_KEYS_STAMP_H
+
+#include <stdio.h>
+
+#include "../config/config.h"
+
+int app_keys_stamp_path(const char *path, siglatch_key_stamp *out);
+int app_keys_stamp_file(FILE *fp, siglatch_key_stamp *out);
+int app_keys_stamp_unchanged(const char *path,
+                             const char *previous_path,
+                             const siglatch_key_stamp *previous);
+
+#endif
@@ -3,59 +3,389 @@
  * License: MTL-10 (see LICENSE.md)
  */
 
+#include <pthread.h>
 #include <stdio.h>
+#include <string.h>
 #include <openssl/pem.h>
 #include <openssl/evp.h>
+#include <openssl/x509.h>
 
 #include "user.h"
+#include "pool.h"
+#include "stamp.h"
+#include "../app.h"
 #include "../../lib.h"
 
+typedef struct {
+  siglatch_config *cfg;
+  const siglatch_config *previous;
+  int lazy;
+  int loaded;
+  int reused;
+  int deferred;
+} AppKeysUserLoad;
+
+/*
+ * Background threads that parse lazy_user_keys after startup. They hold a
+ * reference on the config they walk, so a reload cannot free it under them.
+ */
+typedef struct {
+  pthread_t threads[APP_KEYS_POOL_THREADS_MAX];
+  int thread_count;
+  int running;
+  int stop;
+  int next;
+  const siglatch_config *cfg;
+} AppKeysUserWarm;
+
+static AppKeysUserWarm g_app_keys_user_warm = {0};
+
+static void app_keys_user_warm_stop(void);
+
 int app_keys_user_init(void) {
   return 1;
 }
 
 void app_keys_user_shutdown(void) {
+  app_keys_user_warm_stop();
 }
 
-int app_keys_user_load_all(siglatch_config *cfg) {
-  int i = 0;
+/* The same user in the previous config, matched by id and name. */
+const siglatch_user *app_keys_user_previous(const siglatch_config *previous,
+                                            const siglatch_user *user) {
+  const siglatch_user *old = NULL;
 
-  if (!cfg) {
+  if (!previous || !user) {
+    return NULL;
+  }
+
+  old = app.config.user_by_id_from(previous, user->id);
+  if (!old || strcmp(old->name, user->name) != 0) {
+    return NULL;
+  }
+
+  return old;
+}
+
+/*
+ * A settled public key from the previous config. That config may still be
+ * resolving keys on the daemon loop or the warm threads, so its state and
+ * pointer are read atomically; the state is published after the key.
+ */
+static EVP_PKEY *app_keys_user_previous_pubkey(const siglatch_user *old) {
+  if (!old || __atomic_load_n(&old->key_state, __ATOMIC_ACQUIRE) != SL_USER_KEY_SETTLED) {
+    return NULL;
+  }
+
+  return __atomic_load_n(&old->pubkey, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * A keyring-bound user keeps a decoded key from the previous config when the
+ * DER is byte-for-byte the same.
+ */
+static int app_keys_user_reuse_keyring(siglatch_user *u, const siglatch_user *old) {
+  EVP_PKEY *pkey = NULL;
+
+  if (!old || !old->keyring_der || old->keyring_der_len != u->keyring_der_len ||
+      memcmp(old->keyring_der, u->keyring_der, u->keyring_der_len) != 0) {
+    return 0;
+  }
+
+  pkey = app_keys_user_previous_pubkey(old);
+  if (!pkey || EVP_PKEY_up_ref(pkey) != 1) {
     return 0;
   }
 
-  for (i = 0; i < cfg->user_count; ++i) {
-    FILE *fp = NULL;
-    EVP_PKEY *pkey = NULL;
-    siglatch_user *u = &cfg->users[i];
+  u->pubkey = pkey;
+  return 1;
+}
+
+/* Read and check key_file. The stamp is of the file actually parsed. */
+static EVP_PKEY *app_keys_user_read_file(const siglatch_user *u, siglatch_key_stamp *out_stamp) {
+  FILE *fp = NULL;
+  EVP_PKEY *pkey = NULL;
+
+  if (!u->key_file) {
+    LOGE("No key_file set for user '%s'\n", u->name);
+    return NULL;
+  }
+
+  fp = fopen(u->key_file, "r");
+  if (!fp) {
+    LOGE("Failed to open key file for user '%s': %s\n", u->name, u->key_file);
+    return NULL;
+  }
+
+  (void)app_keys_stamp_file(fp, out_stamp);
+  pkey = PEM_read_PUBKEY(fp, NULL, NULL, NULL);
+  fclose(fp);
 
-    if (!u->enabled) {
-      continue;
+  if (!pkey) {
+    LOGE("Invalid public key for user '%s' (%s)\n", u->name, u->key_file);
+    return NULL;
+  }
+
+  if (EVP_PKEY_base_id(pkey) != EVP_PKEY_RSA) {
+    LOGE("Public key for user '%s' is not RSA\n", u->name);
+    EVP_PKEY_free(pkey);
+    return NULL;
+  }
+
+  return pkey;
+}
+
+/*
+ * Resolve a PENDING user on the calling thread. Whoever moves the state to
+ * LOADING owns the load; everyone else sees LOADING until it settles.
+ */
+static void app_keys_user_claim_and_load(siglatch_user *u) {
+  int expected = SL_USER_KEY_PENDING;
+  siglatch_key_stamp stamp = {0};
+  EVP_PKEY *pkey = NULL;
+
+  if (!__atomic_compare_exchange_n(&u->key_state, &expected, SL_USER_KEY_LOADING, 0,
+                                   __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    return;
+  }
+
+  pkey = app_keys_user_read_file(u, &stamp);
+  if (!pkey) {
+    __atomic_store_n(&u->key_state, SL_USER_KEY_FAILED, __ATOMIC_RELEASE);
+    return;
+  }
+
+  u->key_stamp = stamp;
+  __atomic_store_n(&u->pubkey, pkey, __ATOMIC_RELEASE);
+  __atomic_store_n(&u->key_state, SL_USER_KEY_SETTLED, __ATOMIC_RELEASE);
+}
+
+/*
+ * The user's public key. Keyring users are decoded from the map on first
+ * use and published with a compare-and-swap. Users left PENDING by
+ * lazy_user_keys are parsed here if no warm thread has claimed them yet.
+ * Returns NULL while another thread is loading the key, or if it failed.
+ */
+EVP_PKEY *app_keys_user_pubkey(const siglatch_user *user) {
+  siglatch_user *slot = (siglatch_user *)user;
+  EVP_PKEY *pkey = NULL;
+  EVP_PKEY *expected = NULL;
+  const unsigned char *der = NULL;
+
+  if (!user) {
+    return NULL;
+  }
+
+  pkey = __atomic_load_n(&slot->pubkey, __ATOMIC_ACQUIRE);
+  if (pkey) {
+    return pkey;
+  }
+
+  if (!user->keyring_der) {
+    if (__atomic_load_n(&slot->key_state, __ATOMIC_ACQUIRE) == SL_USER_KEY_PENDING) {
+      app_keys_user_claim_and_load(slot);
     }
+    return __atomic_load_n(&slot->pubkey, __ATOMIC_ACQUIRE);
+  }
+
+  der = user->keyring_der;
+  pkey = d2i_PUBKEY(NULL, &der, (long)user->keyring_der_len);
+  if (!pkey || EVP_PKEY_base_id(pkey) != EVP_PKEY_RSA) {
+    LOGE("Invalid keyring public key for user '%s'\n", user->name);
+    EVP_PKEY_free(pkey);
+    return NULL;
+  }
+
+  if (!__atomic_compare_exchange_n(&slot->pubkey, &expected, pkey, 0,
+                                   __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    EVP_PKEY_free(pkey);
+    return expected;
+  }
+
+  LOGD("Decoded keyring public key for user '%s'\n", user->name);
+  return pkey;
+}
+
+/*
+ * 1 once the user's public key has settled either way, 0 while a warm thread
+ * is still parsing it. A PENDING key is resolved on the spot.
+ */
+int app_keys_user_resolve(const siglatch_user *user) {
+  if (!user) {
+    return 1;
+  }
 
-    fp = fopen(u->key_file, "r");
-    if (!fp) {
-      LOGE("Failed to open key file for user '%s': %s\n", u->name, u->key_file);
-      return 0;
+  (void)app_keys_user_pubkey(user);
+  return __atomic_load_n(&user->key_state, __ATOMIC_ACQUIRE) != SL_USER_KEY_LOADING;
+}
+
+static int app_keys_user_load_one(int index, void *arg) {
+  AppKeysUserLoad *load = arg;
+  siglatch_user *u = &load->cfg->users[index];
+  const siglatch_user *old = NULL;
+  EVP_PKEY *pkey = NULL;
+
+  if (!u->enabled) {
+    return 1;
+  }
+
+  old = app_keys_user_previous(load->previous, u);
+  if (u->keyring_der) {
+    if (app_keys_user_reuse_keyring(u, old)) {
+      __atomic_fetch_add(&load->reused, 1, __ATOMIC_RELAXED);
     }
+    return 1;
+  }
+
+  pkey = app_keys_user_previous_pubkey(old);
+  if (pkey &&
+      app_keys_stamp_unchanged(u->key_file, old->key_file, &old->key_stamp) &&
+      EVP_PKEY_up_ref(pkey) == 1) {
+    u->pubkey = pkey;
+    u->key_stamp = old->key_stamp;
+    __atomic_fetch_add(&load->reused, 1, __ATOMIC_RELAXED);
+    return 1;
+  }
+
+  if (load->lazy) {
+    u->key_state = SL_USER_KEY_PENDING;
+    __atomic_fetch_add(&load->deferred, 1, __ATOMIC_RELAXED);
+    return 1;
+  }
+
+  u->pubkey = app_keys_user_read_file(u, &u->key_stamp);
+  if (!u->pubkey) {
+    return 0;
+  }
+
+  __atomic_fetch_add(&load->loaded, 1, __ATOMIC_RELAXED);
+  LOGD("Loaded and validated RSA public key for user '%s' (EVP)\n", u->name);
+  return 1;
+}
 
-    pkey = PEM_read_PUBKEY(fp, NULL, NULL, NULL);
-    fclose(fp);
+/*
+ * Load every enabled user's public key, spread over the key pool. With lazy
+ * set, keys that cannot be reused are left PENDING for app_keys_user_warm()
+ * and first use instead of being parsed now.
+ */
+static int app_keys_user_load(siglatch_config *cfg, const siglatch_config *previous, int lazy) {
+  AppKeysUserLoad load = {0};
 
-    if (!pkey) {
-      LOGE("Invalid public key for user '%s' (%s)\n", u->name, u->key_file);
-      return 0;
+  if (!cfg) {
+    return 0;
+  }
+
+  load.cfg = cfg;
+  load.previous = previous;
+  load.lazy = lazy;
+
+  if (!app_keys_pool_run(cfg->user_count, app_keys_user_load_one, &load)) {
+    return 0;
+  }
+
+  if (previous) {
+    LOGD("User public keys: %d loaded, %d unchanged and reused\n", load.loaded, load.reused);
+  }
+  if (load.deferred > 0) {
+    LOGD("User public keys: %d deferred until after startup\n", load.deferred);
+  }
+
+  return 1;
+}
+
+int app_keys_user_load_all(siglatch_config *cfg, const siglatch_config *previous) {
+  return app_keys_user_load(cfg, previous, 0);
+}
+
+int app_keys_user_load_lazy(siglatch_config *cfg) {
+  return app_keys_user_load(cfg, NULL, 1);
+}
+
+static void *app_keys_user_warm_worker(void *opaque) {
+  const siglatch_config *cfg = opaque;
+
+  for (;;) {
+    int index = 0;
+
+    if (__atomic_load_n(&g_app_keys_user_warm.stop, __ATOMIC_RELAXED)) {
+      break;
     }
 
-    if (EVP_PKEY_base_id(pkey) != EVP_PKEY_RSA) {
-      LOGE("Public key for user '%s' is not RSA\n", u->name);
-      EVP_PKEY_free(pkey);
-      return 0;
+    index = __atomic_fetch_add(&g_app_keys_user_warm.next, 1, __ATOMIC_RELAXED);
+    if (index >= cfg->user_count) {
+      break;
     }
 
-    u->pubkey = pkey;
-    LOGD("Loaded and validated RSA public key for user '%s' (EVP)\n", u->name);
+    app_keys_user_claim_and_load((siglatch_user *)&cfg->users[index]);
+  }
+
+  if (__atomic_sub_fetch(&g_app_keys_user_warm.running, 1, __ATOMIC_ACQ_REL) == 0) {
+    LOGD("User public keys: background load finished\n");
+  }
+  return NULL;
+}
+
+/*
+ * Parse the PENDING keys of the live config in the background. Requests for
+ * users not reached yet resolve their own key on first use.
+ */
+int app_keys_user_warm(void) {
+  const siglatch_config *cfg = NULL;
+  int wanted = 0;
+  int i = 0;
+
+  if (g_app_keys_user_warm.cfg) {
+    return 1;
+  }
+
+  cfg = app.config.acquire();
+  if (!cfg || !cfg->lazy_user_keys) {
+    app.config.release(cfg);
+    return 1;
+  }
+
+  g_app_keys_user_warm.cfg = cfg;
+  g_app_keys_user_warm.stop = 0;
+  g_app_keys_user_warm.next = 0;
+  g_app_keys_user_warm.thread_count = 0;
+
+  wanted = app_keys_pool_threads(cfg->user_count);
+  __atomic_store_n(&g_app_keys_user_warm.running, wanted, __ATOMIC_RELEASE);
+  for (i = 0; i < wanted; ++i) {
+    if (pthread_create(&g_app_keys_user_warm.threads[i], NULL,
+                       app_keys_user_warm_worker, (void *)cfg) != 0) {
+      LOGW("Key warm thread could not be started; continuing with %d\n", i);
+      __atomic_sub_fetch(&g_app_keys_user_warm.running, wanted - i, __ATOMIC_ACQ_REL);
+      break;
+    }
+    g_app_keys_user_warm.thread_count++;
   }
 
   return 1;
 }
+
+static void app_keys_user_warm_stop(void) {
+  int i = 0;
+
+  if (!g_app_keys_user_warm.cfg) {
+    return;
+  }
+
+  __atomic_store_n(&g_app_keys_user_warm.stop, 1, __ATOMIC_RELAXED);
+  for (i = 0; i < g_app_keys_user_warm.thread_count; ++i) {
+    pthread_join(g_app_keys_user_warm.threads[i], NULL);
+  }
+
+  app.config.release(g_app_keys_user_warm.cfg);
+  g_app_keys_user_warm.cfg = NULL;
+  g_app_keys_user_warm.thread_count = 0;
+}
+
+/* While keys are loading in the background, deferred requests poll at this pace. */
+uint64_t app_keys_user_next_at(uint64_t now_ms) {
+  if (__atomic_load_n(&g_app_keys_user_warm.running, __ATOMIC_ACQUIRE) > 0) {
+    return now_ms + APP_KEYS_USER_WARM_POLL_MS;
+  }
+
+  return UINT64_MAX;
+}
@@ -6,16 +6,31 @@
 #ifndef SIGLATCH_SERVER_APP_KEYS_USER_H
 #define SIGLATCH_SERVER_APP_KEYS_USER_H
 
+#include <stdint.h>
+
 #include "../config/config.h"
 
+#define APP_KEYS_USER_WARM_POLL_MS 2u
+
 typedef struct {
   int (*init)(void);
   void (*shutdown)(void);
-  int (*load_all)(siglatch_config *cfg);
+  int (*load_all)(siglatch_config *cfg, const siglatch_config *previous);
+  EVP_PKEY *(*pubkey)(const siglatch_user *user);
+  int (*resolve)(const siglatch_user *user);
+  int (*warm)(void);
+  uint64_t (*next_at)(uint64_t now_ms);
 } AppKeysUserLib;
 
 int app_keys_user_init(void);
 void app_keys_user_shutdown(void);
-int app_keys_user_load_all(siglatch_config *cfg);
+const siglatch_user *app_keys_user_previous(const siglatch_config *previous,
+                                            const siglatch_user *user);
+int app_keys_user_load_all(siglatch_config *cfg, const siglatch_config *previous);
+int app_keys_user_load_lazy(siglatch_config *cfg);
+EVP_PKEY *app_keys_user_pubkey(const siglatch_user *user);
+int app_keys_user_resolve(const siglatch_user *user);
+int app_keys_user_warm(void);
+uint64_t app_keys_user_next_at(uint64_t now_ms);
 
 #endif
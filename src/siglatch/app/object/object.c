@@ -7,10 +7,16 @@
 
 #include <dlfcn.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
 #include <string.h>
+#include <sys/socket.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include "worker.h"
 #include "../app.h"
 #include "../../lib.h"
 
@@ -19,11 +25,6 @@ typedef struct {
   AppObjectHandlerFn handle;
 } AppStaticObjectEntry;
 
-typedef struct {
-  int handler_ok;
-  AppActionReply reply;
-} AppObjectChildResult;
-
 static int app_object_init(void);
 static void app_object_shutdown(void);
 static int app_object_supports_static(const char *name);
@@ -38,13 +39,22 @@ static int app_object_build_context(
     const char *ip_addr);
 static int app_object_run_static(const AppObjectContext *ctx, AppActionReply *reply);
 static int app_object_run_dynamic(const AppObjectContext *ctx, AppActionReply *reply);
+static void app_object_sweep(uint64_t now_ms);
 
 static const AppStaticObjectEntry *app_object_lookup_static(const char *name);
-static int app_object_run_static_child(const AppObjectContext *ctx, AppObjectChildResult *out_result);
-static int app_object_run_dynamic_child(const AppObjectContext *ctx, AppObjectChildResult *out_result);
+static int app_object_run_static_child(const AppObjectContext *ctx, AppObjectResult *out_result);
+static int app_object_run_dynamic_child(const AppObjectContext *ctx, AppObjectResult *out_result);
+static int app_object_fork_timeout_ms(const siglatch_action *action);
+static int app_object_zygote_child(int io_fd);
+static int app_object_run_zygote(const AppObjectContext *ctx, AppActionReply *reply);
 static int app_object_run_forked(const AppObjectContext *ctx,
                                  int is_dynamic,
                                  AppActionReply *reply);
+static int app_object_run_in_process(const AppObjectContext *ctx,
+                                     const AppStaticObjectEntry *entry,
+                                     AppActionReply *reply);
+static int app_object_in_process_demoted(const char *action_name);
+static void app_object_in_process_demote(const char *action_name);
 static int app_object_reply_pipe_write(int fd, const void *buf, size_t len);
 static int app_object_reply_pipe_read(int fd, void *buf, size_t len);
 
@@ -53,7 +63,29 @@ static const AppStaticObjectEntry app_static_objects[] = {
   {"sample_blurt_static", siglatch_object_sample_blurt_static_handle}
 };
 
+#define APP_STATIC_OBJECT_COUNT (sizeof(app_static_objects) / sizeof(app_static_objects[0]))
+
+/*
+ * In-process calls share the daemon with every other executor thread.
+ * Handlers were written for a private child, so calls into one object are
+ * serialized; an action that overruns its budget is demoted to the fork path.
+ */
+static pthread_mutex_t app_static_object_locks[APP_STATIC_OBJECT_COUNT];
+static pthread_mutex_t app_object_demoted_lock = PTHREAD_MUTEX_INITIALIZER;
+static char app_object_demoted[APP_OBJECT_IN_PROCESS_DEMOTED_MAX][MAX_ACTION_NAME];
+static size_t app_object_demoted_count = 0;
+
 static int app_object_init(void) {
+  size_t i = 0;
+
+  for (i = 0; i < APP_STATIC_OBJECT_COUNT; ++i) {
+    pthread_mutex_init(&app_static_object_locks[i], NULL);
+  }
+
+  pthread_mutex_lock(&app_object_demoted_lock);
+  app_object_demoted_count = 0;
+  pthread_mutex_unlock(&app_object_demoted_lock);
+
   if (!app_object_test_static_init()) {
     return 0;
   }
@@ -63,12 +95,27 @@ static int app_object_init(void) {
     return 0;
   }
 
+  if (!app_object_worker_init()) {
+    siglatch_object_sample_blurt_static_shutdown();
+    app_object_test_static_shutdown();
+    return 0;
+  }
+
+  /* The zygote is started later in startup and inherits this. */
+  app.payload.zygote.set_object_runner(app_object_zygote_child);
   return 1;
 }
 
 static void app_object_shutdown(void) {
+  size_t i = 0;
+
+  app_object_worker_shutdown();
   siglatch_object_sample_blurt_static_shutdown();
   app_object_test_static_shutdown();
+
+  for (i = 0; i < APP_STATIC_OBJECT_COUNT; ++i) {
+    pthread_mutex_destroy(&app_static_object_locks[i]);
+  }
 }
 
 static int app_object_supports_static(const char *name) {
@@ -118,13 +165,49 @@ static int app_object_build_context(
 }
 
 static int app_object_run_static(const AppObjectContext *ctx, AppActionReply *reply) {
+  const AppStaticObjectEntry *entry = NULL;
+  int rc = -1;
+
+  if (ctx && ctx->action && ctx->action->in_process && ctx->action->run_as[0] == '\0') {
+    entry = app_object_lookup_static(ctx->action->object);
+    if (entry && entry->handle) {
+      rc = app_object_run_in_process(ctx, entry, reply);
+    }
+    if (rc >= 0) {
+      return rc;
+    }
+  }
+
+  if (ctx && app_object_worker_wants(ctx->action)) {
+    entry = app_object_lookup_static(ctx->action->object);
+    if (entry && entry->handle) {
+      rc = app_object_worker_run(ctx, entry->handle, reply);
+    }
+    if (rc >= 0) {
+      return rc;
+    }
+  }
+
   return app_object_run_forked(ctx, 0, reply);
 }
 
 static int app_object_run_dynamic(const AppObjectContext *ctx, AppActionReply *reply) {
+  int rc = -1;
+
+  if (ctx && app_object_worker_wants(ctx->action)) {
+    rc = app_object_worker_run(ctx, NULL, reply);
+    if (rc >= 0) {
+      return rc;
+    }
+  }
+
   return app_object_run_forked(ctx, 1, reply);
 }
 
+static void app_object_sweep(uint64_t now_ms) {
+  app_object_worker_sweep(now_ms);
+}
+
 static const AppStaticObjectEntry *app_object_lookup_static(const char *name) {
   size_t i = 0;
 
@@ -132,7 +215,7 @@ static const AppStaticObjectEntry *app_object_lookup_static(const char *name) {
     return NULL;
   }
 
-  for (i = 0; i < sizeof(app_static_objects) / sizeof(app_static_objects[0]); ++i) {
+  for (i = 0; i < APP_STATIC_OBJECT_COUNT; ++i) {
     if (strcmp(app_static_objects[i].name, name) == 0) {
       return &app_static_objects[i];
     }
@@ -141,7 +224,7 @@ static const AppStaticObjectEntry *app_object_lookup_static(const char *name) {
   return NULL;
 }
 
-static int app_object_run_static_child(const AppObjectContext *ctx, AppObjectChildResult *out_result) {
+static int app_object_run_static_child(const AppObjectContext *ctx, AppObjectResult *out_result) {
   const AppStaticObjectEntry *entry = NULL;
 
   if (!ctx || !ctx->action || !out_result) {
@@ -158,7 +241,7 @@ static int app_object_run_static_child(const AppObjectContext *ctx, AppObjectChi
   return out_result->handler_ok;
 }
 
-static int app_object_run_dynamic_child(const AppObjectContext *ctx, AppObjectChildResult *out_result) {
+static int app_object_run_dynamic_child(const AppObjectContext *ctx, AppObjectResult *out_result) {
   void *handle = NULL;
   AppObjectHandlerFn handler = NULL;
   int ok = 0;
@@ -196,13 +279,110 @@ static int app_object_run_dynamic_child(const AppObjectContext *ctx, AppObjectCh
   return ok;
 }
 
+static int app_object_fork_timeout_ms(const siglatch_action *action) {
+  return action->timeout_ms > 0 ? action->timeout_ms : (int)APP_OBJECT_FORK_TIMEOUT_MS;
+}
+
+/* Runs inside a zygote child: serve one request from io_fd, then exit. */
+static int app_object_zygote_child(int io_fd) {
+  AppObjectRequest request;
+  AppObjectResult result;
+  AppObjectContext ctx;
+  int ok = 0;
+
+  if (!app_object_recv_request(io_fd, &request, &ctx)) {
+    return 0;
+  }
+
+  memset(&result, 0, sizeof(result));
+  if (request.action.handler == SL_ACTION_HANDLER_DYNAMIC) {
+    ok = app_object_run_dynamic_child(&ctx, &result);
+  } else {
+    ok = app_object_run_static_child(&ctx, &result);
+  }
+
+  if (!result.reply.should_reply) {
+    if (ok) {
+      app_action_reply_set(&result.reply, 1, "OK %s", request.action.name);
+    } else {
+      app_action_reply_set(&result.reply, 0, "ERROR %s object_failed", request.action.name);
+    }
+  }
+  result.handler_ok = ok ? 1 : 0;
+
+  app_object_release_request(&request);
+  (void)app_object_send_result(io_fd, &result);
+  close(io_fd);
+  return ok;
+}
+
+/*
+ * Executor threads make a bare fork() from the daemon unsafe for anything
+ * short of exec, so forked objects start from the single-threaded zygote,
+ * which also applies run_as. Returns -1 when the zygote is unavailable and
+ * nothing ran.
+ */
+static int app_object_run_zygote(const AppObjectContext *ctx, AppActionReply *reply) {
+  AppObjectResult result = {0};
+  int pair[2] = {-1, -1};
+  int handle = -1;
+  pid_t pid = -1;
+  int timeout_ms = app_object_fork_timeout_ms(ctx->action);
+  int exit_code = 0;
+  int read_ok = 0;
+  int rc = 0;
+
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+    LOGPERR("socketpair");
+    return -1;
+  }
+  (void)fcntl(pair[0], F_SETFD, FD_CLOEXEC);
+
+  rc = app.payload.zygote.spawn_object(ctx->action->run_as, pair[1], &handle, &pid);
+  close(pair[1]);
+  if (rc <= 0) {
+    close(pair[0]);
+    if (rc == 0) {
+      app_action_reply_set(reply, 0, "ERROR %s object_exec_failed", ctx->action->name);
+    }
+    return rc;
+  }
+
+  if (!app_object_send_request(pair[0], ctx)) {
+    app_action_reply_set(reply, 0, "ERROR %s object_ipc_failed", ctx->action->name);
+  } else if (!app_object_wait_readable(pair[0], timeout_ms)) {
+    LOGW("[object] Action (%s) exceeded %d ms; killing PID %d\n",
+         ctx->action->name,
+         timeout_ms,
+         (int)pid);
+    (void)kill(-pid, SIGKILL);
+    (void)kill(pid, SIGKILL);
+    app_action_reply_set(reply, 0, "ERROR %s timeout", ctx->action->name);
+  } else if (!(read_ok = app_object_recv_result(pair[0], &result))) {
+    app_action_reply_set(reply, 0, "ERROR %s object_ipc_failed", ctx->action->name);
+  }
+  close(pair[0]);
+
+  /* The child exits once its result is sent; bound the wait regardless. */
+  (void)app.payload.zygote.wait(handle, pid, timeout_ms, &exit_code);
+
+  if (!read_ok) {
+    return 0;
+  }
+
+  *reply = result.reply;
+  return result.handler_ok;
+}
+
 static int app_object_run_forked(const AppObjectContext *ctx,
                                  int is_dynamic,
                                  AppActionReply *reply) {
   int pipefd[2] = {-1, -1};
   pid_t pid = -1;
-  AppObjectChildResult child_result = {0};
+  AppObjectResult child_result = {0};
+  int timeout_ms = 0;
   int read_ok = 0;
+  int rc = 0;
 
   if (!ctx || !ctx->action || !reply) {
     return 0;
@@ -210,6 +390,14 @@ static int app_object_run_forked(const AppObjectContext *ctx,
 
   app_action_reply_reset(reply);
 
+  rc = app_object_run_zygote(ctx, reply);
+  if (rc >= 0) {
+    return rc;
+  }
+
+  /* No zygote: fork directly, and never wait without a limit. */
+  timeout_ms = app_object_fork_timeout_ms(ctx->action);
+
   if (pipe(pipefd) != 0) {
     LOGPERR("pipe");
     app_action_reply_set(reply, 0, "ERROR %s object_ipc_failed", ctx->action->name);
@@ -263,6 +451,18 @@ static int app_object_run_forked(const AppObjectContext *ctx,
   }
 
   close(pipefd[1]);
+  if (!app_object_wait_readable(pipefd[0], timeout_ms)) {
+    LOGW("[object] Action (%s) exceeded %d ms; killing PID %d\n",
+         ctx->action->name,
+         timeout_ms,
+         (int)pid);
+    (void)kill(pid, SIGKILL);
+    close(pipefd[0]);
+    while (waitpid(pid, NULL, 0) < 0 && errno == EINTR) {
+    }
+    app_action_reply_set(reply, 0, "ERROR %s timeout", ctx->action->name);
+    return 0;
+  }
   read_ok = app_object_reply_pipe_read(pipefd[0], &child_result, sizeof(child_result));
   close(pipefd[0]);
 
@@ -278,6 +478,112 @@ static int app_object_run_forked(const AppObjectContext *ctx,
   return child_result.handler_ok;
 }
 
+/*
+ * Trusted fast path: call the compiled-in handler on the executor thread.
+ * A thread cannot be preempted safely, so the budget is enforced after the
+ * fact: the call that overran still replies, and later calls fork.
+ * Returns -1 when the action has been demoted and nothing ran.
+ */
+static int app_object_run_in_process(const AppObjectContext *ctx,
+                                     const AppStaticObjectEntry *entry,
+                                     AppActionReply *reply) {
+  pthread_mutex_t *lock = NULL;
+  uint64_t started_ms = 0;
+  uint64_t elapsed_ms = 0;
+  uint64_t budget_ms = 0;
+  int ok = 0;
+
+  if (!ctx || !ctx->action || !entry || !entry->handle || !reply) {
+    return -1;
+  }
+
+  if (app_object_in_process_demoted(ctx->action->name)) {
+    return -1;
+  }
+
+  budget_ms = ctx->action->timeout_ms > 0
+                  ? (uint64_t)ctx->action->timeout_ms
+                  : APP_OBJECT_IN_PROCESS_BUDGET_MS;
+  lock = &app_static_object_locks[entry - app_static_objects];
+
+  app_action_reply_reset(reply);
+  pthread_mutex_lock(lock);
+  started_ms = lib.time.monotonic_ms();
+  ok = entry->handle(ctx, reply) ? 1 : 0;
+  elapsed_ms = lib.time.monotonic_ms() - started_ms;
+  pthread_mutex_unlock(lock);
+
+  if (!reply->should_reply) {
+    if (ok) {
+      app_action_reply_set(reply, 1, "OK %s", ctx->action->name);
+    } else {
+      app_action_reply_set(reply, 0, "ERROR %s object_failed", ctx->action->name);
+    }
+  }
+
+  if (elapsed_ms > budget_ms) {
+    LOGW("[object] In-process action (%s) took %llu ms (budget %llu ms); using fork from now on\n",
+         ctx->action->name,
+         (unsigned long long)elapsed_ms,
+         (unsigned long long)budget_ms);
+    app_object_in_process_demote(ctx->action->name);
+  }
+
+  return ok;
+}
+
+static int app_object_in_process_demoted(const char *action_name) {
+  size_t i = 0;
+  int found = 0;
+
+  pthread_mutex_lock(&app_object_demoted_lock);
+  for (i = 0; i < app_object_demoted_count; ++i) {
+    if (strcmp(app_object_demoted[i], action_name) == 0) {
+      found = 1;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&app_object_demoted_lock);
+
+  return found;
+}
+
+static void app_object_in_process_demote(const char *action_name) {
+  size_t i = 0;
+
+  pthread_mutex_lock(&app_object_demoted_lock);
+  for (i = 0; i < app_object_demoted_count; ++i) {
+    if (strcmp(app_object_demoted[i], action_name) == 0) {
+      pthread_mutex_unlock(&app_object_demoted_lock);
+      return;
+    }
+  }
+
+  if (app_object_demoted_count < APP_OBJECT_IN_PROCESS_DEMOTED_MAX) {
+    lib.str.lcpy(app_object_demoted[app_object_demoted_count],
+                 action_name,
+                 sizeof(app_object_demoted[0]));
+    app_object_demoted_count++;
+  }
+  pthread_mutex_unlock(&app_object_demoted_lock);
+}
+
+/* Returns 0 only when timeout_ms > 0 elapses with nothing to read. */
+int app_object_wait_readable(int fd, int timeout_ms) {
+  struct pollfd pfd = {.fd = fd, .events = POLLIN, .revents = 0};
+  int ready = 0;
+
+  if (timeout_ms <= 0) {
+    return 1;
+  }
+
+  do {
+    ready = poll(&pfd, 1, timeout_ms);
+  } while (ready < 0 && errno == EINTR);
+
+  return ready != 0;
+}
+
 static int app_object_reply_pipe_write(int fd, const void *buf, size_t len) {
   const uint8_t *cursor = (const uint8_t *)buf;
   size_t written_total = 0;
@@ -324,7 +630,8 @@ static const AppObjectLib app_object_instance = {
   .supports_dynamic = app_object_supports_dynamic,
   .build_context = app_object_build_context,
   .run_static = app_object_run_static,
-  .run_dynamic = app_object_run_dynamic
+  .run_dynamic = app_object_run_dynamic,
+  .sweep = app_object_sweep
 };
 
 const AppObjectLib *get_app_object_lib(void) {
@@ -6,9 +6,17 @@
 #ifndef SIGLATCH_SERVER_APP_OBJECT_H
 #define SIGLATCH_SERVER_APP_OBJECT_H
 
+#include <stdint.h>
+
 #include "test_static.h"
 #include "../../objects/static/sample_blurt.h"
 
+/* Default budget for in_process static objects without timeout_ms. */
+#define APP_OBJECT_IN_PROCESS_BUDGET_MS 100u
+#define APP_OBJECT_IN_PROCESS_DEMOTED_MAX 32u
+/* Limit for forked objects without timeout_ms, so a wedged child is reaped. */
+#define APP_OBJECT_FORK_TIMEOUT_MS 30000u
+
 typedef struct {
   int (*init)(void);
   void (*shutdown)(void);
@@ -24,6 +32,7 @@ typedef struct {
       const char *ip_addr);
   int (*run_static)(const AppObjectContext *ctx, AppActionReply *reply);
   int (*run_dynamic)(const AppObjectContext *ctx, AppActionReply *reply);
+  void (*sweep)(uint64_t now_ms);
 } AppObjectLib;
 
 const AppObjectLib *get_app_object_lib(void);
@@ -12,6 +12,16 @@
 #include "../runtime/runtime.h"
 #include "../../../stdlib/openssl/session/session.h"
 
+/*
+ * Handlers must treat listener and session as optional. Both are set only
+ * when the daemon loop runs the object itself, which happens while the
+ * executor pool is not started. Executor-run objects get NULL for both.
+ *
+ * On the executor, and in every worker or forked child, user is a stripped
+ * copy: key_file, hmac_file, actions, allowed_ips, pubkey and keyring_der
+ * are NULL, and the action and IP counts are 0. Only id, name, enabled and
+ * action_grants can be relied on. job, action and ip_addr are always set.
+ */
 typedef struct {
   AppRuntimeListenerState *listener;
   const AppConnectionJob *job;
@@ -0,0 +1,632 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "worker.h"
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../app.h"
+#include "../../lib.h"
+
+#define APP_OBJECT_WORKER_MAGIC 0x4f424a31u /* "OBJ1" */
+#define APP_OBJECT_WORKER_STOP_POLLS 100
+#define APP_OBJECT_WORKER_STOP_POLL_US 10000
+/* Seconds a SIGTERMed worker has to finish its destructor. */
+#define APP_OBJECT_WORKER_STOP_GRACE_S 1
+
+typedef int (*AppObjectWorkerConstructorFn)(void);
+typedef void (*AppObjectWorkerDestructorFn)(void);
+
+typedef struct {
+  uint32_t magic;
+  uint32_t payload_len;
+} AppObjectWorkerRequestHeader;
+
+/*
+ * One persistent worker bound to an action id. The slot lock serializes
+ * requests to the worker; the table lock only guards slot assignment.
+ */
+typedef struct {
+  int assigned;
+  uint32_t action_id;
+  pthread_mutex_t lock;
+  pid_t pid;
+  int fd;
+  uint64_t last_used_ms;
+  uint64_t idle_ms;
+  int handler;
+  char object[sizeof(((siglatch_action *)0)->object)];
+  char object_path[sizeof(((siglatch_action *)0)->object_path)];
+  char run_as[sizeof(((siglatch_action *)0)->run_as)];
+} AppObjectWorkerSlot;
+
+typedef struct {
+  int initialized;
+  pthread_mutex_t lock;
+  AppObjectWorkerSlot slots[APP_OBJECT_WORKER_CAPACITY];
+} AppObjectWorkerState;
+
+static AppObjectWorkerState g_app_object_worker = {0};
+
+/* Set in a worker process once it has been asked to stop. */
+static volatile sig_atomic_t g_app_object_worker_stopping = 0;
+
+static int app_object_worker_send_all(int fd, const void *buf, size_t len) {
+  const uint8_t *cursor = (const uint8_t *)buf;
+  size_t total = 0;
+
+  while (total < len) {
+    ssize_t sent = send(fd, cursor + total, len - total, MSG_NOSIGNAL);
+    if (sent < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return 0;
+    }
+    total += (size_t)sent;
+  }
+
+  return 1;
+}
+
+static int app_object_worker_recv_all(int fd, void *buf, size_t len) {
+  uint8_t *cursor = (uint8_t *)buf;
+  size_t total = 0;
+
+  while (total < len) {
+    ssize_t got = recv(fd, cursor + total, len - total, 0);
+    if (got == 0) {
+      return 0;
+    }
+    if (got < 0) {
+      if (errno == EINTR && !g_app_object_worker_stopping) {
+        continue;
+      }
+      return 0;
+    }
+    total += (size_t)got;
+  }
+
+  return 1;
+}
+
+/* ---- request framing --------------------------------------------------- */
+
+int app_object_send_request(int fd, const AppObjectContext *ctx) {
+  AppObjectWorkerRequestHeader header = {0};
+  AppConnectionJob job;
+  siglatch_user user;
+  const uint8_t *payload = NULL;
+
+  if (!ctx || !ctx->job || !ctx->user || !ctx->action) {
+    return 0;
+  }
+
+  job = *ctx->job;
+  payload = job.request.payload_buffer;
+  job.request.payload_buffer = NULL;
+  job.response_buffer = NULL;
+  job.arena = NULL;
+  job.batch = NULL;
+  /* Heap pointers mean nothing on the other side of the socket. */
+  user = *ctx->user;
+  user.key_file = NULL;
+  user.hmac_file = NULL;
+  user.actions = NULL;
+  user.action_count = 0;
+  user.allowed_ips = NULL;
+  user.allowed_ip_count = 0;
+  user.pubkey = NULL;
+  user.keyring_der = NULL;
+  user.keyring_der_len = 0u;
+
+  header.magic = APP_OBJECT_WORKER_MAGIC;
+  header.payload_len = (uint32_t)(payload ? job.request.payload_len : 0u);
+
+  return app_object_worker_send_all(fd, &header, sizeof(header)) &&
+         app_object_worker_send_all(fd, &job, sizeof(job)) &&
+         app_object_worker_send_all(fd, &user, sizeof(user)) &&
+         app_object_worker_send_all(fd, ctx->action, sizeof(*ctx->action)) &&
+         (header.payload_len == 0u ||
+          app_object_worker_send_all(fd, payload, header.payload_len));
+}
+
+int app_object_recv_request(int fd, AppObjectRequest *out, AppObjectContext *ctx) {
+  AppObjectWorkerRequestHeader header = {0};
+
+  if (!out || !ctx) {
+    return 0;
+  }
+
+  out->payload = NULL;
+  if (!app_object_worker_recv_all(fd, &header, sizeof(header)) ||
+      header.magic != APP_OBJECT_WORKER_MAGIC ||
+      !app_object_worker_recv_all(fd, &out->job, sizeof(out->job)) ||
+      !app_object_worker_recv_all(fd, &out->user, sizeof(out->user)) ||
+      !app_object_worker_recv_all(fd, &out->action, sizeof(out->action))) {
+    return 0;
+  }
+
+  if (header.payload_len > 0u) {
+    out->payload = (uint8_t *)malloc(header.payload_len);
+    if (!out->payload || !app_object_worker_recv_all(fd, out->payload, header.payload_len)) {
+      app_object_release_request(out);
+      return 0;
+    }
+  }
+
+  out->job.request.payload_buffer = out->payload;
+  out->job.request.payload_len = header.payload_len;
+  out->job.request.payload_cap = header.payload_len;
+  out->job.response_buffer = NULL;
+  out->job.response_len = 0u;
+  out->job.response_cap = 0u;
+  out->job.arena = NULL;
+  out->job.batch = NULL;
+
+  *ctx = (AppObjectContext){
+    .listener = NULL,
+    .job = &out->job,
+    .session = NULL,
+    .user = &out->user,
+    .action = &out->action,
+    .ip_addr = out->job.ip
+  };
+
+  return 1;
+}
+
+void app_object_release_request(AppObjectRequest *request) {
+  if (!request) {
+    return;
+  }
+
+  free(request->payload);
+  request->payload = NULL;
+}
+
+int app_object_send_result(int fd, const AppObjectResult *result) {
+  return result && app_object_worker_send_all(fd, result, sizeof(*result));
+}
+
+int app_object_recv_result(int fd, AppObjectResult *result) {
+  return result && app_object_worker_recv_all(fd, result, sizeof(*result));
+}
+
+int app_object_worker_init(void) {
+  size_t i = 0;
+
+  if (g_app_object_worker.initialized) {
+    return 1;
+  }
+
+  if (pthread_mutex_init(&g_app_object_worker.lock, NULL) != 0) {
+    return 0;
+  }
+
+  for (i = 0; i < APP_OBJECT_WORKER_CAPACITY; ++i) {
+    AppObjectWorkerSlot *slot = &g_app_object_worker.slots[i];
+
+    memset(slot, 0, sizeof(*slot));
+    slot->pid = -1;
+    slot->fd = -1;
+    if (pthread_mutex_init(&slot->lock, NULL) != 0) {
+      while (i > 0u) {
+        --i;
+        pthread_mutex_destroy(&g_app_object_worker.slots[i].lock);
+      }
+      pthread_mutex_destroy(&g_app_object_worker.lock);
+      return 0;
+    }
+  }
+
+  g_app_object_worker.initialized = 1;
+  return 1;
+}
+
+/*
+ * Ask the worker to exit by closing its socket, which runs the destructor.
+ * A worker that does not exit promptly is killed so a stuck destructor
+ * cannot hold up the daemon.
+ */
+static void app_object_worker_stop_slot(AppObjectWorkerSlot *slot) {
+  int polls = 0;
+  pid_t waited = -1;
+
+  if (!slot) {
+    return;
+  }
+
+  if (slot->fd >= 0) {
+    close(slot->fd);
+    slot->fd = -1;
+  }
+
+  if (slot->pid > 0) {
+    for (polls = 0; polls < APP_OBJECT_WORKER_STOP_POLLS; ++polls) {
+      waited = waitpid(slot->pid, NULL, WNOHANG);
+      if (waited == slot->pid || (waited < 0 && errno != EINTR)) {
+        break;
+      }
+      usleep(APP_OBJECT_WORKER_STOP_POLL_US);
+    }
+
+    if (waited != slot->pid) {
+      LOGW("[object.worker] Worker PID %d did not exit; killing\n", (int)slot->pid);
+      (void)kill(slot->pid, SIGKILL);
+      while (waitpid(slot->pid, NULL, 0) < 0 && errno == EINTR) {
+      }
+    }
+
+    LOGD("[object.worker] Stopped worker for action id %u\n", slot->action_id);
+    slot->pid = -1;
+  }
+}
+
+/*
+ * Stop a worker without waiting for it. SIGTERM ends its request loop and
+ * the tick's detached reaper collects it; the worker gives its destructor
+ * APP_OBJECT_WORKER_STOP_GRACE_S before SIGALRM ends it. Only when the
+ * reaper has no room left is the worker waited for here.
+ */
+static void app_object_worker_retire_slot(AppObjectWorkerSlot *slot) {
+  if (!slot) {
+    return;
+  }
+
+  if (slot->pid > 0) {
+    (void)kill(slot->pid, SIGTERM);
+    if (!app.payload.adopt_detached(slot->pid)) {
+      LOGW("[object.worker] No room to reap worker PID %d later; waiting\n", (int)slot->pid);
+      app_object_worker_stop_slot(slot);
+      return;
+    }
+    LOGD("[object.worker] Retired worker for action id %u\n", slot->action_id);
+    slot->pid = -1;
+  }
+
+  if (slot->fd >= 0) {
+    close(slot->fd);
+    slot->fd = -1;
+  }
+}
+
+void app_object_worker_shutdown(void) {
+  size_t i = 0;
+
+  if (!g_app_object_worker.initialized) {
+    return;
+  }
+
+  for (i = 0; i < APP_OBJECT_WORKER_CAPACITY; ++i) {
+    AppObjectWorkerSlot *slot = &g_app_object_worker.slots[i];
+
+    pthread_mutex_lock(&slot->lock);
+    app_object_worker_stop_slot(slot);
+    slot->assigned = 0;
+    pthread_mutex_unlock(&slot->lock);
+    pthread_mutex_destroy(&slot->lock);
+  }
+
+  pthread_mutex_destroy(&g_app_object_worker.lock);
+  g_app_object_worker.initialized = 0;
+}
+
+int app_object_worker_wants(const siglatch_action *action) {
+  if (!action || action->keepalive_interval <= 0) {
+    return 0;
+  }
+
+  return action->handler == SL_ACTION_HANDLER_STATIC ||
+         action->handler == SL_ACTION_HANDLER_DYNAMIC;
+}
+
+static int app_object_worker_matches(const AppObjectWorkerSlot *slot,
+                                     const siglatch_action *action) {
+  return slot->handler == (int)action->handler &&
+         slot->idle_ms == (uint64_t)action->keepalive_interval * 1000u &&
+         strcmp(slot->object, action->object) == 0 &&
+         strcmp(slot->object_path, action->object_path) == 0 &&
+         strcmp(slot->run_as, action->run_as) == 0;
+}
+
+static AppObjectWorkerSlot *app_object_worker_claim(uint32_t action_id) {
+  AppObjectWorkerSlot *free_slot = NULL;
+  AppObjectWorkerSlot *slot = NULL;
+  size_t i = 0;
+
+  pthread_mutex_lock(&g_app_object_worker.lock);
+  for (i = 0; i < APP_OBJECT_WORKER_CAPACITY; ++i) {
+    AppObjectWorkerSlot *candidate = &g_app_object_worker.slots[i];
+
+    if (candidate->assigned && candidate->action_id == action_id) {
+      slot = candidate;
+      break;
+    }
+
+    if (!candidate->assigned && !free_slot) {
+      free_slot = candidate;
+    }
+  }
+
+  if (!slot && free_slot) {
+    slot = free_slot;
+    slot->assigned = 1;
+    slot->action_id = action_id;
+  }
+  pthread_mutex_unlock(&g_app_object_worker.lock);
+
+  return slot;
+}
+
+/* Whether slot still belongs to action_id; sweep() may have released it. */
+static int app_object_worker_holds(AppObjectWorkerSlot *slot, uint32_t action_id) {
+  int held = 0;
+
+  pthread_mutex_lock(&g_app_object_worker.lock);
+  held = slot->assigned && slot->action_id == action_id;
+  pthread_mutex_unlock(&g_app_object_worker.lock);
+
+  return held;
+}
+
+/* ---- worker process ---------------------------------------------------- */
+
+static void app_object_worker_child_loop(int fd,
+                                         const siglatch_action *action,
+                                         AppObjectHandlerFn handler) {
+  AppObjectRequest request;
+  AppObjectResult result;
+  AppObjectContext ctx;
+  int ok = 0;
+
+  for (;;) {
+    if (!app_object_recv_request(fd, &request, &ctx)) {
+      return;
+    }
+
+    memset(&result, 0, sizeof(result));
+    ok = handler(&ctx, &result.reply) ? 1 : 0;
+    if (!result.reply.should_reply) {
+      if (ok) {
+        app_action_reply_set(&result.reply, 1, "OK %s", action->name);
+      } else {
+        app_action_reply_set(&result.reply, 0, "ERROR %s object_failed", action->name);
+      }
+    }
+    result.handler_ok = ok;
+
+    app_object_release_request(&request);
+
+    if (!app_object_send_result(fd, &result)) {
+      return;
+    }
+  }
+}
+
+/* Leave the request loop, and bound how long the destructor may take. */
+static void app_object_worker_on_term(int sig) {
+  (void)sig;
+  g_app_object_worker_stopping = 1;
+  (void)alarm(APP_OBJECT_WORKER_STOP_GRACE_S);
+}
+
+static void app_object_worker_child_main(int fd,
+                                         const siglatch_action *action,
+                                         AppObjectHandlerFn static_handle) {
+  void *handle = NULL;
+  AppObjectHandlerFn handler = static_handle;
+  AppObjectWorkerConstructorFn constructor = NULL;
+  AppObjectWorkerDestructorFn destructor = NULL;
+  struct sigaction term;
+  sigset_t empty;
+
+  /* The daemon's handlers and mask do not apply here. */
+  memset(&term, 0, sizeof(term));
+  term.sa_handler = app_object_worker_on_term;
+  sigemptyset(&term.sa_mask);
+  (void)sigaction(SIGTERM, &term, NULL);
+  signal(SIGINT, SIG_DFL);
+  signal(SIGALRM, SIG_DFL);
+  sigemptyset(&empty);
+  sigprocmask(SIG_SETMASK, &empty, NULL);
+
+  if (action->run_as[0] != '\0' && !lib.process.user.drop_to_name(action->run_as)) {
+    LOGE("[object.worker] Failed to drop privileges to user '%s'\n", action->run_as);
+    _exit(126);
+  }
+
+  if (!static_handle) {
+    handle = dlopen(action->object_path, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+      LOGE("[object.worker] dlopen failed for %s: %s\n", action->object_path, dlerror());
+      _exit(1);
+    }
+
+    handler = (AppObjectHandlerFn)dlsym(handle, action->object);
+    if (!handler) {
+      LOGE("[object.worker] dlsym failed for %s in %s\n", action->object, action->object_path);
+      _exit(1);
+    }
+
+    if (action->constructor[0] != '\0') {
+      constructor = (AppObjectWorkerConstructorFn)dlsym(handle, action->constructor);
+      if (!constructor || !constructor()) {
+        LOGE("[object.worker] Constructor %s failed for action (%s)\n",
+             action->constructor,
+             action->name);
+        _exit(1);
+      }
+    }
+
+    if (action->destructor[0] != '\0') {
+      destructor = (AppObjectWorkerDestructorFn)dlsym(handle, action->destructor);
+    }
+  }
+
+  app_object_worker_child_loop(fd, action, handler);
+
+  if (destructor) {
+    destructor();
+  }
+  if (handle) {
+    dlclose(handle);
+  }
+  close(fd);
+  _exit(0);
+}
+
+/* ---- daemon side ------------------------------------------------------- */
+
+static int app_object_worker_spawn(AppObjectWorkerSlot *slot,
+                                   const siglatch_action *action,
+                                   AppObjectHandlerFn static_handle) {
+  int pair[2] = {-1, -1};
+  pid_t pid = -1;
+  size_t i = 0;
+
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+    LOGPERR("socketpair");
+    return 0;
+  }
+
+  pid = fork();
+  if (pid < 0) {
+    LOGPERR("fork");
+    close(pair[0]);
+    close(pair[1]);
+    return 0;
+  }
+
+  if (pid == 0) {
+    close(pair[0]);
+    for (i = 0; i < APP_OBJECT_WORKER_CAPACITY; ++i) {
+      if (g_app_object_worker.slots[i].fd >= 0) {
+        close(g_app_object_worker.slots[i].fd);
+      }
+    }
+    app_object_worker_child_main(pair[1], action, static_handle);
+  }
+
+  close(pair[1]);
+  (void)fcntl(pair[0], F_SETFD, FD_CLOEXEC);
+
+  slot->pid = pid;
+  slot->fd = pair[0];
+  slot->handler = (int)action->handler;
+  slot->idle_ms = (uint64_t)action->keepalive_interval * 1000u;
+  lib.str.lcpy(slot->object, action->object, sizeof(slot->object));
+  lib.str.lcpy(slot->object_path, action->object_path, sizeof(slot->object_path));
+  lib.str.lcpy(slot->run_as, action->run_as, sizeof(slot->run_as));
+  LOGD("[object.worker] Started worker PID %d for action (%s)\n", (int)pid, action->name);
+  return 1;
+}
+
+int app_object_worker_run(const AppObjectContext *ctx,
+                          AppObjectHandlerFn static_handle,
+                          AppActionReply *reply) {
+  AppObjectResult result = {0};
+  AppObjectWorkerSlot *slot = NULL;
+  int sent = 0;
+
+  if (!g_app_object_worker.initialized || !ctx || !ctx->job || !ctx->user ||
+      !ctx->action || !reply) {
+    return -1;
+  }
+
+  for (;;) {
+    slot = app_object_worker_claim((uint32_t)ctx->action->id);
+    if (!slot) {
+      return -1;
+    }
+
+    pthread_mutex_lock(&slot->lock);
+    if (app_object_worker_holds(slot, (uint32_t)ctx->action->id)) {
+      break;
+    }
+    pthread_mutex_unlock(&slot->lock);
+  }
+
+  if (slot->pid > 0 && !app_object_worker_matches(slot, ctx->action)) {
+    app_object_worker_retire_slot(slot);
+  }
+
+  if (slot->pid <= 0 && !app_object_worker_spawn(slot, ctx->action, static_handle)) {
+    pthread_mutex_unlock(&slot->lock);
+    return -1;
+  }
+
+  sent = app_object_send_request(slot->fd, ctx);
+
+  if (sent && !app_object_wait_readable(slot->fd, ctx->action->timeout_ms)) {
+    LOGW("[object.worker] Action (%s) exceeded %d ms; killing worker PID %d\n",
+         ctx->action->name,
+         ctx->action->timeout_ms,
+         (int)slot->pid);
+    (void)kill(slot->pid, SIGKILL);
+    app_object_worker_retire_slot(slot);
+    pthread_mutex_unlock(&slot->lock);
+    app_action_reply_set(reply, 0, "ERROR %s timeout", ctx->action->name);
+    return 0;
+  }
+
+  if (!sent || !app_object_recv_result(slot->fd, &result)) {
+    LOGE("[object.worker] Worker for action (%s) failed; recycling\n", ctx->action->name);
+    app_object_worker_retire_slot(slot);
+    pthread_mutex_unlock(&slot->lock);
+    app_action_reply_set(reply, 0, "ERROR %s object_ipc_failed", ctx->action->name);
+    return 0;
+  }
+
+  slot->last_used_ms = lib.time.monotonic_ms();
+  pthread_mutex_unlock(&slot->lock);
+
+  *reply = result.reply;
+  return result.handler_ok;
+}
+
+/*
+ * Recycle workers idle longer than their action's keepalive_interval, and
+ * give their slots back so other actions can use them; an action that runs
+ * again claims a slot afresh. Busy workers are skipped rather than waited
+ * on, and nothing here waits for a worker to exit.
+ */
+void app_object_worker_sweep(uint64_t now_ms) {
+  size_t i = 0;
+
+  if (!g_app_object_worker.initialized) {
+    return;
+  }
+
+  for (i = 0; i < APP_OBJECT_WORKER_CAPACITY; ++i) {
+    AppObjectWorkerSlot *slot = &g_app_object_worker.slots[i];
+
+    if (pthread_mutex_trylock(&slot->lock) != 0) {
+      continue;
+    }
+
+    if (slot->pid > 0 && now_ms >= slot->last_used_ms + slot->idle_ms) {
+      app_object_worker_retire_slot(slot);
+    }
+
+    if (slot->pid <= 0) {
+      pthread_mutex_lock(&g_app_object_worker.lock);
+      slot->assigned = 0;
+      pthread_mutex_unlock(&g_app_object_worker.lock);
+    }
+
+    pthread_mutex_unlock(&slot->lock);
+  }
+}
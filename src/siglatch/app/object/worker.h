@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef SIGLATCH_SERVER_APP_OBJECT_WORKER_H
+#define SIGLATCH_SERVER_APP_OBJECT_WORKER_H
+
+#include <stdint.h>
+
+#include "types.h"
+
+#define APP_OBJECT_WORKER_CAPACITY 32u
+
+/*
+ * Persistent per-action object workers.
+ *
+ * Actions with keepalive_interval > 0 keep one long-lived child that loads
+ * the object once and serves requests over a socket, instead of forking (and
+ * for dynamic objects dlopen-ing) per request. Idle workers are recycled by
+ * sweep() after keepalive_interval seconds.
+ */
+int app_object_worker_init(void);
+void app_object_worker_shutdown(void);
+int app_object_worker_wants(const siglatch_action *action);
+
+/*
+ * Run one request on the action's worker. static_handle is the resolved
+ * static entry point, or NULL for a dynamic object. Returns the handler
+ * result, or -1 when no worker could be started and nothing was sent.
+ */
+int app_object_worker_run(const AppObjectContext *ctx,
+                          AppObjectHandlerFn static_handle,
+                          AppActionReply *reply);
+void app_object_worker_sweep(uint64_t now_ms);
+
+/* Result of one object request, as sent back by a worker or child. */
+typedef struct {
+  int handler_ok;
+  AppActionReply reply;
+} AppObjectResult;
+
+/* One object request as received by a worker or zygote-spawned child. */
+typedef struct {
+  AppConnectionJob job;
+  siglatch_user user;
+  siglatch_action action;
+  uint8_t *payload;
+} AppObjectRequest;
+
+/*
+ * Request framing over a stream socket, shared with the zygote path in
+ * object.c. recv_request() points ctx at out; release_request() frees the
+ * payload it allocated.
+ */
+int app_object_send_request(int fd, const AppObjectContext *ctx);
+int app_object_recv_request(int fd, AppObjectRequest *out, AppObjectContext *ctx);
+void app_object_release_request(AppObjectRequest *request);
+int app_object_send_result(int fd, const AppObjectResult *result);
+int app_object_recv_result(int fd, AppObjectResult *result);
+
+/* Shared with the fork path in object.c. */
+int app_object_wait_readable(int fd, int timeout_ms);
+
+#endif /* SIGLATCH_SERVER_APP_OBJECT_WORKER_H */
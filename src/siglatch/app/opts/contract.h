@@ -15,6 +15,7 @@ typedef struct {
   int output_mode;
   char config_path[PATH_MAX];
   char server_name[MAX_SERVER_NAME];
+  char write_keyring_path[PATH_MAX];          ///< Set by --write-keyring; empty otherwise
 } AppOpts;
 
 #endif
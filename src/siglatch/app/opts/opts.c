@@ -16,7 +16,8 @@ enum {
   OPT_ID_DUMP_CONFIG,
   OPT_ID_OUTPUT_MODE,
   OPT_ID_CONFIG,
-  OPT_ID_SERVER
+  OPT_ID_SERVER,
+  OPT_ID_WRITE_KEYRING
 };
 
 static const ArgvOptionSpec app_opts_specs[] = {
@@ -26,6 +27,7 @@ static const ArgvOptionSpec app_opts_specs[] = {
   { "--output-mode", OPT_ID_OUTPUT_MODE, 1, ARGV_OPT_KEYED, 0, 1, 1 },
   { "--config", OPT_ID_CONFIG, 1, ARGV_OPT_KEYED, 0, 1, 1 },
   { "--server", OPT_ID_SERVER, 1, ARGV_OPT_KEYED, 0, 1, 1 },
+  { "--write-keyring", OPT_ID_WRITE_KEYRING, 1, ARGV_OPT_KEYED, 0, 1, 1 },
   { NULL, 0, 0, ARGV_OPT_FLAG, 0, 0, 0 }
 };
 
@@ -250,14 +252,36 @@ static int app_opts_copy_config_path(AppParsedOpts *out, const char *value) {
   return 1;
 }
 
+static int app_opts_copy_keyring_path(AppParsedOpts *out, const char *value) {
+  int written = 0;
+
+  if (!out || !value) {
+    return app_opts_set_error(out, 2, "Invalid --write-keyring value");
+  }
+
+  if (value[0] == '\0') {
+    return app_opts_set_error(out, 2, "Invalid --write-keyring value (empty)");
+  }
+
+  written = snprintf(out->values.write_keyring_path, sizeof(out->values.write_keyring_path),
+                     "%s", value);
+  if (written < 0 || (size_t)written >= sizeof(out->values.write_keyring_path)) {
+    return app_opts_set_error(out, 2, "Keyring path is too long");
+  }
+
+  return 1;
+}
+
 static int app_opts_parse(int argc, char *argv[], AppParsedOpts *out) {
   ArgvParsed parsed = {0};
   const ArgvParsedOption *output_mode_opt = NULL;
   const ArgvParsedOption *config_opt = NULL;
   const ArgvParsedOption *server_opt = NULL;
+  const ArgvParsedOption *keyring_opt = NULL;
   ArgvError parse_err = {0};
   const char *config_path = NULL;
   const char *server_name = NULL;
+  const char *keyring_path = NULL;
 
   if (!out) {
     return 0;
@@ -331,6 +355,18 @@ static int app_opts_parse(int argc, char *argv[], AppParsedOpts *out) {
     }
   }
 
+  keyring_opt = lib.argv.find_last_by_id(&parsed, OPT_ID_WRITE_KEYRING);
+  if (keyring_opt) {
+    if (!app_opts_reject_equals_form(out, keyring_opt, argc, argv)) {
+      return 0;
+    }
+
+    keyring_path = lib.argv.option_value ? lib.argv.option_value(keyring_opt, 0) : NULL;
+    if (!app_opts_copy_keyring_path(out, keyring_path)) {
+      return 0;
+    }
+  }
+
   out->ok = 1;
   out->exit_code = 0;
   out->values.dump_config_requested = lib.argv.has(&parsed, "--dump-config") ? 1 : 0;
@@ -357,6 +393,8 @@ static void app_opts_dump(const AppParsedOpts *parsed) {
                       parsed->values.config_path[0] ? parsed->values.config_path : "(default)");
   lib.print.uc_printf(NULL, "  Server Name      : %s\n",
                       parsed->values.server_name[0] ? parsed->values.server_name : "(unset)");
+  lib.print.uc_printf(NULL, "  Write Keyring    : %s\n",
+                      parsed->values.write_keyring_path[0] ? parsed->values.write_keyring_path : "(unset)");
 }
 
 static const AppOptsLib app_opts_instance = {
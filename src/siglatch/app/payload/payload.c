@@ -3,13 +3,25 @@
  * License: MTL-10 (see LICENSE.md)
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* memfd_create, F_ADD_SEALS */
+#endif
+
 #include "payload.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
+#include <signal.h>
+#include <sys/mman.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 
 #include "../../lib.h"
 
@@ -20,14 +32,65 @@ static int app_payload_parse_cmd(
     size_t cmd_size,
     char *arg,
     size_t arg_size);
-static pid_t app_payload_fork_exec(const char *cmd, char *const argv[], const char *run_as);
+static pid_t app_payload_fork_exec(const char *cmd,
+                                   char *const argv[],
+                                   const char *run_as,
+                                   int stdin_fd);
+static int app_payload_launch(const char *cmd,
+                              char *const argv[],
+                              const char *run_as,
+                              int stdin_fd,
+                              int timeout_ms,
+                              int *out_exit_code);
+static int app_payload_memfd_create(const char *name,
+                                    const uint8_t *buf,
+                                    size_t len,
+                                    int seal);
+static int app_payload_spawn_output(const char *exec_path,
+                                    char *const argv[],
+                                    const char *run_as,
+                                    int stdin_fd,
+                                    int output_fd,
+                                    int *out_handle,
+                                    pid_t *out_pid);
+static int app_payload_reap(pid_t pid, int zygote_handle, int timeout_ms, int *out_exit_code);
 static int app_payload_waitpid_exit_code(pid_t pid, int *out_exit_code);
+static int app_payload_wait_child(pid_t pid, int timeout_ms, int *out_exit_code);
+static int app_payload_reserve_detached(void);
+static void app_payload_track_detached(pid_t pid);
+static void app_payload_kill_child(pid_t pid, int timeout_ms);
 static int app_payload_run_shell_wait(
     const char *script_path,
     int argc,
     char *argv[],
     int exec_split,
     const char *run_as,
+    const uint8_t *input,
+    size_t input_len,
+    int timeout_ms,
+    int *out_exit_code);
+static int app_payload_spawn_shell_stdin(
+    const char *script_path,
+    int argc,
+    char *argv[],
+    int exec_split,
+    const char *run_as,
+    pid_t *out_pid,
+    int *out_handle,
+    int *out_stdin_fd);
+static int app_payload_try_reap(pid_t pid, int zygote_handle, int *out_exit_code);
+static int app_payload_run_shell_stream(
+    const char *script_path,
+    int argc,
+    char *argv[],
+    int exec_split,
+    const char *run_as,
+    const uint8_t *input,
+    size_t input_len,
+    int timeout_ms,
+    size_t chunk_max,
+    AppPayloadOutputFn on_output,
+    void *output_ctx,
     int *out_exit_code);
 
 static int app_payload_init(void) {
@@ -40,10 +103,17 @@ static int app_payload_init(void) {
     return 0;
   }
 
+  if (!app_payload_zygote_init()) {
+    app_payload_unstructured_shutdown();
+    app_payload_digest_shutdown();
+    return 0;
+  }
+
   return 1;
 }
 
 static void app_payload_shutdown(void) {
+  app_payload_zygote_shutdown();
   app_payload_unstructured_shutdown();
   app_payload_digest_shutdown();
 }
@@ -56,7 +126,6 @@ static int app_payload_run_shell(
     const char *run_as) {
   char *final_argv[argc + 3];
   int i = 0;
-  pid_t pid = -1;
 
   if (!script_path || argc < 1 || !argv || !argv[0]) {
     LOGE("[runShell] Invalid parameters\n");
@@ -83,23 +152,15 @@ static int app_payload_run_shell(
     }
 
     final_argv[i] = NULL;
-    pid = app_payload_fork_exec(cmd, final_argv, run_as);
-  } else {
-    final_argv[0] = (char *)script_path;
-    for (int j = 0; j < argc; ++j) {
-      final_argv[j + 1] = argv[j];
-    }
-    final_argv[argc + 1] = NULL;
-    pid = app_payload_fork_exec(script_path, final_argv, run_as);
+    return app_payload_launch(cmd, final_argv, run_as, -1, 0, NULL);
   }
 
-  if (pid > 0) {
-    LOGT("[runShell] Spawned child PID: %d\n", pid);
-    return 1;
-  } else {
-    LOGPERR("fork");
-    return 0;
+  final_argv[0] = (char *)script_path;
+  for (int j = 0; j < argc; ++j) {
+    final_argv[j + 1] = argv[j];
   }
+  final_argv[argc + 1] = NULL;
+  return app_payload_launch(script_path, final_argv, run_as, -1, 0, NULL);
 }
 
 static int app_payload_run_shell_wait(
@@ -108,10 +169,17 @@ static int app_payload_run_shell_wait(
     char *argv[],
     int exec_split,
     const char *run_as,
+    const uint8_t *input,
+    size_t input_len,
+    int timeout_ms,
     int *out_exit_code) {
   char *final_argv[argc + 3];
+  const char *exec_path = script_path;
+  char cmd[128] = {0};
+  char script[256] = {0};
+  int stdin_fd = -1;
+  int ok = 0;
   int i = 0;
-  pid_t pid = -1;
 
   if (!script_path || argc < 1 || !argv || !argv[0] || !out_exit_code) {
     LOGE("[runShellWait] Invalid parameters\n");
@@ -121,9 +189,6 @@ static int app_payload_run_shell_wait(
   *out_exit_code = 127;
 
   if (exec_split && strchr(script_path, ' ') != NULL) {
-    char cmd[128] = {0};
-    char script[256] = {0};
-
     if (!app_payload_parse_cmd(
             script_path, strlen(script_path), cmd, sizeof(cmd), script, sizeof(script))) {
       LOGE("[runShellWait] Failed to parse constructor: %s\n", script_path);
@@ -134,29 +199,29 @@ static int app_payload_run_shell_wait(
     if (script[0] != '\0' && strcmp(cmd, script) != 0) {
       final_argv[i++] = script;
     }
+    exec_path = cmd;
+  } else {
+    final_argv[i++] = (char *)script_path;
+  }
 
-    for (int j = 0; j < argc; ++j) {
-      final_argv[i++] = argv[j];
-    }
+  for (int j = 0; j < argc; ++j) {
+    final_argv[i++] = argv[j];
+  }
+  final_argv[i] = NULL;
 
-    final_argv[i] = NULL;
-    pid = app_payload_fork_exec(cmd, final_argv, run_as);
-  } else {
-    final_argv[0] = (char *)script_path;
-    for (int j = 0; j < argc; ++j) {
-      final_argv[j + 1] = argv[j];
+  if (input) {
+    stdin_fd = app_payload_memfd_create("siglatch-payload", input, input_len, 1);
+    if (stdin_fd < 0) {
+      LOGPERR("memfd_create");
+      return 0;
     }
-    final_argv[argc + 1] = NULL;
-    pid = app_payload_fork_exec(script_path, final_argv, run_as);
   }
 
-  if (pid < 0) {
-    LOGPERR("fork");
-    return 0;
+  ok = app_payload_launch(exec_path, final_argv, run_as, stdin_fd, timeout_ms, out_exit_code);
+  if (stdin_fd >= 0) {
+    close(stdin_fd);
   }
-
-  LOGT("[runShellWait] Spawned child PID: %d\n", pid);
-  return app_payload_waitpid_exit_code(pid, out_exit_code);
+  return ok;
 }
 
 static int app_payload_run_shell_capture(
@@ -165,15 +230,28 @@ static int app_payload_run_shell_capture(
     char *argv[],
     int exec_split,
     const char *run_as,
+    const uint8_t *input,
+    size_t input_len,
+    int timeout_ms,
     uint8_t *out_buf,
     size_t out_cap,
     size_t *out_len,
     int *out_exit_code) {
   char *final_argv[argc + 3];
+  char cmd[128] = {0};
+  char script[256] = {0};
+  const char *exec_path = script_path;
   int i = 0;
   pid_t pid = -1;
+  int handle = -1;
+  int spawned = 0;
   int pipefd[2] = {-1, -1};
+  int stdin_fd = -1;
+  int output_fd = -1;
+  int read_fd = -1;
   size_t captured_total = 0;
+  uint64_t deadline_ms = 0;
+  uint64_t now_ms = 0;
 
   if (!script_path || argc < 1 || !argv || !argv[0] || !out_buf || out_cap == 0u ||
       !out_len || !out_exit_code) {
@@ -184,20 +262,10 @@ static int app_payload_run_shell_capture(
   *out_len = 0u;
   *out_exit_code = 127;
 
-  if (pipe(pipefd) != 0) {
-    LOGPERR("pipe");
-    return 0;
-  }
-
   if (exec_split && strchr(script_path, ' ') != NULL) {
-    char cmd[128] = {0};
-    char script[256] = {0};
-
     if (!app_payload_parse_cmd(
             script_path, strlen(script_path), cmd, sizeof(cmd), script, sizeof(script))) {
       LOGE("[runShellCapture] Failed to parse constructor: %s\n", script_path);
-      close(pipefd[0]);
-      close(pipefd[1]);
       return 0;
     }
 
@@ -205,78 +273,113 @@ static int app_payload_run_shell_capture(
     if (script[0] != '\0' && strcmp(cmd, script) != 0) {
       final_argv[i++] = script;
     }
+    exec_path = cmd;
+  } else {
+    final_argv[i++] = (char *)script_path;
+  }
 
-    for (int j = 0; j < argc; ++j) {
-      final_argv[i++] = argv[j];
+  for (int j = 0; j < argc; ++j) {
+    final_argv[i++] = argv[j];
+  }
+  final_argv[i] = NULL;
+
+  /*
+   * With an input payload the child reads a sealed memfd on stdin and writes
+   * into a second memfd, so neither side copies through a pipe.
+   */
+  if (input) {
+    stdin_fd = app_payload_memfd_create("siglatch-payload", input, input_len, 1);
+    if (stdin_fd < 0) {
+      LOGPERR("memfd_create");
+      return 0;
     }
+    output_fd = app_payload_memfd_create("siglatch-output", NULL, 0u, 0);
+  }
 
-    final_argv[i] = NULL;
-    pid = fork();
-    if (pid == 0) {
-      if (run_as && run_as[0] != '\0') {
-        if (!lib.process.user.drop_to_name(run_as)) {
-          LOGE("[runShellCapture] Failed to drop privileges to user '%s'\n", run_as);
-          LOGPERR("drop_to_name");
-          _exit(126);
-        }
+  if (output_fd < 0) {
+    if (pipe(pipefd) != 0) {
+      LOGPERR("pipe");
+      if (stdin_fd >= 0) {
+        close(stdin_fd);
       }
+      return 0;
+    }
+    (void)fcntl(pipefd[0], F_SETFD, FD_CLOEXEC);
+    read_fd = pipefd[0];
+    output_fd = pipefd[1];
+  }
 
-      if (dup2(pipefd[1], STDOUT_FILENO) < 0 || dup2(pipefd[1], STDERR_FILENO) < 0) {
-        LOGPERR("dup2");
-        _exit(126);
-      }
+  spawned = app_payload_spawn_output(
+      exec_path, final_argv, run_as, stdin_fd, output_fd, &handle, &pid);
+
+  if (stdin_fd >= 0) {
+    close(stdin_fd);
+  }
 
-      close(pipefd[0]);
-      close(pipefd[1]);
-      execv(cmd, final_argv);
-      LOGPERR("execv");
-      _exit(127);
-    } else if (pid > 0) {
-      close(pipefd[1]);
+  if (read_fd < 0) {
+    /* memfd output: wait for exit, then read what the child left behind. */
+    if (spawned && !app_payload_reap(pid, handle, timeout_ms, out_exit_code)) {
+      spawned = 0;
     }
-  } else {
-    final_argv[0] = (char *)script_path;
-    for (int j = 0; j < argc; ++j) {
-      final_argv[j + 1] = argv[j];
-    }
-    final_argv[argc + 1] = NULL;
-    pid = fork();
-    if (pid == 0) {
-      if (run_as && run_as[0] != '\0') {
-        if (!lib.process.user.drop_to_name(run_as)) {
-          LOGE("[runShellCapture] Failed to drop privileges to user '%s'\n", run_as);
-          LOGPERR("drop_to_name");
-          _exit(126);
-        }
-      }
 
-      if (dup2(pipefd[1], STDOUT_FILENO) < 0 || dup2(pipefd[1], STDERR_FILENO) < 0) {
-        LOGPERR("dup2");
-        _exit(126);
+    while (spawned && captured_total < out_cap) {
+      ssize_t read_count = pread(output_fd,
+                                 out_buf + captured_total,
+                                 out_cap - captured_total,
+                                 (off_t)captured_total);
+      if (read_count < 0 && errno == EINTR) {
+        continue;
       }
+      if (read_count <= 0) {
+        break;
+      }
+      captured_total += (size_t)read_count;
+    }
 
-      close(pipefd[0]);
-      close(pipefd[1]);
-      execv(script_path, final_argv);
-      LOGPERR("execv");
-      _exit(127);
-    } else if (pid > 0) {
-      close(pipefd[1]);
+    close(output_fd);
+    if (!spawned) {
+      return 0;
     }
+
+    *out_len = captured_total;
+    return 1;
   }
 
-  if (pid < 0) {
-    LOGPERR("fork");
-    close(pipefd[0]);
-    if (pipefd[1] >= 0) {
-      close(pipefd[1]);
-    }
+  close(output_fd);
+
+  if (!spawned) {
+    close(read_fd);
     return 0;
   }
 
+  if (timeout_ms > 0) {
+    deadline_ms = lib.time.monotonic_ms() + (uint64_t)timeout_ms;
+  }
+
   while (1) {
     uint8_t chunk[256];
-    ssize_t read_count = read(pipefd[0], chunk, sizeof(chunk));
+    ssize_t read_count = 0;
+
+    /* A hung child must not hold the pipe open past its deadline. */
+    if (deadline_ms != 0u) {
+      struct pollfd pfd = {.fd = read_fd, .events = POLLIN, .revents = 0};
+      int ready = 0;
+
+      now_ms = lib.time.monotonic_ms();
+      ready = now_ms < deadline_ms ? poll(&pfd, 1, (int)(deadline_ms - now_ms)) : 0;
+      if (ready < 0 && errno == EINTR) {
+        continue;
+      }
+      if (ready == 0) {
+        if (pid > 0) {
+          app_payload_kill_child(pid, timeout_ms);
+        }
+        deadline_ms = 0u;
+        continue;
+      }
+    }
+
+    read_count = read(read_fd, chunk, sizeof(chunk));
 
     if (read_count < 0) {
       if (errno == EINTR) {
@@ -284,9 +387,8 @@ static int app_payload_run_shell_capture(
       }
 
       LOGPERR("read");
-      close(pipefd[0]);
-      while (waitpid(pid, NULL, 0) < 0 && errno == EINTR) {
-      }
+      close(read_fd);
+      (void)app_payload_reap(pid, handle, timeout_ms, out_exit_code);
       return 0;
     }
 
@@ -304,9 +406,9 @@ static int app_payload_run_shell_capture(
     }
   }
 
-  close(pipefd[0]);
+  close(read_fd);
 
-  if (!app_payload_waitpid_exit_code(pid, out_exit_code)) {
+  if (!app_payload_reap(pid, handle, timeout_ms, out_exit_code)) {
     return 0;
   }
 
@@ -314,6 +416,276 @@ static int app_payload_run_shell_capture(
   return 1;
 }
 
+/*
+ * Run a shell action and hand its stdout and stderr to on_output as they are
+ * produced.
+ *
+ * Output is read from a pipe and passed on in chunks of at most chunk_max
+ * bytes. A chunk is cut when it fills or when the pipe has nothing more ready,
+ * so slow writers are not held back and fast ones do not produce one call per
+ * write. If on_output fails, the rest of the output is read and discarded so
+ * the child is never blocked on a full pipe.
+ */
+static int app_payload_run_shell_stream(
+    const char *script_path,
+    int argc,
+    char *argv[],
+    int exec_split,
+    const char *run_as,
+    const uint8_t *input,
+    size_t input_len,
+    int timeout_ms,
+    size_t chunk_max,
+    AppPayloadOutputFn on_output,
+    void *output_ctx,
+    int *out_exit_code) {
+  char *final_argv[argc + 3];
+  char cmd[128] = {0};
+  char script[256] = {0};
+  uint8_t chunk[APP_PAYLOAD_STREAM_CHUNK_MAX];
+  const char *exec_path = script_path;
+  int i = 0;
+  pid_t pid = -1;
+  int handle = -1;
+  int pipefd[2] = {-1, -1};
+  int stdin_fd = -1;
+  int sink_ok = 1;
+  size_t filled = 0;
+  uint64_t deadline_ms = 0;
+  uint64_t now_ms = 0;
+
+  if (!script_path || argc < 1 || !argv || !argv[0] || chunk_max == 0u || !on_output ||
+      !out_exit_code) {
+    LOGE("[runShellStream] Invalid parameters\n");
+    return 0;
+  }
+
+  *out_exit_code = 127;
+  if (chunk_max > sizeof(chunk)) {
+    chunk_max = sizeof(chunk);
+  }
+
+  if (exec_split && strchr(script_path, ' ') != NULL) {
+    if (!app_payload_parse_cmd(
+            script_path, strlen(script_path), cmd, sizeof(cmd), script, sizeof(script))) {
+      LOGE("[runShellStream] Failed to parse constructor: %s\n", script_path);
+      return 0;
+    }
+
+    final_argv[i++] = cmd;
+    if (script[0] != '\0' && strcmp(cmd, script) != 0) {
+      final_argv[i++] = script;
+    }
+    exec_path = cmd;
+  } else {
+    final_argv[i++] = (char *)script_path;
+  }
+
+  for (int j = 0; j < argc; ++j) {
+    final_argv[i++] = argv[j];
+  }
+  final_argv[i] = NULL;
+
+  if (input) {
+    stdin_fd = app_payload_memfd_create("siglatch-payload", input, input_len, 1);
+    if (stdin_fd < 0) {
+      LOGPERR("memfd_create");
+      return 0;
+    }
+  }
+
+  if (pipe(pipefd) != 0) {
+    LOGPERR("pipe");
+    if (stdin_fd >= 0) {
+      close(stdin_fd);
+    }
+    return 0;
+  }
+  (void)fcntl(pipefd[0], F_SETFD, FD_CLOEXEC);
+
+  if (!app_payload_spawn_output(
+          exec_path, final_argv, run_as, stdin_fd, pipefd[1], &handle, &pid)) {
+    close(pipefd[0]);
+    close(pipefd[1]);
+    if (stdin_fd >= 0) {
+      close(stdin_fd);
+    }
+    return 0;
+  }
+
+  close(pipefd[1]);
+  if (stdin_fd >= 0) {
+    close(stdin_fd);
+  }
+
+  if (timeout_ms > 0) {
+    deadline_ms = lib.time.monotonic_ms() + (uint64_t)timeout_ms;
+  }
+
+  while (1) {
+    struct pollfd pfd = {.fd = pipefd[0], .events = POLLIN, .revents = 0};
+    ssize_t read_count = 0;
+    int wait_ms = -1;
+    int ready = 0;
+
+    now_ms = lib.time.monotonic_ms();
+    if (deadline_ms != 0u && now_ms >= deadline_ms) {
+      app_payload_kill_child(pid, timeout_ms);
+      deadline_ms = 0u;
+    }
+
+    if (filled > 0u) {
+      wait_ms = 0;
+    } else if (deadline_ms != 0u) {
+      wait_ms = (int)(deadline_ms - now_ms);
+    }
+
+    ready = poll(&pfd, 1, wait_ms);
+    if (ready < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOGPERR("poll");
+      break;
+    }
+
+    if (ready == 0) {
+      /* Nothing more ready: pass on what is buffered, or re-check the deadline. */
+      if (filled > 0u) {
+        if (sink_ok && !on_output(output_ctx, chunk, filled)) {
+          sink_ok = 0;
+        }
+        filled = 0u;
+      }
+      continue;
+    }
+
+    read_count = read(pipefd[0], chunk + filled, chunk_max - filled);
+    if (read_count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOGPERR("read");
+      break;
+    }
+
+    if (read_count == 0) {
+      break;
+    }
+
+    filled += (size_t)read_count;
+    if (filled == chunk_max) {
+      if (sink_ok && !on_output(output_ctx, chunk, filled)) {
+        sink_ok = 0;
+      }
+      filled = 0u;
+    }
+  }
+
+  if (filled > 0u && sink_ok) {
+    (void)on_output(output_ctx, chunk, filled);
+  }
+
+  close(pipefd[0]);
+  return app_payload_reap(pid, handle, timeout_ms, out_exit_code);
+}
+
+/*
+ * Spawn a shell action with its stdin attached to a pipe.
+ *
+ * The caller owns the returned write end, which is non-blocking and
+ * close-on-exec so later children do not hold the stream open. Closing it
+ * signals EOF to the action. The child comes from the zygote when it is up,
+ * with out_handle set to reap it through; otherwise it is forked here and
+ * out_handle is -1. Either way the caller reaps it with try_reap().
+ */
+static int app_payload_spawn_shell_stdin(
+    const char *script_path,
+    int argc,
+    char *argv[],
+    int exec_split,
+    const char *run_as,
+    pid_t *out_pid,
+    int *out_handle,
+    int *out_stdin_fd) {
+  char *final_argv[argc + 3];
+  char cmd[128] = {0};
+  char script[256] = {0};
+  const char *exec_path = script_path;
+  int i = 0;
+  pid_t pid = -1;
+  int handle = -1;
+  int spawned = 0;
+  int pipefd[2] = {-1, -1};
+  int flags = 0;
+
+  if (!script_path || argc < 1 || !argv || !argv[0] || !out_pid || !out_handle ||
+      !out_stdin_fd) {
+    LOGE("[runShellStdin] Invalid parameters\n");
+    return 0;
+  }
+
+  *out_pid = -1;
+  *out_handle = -1;
+  *out_stdin_fd = -1;
+
+  if (exec_split && strchr(script_path, ' ') != NULL) {
+    if (!app_payload_parse_cmd(
+            script_path, strlen(script_path), cmd, sizeof(cmd), script, sizeof(script))) {
+      LOGE("[runShellStdin] Failed to parse constructor: %s\n", script_path);
+      return 0;
+    }
+
+    final_argv[i++] = cmd;
+    if (script[0] != '\0' && strcmp(cmd, script) != 0) {
+      final_argv[i++] = script;
+    }
+    exec_path = cmd;
+  } else {
+    final_argv[i++] = (char *)script_path;
+  }
+
+  for (int j = 0; j < argc; ++j) {
+    final_argv[i++] = argv[j];
+  }
+  final_argv[i] = NULL;
+
+  if (pipe(pipefd) != 0) {
+    LOGPERR("pipe");
+    return 0;
+  }
+
+  flags = fcntl(pipefd[1], F_GETFL, 0);
+  if (flags < 0 || fcntl(pipefd[1], F_SETFL, flags | O_NONBLOCK) != 0 ||
+      fcntl(pipefd[1], F_SETFD, FD_CLOEXEC) != 0) {
+    LOGPERR("fcntl");
+    close(pipefd[0]);
+    close(pipefd[1]);
+    return 0;
+  }
+
+  spawned = app_payload_zygote_spawn(exec_path, final_argv, run_as, pipefd[0], -1, &handle, &pid);
+  if (spawned < 0) {
+    pid = app_payload_fork_exec(exec_path, final_argv, run_as, pipefd[0]);
+    spawned = pid > 0;
+    if (!spawned) {
+      LOGPERR("fork");
+    }
+  }
+
+  close(pipefd[0]);
+  if (!spawned) {
+    close(pipefd[1]);
+    return 0;
+  }
+
+  LOGT("[runShellStdin] Spawned child PID: %d\n", pid);
+  *out_pid = pid;
+  *out_handle = handle;
+  *out_stdin_fd = pipefd[1];
+  return 1;
+}
+
 static int app_payload_parse_cmd(
     const char *input,
     size_t input_len,
@@ -360,9 +732,235 @@ static int app_payload_parse_cmd(
   return 1;
 }
 
-static pid_t app_payload_fork_exec(const char *cmd, char *const argv[], const char *run_as) {
+/*
+ * Launch an action child through the zygote when it is up, falling back to a
+ * direct fork of the daemon. With out_exit_code the call waits for exit.
+ */
+static int app_payload_launch(const char *cmd,
+                              char *const argv[],
+                              const char *run_as,
+                              int stdin_fd,
+                              int timeout_ms,
+                              int *out_exit_code) {
+  int handle = -1;
+  int spawned = 0;
+  pid_t pid = -1;
+
+  spawned = app_payload_zygote_spawn(
+      cmd, argv, run_as, stdin_fd, -1, out_exit_code ? &handle : NULL, &pid);
+  if (spawned == 0) {
+    return 0;
+  }
+
+  if (spawned < 0) {
+    /* A detached child the tick cannot track is shed, not waited for. */
+    if (!out_exit_code && !app_payload_reserve_detached()) {
+      LOGW("[runShell] Too many detached children still running; not launching %s\n", cmd);
+      return 0;
+    }
+
+    pid = app_payload_fork_exec(cmd, argv, run_as, stdin_fd);
+    if (pid < 0) {
+      LOGPERR("fork");
+      if (!out_exit_code) {
+        app_payload_track_detached(-1);
+      }
+      return 0;
+    }
+    LOGT("[runShell] Spawned child PID: %d\n", pid);
+
+    if (!out_exit_code) {
+      app_payload_track_detached(pid);
+      return 1;
+    }
+  }
+
+  if (!out_exit_code) {
+    return 1;
+  }
+
+  return app_payload_reap(pid, handle, timeout_ms, out_exit_code);
+}
+
+/*
+ * Anonymous memory file for handing bytes to or from a child. With seal set
+ * the contents are written, rewound and sealed so the child sees exactly the
+ * payload and nothing can grow, shrink or rewrite it. Returns -1 where memfd
+ * is unavailable.
+ */
+static int app_payload_memfd_create(const char *name,
+                                    const uint8_t *buf,
+                                    size_t len,
+                                    int seal) {
+#if defined(__linux__) && defined(MFD_ALLOW_SEALING) && defined(F_ADD_SEALS)
+  size_t written_total = 0;
+  int fd = memfd_create(name, MFD_CLOEXEC | (seal ? MFD_ALLOW_SEALING : 0u));
+
+  if (fd < 0) {
+    return -1;
+  }
+
+  while (buf && written_total < len) {
+    ssize_t written = write(fd, buf + written_total, len - written_total);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      close(fd);
+      return -1;
+    }
+    written_total += (size_t)written;
+  }
+
+  if (lseek(fd, 0, SEEK_SET) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  if (seal &&
+      fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+#else
+  (void)name;
+  (void)buf;
+  (void)len;
+  (void)seal;
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+/* Collect the exit code from whichever side launched the child. */
+/*
+ * Start a child with stdout and stderr on output_fd, through the zygote when
+ * it is up and by forking here otherwise. Returns 1 once the child exists;
+ * out_handle is the zygote handle to reap with, or -1 for a direct child.
+ */
+static int app_payload_spawn_output(const char *exec_path,
+                                    char *const argv[],
+                                    const char *run_as,
+                                    int stdin_fd,
+                                    int output_fd,
+                                    int *out_handle,
+                                    pid_t *out_pid) {
+  pid_t pid = -1;
+  int spawned = 0;
+
+  *out_handle = -1;
+  *out_pid = -1;
+
+  spawned = app_payload_zygote_spawn(
+      exec_path, argv, run_as, stdin_fd, output_fd, out_handle, out_pid);
+  if (spawned >= 0) {
+    return spawned;
+  }
+
+  pid = fork();
+  if (pid == 0) {
+    (void)setpgid(0, 0);
+    if (run_as && run_as[0] != '\0') {
+      if (!lib.process.user.drop_to_name(run_as)) {
+        LOGE("[runShell] Failed to drop privileges to user '%s'\n", run_as);
+        LOGPERR("drop_to_name");
+        _exit(126);
+      }
+    }
+
+    if (stdin_fd >= 0 && dup2(stdin_fd, STDIN_FILENO) < 0) {
+      LOGPERR("dup2");
+      _exit(126);
+    }
+
+    if (dup2(output_fd, STDOUT_FILENO) < 0 || dup2(output_fd, STDERR_FILENO) < 0) {
+      LOGPERR("dup2");
+      _exit(126);
+    }
+
+    execv(exec_path, argv);
+    LOGPERR("execv");
+    _exit(127);
+  }
+
+  if (pid < 0) {
+    LOGPERR("fork");
+    return 0;
+  }
+
+  (void)setpgid(pid, pid);
+  *out_pid = pid;
+  return 1;
+}
+
+static int app_payload_reap(pid_t pid, int zygote_handle, int timeout_ms, int *out_exit_code) {
+  if (zygote_handle >= 0) {
+    return app_payload_zygote_wait(zygote_handle, pid, timeout_ms, out_exit_code);
+  }
+
+  return app_payload_wait_child(pid, timeout_ms, out_exit_code);
+}
+
+/*
+ * Collect a child's exit code without blocking. Returns 1 once it is gone,
+ * 0 while it still runs, and -1 if its status was lost. The zygote handle is
+ * consumed unless 0 is returned.
+ */
+static int app_payload_try_reap(pid_t pid, int zygote_handle, int *out_exit_code) {
+  int status = 0;
+  pid_t waited = -1;
+
+  if (!out_exit_code) {
+    return -1;
+  }
+
+  if (zygote_handle >= 0) {
+    struct pollfd pfd = {.fd = zygote_handle, .events = POLLIN, .revents = 0};
+
+    if (poll(&pfd, 1, 0) == 0) {
+      return 0;
+    }
+
+    return app_payload_zygote_wait(zygote_handle, pid, 0, out_exit_code) ? 1 : -1;
+  }
+
+  if (pid <= 0) {
+    return -1;
+  }
+
+  do {
+    waited = waitpid(pid, &status, WNOHANG);
+  } while (waited < 0 && errno == EINTR);
+
+  if (waited == 0) {
+    return 0;
+  }
+
+  if (waited != pid) {
+    LOGPERR("waitpid");
+    return -1;
+  }
+
+  if (WIFEXITED(status)) {
+    *out_exit_code = WEXITSTATUS(status);
+  } else if (WIFSIGNALED(status)) {
+    *out_exit_code = 128 + WTERMSIG(status);
+  } else {
+    *out_exit_code = 127;
+  }
+
+  return 1;
+}
+
+static pid_t app_payload_fork_exec(const char *cmd,
+                                   char *const argv[],
+                                   const char *run_as,
+                                   int stdin_fd) {
   pid_t pid = fork();
   if (pid == 0) {
+    (void)setpgid(0, 0);
     if (run_as && run_as[0] != '\0') {
       if (!lib.process.user.drop_to_name(run_as)) {
         LOGE("[runShell] Failed to drop privileges to user '%s'\n", run_as);
@@ -371,10 +969,16 @@ static pid_t app_payload_fork_exec(const char *cmd, char *const argv[], const ch
       }
     }
 
+    if (stdin_fd >= 0 && dup2(stdin_fd, STDIN_FILENO) < 0) {
+      LOGPERR("dup2");
+      _exit(126);
+    }
+
     execv(cmd, argv);
     LOGPERR("execv");
     _exit(127);
   } else if (pid > 0) {
+    (void)setpgid(pid, pid);
     return pid;
   } else {
     return -1;
@@ -412,12 +1016,173 @@ static int app_payload_waitpid_exit_code(pid_t pid, int *out_exit_code) {
   return 1;
 }
 
+static void app_payload_kill_child(pid_t pid, int timeout_ms) {
+  LOGW("[runShell] Child PID %d exceeded %d ms; killing\n", (int)pid, timeout_ms);
+  (void)kill(-pid, SIGKILL);
+  (void)kill(pid, SIGKILL);
+}
+
+/*
+ * waitpid with an optional wall-clock limit. Uses a pidfd where the kernel
+ * has one, otherwise polls with WNOHANG. A child that outlives timeout_ms has
+ * its process group killed and is then reaped normally.
+ */
+static int app_payload_wait_child(pid_t pid, int timeout_ms, int *out_exit_code) {
+  uint64_t deadline_ms = 0;
+  uint64_t now_ms = 0;
+  unsigned int sleep_us = 1000u;
+  int status = 0;
+  pid_t waited = -1;
+
+  if (timeout_ms <= 0) {
+    return app_payload_waitpid_exit_code(pid, out_exit_code);
+  }
+
+  if (pid <= 0 || !out_exit_code) {
+    return 0;
+  }
+
+#if defined(__linux__) && defined(SYS_pidfd_open)
+  {
+    int pidfd = (int)syscall(SYS_pidfd_open, pid, 0);
+
+    if (pidfd >= 0) {
+      struct pollfd pfd = {.fd = pidfd, .events = POLLIN, .revents = 0};
+      int ready = 0;
+
+      do {
+        ready = poll(&pfd, 1, timeout_ms);
+      } while (ready < 0 && errno == EINTR);
+      close(pidfd);
+
+      if (ready == 0) {
+        app_payload_kill_child(pid, timeout_ms);
+      }
+
+      return app_payload_waitpid_exit_code(pid, out_exit_code);
+    }
+  }
+#endif
+
+  deadline_ms = lib.time.monotonic_ms() + (uint64_t)timeout_ms;
+  for (;;) {
+    waited = waitpid(pid, &status, WNOHANG);
+    if (waited < 0 && errno == EINTR) {
+      continue;
+    }
+    if (waited != 0) {
+      break;
+    }
+
+    now_ms = lib.time.monotonic_ms();
+    if (now_ms >= deadline_ms) {
+      app_payload_kill_child(pid, timeout_ms);
+      return app_payload_waitpid_exit_code(pid, out_exit_code);
+    }
+
+    usleep(sleep_us);
+    if (sleep_us < 50000u) {
+      sleep_us *= 2u;
+    }
+  }
+
+  if (waited != pid) {
+    LOGPERR("waitpid");
+    return 0;
+  }
+
+  if (WIFEXITED(status)) {
+    *out_exit_code = WEXITSTATUS(status);
+  } else if (WIFSIGNALED(status)) {
+    *out_exit_code = 128 + WTERMSIG(status);
+  } else {
+    *out_exit_code = 127;
+  }
+
+  return 1;
+}
+
+/*
+ * Fire-and-forget children forked by the daemon itself are remembered here
+ * and reaped from the tick so they do not accumulate as zombies. Children
+ * launched through the zygote are reaped by the zygote.
+ */
+#define APP_PAYLOAD_DETACHED_MAX 64u
+
+static pthread_mutex_t g_app_payload_detached_lock = PTHREAD_MUTEX_INITIALIZER;
+static pid_t g_app_payload_detached[APP_PAYLOAD_DETACHED_MAX];
+static size_t g_app_payload_detached_count = 0u;
+static size_t g_app_payload_detached_reserved = 0u;
+
+/* Claim a table entry before forking; 0 when every entry is taken. */
+static int app_payload_reserve_detached(void) {
+  int ok = 0;
+
+  pthread_mutex_lock(&g_app_payload_detached_lock);
+  if (g_app_payload_detached_count + g_app_payload_detached_reserved < APP_PAYLOAD_DETACHED_MAX) {
+    g_app_payload_detached_reserved++;
+    ok = 1;
+  }
+  pthread_mutex_unlock(&g_app_payload_detached_lock);
+
+  return ok;
+}
+
+/* Fill a reserved entry with the forked pid, or release it when pid < 0. */
+static void app_payload_track_detached(pid_t pid) {
+  pthread_mutex_lock(&g_app_payload_detached_lock);
+  if (g_app_payload_detached_reserved > 0u) {
+    g_app_payload_detached_reserved--;
+  }
+  if (pid > 0) {
+    g_app_payload_detached[g_app_payload_detached_count++] = pid;
+  }
+  pthread_mutex_unlock(&g_app_payload_detached_lock);
+}
+
+/* Hand an already running child to the tick; 0 when the table is full. */
+static int app_payload_adopt_detached(pid_t pid) {
+  if (pid <= 0 || !app_payload_reserve_detached()) {
+    return 0;
+  }
+
+  app_payload_track_detached(pid);
+  return 1;
+}
+
+static size_t app_payload_reap_detached(void) {
+  size_t i = 0;
+  size_t reaped = 0;
+  pid_t waited = -1;
+
+  pthread_mutex_lock(&g_app_payload_detached_lock);
+  while (i < g_app_payload_detached_count) {
+    waited = waitpid(g_app_payload_detached[i], NULL, WNOHANG);
+    if (waited == 0 || (waited < 0 && errno == EINTR)) {
+      i++;
+      continue;
+    }
+
+    g_app_payload_detached[i] = g_app_payload_detached[--g_app_payload_detached_count];
+    reaped++;
+  }
+  pthread_mutex_unlock(&g_app_payload_detached_lock);
+
+  return reaped;
+}
+
 static const AppPayloadLib app_payload_instance = {
   .init = app_payload_init,
   .shutdown = app_payload_shutdown,
   .run_shell = app_payload_run_shell,
   .run_shell_wait = app_payload_run_shell_wait,
   .run_shell_capture = app_payload_run_shell_capture,
+  .run_shell_stream = app_payload_run_shell_stream,
+  .spawn_shell_stdin = app_payload_spawn_shell_stdin,
+  .try_reap = app_payload_try_reap,
+  .kill_child = app_payload_kill_child,
+  .adopt_detached = app_payload_adopt_detached,
+  .reap_detached = app_payload_reap_detached,
   .digest = {
     .init = app_payload_digest_init,
     .shutdown = app_payload_digest_shutdown,
@@ -433,7 +1198,21 @@ static const AppPayloadLib app_payload_instance = {
   .unstructured = {
     .init = app_payload_unstructured_init,
     .shutdown = app_payload_unstructured_shutdown,
+    .match = app_payload_unstructured_match,
+    .run = app_payload_unstructured_run,
     .handle = app_payload_unstructured_handle
+  },
+  .zygote = {
+    .init = app_payload_zygote_init,
+    .shutdown = app_payload_zygote_shutdown,
+    .start = app_payload_zygote_start,
+    .stop = app_payload_zygote_stop,
+    .is_running = app_payload_zygote_is_running,
+    .spawn = app_payload_zygote_spawn,
+    .set_object_runner = app_payload_zygote_set_object_runner,
+    .spawn_object = app_payload_zygote_spawn_object,
+    .wait = app_payload_zygote_wait,
+    .recycle = app_payload_zygote_recycle
   }
 };
 
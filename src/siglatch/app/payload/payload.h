@@ -6,29 +6,75 @@
 #ifndef SIGLATCH_SERVER_APP_PAYLOAD_H
 #define SIGLATCH_SERVER_APP_PAYLOAD_H
 
+#include <sys/types.h>
+
 #include "digest/digest.h"
 #include "reply.h"
 #include "unstructured.h"
+#include "zygote.h"
+
+#define APP_PAYLOAD_STREAM_CHUNK_MAX 512u
+
+/* Receives one chunk of a streamed action's output; return 0 to drop the rest. */
+typedef int (*AppPayloadOutputFn)(void *ctx, const uint8_t *data, size_t len);
 
+/*
+ * run_shell_wait/run_shell_capture: when input is non-NULL, the bytes are
+ * handed to the child as a sealed memfd on stdin (also reachable as
+ * /dev/stdin), and capture collects the child's stdout in a memfd instead of
+ * a pipe.
+ */
 typedef struct {
   int (*init)(void);
   void (*shutdown)(void);
   int (*run_shell)(const char *script_path, int argc, char *argv[], int exec_split,
                    const char *run_as);
   int (*run_shell_wait)(const char *script_path, int argc, char *argv[], int exec_split,
-                        const char *run_as, int *out_exit_code);
+                        const char *run_as, const uint8_t *input, size_t input_len,
+                        int timeout_ms, int *out_exit_code);
   int (*run_shell_capture)(const char *script_path,
                            int argc,
                            char *argv[],
                            int exec_split,
                            const char *run_as,
+                           const uint8_t *input,
+                           size_t input_len,
+                           int timeout_ms,
                            uint8_t *out_buf,
                            size_t out_cap,
                            size_t *out_len,
                            int *out_exit_code);
+  int (*run_shell_stream)(const char *script_path,
+                          int argc,
+                          char *argv[],
+                          int exec_split,
+                          const char *run_as,
+                          const uint8_t *input,
+                          size_t input_len,
+                          int timeout_ms,
+                          size_t chunk_max,
+                          AppPayloadOutputFn on_output,
+                          void *output_ctx,
+                          int *out_exit_code);
+  int (*spawn_shell_stdin)(const char *script_path,
+                           int argc,
+                           char *argv[],
+                           int exec_split,
+                           const char *run_as,
+                           pid_t *out_pid,
+                           int *out_handle,
+                           int *out_stdin_fd);
+  /* Non-blocking reap of a spawn_shell_stdin child: 1 exited, 0 running, -1 lost. */
+  int (*try_reap)(pid_t pid, int zygote_handle, int *out_exit_code);
+  /* SIGKILL a child's process group once it has outlived timeout_ms. */
+  void (*kill_child)(pid_t pid, int timeout_ms);
+  /* Leave a child the caller will not wait for to reap_detached(); 0 when full. */
+  int (*adopt_detached)(pid_t pid);
+  size_t (*reap_detached)(void);
   AppPayloadDigestLib digest;
   AppPayloadReplyLib reply;
   AppPayloadUnstructuredLib unstructured;
+  AppPayloadZygoteLib zygote;
 } AppPayloadLib;
 
 const AppPayloadLib *get_app_payload_lib(void);
@@ -12,6 +12,8 @@ typedef struct {
   int should_reply;
   int ok;
   int truncated;
+  int deferred;   /* Not finished yet; the request is retried on a later pass */
+  unsigned int chunk_count;  /* Streamed output packets sent ahead of this reply */
   char message[APP_ACTION_REPLY_MESSAGE_MAX];
 } AppActionReply;
 
@@ -29,45 +29,40 @@ int app_payload_unstructured_init(void) {
 void app_payload_unstructured_shutdown(void) {
 }
 
-void app_payload_unstructured_handle(
+/*
+ * Find the dead-drop a raw payload is addressed to. Unmatched payloads are
+ * logged and NULL is returned. The result points into the current config.
+ */
+const siglatch_deaddrop *app_payload_unstructured_match(
     const AppRuntimeListenerState *listener,
-    AppConnectionJob *job) {
+    const AppConnectionJob *job,
+    size_t *out_match_len) {
   const siglatch_deaddrop *deaddrop = NULL;
   char match[512] = {0};
   size_t match_len = 0;
-  char encrypted_str[8];
-  char empty_payload_b64[1] = {0};
-  char *payload_b64 = empty_payload_b64;
-  char *argv[5] = {0};
-  size_t payload_b64_size = 0;
-  size_t payload_tail_len = 0;
-  int shell_exit_code = 127;
   const uint8_t *payload = NULL;
   size_t payload_len = 0;
-  const char *ip_addr = NULL;
-  int payload_b64_allocated = 0;
 
   LOGD("[payload] [unstructured] processing unstructured data.\n");
 
-  if (!listener || !listener->server || !job) {
+  if (!listener || !listener->server || !job || !out_match_len) {
     LOGE("[payload] [unstructured] current server context is NULL; dropping packet.\n");
-    return;
+    return NULL;
   }
 
   payload = job->request.payload_buffer;
   payload_len = job->request.payload_len;
-  ip_addr = job->ip;
 
   if (payload_len > 0u && !payload) {
     LOGE("[payload] [unstructured] payload buffer is NULL for non-empty input\n");
-    return;
+    return NULL;
   }
 
   deaddrop = app.server.deaddrop_starts_with_buffer(
       listener->server, payload, payload_len, match, sizeof(match), &match_len);
   if (!deaddrop) {
     app_payload_unstructured_handle_invalid(payload, payload_len);
-    return;
+    return NULL;
   }
 
   if (deaddrop->require_ascii &&
@@ -75,25 +70,67 @@ void app_payload_unstructured_handle(
     LOGD("[payload] [unstructured] deaddrop matched to %s, but contains non ascii characters.\n",
          deaddrop->name);
     app_payload_unstructured_handle_invalid(payload, payload_len);
+    return NULL;
+  }
+
+  *out_match_len = match_len;
+  return deaddrop;
+}
+
+/*
+ * Run a matched dead-drop script and leave its raw output in the job's
+ * response buffer. Touches only the job and the dead-drop, so it may run on
+ * an executor worker with a private copy of the dead-drop.
+ */
+void app_payload_unstructured_run(
+    AppConnectionJob *job,
+    const siglatch_deaddrop *deaddrop,
+    size_t match_len,
+    int secure) {
+  char encrypted_str[8];
+  char empty_payload_b64[1] = {0};
+  char payload_stdin[] = "/dev/stdin";
+  char *payload_b64 = empty_payload_b64;
+  char *argv[5] = {0};
+  const uint8_t *input = NULL;
+  size_t payload_b64_size = 0;
+  size_t payload_tail_len = 0;
+  int shell_exit_code = 127;
+  const uint8_t *payload = NULL;
+  size_t payload_len = 0;
+  const char *ip_addr = NULL;
+
+  if (!job || !deaddrop) {
+    return;
+  }
+
+  payload = job->request.payload_buffer;
+  payload_len = job->request.payload_len;
+  ip_addr = job->ip;
+
+  if (match_len > payload_len) {
     return;
   }
 
-  snprintf(encrypted_str, sizeof(encrypted_str), "%d", listener->server->secure ? 1 : 0);
+  snprintf(encrypted_str, sizeof(encrypted_str), "%d", secure ? 1 : 0);
   payload_tail_len = payload_len - match_len;
-  if (payload_tail_len > 0u) {
+  if (deaddrop->payload_memfd) {
+    /* Raw body on stdin; the script reads /dev/stdin instead of base64. */
+    input = payload_tail_len > 0u ? payload + match_len : (const uint8_t *)"";
+    payload_b64 = payload_stdin;
+  } else if (payload_tail_len > 0u) {
     if (!app_payload_unstructured_base64_size(payload_tail_len, &payload_b64_size)) {
       LOGE("[payload] [unstructured] payload too large for base64 buffer (%zu bytes)\n",
            payload_tail_len);
       return;
     }
 
-    payload_b64 = (char *)malloc(payload_b64_size);
+    payload_b64 = (char *)lib.arena.alloc(job->arena, payload_b64_size);
     if (!payload_b64) {
       LOGE("[payload] [unstructured] failed to allocate base64 buffer for %zu bytes\n",
            payload_tail_len);
       return;
     }
-    payload_b64_allocated = 1;
 
     if (base64_encode(payload + match_len,
                       payload_tail_len,
@@ -101,7 +138,6 @@ void app_payload_unstructured_handle(
                       payload_b64_size) < 0) {
       LOGE("[payload] [unstructured] payload too large for base64 buffer (%zu bytes)\n",
            payload_tail_len);
-      free(payload_b64);
       return;
     }
   }
@@ -123,7 +159,7 @@ void app_payload_unstructured_handle(
   job->should_reply = 0;
   if (!app.daemon.job.reserve_response(job, APP_JOB_RESPONSE_BLOCK_SIZE)) {
     LOGE("[payload] [unstructured] failed to reserve response buffer for dead-drop output\n");
-    goto cleanup;
+    return;
   }
 
   memset(job->response_buffer, 0, job->response_cap);
@@ -133,6 +169,9 @@ void app_payload_unstructured_handle(
           argv,
           deaddrop->exec_split,
           deaddrop->run_as[0] ? deaddrop->run_as : NULL,
+          input,
+          input ? payload_tail_len : 0u,
+          deaddrop->timeout_ms,
           job->response_buffer,
           job->response_cap,
           &job->response_len,
@@ -141,18 +180,26 @@ void app_payload_unstructured_handle(
          deaddrop->name);
     job->response_len = 0u;
     job->should_reply = 0;
-    goto cleanup;
+    return;
   }
 
   if (job->response_len > 0u) {
     job->should_reply = 1;
-  } else {
   }
+}
 
-cleanup:
-  if (payload_b64_allocated) {
-    free(payload_b64);
+void app_payload_unstructured_handle(
+    const AppRuntimeListenerState *listener,
+    AppConnectionJob *job) {
+  const siglatch_deaddrop *deaddrop = NULL;
+  size_t match_len = 0;
+
+  deaddrop = app_payload_unstructured_match(listener, job, &match_len);
+  if (!deaddrop) {
+    return;
   }
+
+  app_payload_unstructured_run(job, deaddrop, match_len, listener->server->secure);
 }
 
 static void app_payload_unstructured_handle_invalid(
@@ -15,6 +15,15 @@
 typedef struct {
   int (*init)(void);
   void (*shutdown)(void);
+  const siglatch_deaddrop *(*match)(
+      const AppRuntimeListenerState *listener,
+      const AppConnectionJob *job,
+      size_t *out_match_len);
+  void (*run)(
+      AppConnectionJob *job,
+      const siglatch_deaddrop *deaddrop,
+      size_t match_len,
+      int secure);
   void (*handle)(
       const AppRuntimeListenerState *listener,
       AppConnectionJob *job);
@@ -22,6 +31,15 @@ typedef struct {
 
 int app_payload_unstructured_init(void);
 void app_payload_unstructured_shutdown(void);
+const siglatch_deaddrop *app_payload_unstructured_match(
+    const AppRuntimeListenerState *listener,
+    const AppConnectionJob *job,
+    size_t *out_match_len);
+void app_payload_unstructured_run(
+    AppConnectionJob *job,
+    const siglatch_deaddrop *deaddrop,
+    size_t match_len,
+    int secure);
 void app_payload_unstructured_handle(
     const AppRuntimeListenerState *listener,
     AppConnectionJob *job);
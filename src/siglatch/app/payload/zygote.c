@@ -0,0 +1,984 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "zygote.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../../lib.h"
+
+#define APP_PAYLOAD_ZYGOTE_MAGIC 0x5a594731u /* "ZYG1" */
+#define APP_PAYLOAD_ZYGOTE_FLAG_WAIT 0x1u
+#define APP_PAYLOAD_ZYGOTE_FLAG_STDOUT 0x2u
+#define APP_PAYLOAD_ZYGOTE_FLAG_RECYCLE 0x4u
+#define APP_PAYLOAD_ZYGOTE_FLAG_STDIN 0x8u
+#define APP_PAYLOAD_ZYGOTE_FLAG_OBJECT 0x10u
+#define APP_PAYLOAD_ZYGOTE_FD_MAX 3u
+
+#define APP_PAYLOAD_ZYGOTE_SPAWN_FAILED 0
+#define APP_PAYLOAD_ZYGOTE_SPAWN_OK 1
+#define APP_PAYLOAD_ZYGOTE_SPAWN_BUSY 2
+
+typedef struct {
+  uint32_t magic;
+  uint32_t flags;
+  uint32_t argc;
+  uint32_t body_len;
+} AppPayloadZygoteRequestHeader;
+
+typedef struct {
+  int32_t status;
+  int32_t exit_code;
+  int32_t pid;
+} AppPayloadZygoteReply;
+
+typedef struct {
+  pid_t pid;
+  int reply_fd;
+} AppPayloadZygoteWaiter;
+
+typedef struct {
+  pid_t pid;
+  int control_fd;
+} AppPayloadZygoteState;
+
+/* A zygote that already dropped to one run_as user. */
+typedef struct {
+  pid_t pid;
+  int control_fd;
+  char run_as[APP_PAYLOAD_ZYGOTE_RUN_AS_NAME_MAX];
+} AppPayloadZygoteRunAs;
+
+static AppPayloadZygoteState g_app_payload_zygote = {
+  .pid = -1,
+  .control_fd = -1
+};
+
+/* Zygote-side state; only meaningful inside the zygote process. */
+static int g_app_payload_zygote_chld_pipe[2] = {-1, -1};
+static AppPayloadZygoteRunAs g_app_payload_zygote_run_as[APP_PAYLOAD_ZYGOTE_RUN_AS_MAX];
+static int g_app_payload_zygote_dropped = 0;
+static int g_app_payload_zygote_draining = 0;
+/* Set before start() so the zygote inherits it. */
+static AppPayloadZygoteObjectFn g_app_payload_zygote_object_runner = NULL;
+
+static void app_payload_zygote_main(int control_fd);
+static int app_payload_zygote_sendmsg(int fd,
+                                      const void *buf,
+                                      size_t len,
+                                      const int *fds,
+                                      size_t fd_count);
+
+int app_payload_zygote_init(void) {
+  return 1;
+}
+
+void app_payload_zygote_shutdown(void) {
+  app_payload_zygote_stop();
+}
+
+/*
+ * Fork the zygote. Call this early, before config and keys are loaded, so the
+ * image it copies stays small; every action child forks from that image.
+ */
+int app_payload_zygote_start(void) {
+  int pair[2] = {-1, -1};
+  pid_t pid = -1;
+
+  if (g_app_payload_zygote.control_fd >= 0) {
+    return 1;
+  }
+
+  if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, pair) != 0) {
+    LOGW("[payload.zygote] socketpair unavailable; shell actions fork from the daemon\n");
+    return 0;
+  }
+
+  pid = fork();
+  if (pid < 0) {
+    LOGPERR("fork");
+    close(pair[0]);
+    close(pair[1]);
+    return 0;
+  }
+
+  if (pid == 0) {
+    close(pair[0]);
+    app_payload_zygote_main(pair[1]);
+    _exit(0);
+  }
+
+  close(pair[1]);
+  (void)fcntl(pair[0], F_SETFD, FD_CLOEXEC);
+
+  g_app_payload_zygote.pid = pid;
+  g_app_payload_zygote.control_fd = pair[0];
+  LOGD("[payload.zygote] Started zygote PID %d\n", (int)pid);
+  return 1;
+}
+
+void app_payload_zygote_stop(void) {
+  if (g_app_payload_zygote.control_fd >= 0) {
+    close(g_app_payload_zygote.control_fd);
+    g_app_payload_zygote.control_fd = -1;
+  }
+
+  if (g_app_payload_zygote.pid > 0) {
+    while (waitpid(g_app_payload_zygote.pid, NULL, 0) < 0 && errno == EINTR) {
+    }
+    g_app_payload_zygote.pid = -1;
+  }
+}
+
+int app_payload_zygote_is_running(void) {
+  return g_app_payload_zygote.control_fd >= 0;
+}
+
+static int app_payload_zygote_read_reply(int fd, AppPayloadZygoteReply *out_reply) {
+  ssize_t got = 0;
+
+  do {
+    got = recv(fd, out_reply, sizeof(*out_reply), 0);
+  } while (got < 0 && errno == EINTR);
+
+  return got == (ssize_t)sizeof(*out_reply);
+}
+
+static int app_payload_zygote_sendmsg(int fd,
+                                      const void *buf,
+                                      size_t len,
+                                      const int *fds,
+                                      size_t fd_count) {
+  union {
+    struct cmsghdr align;
+    char buf[CMSG_SPACE(sizeof(int) * APP_PAYLOAD_ZYGOTE_FD_MAX)];
+  } control;
+  struct iovec iov = {0};
+  struct msghdr msg = {0};
+  struct cmsghdr *cmsg = NULL;
+  ssize_t sent = 0;
+
+  if (fd < 0 || fd_count == 0u || fd_count > APP_PAYLOAD_ZYGOTE_FD_MAX) {
+    return 0;
+  }
+
+  memset(&control, 0, sizeof(control));
+  iov.iov_base = (void *)buf;
+  iov.iov_len = len;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = CMSG_SPACE(sizeof(int) * fd_count);
+  cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fd_count);
+  memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * fd_count);
+
+  do {
+    sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+  } while (sent < 0 && errno == EINTR);
+
+  return sent == (ssize_t)len;
+}
+
+/*
+ * Retire every per-user zygote. Each one finishes the children it is still
+ * waiting on and exits; the next request for that user starts a fresh one.
+ * Call this when the set of run_as users in the config changes.
+ */
+int app_payload_zygote_recycle(void) {
+  uint8_t message[sizeof(AppPayloadZygoteRequestHeader) + 2u] = {0};
+  AppPayloadZygoteRequestHeader header = {0};
+  AppPayloadZygoteReply reply = {0};
+  int pair[2] = {-1, -1};
+  int ok = 0;
+
+  if (g_app_payload_zygote.control_fd < 0) {
+    return 1;
+  }
+
+  header.magic = APP_PAYLOAD_ZYGOTE_MAGIC;
+  header.flags = APP_PAYLOAD_ZYGOTE_FLAG_RECYCLE;
+  header.argc = 0u;
+  header.body_len = 2u;
+  memcpy(message, &header, sizeof(header));
+
+  if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, pair) != 0) {
+    return 0;
+  }
+  (void)fcntl(pair[0], F_SETFD, FD_CLOEXEC);
+
+  ok = app_payload_zygote_sendmsg(
+      g_app_payload_zygote.control_fd, message, sizeof(message), &pair[1], 1u);
+  close(pair[1]);
+
+  if (ok) {
+    ok = app_payload_zygote_read_reply(pair[0], &reply) &&
+         reply.status == APP_PAYLOAD_ZYGOTE_SPAWN_OK;
+  }
+  close(pair[0]);
+
+  if (ok) {
+    LOGD("[payload.zygote] Recycled per-user zygotes\n");
+  } else {
+    LOGW("[payload.zygote] Failed to recycle per-user zygotes\n");
+  }
+
+  return ok;
+}
+
+static int app_payload_zygote_request(uint32_t flags,
+                                      const char *exec_path,
+                                      char *const argv[],
+                                      const char *run_as,
+                                      int stdin_fd,
+                                      int stdout_fd,
+                                      int *out_handle,
+                                      pid_t *out_pid) {
+  AppPayloadZygoteRequestHeader header = {0};
+  AppPayloadZygoteReply reply = {0};
+  const char *run_as_str = (run_as && run_as[0] != '\0') ? run_as : "";
+  uint8_t *message = NULL;
+  size_t body_len = 0;
+  size_t offset = 0;
+  size_t argc = 0;
+  size_t len = 0;
+  int pair[2] = {-1, -1};
+  int fds[APP_PAYLOAD_ZYGOTE_FD_MAX] = {-1, -1, -1};
+  size_t fd_count = 0;
+  int sent_ok = 0;
+
+  if (out_handle) {
+    *out_handle = -1;
+  }
+  if (out_pid) {
+    *out_pid = -1;
+  }
+
+  if (g_app_payload_zygote.control_fd < 0 || !exec_path || !argv) {
+    return -1;
+  }
+
+  body_len = strlen(exec_path) + 1u + strlen(run_as_str) + 1u;
+  for (argc = 0; argv[argc]; ++argc) {
+    if (argc >= APP_PAYLOAD_ZYGOTE_ARG_MAX) {
+      return -1;
+    }
+    len = strlen(argv[argc]) + 1u;
+    if (len > APP_PAYLOAD_ZYGOTE_REQUEST_MAX - body_len) {
+      return -1;
+    }
+    body_len += len;
+  }
+
+  if (body_len > APP_PAYLOAD_ZYGOTE_REQUEST_MAX - sizeof(header)) {
+    return -1;
+  }
+
+  message = (uint8_t *)malloc(sizeof(header) + body_len);
+  if (!message) {
+    return -1;
+  }
+
+  header.magic = APP_PAYLOAD_ZYGOTE_MAGIC;
+  header.flags = flags |
+                 (out_handle ? APP_PAYLOAD_ZYGOTE_FLAG_WAIT : 0u) |
+                 (stdout_fd >= 0 ? APP_PAYLOAD_ZYGOTE_FLAG_STDOUT : 0u) |
+                 (stdin_fd >= 0 ? APP_PAYLOAD_ZYGOTE_FLAG_STDIN : 0u);
+  header.argc = (uint32_t)argc;
+  header.body_len = (uint32_t)body_len;
+  memcpy(message, &header, sizeof(header));
+  offset = sizeof(header);
+
+  len = strlen(exec_path) + 1u;
+  memcpy(message + offset, exec_path, len);
+  offset += len;
+  len = strlen(run_as_str) + 1u;
+  memcpy(message + offset, run_as_str, len);
+  offset += len;
+  for (size_t i = 0; i < argc; ++i) {
+    len = strlen(argv[i]) + 1u;
+    memcpy(message + offset, argv[i], len);
+    offset += len;
+  }
+
+  /* Each request carries its own reply channel so workers never share one. */
+  if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, pair) != 0) {
+    free(message);
+    return -1;
+  }
+  (void)fcntl(pair[0], F_SETFD, FD_CLOEXEC);
+
+  fds[fd_count++] = pair[1];
+  if (stdout_fd >= 0) {
+    fds[fd_count++] = stdout_fd;
+  }
+  if (stdin_fd >= 0) {
+    fds[fd_count++] = stdin_fd;
+  }
+
+  sent_ok = app_payload_zygote_sendmsg(
+      g_app_payload_zygote.control_fd, message, offset, fds, fd_count);
+
+  free(message);
+  close(pair[1]);
+
+  if (!sent_ok) {
+    LOGW("[payload.zygote] Zygote unreachable; falling back to direct fork\n");
+    close(pair[0]);
+    return -1;
+  }
+
+  if (!app_payload_zygote_read_reply(pair[0], &reply)) {
+    LOGE("[payload.zygote] No spawn reply from zygote for %s\n",
+         exec_path[0] != '\0' ? exec_path : "object child");
+    close(pair[0]);
+    return 0;
+  }
+
+  if (reply.status == APP_PAYLOAD_ZYGOTE_SPAWN_BUSY) {
+    close(pair[0]);
+    return -1;
+  }
+
+  if (reply.status != APP_PAYLOAD_ZYGOTE_SPAWN_OK) {
+    close(pair[0]);
+    return 0;
+  }
+
+  LOGT("[payload.zygote] Zygote spawned child PID: %d\n", (int)reply.pid);
+
+  if (out_pid) {
+    *out_pid = (pid_t)reply.pid;
+  }
+
+  if (out_handle) {
+    *out_handle = pair[0];
+  } else {
+    close(pair[0]);
+  }
+
+  return 1;
+}
+
+int app_payload_zygote_spawn(const char *exec_path,
+                             char *const argv[],
+                             const char *run_as,
+                             int stdin_fd,
+                             int stdout_fd,
+                             int *out_handle,
+                             pid_t *out_pid) {
+  return app_payload_zygote_request(
+      0u, exec_path, argv, run_as, stdin_fd, stdout_fd, out_handle, out_pid);
+}
+
+void app_payload_zygote_set_object_runner(AppPayloadZygoteObjectFn runner) {
+  g_app_payload_zygote_object_runner = runner;
+}
+
+int app_payload_zygote_spawn_object(const char *run_as,
+                                    int io_fd,
+                                    int *out_handle,
+                                    pid_t *out_pid) {
+  char *argv[] = {NULL};
+
+  if (!g_app_payload_zygote_object_runner || io_fd < 0 || !out_handle) {
+    return -1;
+  }
+
+  return app_payload_zygote_request(
+      APP_PAYLOAD_ZYGOTE_FLAG_OBJECT, "", argv, run_as, io_fd, -1, out_handle, out_pid);
+}
+
+/*
+ * Wait for the exit status of a zygote child. With timeout_ms > 0 the child's
+ * process group is killed once the limit passes; the zygote still reaps it and
+ * reports 128 + SIGKILL.
+ */
+int app_payload_zygote_wait(int handle, pid_t pid, int timeout_ms, int *out_exit_code) {
+  AppPayloadZygoteReply reply = {0};
+  struct pollfd pfd = {0};
+  int ready = 0;
+  int ok = 0;
+
+  if (handle < 0 || !out_exit_code) {
+    return 0;
+  }
+
+  if (timeout_ms > 0) {
+    pfd.fd = handle;
+    pfd.events = POLLIN;
+
+    do {
+      ready = poll(&pfd, 1, timeout_ms);
+    } while (ready < 0 && errno == EINTR);
+
+    if (ready == 0 && pid > 0) {
+      LOGW("[payload.zygote] Child PID %d exceeded %d ms; killing\n", (int)pid, timeout_ms);
+      (void)kill(-pid, SIGKILL);
+      (void)kill(pid, SIGKILL);
+    }
+  }
+
+  ok = app_payload_zygote_read_reply(handle, &reply);
+  close(handle);
+
+  if (!ok) {
+    LOGE("[payload.zygote] Lost exit status from zygote\n");
+    return 0;
+  }
+
+  *out_exit_code = reply.exit_code;
+  return 1;
+}
+
+/* ---- zygote process ---------------------------------------------------- */
+
+static void app_payload_zygote_on_sigchld(int sig) {
+  int saved_errno = errno;
+  uint8_t one = 1u;
+  ssize_t rc = 0;
+
+  (void)sig;
+  rc = write(g_app_payload_zygote_chld_pipe[1], &one, sizeof(one));
+  (void)rc;
+  errno = saved_errno;
+}
+
+static void app_payload_zygote_send_reply(int fd, int32_t status, int32_t exit_code, pid_t pid) {
+  AppPayloadZygoteReply reply = {
+    .status = status,
+    .exit_code = exit_code,
+    .pid = (int32_t)pid
+  };
+
+  while (send(fd, &reply, sizeof(reply), MSG_NOSIGNAL) < 0 && errno == EINTR) {
+  }
+}
+
+static void app_payload_zygote_reap(AppPayloadZygoteWaiter *waiters) {
+  int status = 0;
+  int exit_code = 127;
+  pid_t pid = -1;
+  size_t i = 0;
+
+  while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+    if (WIFEXITED(status)) {
+      exit_code = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+      exit_code = 128 + WTERMSIG(status);
+    } else {
+      exit_code = 127;
+    }
+
+    for (i = 0; i < APP_PAYLOAD_ZYGOTE_RUN_AS_MAX; ++i) {
+      if (g_app_payload_zygote_run_as[i].pid == pid) {
+        if (g_app_payload_zygote_run_as[i].control_fd >= 0) {
+          close(g_app_payload_zygote_run_as[i].control_fd);
+        }
+        g_app_payload_zygote_run_as[i].pid = -1;
+        g_app_payload_zygote_run_as[i].control_fd = -1;
+        g_app_payload_zygote_run_as[i].run_as[0] = '\0';
+        break;
+      }
+    }
+
+    for (i = 0; i < APP_PAYLOAD_ZYGOTE_WAITER_MAX; ++i) {
+      if (waiters[i].pid == pid) {
+        app_payload_zygote_send_reply(
+            waiters[i].reply_fd, APP_PAYLOAD_ZYGOTE_SPAWN_OK, exit_code, pid);
+        close(waiters[i].reply_fd);
+        waiters[i].pid = -1;
+        waiters[i].reply_fd = -1;
+        break;
+      }
+    }
+  }
+}
+
+static int app_payload_zygote_waiters_pending(const AppPayloadZygoteWaiter *waiters) {
+  size_t i = 0;
+
+  for (i = 0; i < APP_PAYLOAD_ZYGOTE_WAITER_MAX; ++i) {
+    if (waiters[i].pid > 0) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static void app_payload_zygote_retire_run_as(AppPayloadZygoteRunAs *slot) {
+  if (slot->control_fd >= 0) {
+    close(slot->control_fd);
+    slot->control_fd = -1;
+  }
+  /* pid stays set until the exit is reaped. */
+  slot->run_as[0] = '\0';
+}
+
+/*
+ * Fork a zygote that drops to run_as once and then serves that user's
+ * requests. Blocks until the drop has succeeded or failed.
+ */
+static AppPayloadZygoteRunAs *app_payload_zygote_start_run_as(const char *run_as,
+                                                               int control_fd,
+                                                               AppPayloadZygoteWaiter *waiters,
+                                                               const int *request_fds,
+                                                               size_t request_fd_count) {
+  AppPayloadZygoteRunAs *slot = NULL;
+  int pair[2] = {-1, -1};
+  uint8_t ready = 0u;
+  ssize_t got = 0;
+  pid_t pid = -1;
+  size_t i = 0;
+
+  if (strlen(run_as) >= sizeof(slot->run_as)) {
+    return NULL;
+  }
+
+  for (i = 0; i < APP_PAYLOAD_ZYGOTE_RUN_AS_MAX; ++i) {
+    if (g_app_payload_zygote_run_as[i].pid < 0) {
+      slot = &g_app_payload_zygote_run_as[i];
+      break;
+    }
+  }
+
+  if (!slot || socketpair(AF_UNIX, SOCK_SEQPACKET, 0, pair) != 0) {
+    return NULL;
+  }
+
+  pid = fork();
+  if (pid < 0) {
+    close(pair[0]);
+    close(pair[1]);
+    return NULL;
+  }
+
+  if (pid == 0) {
+    close(pair[0]);
+    close(control_fd);
+    for (i = 0; i < request_fd_count; ++i) {
+      close(request_fds[i]);
+    }
+    close(g_app_payload_zygote_chld_pipe[0]);
+    close(g_app_payload_zygote_chld_pipe[1]);
+    for (i = 0; i < APP_PAYLOAD_ZYGOTE_WAITER_MAX; ++i) {
+      if (waiters[i].reply_fd >= 0) {
+        close(waiters[i].reply_fd);
+      }
+    }
+    for (i = 0; i < APP_PAYLOAD_ZYGOTE_RUN_AS_MAX; ++i) {
+      if (g_app_payload_zygote_run_as[i].control_fd >= 0) {
+        close(g_app_payload_zygote_run_as[i].control_fd);
+      }
+      g_app_payload_zygote_run_as[i].pid = -1;
+      g_app_payload_zygote_run_as[i].control_fd = -1;
+    }
+
+    if (!lib.process.user.drop_to_name(run_as)) {
+      LOGE("[payload.zygote] Failed to drop privileges to user '%s'\n", run_as);
+      LOGPERR("drop_to_name");
+      _exit(126);
+    }
+
+    g_app_payload_zygote_dropped = 1;
+    ready = 1u;
+    while (send(pair[1], &ready, sizeof(ready), MSG_NOSIGNAL) < 0 && errno == EINTR) {
+    }
+    app_payload_zygote_main(pair[1]);
+    _exit(0);
+  }
+
+  close(pair[1]);
+  (void)fcntl(pair[0], F_SETFD, FD_CLOEXEC);
+
+  slot->pid = pid;
+  slot->control_fd = pair[0];
+  lib.str.lcpy(slot->run_as, run_as, sizeof(slot->run_as));
+
+  do {
+    got = recv(pair[0], &ready, sizeof(ready), 0);
+  } while (got < 0 && errno == EINTR);
+
+  if (got != (ssize_t)sizeof(ready) || ready != 1u) {
+    app_payload_zygote_retire_run_as(slot);
+    return NULL;
+  }
+
+  LOGD("[payload.zygote] Started zygote PID %d for user '%s'\n", (int)pid, run_as);
+  return slot;
+}
+
+/*
+ * Hand a request to the zygote for its run_as user, starting one if needed.
+ * The reply and stdio fds travel with it, so that zygote answers the daemon
+ * directly. Returns 0 when the request should be served here instead.
+ */
+static int app_payload_zygote_forward(const char *run_as,
+                                      const uint8_t *message,
+                                      size_t len,
+                                      int control_fd,
+                                      AppPayloadZygoteWaiter *waiters,
+                                      const int *fds,
+                                      size_t fd_count) {
+  AppPayloadZygoteRunAs *slot = NULL;
+  size_t i = 0;
+
+  for (i = 0; i < APP_PAYLOAD_ZYGOTE_RUN_AS_MAX; ++i) {
+    if (g_app_payload_zygote_run_as[i].control_fd >= 0 &&
+        strcmp(g_app_payload_zygote_run_as[i].run_as, run_as) == 0) {
+      slot = &g_app_payload_zygote_run_as[i];
+      break;
+    }
+  }
+
+  if (slot && app_payload_zygote_sendmsg(slot->control_fd, message, len, fds, fd_count)) {
+    return 1;
+  }
+
+  if (slot) {
+    app_payload_zygote_retire_run_as(slot);
+  }
+
+  slot = app_payload_zygote_start_run_as(run_as, control_fd, waiters, fds, fd_count);
+  if (!slot) {
+    return 0;
+  }
+
+  return app_payload_zygote_sendmsg(slot->control_fd, message, len, fds, fd_count);
+}
+
+/* Common child setup: own process group, default signals, run_as. */
+static void app_payload_zygote_prepare_child(const char *run_as) {
+  sigset_t empty;
+
+  (void)setpgid(0, 0);
+  signal(SIGINT, SIG_DFL);
+  signal(SIGTERM, SIG_DFL);
+  signal(SIGPIPE, SIG_DFL);
+  signal(SIGCHLD, SIG_DFL);
+  sigemptyset(&empty);
+  sigprocmask(SIG_SETMASK, &empty, NULL);
+
+  if (run_as[0] != '\0' && !lib.process.user.drop_to_name(run_as)) {
+    LOGE("[runShell] Failed to drop privileges to user '%s'\n", run_as);
+    LOGPERR("drop_to_name");
+    _exit(126);
+  }
+}
+
+/*
+ * Object children do not exec: the runner set before start() serves one
+ * request on io_fd from this single-threaded image and the child exits.
+ */
+static void app_payload_zygote_object_child(const char *run_as, int io_fd) {
+  app_payload_zygote_prepare_child(run_as);
+  _exit(g_app_payload_zygote_object_runner(io_fd) ? 0 : 1);
+}
+
+static void app_payload_zygote_exec_child(const char *exec_path,
+                                          const char *run_as,
+                                          char *argv[],
+                                          int stdin_fd,
+                                          int stdout_fd) {
+  app_payload_zygote_prepare_child(run_as);
+
+  if (stdin_fd >= 0) {
+    if (dup2(stdin_fd, STDIN_FILENO) < 0) {
+      LOGPERR("dup2");
+      _exit(126);
+    }
+    close(stdin_fd);
+  }
+
+  if (stdout_fd >= 0) {
+    if (dup2(stdout_fd, STDOUT_FILENO) < 0 || dup2(stdout_fd, STDERR_FILENO) < 0) {
+      LOGPERR("dup2");
+      _exit(126);
+    }
+    close(stdout_fd);
+  }
+
+  execv(exec_path, argv);
+  LOGPERR("execv");
+  _exit(127);
+}
+
+static void app_payload_zygote_handle(int control_fd, AppPayloadZygoteWaiter *waiters) {
+  static uint8_t message[APP_PAYLOAD_ZYGOTE_REQUEST_MAX];
+  AppPayloadZygoteRequestHeader header = {0};
+  char *argv[APP_PAYLOAD_ZYGOTE_ARG_MAX + 1u] = {0};
+  const char *exec_path = NULL;
+  const char *run_as = NULL;
+  const char *cursor = NULL;
+  const char *end = NULL;
+  int fds[APP_PAYLOAD_ZYGOTE_FD_MAX] = {-1, -1, -1};
+  size_t fd_count = 0;
+  size_t fd_next = 1;
+  int reply_fd = -1;
+  int stdin_fd = -1;
+  int stdout_fd = -1;
+  AppPayloadZygoteWaiter *slot = NULL;
+  union {
+    struct cmsghdr align;
+    char buf[CMSG_SPACE(sizeof(int) * APP_PAYLOAD_ZYGOTE_FD_MAX)];
+  } control;
+  struct iovec iov = {0};
+  struct msghdr msg = {0};
+  struct cmsghdr *cmsg = NULL;
+  ssize_t got = 0;
+  pid_t pid = -1;
+  size_t i = 0;
+
+  iov.iov_base = message;
+  iov.iov_len = sizeof(message);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof(control.buf);
+
+  do {
+    got = recvmsg(control_fd, &msg, 0);
+  } while (got < 0 && errno == EINTR);
+
+  if (got <= 0) {
+    /*
+     * Our parent closed its end (or died). A per-user zygote may still owe
+     * exit statuses to the daemon, so it drains its waiters before leaving.
+     */
+    close(control_fd);
+    if (!g_app_payload_zygote_dropped || !app_payload_zygote_waiters_pending(waiters)) {
+      _exit(0);
+    }
+    g_app_payload_zygote_draining = 1;
+    return;
+  }
+
+  for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      fd_count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+      if (fd_count > APP_PAYLOAD_ZYGOTE_FD_MAX) {
+        fd_count = APP_PAYLOAD_ZYGOTE_FD_MAX;
+      }
+      memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * fd_count);
+    }
+  }
+
+  if (fd_count == 0u) {
+    return;
+  }
+
+  reply_fd = fds[0];
+  (void)fcntl(reply_fd, F_SETFD, FD_CLOEXEC);
+
+  if ((size_t)got < sizeof(header) || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC))) {
+    goto reject;
+  }
+
+  memcpy(&header, message, sizeof(header));
+  if (header.magic != APP_PAYLOAD_ZYGOTE_MAGIC ||
+      header.argc > APP_PAYLOAD_ZYGOTE_ARG_MAX ||
+      header.body_len != (size_t)got - sizeof(header)) {
+    goto reject;
+  }
+
+  if (header.flags & APP_PAYLOAD_ZYGOTE_FLAG_RECYCLE) {
+    for (i = 0; i < APP_PAYLOAD_ZYGOTE_RUN_AS_MAX; ++i) {
+      app_payload_zygote_retire_run_as(&g_app_payload_zygote_run_as[i]);
+    }
+    app_payload_zygote_send_reply(reply_fd, APP_PAYLOAD_ZYGOTE_SPAWN_OK, 0, -1);
+    goto done;
+  }
+
+  /* Extra fds follow the reply channel in flag order: stdout, then stdin. */
+  if (header.flags & APP_PAYLOAD_ZYGOTE_FLAG_STDOUT) {
+    if (fd_count <= fd_next) {
+      goto reject;
+    }
+    stdout_fd = fds[fd_next++];
+  }
+
+  if (header.flags & APP_PAYLOAD_ZYGOTE_FLAG_STDIN) {
+    if (fd_count <= fd_next) {
+      goto reject;
+    }
+    stdin_fd = fds[fd_next++];
+  }
+
+  if ((header.flags & APP_PAYLOAD_ZYGOTE_FLAG_OBJECT) &&
+      (stdin_fd < 0 || !g_app_payload_zygote_object_runner)) {
+    goto reject;
+  }
+
+  cursor = (const char *)message + sizeof(header);
+  end = (const char *)message + got;
+  if (end[-1] != '\0') {
+    goto reject;
+  }
+
+  exec_path = cursor;
+  cursor += strlen(cursor) + 1u;
+  if (cursor >= end) {
+    goto reject;
+  }
+  run_as = cursor;
+  cursor += strlen(cursor) + 1u;
+  for (i = 0; i < header.argc; ++i) {
+    if (cursor >= end) {
+      goto reject;
+    }
+    argv[i] = (char *)cursor;
+    cursor += strlen(cursor) + 1u;
+  }
+  argv[header.argc] = NULL;
+
+  if (run_as[0] != '\0') {
+    if (g_app_payload_zygote_dropped) {
+      /* Already running as the requested user. */
+      run_as = "";
+    } else if (app_payload_zygote_forward(
+                   run_as, message, (size_t)got, control_fd, waiters, fds, fd_count)) {
+      goto done;
+    }
+  }
+
+  if (header.flags & APP_PAYLOAD_ZYGOTE_FLAG_WAIT) {
+    for (i = 0; i < APP_PAYLOAD_ZYGOTE_WAITER_MAX; ++i) {
+      if (waiters[i].pid < 0) {
+        slot = &waiters[i];
+        break;
+      }
+    }
+
+    if (!slot) {
+      app_payload_zygote_send_reply(reply_fd, APP_PAYLOAD_ZYGOTE_SPAWN_BUSY, 127, -1);
+      goto done;
+    }
+  }
+
+  pid = fork();
+  if (pid == 0) {
+    close(control_fd);
+    close(reply_fd);
+    close(g_app_payload_zygote_chld_pipe[0]);
+    close(g_app_payload_zygote_chld_pipe[1]);
+    if (header.flags & APP_PAYLOAD_ZYGOTE_FLAG_OBJECT) {
+      app_payload_zygote_object_child(run_as, stdin_fd);
+    }
+    app_payload_zygote_exec_child(exec_path, run_as, argv, stdin_fd, stdout_fd);
+  }
+
+  if (pid < 0) {
+    app_payload_zygote_send_reply(reply_fd, APP_PAYLOAD_ZYGOTE_SPAWN_FAILED, 127, -1);
+    goto done;
+  }
+
+  (void)setpgid(pid, pid);
+
+  app_payload_zygote_send_reply(reply_fd, APP_PAYLOAD_ZYGOTE_SPAWN_OK, 0, pid);
+  if (slot) {
+    slot->pid = pid;
+    slot->reply_fd = reply_fd;
+    reply_fd = -1;
+  }
+  goto done;
+
+reject:
+  app_payload_zygote_send_reply(reply_fd, APP_PAYLOAD_ZYGOTE_SPAWN_FAILED, 127, -1);
+
+done:
+  if (reply_fd >= 0) {
+    close(reply_fd);
+  }
+  for (i = 1; i < fd_count; ++i) {
+    close(fds[i]);
+  }
+}
+
+/*
+ * Zygote loop. Interactive and termination signals are ignored here; the
+ * zygote exits when the daemon closes the control socket. Children restore
+ * default dispositions before exec.
+ */
+static void app_payload_zygote_main(int control_fd) {
+  AppPayloadZygoteWaiter waiters[APP_PAYLOAD_ZYGOTE_WAITER_MAX];
+  struct pollfd fds[2];
+  struct sigaction sa;
+  uint8_t sink[64];
+  size_t i = 0;
+
+  for (i = 0; i < APP_PAYLOAD_ZYGOTE_WAITER_MAX; ++i) {
+    waiters[i].pid = -1;
+    waiters[i].reply_fd = -1;
+  }
+
+  for (i = 0; i < APP_PAYLOAD_ZYGOTE_RUN_AS_MAX; ++i) {
+    g_app_payload_zygote_run_as[i].pid = -1;
+    g_app_payload_zygote_run_as[i].control_fd = -1;
+    g_app_payload_zygote_run_as[i].run_as[0] = '\0';
+  }
+
+  signal(SIGINT, SIG_IGN);
+  signal(SIGTERM, SIG_IGN);
+  signal(SIGPIPE, SIG_IGN);
+
+  if (pipe(g_app_payload_zygote_chld_pipe) != 0) {
+    _exit(1);
+  }
+  for (i = 0; i < 2u; ++i) {
+    int flags = fcntl(g_app_payload_zygote_chld_pipe[i], F_GETFL, 0);
+    (void)fcntl(g_app_payload_zygote_chld_pipe[i], F_SETFL, flags | O_NONBLOCK);
+    (void)fcntl(g_app_payload_zygote_chld_pipe[i], F_SETFD, FD_CLOEXEC);
+  }
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = app_payload_zygote_on_sigchld;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+  if (sigaction(SIGCHLD, &sa, NULL) != 0) {
+    _exit(1);
+  }
+
+  for (;;) {
+    fds[0].fd = g_app_payload_zygote_draining ? -1 : control_fd;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = g_app_payload_zygote_chld_pipe[0];
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      _exit(1);
+    }
+
+    if (fds[1].revents & POLLIN) {
+      while (read(g_app_payload_zygote_chld_pipe[0], sink, sizeof(sink)) > 0) {
+      }
+      app_payload_zygote_reap(waiters);
+      if (g_app_payload_zygote_draining && !app_payload_zygote_waiters_pending(waiters)) {
+        _exit(0);
+      }
+    }
+
+    if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+      app_payload_zygote_handle(control_fd, waiters);
+    }
+  }
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef SIGLATCH_SERVER_APP_PAYLOAD_ZYGOTE_H
+#define SIGLATCH_SERVER_APP_PAYLOAD_ZYGOTE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define APP_PAYLOAD_ZYGOTE_REQUEST_MAX (64u * 1024u)
+#define APP_PAYLOAD_ZYGOTE_ARG_MAX 32u
+#define APP_PAYLOAD_ZYGOTE_WAITER_MAX 128u
+#define APP_PAYLOAD_ZYGOTE_RUN_AS_MAX 16u
+#define APP_PAYLOAD_ZYGOTE_RUN_AS_NAME_MAX 64u
+
+/*
+ * Spawn helper forked from the daemon before config, keys and listener state
+ * exist. Shell actions are launched from this small image so exec latency no
+ * longer tracks daemon RSS.
+ *
+ * spawn() returns 1 when the child is running, 0 when the zygote tried and
+ * failed, and -1 when the zygote is unavailable and nothing was attempted; on
+ * -1 the caller should fork directly. When out_handle is non-NULL the zygote
+ * keeps the child and wait() must be called exactly once with the handle.
+ * Children lead their own process group so a timed-out wait() can kill the
+ * whole tree.
+ *
+ * Requests with run_as are routed to a second-level zygote that dropped to
+ * that user once, so a spawn costs one message instead of an NSS lookup plus
+ * initgroups/setgid/setuid. recycle() retires those zygotes after the config's
+ * run_as set changes.
+ *
+ * spawn_object() starts a child that runs the registered object runner on
+ * io_fd instead of exec-ing; out_handle is required. The runner must be set
+ * before start(), since the zygote only sees what it inherited.
+ */
+typedef int (*AppPayloadZygoteObjectFn)(int io_fd);
+
+typedef struct {
+  int (*init)(void);
+  void (*shutdown)(void);
+  int (*start)(void);
+  void (*stop)(void);
+  int (*is_running)(void);
+  int (*spawn)(const char *exec_path,
+               char *const argv[],
+               const char *run_as,
+               int stdin_fd,
+               int stdout_fd,
+               int *out_handle,
+               pid_t *out_pid);
+  void (*set_object_runner)(AppPayloadZygoteObjectFn runner);
+  int (*spawn_object)(const char *run_as, int io_fd, int *out_handle, pid_t *out_pid);
+  int (*wait)(int handle, pid_t pid, int timeout_ms, int *out_exit_code);
+  int (*recycle)(void);
+} AppPayloadZygoteLib;
+
+int app_payload_zygote_init(void);
+void app_payload_zygote_shutdown(void);
+int app_payload_zygote_start(void);
+void app_payload_zygote_stop(void);
+int app_payload_zygote_is_running(void);
+int app_payload_zygote_spawn(const char *exec_path,
+                             char *const argv[],
+                             const char *run_as,
+                             int stdin_fd,
+                             int stdout_fd,
+                             int *out_handle,
+                             pid_t *out_pid);
+void app_payload_zygote_set_object_runner(AppPayloadZygoteObjectFn runner);
+int app_payload_zygote_spawn_object(const char *run_as,
+                                    int io_fd,
+                                    int *out_handle,
+                                    pid_t *out_pid);
+int app_payload_zygote_wait(int handle, pid_t pid, int timeout_ms, int *out_exit_code);
+int app_payload_zygote_recycle(void);
+
+#endif
@@ -6,8 +6,10 @@
 #include "runtime.h"
 
 #include <openssl/evp.h>
+#include <pthread.h>
 #include <string.h>
 
+#include "watch.h"
 #include "../../../stdlib/openssl/session/session.h"
 #include "../app.h"
 #include "../../lib.h"
@@ -18,14 +20,63 @@ static int app_runtime_listener_binding_changed(const AppRuntimeListenerState *l
                                                 const siglatch_server *server);
 static int app_runtime_listener_same_port_ip_change(const AppRuntimeListenerState *listener,
                                                     const siglatch_server *server);
-static int app_runtime_sync_codec_context(const siglatch_config *cfg,
-                                          const siglatch_server *server);
+static int app_runtime_build_codec_context(const siglatch_config *cfg,
+                                           const siglatch_server *server,
+                                           SharedKnockCodecContext **out_context);
+static int app_runtime_install_codec_context(SharedKnockCodecContext *staged,
+                                             const siglatch_server *server);
+static int app_runtime_config_uses_run_as(const siglatch_config *cfg, const char *run_as);
+static int app_runtime_run_as_covered(const siglatch_config *from, const siglatch_config *to);
+static AppRuntimeReloadState app_runtime_reload_state(void);
+
+/* A snapshot built off the loop, waiting to be published. */
+typedef struct {
+  siglatch_config *config;
+  SharedKnockCodecContext *codec_context;
+  char target_name[MAX_SERVER_NAME];
+} AppRuntimeStagedConfig;
+
+/*
+ * One background reload at a time. The loop writes the request fields before
+ * starting the thread and reads staged only after state turns READY; both
+ * sides take the lock for state and staged.
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_t thread;
+  int thread_active;
+  int from_watch;                    /* Started by the file watcher, not a request */
+  AppRuntimeReloadState state;
+  char config_path[PATH_MAX];
+  char target_name[MAX_SERVER_NAME];
+  const siglatch_config *previous;   /* Live snapshot pinned for key reuse */
+  AppRuntimeStagedConfig staged;
+} AppRuntimeReloadJob;
+
+static AppRuntimeReloadJob g_app_runtime_reload = {
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+  .state = APP_RUNTIME_RELOAD_IDLE
+};
+
+static void app_runtime_reload_collect(AppRuntimeStagedConfig *out);
+static void app_runtime_discard_staged(AppRuntimeStagedConfig *staged);
 
 static int app_runtime_init(void) {
   return 1;
 }
 
 static void app_runtime_shutdown(void) {
+  AppRuntimeStagedConfig staged = {0};
+
+  app_runtime_watch_stop();
+
+  if (!g_app_runtime_reload.thread_active &&
+      app_runtime_reload_state() == APP_RUNTIME_RELOAD_IDLE) {
+    return;
+  }
+
+  app_runtime_reload_collect(&staged);
+  app_runtime_discard_staged(&staged);
 }
 
 static const char *app_runtime_listener_bind_ip(const AppRuntimeListenerState *listener) {
@@ -113,51 +164,38 @@ static void app_runtime_invalidate_config_borrows(
   session->hmac_key_len = 0;
 }
 
-static int app_runtime_sync_codec_context(const siglatch_config *cfg,
-                                          const siglatch_server *server) {
+/*
+ * Build a codec context for server and cfg's enabled users. It shares no
+ * state with the live context, so the reload thread can fill it while the
+ * loop keeps decoding with the current one.
+ */
+static int app_runtime_build_codec_context(const siglatch_config *cfg,
+                                           const siglatch_server *server,
+                                           SharedKnockCodecContext **out_context) {
   const SharedKnockCodecContextLib *codec_context_lib = NULL;
-  AppWorkspace *workspace = NULL;
-  M7MuxContext m7mux_ctx = {0};
+  SharedKnockCodecContext *context = NULL;
   size_t i = 0;
 
-  if (!cfg || !server) {
+  if (!cfg || !server || !out_context) {
     return 0;
   }
 
-  workspace = app.workspace.get();
-  if (!workspace) {
-    LOGE("Workspace unavailable during config reload\n");
-    return 0;
-  }
+  *out_context = NULL;
 
   codec_context_lib = get_shared_knock_codec_context_lib();
-  if (!codec_context_lib || !codec_context_lib->set_server_key ||
-      !codec_context_lib->clear_server_key || !codec_context_lib->add_keychain ||
-      !codec_context_lib->remove_keychain || !codec_context_lib->set_openssl_session ||
-      !codec_context_lib->clear_openssl_session) {
+  if (!codec_context_lib || !codec_context_lib->create || !codec_context_lib->destroy ||
+      !codec_context_lib->set_server_key || !codec_context_lib->add_keychain) {
     LOGE("Codec context builder unavailable during config reload\n");
     return 0;
   }
 
-  if (!workspace->codec_context) {
-    if (!codec_context_lib->create(&workspace->codec_context)) {
-      LOGE("Failed to create workspace codec context during config reload\n");
-      return 0;
-    }
+  if (!codec_context_lib->create(&context)) {
+    LOGE("Failed to create staged codec context during config reload\n");
+    return 0;
   }
 
-  codec_context_lib->clear_server_key(workspace->codec_context);
-  workspace->codec_context->server_secure = server->secure ? 1 : 0;
-  workspace->codec_context->nonce_window_ms = (uint64_t)NONCE_DEFAULT_TTL_SECONDS * 1000u;
-
-  while (workspace->codec_context->keychain_len > 0u) {
-    const char *name = workspace->codec_context->keychain[0].name;
-
-    if (!name || !codec_context_lib->remove_keychain(workspace->codec_context, name)) {
-      LOGE("Failed to clear codec keychain entry during config reload\n");
-      return 0;
-    }
-  }
+  context->server_secure = server->secure ? 1 : 0;
+  context->nonce_window_ms = (uint64_t)NONCE_DEFAULT_TTL_SECONDS * 1000u;
 
   if (server->secure && server->priv_key) {
     SharedKnockCodecServerKey server_key = {0};
@@ -165,9 +203,10 @@ static int app_runtime_sync_codec_context(const siglatch_config *cfg,
     server_key.name = server->name;
     server_key.private_key = server->priv_key;
 
-    if (!codec_context_lib->set_server_key(workspace->codec_context, &server_key)) {
+    if (!codec_context_lib->set_server_key(context, &server_key)) {
       LOGE("Failed to install codec server key for '%s' during config reload\n",
            server->name);
+      codec_context_lib->destroy(context);
       return 0;
     }
   }
@@ -182,95 +221,272 @@ static int app_runtime_sync_codec_context(const siglatch_config *cfg,
 
     entry.name = user->name;
     entry.user_id = user->id;
-    entry.public_key = user->pubkey;
+    /* Warm threads may still be publishing keys of the config being restored. */
+    entry.public_key = __atomic_load_n(&user->pubkey, __ATOMIC_ACQUIRE);
     entry.private_key = NULL;
     entry.hmac_key = user->hmac_key;
     entry.hmac_key_len = sizeof(user->hmac_key);
 
-    if (!codec_context_lib->add_keychain(workspace->codec_context, &entry)) {
+    if (!codec_context_lib->add_keychain(context, &entry)) {
       LOGE("Failed to add codec keychain entry for user '%s' during config reload\n",
            user->name);
+      codec_context_lib->destroy(context);
       return 0;
     }
   }
 
+  *out_context = context;
+  return 1;
+}
+
+/*
+ * Codecs borrow the workspace context by address, so a reload trades
+ * contents rather than pointers. The live session stays with the live
+ * context; calling this twice puts everything back.
+ */
+static void app_runtime_exchange_codec_context(SharedKnockCodecContext *live,
+                                               SharedKnockCodecContext *staged) {
+  SharedKnockCodecContext previous = *live;
+
+  *live = *staged;
+  live->openssl_session = previous.openssl_session;
+  live->active_key_name = NULL;
+
+  *staged = previous;
+  staged->openssl_session = NULL;
+  staged->active_key_name = NULL;
+}
+
+/* On success staged holds the retired keychain for the caller to destroy. */
+static int app_runtime_install_codec_context(SharedKnockCodecContext *staged,
+                                             const siglatch_server *server) {
+  AppWorkspace *workspace = NULL;
+  M7MuxContext m7mux_ctx = {0};
+
+  if (!staged || !server) {
+    return 0;
+  }
+
+  workspace = app.workspace.get();
+  if (!workspace || !workspace->codec_context) {
+    LOGE("Workspace codec context unavailable during config reload\n");
+    return 0;
+  }
+
+  app_runtime_exchange_codec_context(workspace->codec_context, staged);
+
   m7mux_ctx.socket = &lib.net.socket;
   m7mux_ctx.udp = &lib.net.udp;
   m7mux_ctx.time = &lib.time;
   m7mux_ctx.codec_context = workspace->codec_context;
   m7mux_ctx.enforce_wire_decode = server->enforce_wire_decode;
   m7mux_ctx.enforce_wire_auth = server->enforce_wire_auth;
+  m7mux_ctx.reply_cache_ms = (uint64_t)server->reply_cache_ms;
+  m7mux_ctx.rate_limit.rate = (uint32_t)server->rate_limit;
+  m7mux_ctx.rate_limit.burst = (uint32_t)server->rate_limit_burst;
+  m7mux_ctx.rate_limit.prefix_v4 = (uint8_t)server->rate_limit_prefix_v4;
+  m7mux_ctx.rate_limit.prefix_v6 = (uint8_t)server->rate_limit_prefix_v6;
+  m7mux_ctx.overload_high_water = (uint32_t)server->overload_high_water;
 
   if (!lib.m7mux.set_context(&m7mux_ctx)) {
     LOGE("Failed to install codec context into m7mux during config reload\n");
+    app_runtime_exchange_codec_context(workspace->codec_context, staged);
     return 0;
   }
 
   return 1;
 }
 
-static int app_runtime_reload_config(
-    AppRuntimeListenerState *listener,
-    SiglatchOpenSSLSession *session,
-    const char *config_path,
-    const char *server_name) {
-  char current_name[MAX_SERVER_NAME] = {0};
-  char target_name[MAX_SERVER_NAME] = {0};
-  siglatch_config *new_cfg = NULL;
-  siglatch_config *old_cfg = NULL;
-  const siglatch_server *selected_server = NULL;
-  const siglatch_server *restored_server = NULL;
-  SiglatchOpenSSLSession staged_session = {0};
-  int binding_changed = 0;
+static int app_runtime_config_uses_run_as(const siglatch_config *cfg, const char *run_as) {
+  int i = 0;
 
-  if (!listener || !session || !config_path || config_path[0] == '\0') {
-    return 0;
+  for (i = 0; i < cfg->action_count; ++i) {
+    if (strcmp(cfg->actions[i].run_as, run_as) == 0) {
+      return 1;
+    }
   }
 
-  if (listener->server && listener->server->name[0] != '\0') {
-    lib.str.lcpy(current_name, listener->server->name, sizeof(current_name));
+  for (i = 0; i < cfg->deaddrop_count; ++i) {
+    if (strcmp(cfg->deaddrops[i].run_as, run_as) == 0) {
+      return 1;
+    }
   }
 
+  return 0;
+}
+
+/* True when every run_as user named in from is also named in to. */
+static int app_runtime_run_as_covered(const siglatch_config *from, const siglatch_config *to) {
+  int i = 0;
+
+  for (i = 0; i < from->action_count; ++i) {
+    if (from->actions[i].run_as[0] != '\0' &&
+        !app_runtime_config_uses_run_as(to, from->actions[i].run_as)) {
+      return 0;
+    }
+  }
+
+  for (i = 0; i < from->deaddrop_count; ++i) {
+    if (from->deaddrops[i].run_as[0] != '\0' &&
+        !app_runtime_config_uses_run_as(to, from->deaddrops[i].run_as)) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+static void app_runtime_discard_staged(AppRuntimeStagedConfig *staged) {
+  if (!staged) {
+    return;
+  }
+
+  if (staged->codec_context) {
+    get_shared_knock_codec_context_lib()->destroy(staged->codec_context);
+    staged->codec_context = NULL;
+  }
+
+  if (staged->config) {
+    app.config.destroy(staged->config);
+    staged->config = NULL;
+  }
+}
+
+static int app_runtime_resolve_target(const AppRuntimeListenerState *listener,
+                                      const char *server_name,
+                                      char *target_name,
+                                      size_t target_size) {
   if (server_name && server_name[0] != '\0') {
-    lib.str.lcpy(target_name, server_name, sizeof(target_name));
-  } else if (current_name[0] != '\0') {
-    lib.str.lcpy(target_name, current_name, sizeof(target_name));
-  } else {
-    LOGE("Cannot reload config: no selected server name available\n");
-    return 0;
+    lib.str.lcpy(target_name, server_name, target_size);
+    return 1;
+  }
+
+  if (listener && listener->server && listener->server->name[0] != '\0') {
+    lib.str.lcpy(target_name, listener->server->name, target_size);
+    return 1;
   }
 
+  LOGE("Cannot reload config: no selected server name available\n");
+  return 0;
+}
+
+/*
+ * Everything that scales with the config: parse, key loading, a trial
+ * session for the selected server and the codec keychain. Touches no live
+ * state, so it runs on the reload thread. Keys whose files are unchanged
+ * since previous was loaded are shared from it rather than parsed again.
+ */
+static int app_runtime_stage_config(const char *config_path,
+                                    const char *target_name,
+                                    const siglatch_config *previous,
+                                    AppRuntimeStagedConfig *out) {
+  const siglatch_server *selected_server = NULL;
+  SiglatchOpenSSLSession staged_session = {0};
+
+  memset(out, 0, sizeof(*out));
+  lib.str.lcpy(out->target_name, target_name, sizeof(out->target_name));
+
   /*
    * Stage the next config first so the live runtime stays untouched unless
    * the new config parses, loads keys, and still contains a usable selected
    * server.
    */
-  if (!app.config.load_detached(config_path, &new_cfg)) {
+  if (!app.config.load_detached_reusing(config_path, previous, &out->config)) {
     LOGE("Failed to reload config from %s\n", config_path);
     return 0;
   }
 
-  selected_server = app.config.server_by_name_from(new_cfg, target_name);
+  selected_server = app.config.server_by_name_from(out->config, target_name);
   if (!selected_server || !selected_server->enabled) {
     LOGE("Reloaded config does not contain an enabled server named '%s'\n", target_name);
-    app.config.destroy(new_cfg);
+    app_runtime_discard_staged(out);
     return 0;
   }
 
   if (!app.inbound.crypto.init_session_for_server(selected_server, &staged_session)) {
     LOGE("Reloaded config could not initialize a session for server '%s'\n", target_name);
     app.runtime.invalidate_config_borrows(NULL, &staged_session);
-    app.config.destroy(new_cfg);
+    app_runtime_discard_staged(out);
     return 0;
   }
   app.runtime.invalidate_config_borrows(NULL, &staged_session);
 
+  if (!app_runtime_build_codec_context(out->config, selected_server, &out->codec_context)) {
+    app_runtime_discard_staged(out);
+    return 0;
+  }
+
+  return 1;
+}
+
+/* Put the previous snapshot back after a failed commit and drop the new one. */
+static void app_runtime_restore_previous(AppRuntimeListenerState *listener,
+                                         SiglatchOpenSSLSession *session,
+                                         siglatch_config *old_cfg,
+                                         const char *current_name,
+                                         const char *failure) {
+  const siglatch_server *restored_server = NULL;
+  siglatch_config *new_cfg = NULL;
+
+  app.runtime.invalidate_config_borrows(listener, session);
+
+  new_cfg = app.config.detach();
+  if (old_cfg) {
+    app.config.attach(old_cfg);
+  }
+
+  if (new_cfg) {
+    app.config.destroy(new_cfg);
+  }
+
+  if (current_name[0] != '\0') {
+    restored_server = app.config.server_by_name(current_name);
+  }
+
+  if (restored_server &&
+      app.inbound.crypto.init_session_for_server(restored_server, session)) {
+    listener->server = restored_server;
+  } else {
+    app.runtime.invalidate_config_borrows(listener, session);
+    LOGE("Failed to restore previous runtime bindings after %s\n", failure);
+  }
+}
+
+/*
+ * Publish a staged snapshot. Only cheap, per-server steps remain here: bind
+ * checks, the server session, and swapping the prebuilt codec keychain in.
+ * Takes ownership of staged whatever the outcome.
+ */
+static int app_runtime_commit_staged(AppRuntimeListenerState *listener,
+                                     SiglatchOpenSSLSession *session,
+                                     AppRuntimeStagedConfig *staged) {
+  char current_name[MAX_SERVER_NAME] = {0};
+  siglatch_config *new_cfg = NULL;
+  siglatch_config *old_cfg = NULL;
+  const siglatch_server *selected_server = NULL;
+  int binding_changed = 0;
+
+  if (!listener || !session || !staged->config || !staged->codec_context) {
+    app_runtime_discard_staged(staged);
+    return 0;
+  }
+
+  if (listener->server && listener->server->name[0] != '\0') {
+    lib.str.lcpy(current_name, listener->server->name, sizeof(current_name));
+  }
+
+  selected_server = app.config.server_by_name_from(staged->config, staged->target_name);
+  if (!selected_server) {
+    app_runtime_discard_staged(staged);
+    return 0;
+  }
+
   binding_changed = app_runtime_listener_binding_changed(listener, selected_server);
   if (binding_changed) {
     if (app_runtime_listener_same_port_ip_change(listener, selected_server)) {
       LOGE("Hot reload cannot safely change bind_ip on the same port (%d) while the current listener is live; use rebind_listener or restart\n",
            selected_server->port);
-      app.config.destroy(new_cfg);
+      app_runtime_discard_staged(staged);
       return 0;
     }
 
@@ -278,123 +494,264 @@ static int app_runtime_reload_config(
       LOGE("Reloaded config failed listener bind validation for %s:%d\n",
            selected_server->bind_ip[0] != '\0' ? selected_server->bind_ip : "0.0.0.0",
            selected_server->port);
-      app.config.destroy(new_cfg);
+      app_runtime_discard_staged(staged);
       return 0;
     }
   }
 
+  new_cfg = staged->config;
+  staged->config = NULL;
+
   old_cfg = app.config.detach();
   app.runtime.invalidate_config_borrows(listener, session);
   app.config.attach(new_cfg);
-  listener->server = app.config.server_by_name(target_name);
+  listener->server = app.config.server_by_name(staged->target_name);
 
   if (!app.inbound.crypto.init_session_for_server(listener->server, session)) {
     LOGE("Failed to rebuild server session after config reload\n");
+    app_runtime_restore_previous(listener, session, old_cfg, current_name,
+                                 "config reload failure");
+    app_runtime_discard_staged(staged);
+    return 0;
+  }
 
-    app.runtime.invalidate_config_borrows(listener, session);
+  if (binding_changed && !app.udp.rebind_listener(listener, listener->server)) {
+    LOGE("Failed to apply listener rebind after config reload\n");
+    app_runtime_restore_previous(listener, session, old_cfg, current_name,
+                                 "rebind failure");
+    app_runtime_discard_staged(staged);
+    return 0;
+  }
 
-    new_cfg = app.config.detach();
-    if (old_cfg) {
-      app.config.attach(old_cfg);
-      old_cfg = NULL;
-    }
+  if (!app_runtime_install_codec_context(staged->codec_context, listener->server)) {
+    LOGE("Failed to rebuild codec context after config reload\n");
+    app_runtime_restore_previous(listener, session, old_cfg, current_name,
+                                 "codec context reload failure");
+    app_runtime_discard_staged(staged);
+    return 0;
+  }
 
-    if (new_cfg) {
-      app.config.destroy(new_cfg);
-    }
+  /* staged->codec_context now holds the retired keychain. */
+  app_runtime_discard_staged(staged);
 
-    if (current_name[0] != '\0') {
-      restored_server = app.config.server_by_name(current_name);
+  if (old_cfg) {
+    /* Per-user spawn zygotes follow the config's run_as set. */
+    if (!app_runtime_run_as_covered(old_cfg, new_cfg) ||
+        !app_runtime_run_as_covered(new_cfg, old_cfg)) {
+      (void)app.payload.zygote.recycle();
     }
+    /* Requests still holding the old snapshot keep it alive until they finish. */
+    app.config.destroy(old_cfg);
+  }
 
-    if (restored_server &&
-        app.inbound.crypto.init_session_for_server(restored_server, session)) {
-      listener->server = restored_server;
-    } else {
-      app.runtime.invalidate_config_borrows(listener, session);
-      LOGE("Failed to restore previous runtime bindings after config reload failure\n");
-    }
+  app.daemon.cache.invalidate();
+  return 1;
+}
+
+static int app_runtime_reload_config(
+    AppRuntimeListenerState *listener,
+    SiglatchOpenSSLSession *session,
+    const char *config_path,
+    const char *server_name) {
+  AppRuntimeStagedConfig staged = {0};
+  const siglatch_config *previous = NULL;
+  int staged_ok = 0;
 
+  if (!listener || !session || !config_path || config_path[0] == '\0') {
     return 0;
   }
 
-  if (binding_changed && !app.udp.rebind_listener(listener, listener->server)) {
-    LOGE("Failed to apply listener rebind after config reload\n");
+  if (!app_runtime_resolve_target(listener, server_name,
+                                  staged.target_name, sizeof(staged.target_name))) {
+    return 0;
+  }
 
-    app.runtime.invalidate_config_borrows(listener, session);
+  previous = app.config.acquire();
+  staged_ok = app_runtime_stage_config(config_path, staged.target_name, previous, &staged);
+  app.config.release(previous);
+  if (!staged_ok) {
+    return 0;
+  }
 
-    new_cfg = app.config.detach();
-    if (old_cfg) {
-      app.config.attach(old_cfg);
-      old_cfg = NULL;
-    }
+  return app_runtime_commit_staged(listener, session, &staged);
+}
 
-    if (new_cfg) {
-      app.config.destroy(new_cfg);
-    }
+static void *app_runtime_reload_worker(void *arg) {
+  AppRuntimeStagedConfig staged = {0};
+  uint64_t started_at = lib.time.monotonic_ms();
+
+  (void)arg;
+
+  /* A failed build leaves staged.config NULL, which reload_commit() reports. */
+  (void)app_runtime_stage_config(g_app_runtime_reload.config_path,
+                                 g_app_runtime_reload.target_name,
+                                 g_app_runtime_reload.previous,
+                                 &staged);
+
+  LOGD("Reload snapshot for '%s' built in %llu ms\n",
+       g_app_runtime_reload.target_name,
+       (unsigned long long)(lib.time.monotonic_ms() - started_at));
+
+  pthread_mutex_lock(&g_app_runtime_reload.lock);
+  app.config.release(g_app_runtime_reload.previous);
+  g_app_runtime_reload.previous = NULL;
+  g_app_runtime_reload.staged = staged;
+  g_app_runtime_reload.state = APP_RUNTIME_RELOAD_READY;
+  pthread_mutex_unlock(&g_app_runtime_reload.lock);
+  return NULL;
+}
 
-    if (current_name[0] != '\0') {
-      restored_server = app.config.server_by_name(current_name);
-    }
+/*
+ * Start building a snapshot of config_path on the reload thread. Returns 0
+ * if one is already in flight or the thread could not be started. The loop
+ * keeps serving with the current snapshot until reload_commit().
+ */
+static int app_runtime_reload_start(const AppRuntimeListenerState *listener,
+                                    const char *config_path,
+                                    const char *server_name,
+                                    int from_watch) {
+  if (!config_path || config_path[0] == '\0') {
+    return 0;
+  }
 
-    if (restored_server &&
-        app.inbound.crypto.init_session_for_server(restored_server, session)) {
-      listener->server = restored_server;
-    } else {
-      app.runtime.invalidate_config_borrows(listener, session);
-      LOGE("Failed to restore previous runtime bindings after rebind failure\n");
-    }
+  if (app_runtime_reload_state() != APP_RUNTIME_RELOAD_IDLE) {
+    return 0;
+  }
 
+  if (!app_runtime_resolve_target(listener, server_name,
+                                  g_app_runtime_reload.target_name,
+                                  sizeof(g_app_runtime_reload.target_name))) {
+    return 0;
+  }
+  lib.str.lcpy(g_app_runtime_reload.config_path, config_path,
+               sizeof(g_app_runtime_reload.config_path));
+  memset(&g_app_runtime_reload.staged, 0, sizeof(g_app_runtime_reload.staged));
+  g_app_runtime_reload.previous = app.config.acquire();
+
+  g_app_runtime_reload.state = APP_RUNTIME_RELOAD_BUILDING;
+  if (pthread_create(&g_app_runtime_reload.thread, NULL, app_runtime_reload_worker, NULL) != 0) {
+    LOGE("Failed to start config reload thread\n");
+    app.config.release(g_app_runtime_reload.previous);
+    g_app_runtime_reload.previous = NULL;
+    g_app_runtime_reload.state = APP_RUNTIME_RELOAD_IDLE;
     return 0;
   }
+  g_app_runtime_reload.thread_active = 1;
+  g_app_runtime_reload.from_watch = from_watch;
+  return 1;
+}
 
-  if (!app_runtime_sync_codec_context(new_cfg, listener->server)) {
-    LOGE("Failed to rebuild codec context after config reload\n");
+static int app_runtime_reload_begin(const AppRuntimeListenerState *listener,
+                                    const char *config_path,
+                                    const char *server_name) {
+  return app_runtime_reload_start(listener, config_path, server_name, 0);
+}
 
-    app.runtime.invalidate_config_borrows(listener, session);
+static AppRuntimeReloadState app_runtime_reload_state(void) {
+  AppRuntimeReloadState state = APP_RUNTIME_RELOAD_IDLE;
 
-    new_cfg = app.config.detach();
-    if (old_cfg) {
-      app.config.attach(old_cfg);
-      old_cfg = NULL;
-    }
+  pthread_mutex_lock(&g_app_runtime_reload.lock);
+  state = g_app_runtime_reload.state;
+  pthread_mutex_unlock(&g_app_runtime_reload.lock);
+  return state;
+}
 
-    if (new_cfg) {
-      app.config.destroy(new_cfg);
-    }
+/* Join a finished build and hand its snapshot to the caller. */
+static void app_runtime_reload_collect(AppRuntimeStagedConfig *out) {
+  if (g_app_runtime_reload.thread_active) {
+    pthread_join(g_app_runtime_reload.thread, NULL);
+    g_app_runtime_reload.thread_active = 0;
+  }
 
-    if (current_name[0] != '\0') {
-      restored_server = app.config.server_by_name(current_name);
-    }
+  pthread_mutex_lock(&g_app_runtime_reload.lock);
+  *out = g_app_runtime_reload.staged;
+  memset(&g_app_runtime_reload.staged, 0, sizeof(g_app_runtime_reload.staged));
+  g_app_runtime_reload.state = APP_RUNTIME_RELOAD_IDLE;
+  pthread_mutex_unlock(&g_app_runtime_reload.lock);
+}
 
-    if (restored_server &&
-        !app_runtime_sync_codec_context(old_cfg, restored_server)) {
-      LOGE("Failed to restore previous codec context after reload failure\n");
+/*
+ * Publish the snapshot built by reload_begin(). Returns 0 if the build is not
+ * finished, failed, or could not be applied; the live config stays in place.
+ */
+static int app_runtime_reload_commit(AppRuntimeListenerState *listener,
+                                     SiglatchOpenSSLSession *session) {
+  AppRuntimeStagedConfig staged = {0};
+
+  if (app_runtime_reload_state() != APP_RUNTIME_RELOAD_READY) {
+    return 0;
+  }
+
+  app_runtime_reload_collect(&staged);
+  if (!staged.config) {
+    return 0;
+  }
+
+  return app_runtime_commit_staged(listener, session, &staged);
+}
+
+/*
+ * While a reload is building or waiting to be committed the loop polls for
+ * it, so the parked request is picked up promptly instead of after a full tick.
+ */
+static uint64_t app_runtime_reload_next_at(uint64_t now_ms) {
+  if (app_runtime_reload_state() == APP_RUNTIME_RELOAD_IDLE) {
+    return app_runtime_watch_next_at(now_ms);
+  }
+
+  return now_ms + APP_RUNTIME_RELOAD_POLL_MS;
+}
+
+/*
+ * Loop hook for watch_config: follow the live snapshot's key directories,
+ * start a reload once watched files settle, and publish reloads the watcher
+ * started. Reloads requested by a client are left to their request.
+ */
+static void app_runtime_poll(AppRuntimeListenerState *listener,
+                             SiglatchOpenSSLSession *session,
+                             uint64_t now_ms) {
+  const siglatch_config *cfg = app.config.get();
+  AppRuntimeReloadState state = APP_RUNTIME_RELOAD_IDLE;
+
+  if (!listener || !session || !cfg || !cfg->watch_config ||
+      listener->config_path[0] == '\0') {
+    if (app_runtime_watch_active()) {
+      app_runtime_watch_stop();
     }
+    return;
+  }
 
-    if (restored_server &&
-        app.inbound.crypto.init_session_for_server(restored_server, session)) {
-      listener->server = restored_server;
+  state = app_runtime_reload_state();
+  if (state == APP_RUNTIME_RELOAD_READY && g_app_runtime_reload.from_watch) {
+    if (app_runtime_reload_commit(listener, session)) {
+      LOGI("Reloaded %s after watched files changed\n", listener->config_path);
     } else {
-      app.runtime.invalidate_config_borrows(listener, session);
-      LOGE("Failed to restore previous runtime bindings after codec context reload failure\n");
+      LOGE("Automatic reload of %s failed; keeping the current config\n",
+           listener->config_path);
     }
-
-    return 0;
+    return;
   }
 
-  if (old_cfg) {
-    app.config.destroy(old_cfg);
+  if (!app_runtime_watch_tracking(cfg)) {
+    (void)app_runtime_watch_track(cfg, listener->config_path);
   }
 
-  return 1;
+  if (state == APP_RUNTIME_RELOAD_IDLE && app_runtime_watch_changed(now_ms)) {
+    LOGD("Watched files changed; reloading %s\n", listener->config_path);
+    (void)app_runtime_reload_start(listener, listener->config_path, NULL, 1);
+  }
 }
 
 static const AppRuntimeLib app_runtime_instance = {
   .init = app_runtime_init,
   .shutdown = app_runtime_shutdown,
   .invalidate_config_borrows = app_runtime_invalidate_config_borrows,
-  .reload_config = app_runtime_reload_config
+  .reload_config = app_runtime_reload_config,
+  .reload_begin = app_runtime_reload_begin,
+  .reload_state = app_runtime_reload_state,
+  .reload_commit = app_runtime_reload_commit,
+  .reload_next_at = app_runtime_reload_next_at,
+  .poll = app_runtime_poll
 };
 
 const AppRuntimeLib *get_app_runtime_lib(void) {
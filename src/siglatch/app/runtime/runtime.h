@@ -6,6 +6,8 @@
 #ifndef SIGLATCH_SERVER_APP_RUNTIME_H
 #define SIGLATCH_SERVER_APP_RUNTIME_H
 
+#include <stdint.h>
+
 #include "../config/config.h"
 #include "../../../stdlib/nonce.h"
 #include "../../../stdlib/signal.h"
@@ -27,6 +29,15 @@ typedef struct {
   AppRuntimeProcessState *process;
 } AppRuntimeListenerState;
 
+/* How often the loop looks in on a reload running off-thread. */
+#define APP_RUNTIME_RELOAD_POLL_MS 20u
+
+typedef enum {
+  APP_RUNTIME_RELOAD_IDLE = 0,   ///< No reload in flight
+  APP_RUNTIME_RELOAD_BUILDING,   ///< Snapshot is being built on the reload thread
+  APP_RUNTIME_RELOAD_READY       ///< Build finished; reload_commit() publishes or drops it
+} AppRuntimeReloadState;
+
 typedef struct {
   int (*init)(void);
   void (*shutdown)(void);
@@ -36,6 +47,16 @@ typedef struct {
                        SiglatchOpenSSLSession *session,
                        const char *config_path,
                        const char *server_name);
+  int (*reload_begin)(const AppRuntimeListenerState *listener,
+                      const char *config_path,
+                      const char *server_name);
+  AppRuntimeReloadState (*reload_state)(void);
+  int (*reload_commit)(AppRuntimeListenerState *listener,
+                       SiglatchOpenSSLSession *session);
+  uint64_t (*reload_next_at)(uint64_t now_ms);
+  void (*poll)(AppRuntimeListenerState *listener,
+               SiglatchOpenSSLSession *session,
+               uint64_t now_ms);
 } AppRuntimeLib;
 
 const AppRuntimeLib *get_app_runtime_lib(void);
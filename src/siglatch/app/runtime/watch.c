@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "watch.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "../../lib.h"
+
+/*
+ * Loop-thread only. Watches the config file and the directories holding key
+ * files; editors and key tools replace files by rename, so directories are
+ * watched rather than the files themselves. Directories are only ever added:
+ * a snapshot that moves a key elsewhere starts watching the new place, and a
+ * stale watch costs nothing but a spurious, cheap incremental reload.
+ */
+typedef struct {
+  int fd;
+  int config_wd;
+  int config_dir_has_keys;
+  char config_name[PATH_MAX];
+  const siglatch_config *tracked;
+  uint64_t last_event_ms;
+} AppRuntimeWatchState;
+
+static AppRuntimeWatchState g_app_runtime_watch = {
+  .fd = -1,
+  .config_wd = -1
+};
+
+/* Split path into its directory (or ".") and file name. */
+static void app_runtime_watch_split(const char *path,
+                                    char *dir,
+                                    size_t dir_size,
+                                    const char **out_name) {
+  const char *slash = strrchr(path, '/');
+  size_t len = 0;
+
+  if (!slash) {
+    lib.str.lcpy(dir, ".", dir_size);
+    *out_name = path;
+    return;
+  }
+
+  len = (size_t)(slash - path);
+  if (len == 0u) {
+    len = 1u;
+  }
+  if (len >= dir_size) {
+    len = dir_size - 1u;
+  }
+
+  memcpy(dir, path, len);
+  dir[len] = '\0';
+  *out_name = slash + 1;
+}
+
+#ifdef __linux__
+
+#define APP_RUNTIME_WATCH_MASK (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE)
+
+static int app_runtime_watch_open(void) {
+  if (g_app_runtime_watch.fd >= 0) {
+    return 1;
+  }
+
+  g_app_runtime_watch.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (g_app_runtime_watch.fd < 0) {
+    LOGE("Failed to start config watcher: %s\n", strerror(errno));
+    return 0;
+  }
+
+  return 1;
+}
+
+static void app_runtime_watch_key_dir(const char *path, char *last_dir, size_t last_size) {
+  char dir[PATH_MAX];
+  const char *name = NULL;
+  int wd = -1;
+
+  if (!path || path[0] == '\0') {
+    return;
+  }
+
+  app_runtime_watch_split(path, dir, sizeof(dir), &name);
+  if (strcmp(dir, last_dir) == 0) {
+    return;
+  }
+  lib.str.lcpy(last_dir, dir, last_size);
+
+  wd = inotify_add_watch(g_app_runtime_watch.fd, dir, APP_RUNTIME_WATCH_MASK);
+  if (wd < 0) {
+    LOGW("Config watcher cannot watch key directory %s: %s\n", dir, strerror(errno));
+    return;
+  }
+
+  if (wd == g_app_runtime_watch.config_wd) {
+    g_app_runtime_watch.config_dir_has_keys = 1;
+  }
+}
+
+int app_runtime_watch_track(const siglatch_config *cfg, const char *config_path) {
+  char dir[PATH_MAX];
+  char last_dir[PATH_MAX] = {0};
+  const char *name = NULL;
+  int i = 0;
+
+  if (!cfg || !config_path || config_path[0] == '\0') {
+    return 0;
+  }
+
+  if (!app_runtime_watch_open()) {
+    return 0;
+  }
+
+  if (g_app_runtime_watch.config_wd < 0) {
+    app_runtime_watch_split(config_path, dir, sizeof(dir), &name);
+    g_app_runtime_watch.config_wd =
+        inotify_add_watch(g_app_runtime_watch.fd, dir, APP_RUNTIME_WATCH_MASK);
+    if (g_app_runtime_watch.config_wd < 0) {
+      LOGE("Config watcher cannot watch %s: %s\n", dir, strerror(errno));
+      app_runtime_watch_stop();
+      return 0;
+    }
+    lib.str.lcpy(g_app_runtime_watch.config_name, name, sizeof(g_app_runtime_watch.config_name));
+    LOGD("Watching %s for config changes\n", config_path);
+  }
+
+  app_runtime_watch_key_dir(cfg->priv_key_path, last_dir, sizeof(last_dir));
+  app_runtime_watch_key_dir(cfg->keyring_path, last_dir, sizeof(last_dir));
+  for (i = 0; i < cfg->server_count; ++i) {
+    app_runtime_watch_key_dir(cfg->servers[i].priv_key_path, last_dir, sizeof(last_dir));
+  }
+  for (i = 0; i < cfg->user_count; ++i) {
+    if (!cfg->users[i].enabled || cfg->users[i].keyring_der) {
+      continue;
+    }
+    app_runtime_watch_key_dir(cfg->users[i].key_file, last_dir, sizeof(last_dir));
+    app_runtime_watch_key_dir(cfg->users[i].hmac_file, last_dir, sizeof(last_dir));
+  }
+
+  g_app_runtime_watch.tracked = cfg;
+  return 1;
+}
+
+/* Events in the config directory only count for the config file itself. */
+static int app_runtime_watch_relevant(const struct inotify_event *event) {
+  if (event->mask & IN_Q_OVERFLOW) {
+    return 1;
+  }
+
+  if (event->wd != g_app_runtime_watch.config_wd || g_app_runtime_watch.config_dir_has_keys) {
+    return 1;
+  }
+
+  return event->len > 0u && strcmp(event->name, g_app_runtime_watch.config_name) == 0;
+}
+
+static void app_runtime_watch_drain(uint64_t now_ms) {
+  char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  ssize_t len = 0;
+
+  for (;;) {
+    size_t off = 0;
+
+    len = read(g_app_runtime_watch.fd, buf, sizeof(buf));
+    if (len <= 0) {
+      return;
+    }
+
+    while (off + sizeof(struct inotify_event) <= (size_t)len) {
+      const struct inotify_event *event = (const struct inotify_event *)(buf + off);
+
+      if (app_runtime_watch_relevant(event)) {
+        g_app_runtime_watch.last_event_ms = now_ms;
+      }
+      off += sizeof(struct inotify_event) + event->len;
+    }
+  }
+}
+
+void app_runtime_watch_stop(void) {
+  if (g_app_runtime_watch.fd >= 0) {
+    close(g_app_runtime_watch.fd);
+  }
+
+  memset(&g_app_runtime_watch, 0, sizeof(g_app_runtime_watch));
+  g_app_runtime_watch.fd = -1;
+  g_app_runtime_watch.config_wd = -1;
+}
+
+#else
+
+int app_runtime_watch_track(const siglatch_config *cfg, const char *config_path) {
+  (void)cfg;
+  (void)config_path;
+  (void)app_runtime_watch_split;
+  LOGW("watch_config is only supported on Linux; reload with reload_config instead\n");
+  g_app_runtime_watch.tracked = cfg;
+  return 0;
+}
+
+static void app_runtime_watch_drain(uint64_t now_ms) {
+  (void)now_ms;
+}
+
+void app_runtime_watch_stop(void) {
+  memset(&g_app_runtime_watch, 0, sizeof(g_app_runtime_watch));
+  g_app_runtime_watch.fd = -1;
+  g_app_runtime_watch.config_wd = -1;
+}
+
+#endif
+
+int app_runtime_watch_active(void) {
+  return g_app_runtime_watch.fd >= 0;
+}
+
+/* True once watches reflect cfg; a new snapshot may name new key directories. */
+int app_runtime_watch_tracking(const siglatch_config *cfg) {
+  return cfg && g_app_runtime_watch.tracked == cfg;
+}
+
+/*
+ * Returns 1 once files changed and then stayed quiet for the settle period,
+ * so a burst of writes (a config save plus a few key rotations) reloads once.
+ */
+int app_runtime_watch_changed(uint64_t now_ms) {
+  if (!app_runtime_watch_active()) {
+    return 0;
+  }
+
+  app_runtime_watch_drain(now_ms);
+  if (g_app_runtime_watch.last_event_ms == 0u ||
+      now_ms < g_app_runtime_watch.last_event_ms + APP_RUNTIME_WATCH_SETTLE_MS) {
+    return 0;
+  }
+
+  g_app_runtime_watch.last_event_ms = 0u;
+  return 1;
+}
+
+uint64_t app_runtime_watch_next_at(uint64_t now_ms) {
+  if (!app_runtime_watch_active()) {
+    return UINT64_MAX;
+  }
+
+  if (g_app_runtime_watch.last_event_ms != 0u) {
+    return g_app_runtime_watch.last_event_ms + APP_RUNTIME_WATCH_SETTLE_MS;
+  }
+
+  return now_ms + APP_RUNTIME_WATCH_POLL_MS;
+}
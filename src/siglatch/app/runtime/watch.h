@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef SIGLATCH_SERVER_APP_RUNTIME_WATCH_H
+#define SIGLATCH_SERVER_APP_RUNTIME_WATCH_H
+
+#include <stdint.h>
+
+#include "../config/config.h"
+
+/* Quiet period after the last file event before a reload is started. */
+#define APP_RUNTIME_WATCH_SETTLE_MS 500u
+/* How often the loop drains file events when nothing else wakes it. */
+#define APP_RUNTIME_WATCH_POLL_MS 1000u
+
+int app_runtime_watch_track(const siglatch_config *cfg, const char *config_path);
+void app_runtime_watch_stop(void);
+int app_runtime_watch_active(void);
+int app_runtime_watch_tracking(const siglatch_config *cfg);
+int app_runtime_watch_changed(uint64_t now_ms);
+uint64_t app_runtime_watch_next_at(uint64_t now_ms);
+
+#endif
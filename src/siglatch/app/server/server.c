@@ -58,6 +58,15 @@ static int server_action_available(const siglatch_server *server, const char *ac
   return 0;
 }
 
+/* Bit test against the grant set compiled from actions[] at config load. */
+static int server_action_granted(const siglatch_server *server, uint32_t action_id) {
+  if (!server || action_id >= SL_ACTION_ID_SPACE) {
+    return 0;
+  }
+
+  return (server->action_grants[action_id >> 3] >> (action_id & 7u)) & 1u;
+}
+
 static int server_deaddrop_available(const siglatch_server *server, const char *deaddrop_name) {
   int i = 0;
 
@@ -74,6 +83,12 @@ static int server_deaddrop_available(const siglatch_server *server, const char *
   return 0;
 }
 
+/*
+ * Route an unstructured payload with one walk down the server's compiled
+ * starts_with trie. Every node passed is a prefix of the payload; by default
+ * the pattern earliest in config order wins, or the deepest one when the
+ * server sets deaddrop_match = longest.
+ */
 static const siglatch_deaddrop *server_deaddrop_starts_with_buffer(
     const siglatch_server *server,
     const uint8_t *payload,
@@ -81,38 +96,58 @@ static const siglatch_deaddrop *server_deaddrop_starts_with_buffer(
     char *match,
     int match_buf_size,
     size_t *matched_prefix_len) {
-  int i = 0;
+  const siglatch_deaddrop_trie *trie = NULL;
+  const siglatch_config *cfg = app.config.get();
+  uint32_t at = 0;
+  uint32_t best = 0;
+  size_t best_len = 0;
+  size_t i = 0;
+
+  if (!server || !payload || payload_len == 0 || !cfg) {
+    return NULL;
+  }
 
-  if (!server || !payload || payload_len == 0) {
+  trie = &server->deaddrop_trie;
+  if (!trie->nodes || trie->count == 0u) {
     return NULL;
   }
 
-  for (i = 0; i < server->deaddrop_count; ++i) {
-    const char *allowed = server->deaddrops[i];
-    const siglatch_deaddrop *deaddrop = app.config.deaddrop_by_name(allowed);
-    int j = 0;
+  for (i = 0; i <= payload_len; ++i) {
+    const siglatch_deaddrop_trie_node *node = &trie->nodes[at];
+
+    if (node->rank != UINT32_MAX &&
+        (trie->nodes[best].rank == UINT32_MAX ||
+         server->deaddrop_longest_match ||
+         node->rank < trie->nodes[best].rank)) {
+      best = at;
+      best_len = i;
+    }
 
-    if (!deaddrop || !deaddrop->enabled) {
-      continue;
+    if (i == payload_len) {
+      break;
     }
 
-    for (j = 0; j < deaddrop->starts_with_count; ++j) {
-      const char *prefix = deaddrop->starts_with[j];
-      size_t prefix_len = strlen(prefix);
-
-      if (prefix_len <= payload_len && memcmp(payload, prefix, prefix_len) == 0) {
-        if (match && match_buf_size > 0) {
-          snprintf(match, match_buf_size, "%s", prefix);
-        }
-        if (matched_prefix_len) {
-          *matched_prefix_len = prefix_len;
-        }
-        return deaddrop;
-      }
+    at = node->first_child;
+    while (at != 0u && trie->nodes[at].byte != payload[i]) {
+      at = trie->nodes[at].next_sibling;
+    }
+    if (at == 0u) {
+      break;
     }
   }
 
-  return NULL;
+  if (trie->nodes[best].rank == UINT32_MAX || trie->nodes[best].deaddrop < 0 ||
+      trie->nodes[best].deaddrop >= cfg->deaddrop_count) {
+    return NULL;
+  }
+
+  if (match && match_buf_size > 0) {
+    snprintf(match, match_buf_size, "%.*s", (int)best_len, (const char *)payload);
+  }
+  if (matched_prefix_len) {
+    *matched_prefix_len = best_len;
+  }
+  return &cfg->deaddrops[trie->nodes[best].deaddrop];
 }
 
 static siglatch_payload_overflow_policy server_resolve_payload_overflow_by_action(
@@ -146,6 +181,7 @@ static const AppServerLib server_instance = {
   .shutdown = server_shutdown,
   .select = server_select,
   .action_available = server_action_available,
+  .action_granted = server_action_granted,
   .deaddrop_available = server_deaddrop_available,
   .deaddrop_starts_with_buffer = server_deaddrop_starts_with_buffer,
   .resolve_payload_overflow_by_action = server_resolve_payload_overflow_by_action,
@@ -16,6 +16,7 @@ typedef struct {
   void (*shutdown)(void);
   const siglatch_server *(*select)(const char *name);
   int (*action_available)(const siglatch_server *server, const char *action_name);
+  int (*action_granted)(const siglatch_server *server, uint32_t action_id);
   int (*deaddrop_available)(const siglatch_server *server, const char *deaddrop_name);
   const siglatch_deaddrop *(*deaddrop_starts_with_buffer)(
       const siglatch_server *server,
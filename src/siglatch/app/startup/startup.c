@@ -340,6 +340,12 @@ static int app_startup_sync_codec_context(const AppStartupState *state) {
   m7mux_ctx.codec_context = workspace->codec_context;
   m7mux_ctx.enforce_wire_decode = state->listener.server->enforce_wire_decode;
   m7mux_ctx.enforce_wire_auth = state->listener.server->enforce_wire_auth;
+  m7mux_ctx.reply_cache_ms = (uint64_t)state->listener.server->reply_cache_ms;
+  m7mux_ctx.rate_limit.rate = (uint32_t)state->listener.server->rate_limit;
+  m7mux_ctx.rate_limit.burst = (uint32_t)state->listener.server->rate_limit_burst;
+  m7mux_ctx.rate_limit.prefix_v4 = (uint8_t)state->listener.server->rate_limit_prefix_v4;
+  m7mux_ctx.rate_limit.prefix_v6 = (uint8_t)state->listener.server->rate_limit_prefix_v6;
+  m7mux_ctx.overload_high_water = (uint32_t)state->listener.server->overload_high_water;
 
   if (!lib.m7mux.set_context(&m7mux_ctx)) {
     LOGE("Failed to install codec context into m7mux\n");
@@ -382,6 +388,13 @@ static int app_startup_prepare(int argc, char *argv[], AppStartupState *state) {
     return 1;
   }
 
+  /*
+   * Fork the spawn zygote before config, keys and listener state exist so
+   * action children are launched from a small image. Failure is not fatal;
+   * shell actions then fork from the daemon directly.
+   */
+  (void)app.payload.zygote.start();
+
   app.signal.install(&state->process);
   lib.log.set_enabled(1);
   lib.log.set_debug(1);
@@ -407,6 +420,13 @@ static int app_startup_prepare(int argc, char *argv[], AppStartupState *state) {
     return 0;
   }
 
+  if (state->parsed.values.write_keyring_path[0]) {
+    state->should_exit = 1;
+    state->exit_code = app.keys.keyring.write(state->cfg,
+                                              state->parsed.values.write_keyring_path) ? 0 : 1;
+    return 1;
+  }
+
   if (!app_startup_select_server(&state->parsed, state->cfg, &state->listener)) {
     return 0;
   }
@@ -9,6 +9,7 @@
 #include "../stdlib/log_context.h"
 #include "../stdlib/argv.h"
 #include "../stdlib/nonce.h"
+#include "../stdlib/arena.h"
 #include "../stdlib/signal.h"
 #include "../stdlib/parse/parse.h"
 #include "../stdlib/process/process.h"
@@ -23,6 +24,7 @@ Lib lib = {
     .time = {0},
     .hmac = {0},
     .nonce = {0},
+    .arena = {0},
     .openssl = {0},
     .signal = {0},
     .net = {0},
@@ -65,6 +67,7 @@ int init_lib(void) {
   int log_initialized = 0;
   int hmac_initialized = 0;
   int nonce_initialized = 0;
+  int arena_initialized = 0;
   int signal_initialized = 0;
   int file_initialized = 0;
   int openssl_initialized = 0;
@@ -83,6 +86,7 @@ int init_lib(void) {
   lib.hmac = *get_hmac_key_lib();
   lib.file = *get_lib_file();
   lib.nonce = *get_lib_nonce();
+  lib.arena = *get_lib_arena();
   lib.signal = *get_lib_signal();
   lib.openssl = *get_siglatch_openssl();
   lib.m7mux = *get_lib_m7mux();
@@ -122,6 +126,9 @@ int init_lib(void) {
       !lib.nonce.init || !lib.nonce.shutdown ||
       !lib.nonce.cache_init || !lib.nonce.cache_shutdown ||
       !lib.nonce.clear || !lib.nonce.check || !lib.nonce.add ||
+      !lib.arena.init || !lib.arena.shutdown ||
+      !lib.arena.arena_init || !lib.arena.arena_release ||
+      !lib.arena.alloc || !lib.arena.calloc || !lib.arena.reset ||
       !lib.signal.init || !lib.signal.shutdown ||
       !lib.signal.state_reset || !lib.signal.install || !lib.signal.uninstall ||
       !lib.signal.should_exit || !lib.signal.last_signal ||
@@ -227,6 +234,12 @@ int init_lib(void) {
   }
   nonce_initialized = 1;
 
+  if (!lib.arena.init()) {
+    fprintf(stderr, "Failed to initialize siglatchd lib.arena\n");
+    goto fail;
+  }
+  arena_initialized = 1;
+
   if (!lib.signal.init()) {
     fprintf(stderr, "Failed to initialize siglatchd lib.signal\n");
     goto fail;
@@ -266,6 +279,9 @@ fail:
   if (file_initialized) {
     lib.file.shutdown();
   }
+  if (arena_initialized) {
+    lib.arena.shutdown();
+  }
   if (nonce_initialized) {
     lib.nonce.shutdown();
   }
@@ -338,6 +354,7 @@ void shutdown_lib(void) {
   //  clean close
   lib.openssl.shutdown();
   lib.signal.shutdown();
+  lib.arena.shutdown();
   lib.nonce.shutdown();
   lib.hmac.shutdown();
 
@@ -12,6 +12,7 @@
 #include "../stdlib/hmac_key.h"
 #include "../stdlib/file.h"
 #include "../stdlib/nonce.h"
+#include "../stdlib/arena.h"
 #include "../stdlib/signal.h"
 #include "../stdlib/openssl/openssl.h"
 #include "../stdlib/net.h"
@@ -47,6 +48,7 @@ typedef struct {
   HMACKey hmac;
   FileLib file;
   NonceLib nonce;
+  ArenaLib arena;
   SignalLib signal;
   SiglatchOpenSSL_Lib openssl;
   NetLib net;
@@ -37,6 +37,9 @@ int main(int argc, char *argv[]) {
     goto cleanup;
   }
 
+  /* With lazy_user_keys, user public keys are parsed from here on. */
+  (void)app.keys.user.warm();
+
   app.daemon.runner.run(&startup.listener);
   should_log_shutdown = 1;
   status = 0;
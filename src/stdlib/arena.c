@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ArenaBlock {
+  ArenaBlock *next;
+  size_t cap;
+  size_t used;
+  /* Keeps data[] on an ARENA_ALIGN boundary. */
+  size_t pad;
+  unsigned char data[];
+};
+
+int lib_arena_init(void) {
+  return 1;
+}
+
+void lib_arena_shutdown(void) {
+}
+
+static size_t lib_arena_align(size_t size) {
+  return (size + (ARENA_ALIGN - 1u)) & ~(size_t)(ARENA_ALIGN - 1u);
+}
+
+static ArenaBlock *lib_arena_new_block(Arena *arena, size_t min_cap) {
+  ArenaBlock *block = NULL;
+  size_t cap = arena->block_size;
+
+  if (cap < min_cap) {
+    cap = min_cap;
+  }
+
+  if (cap > SIZE_MAX - sizeof(*block)) {
+    return NULL;
+  }
+
+  block = (ArenaBlock *)malloc(sizeof(*block) + cap);
+  if (!block) {
+    return NULL;
+  }
+
+  block->next = arena->blocks;
+  block->cap = cap;
+  block->used = 0u;
+  arena->blocks = block;
+  arena->reserved += cap;
+  return block;
+}
+
+int lib_arena_arena_init(Arena *arena, size_t block_size) {
+  if (!arena) {
+    return 0;
+  }
+
+  memset(arena, 0, sizeof(*arena));
+  arena->block_size = block_size > 0u ? lib_arena_align(block_size) : ARENA_DEFAULT_BLOCK_SIZE;
+  return 1;
+}
+
+void lib_arena_arena_release(Arena *arena) {
+  ArenaBlock *block = NULL;
+
+  if (!arena) {
+    return;
+  }
+
+  block = arena->blocks;
+  while (block) {
+    ArenaBlock *next = block->next;
+
+    free(block);
+    block = next;
+  }
+
+  arena->blocks = NULL;
+  arena->used = 0u;
+  arena->reserved = 0u;
+}
+
+void *lib_arena_alloc(Arena *arena, size_t size) {
+  ArenaBlock *block = NULL;
+  void *out = NULL;
+
+  if (!arena || size == 0u || size > SIZE_MAX - ARENA_ALIGN) {
+    return NULL;
+  }
+
+  size = lib_arena_align(size);
+  block = arena->blocks;
+  if (!block || block->cap - block->used < size) {
+    block = lib_arena_new_block(arena, size);
+    if (!block) {
+      return NULL;
+    }
+  }
+
+  out = block->data + block->used;
+  block->used += size;
+  arena->used += size;
+  if (arena->used > arena->high) {
+    arena->high = arena->used;
+  }
+
+  return out;
+}
+
+void *lib_arena_calloc(Arena *arena, size_t count, size_t size) {
+  void *out = NULL;
+
+  if (size > 0u && count > SIZE_MAX / size) {
+    return NULL;
+  }
+
+  out = lib_arena_alloc(arena, count * size);
+  if (out) {
+    memset(out, 0, count * size);
+  }
+
+  return out;
+}
+
+void lib_arena_reset(Arena *arena) {
+  size_t reserved = 0u;
+
+  if (!arena) {
+    return;
+  }
+
+  arena->used = 0u;
+  if (!arena->blocks) {
+    return;
+  }
+
+  if (!arena->blocks->next) {
+    arena->blocks->used = 0u;
+    return;
+  }
+
+  reserved = arena->reserved;
+  lib_arena_arena_release(arena);
+  /* A failed refold just leaves the arena empty; the next alloc retries. */
+  (void)lib_arena_new_block(arena, reserved);
+}
+
+static const ArenaLib lib_arena_instance = {
+  .init = lib_arena_init,
+  .shutdown = lib_arena_shutdown,
+  .arena_init = lib_arena_arena_init,
+  .arena_release = lib_arena_arena_release,
+  .alloc = lib_arena_alloc,
+  .calloc = lib_arena_calloc,
+  .reset = lib_arena_reset
+};
+
+const ArenaLib *get_lib_arena(void) {
+  return &lib_arena_instance;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef SIGLATCH_ARENA_H
+#define SIGLATCH_ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_DEFAULT_BLOCK_SIZE 4096u
+#define ARENA_ALIGN 16u
+
+typedef struct ArenaBlock ArenaBlock;
+
+/*
+ * Bump-pointer scratch memory.
+ *
+ * Allocations are never freed one by one; reset() hands everything back in
+ * one step. When a cycle spilled into extra blocks, reset() folds them into a
+ * single block of the combined size so the next cycle fits without growing.
+ * An Arena is not locked: one owner at a time.
+ */
+typedef struct {
+  ArenaBlock *blocks;
+  size_t block_size;
+  size_t used;      /* bytes handed out since the last reset */
+  size_t high;      /* largest `used` seen over the arena's life */
+  size_t reserved;  /* bytes held across all blocks */
+} Arena;
+
+typedef struct {
+  int (*init)(void);
+  void (*shutdown)(void);
+  int (*arena_init)(Arena *arena, size_t block_size);
+  void (*arena_release)(Arena *arena);
+  void *(*alloc)(Arena *arena, size_t size);
+  void *(*calloc)(Arena *arena, size_t count, size_t size);
+  void (*reset)(Arena *arena);
+} ArenaLib;
+
+int lib_arena_init(void);
+void lib_arena_shutdown(void);
+int lib_arena_arena_init(Arena *arena, size_t block_size);
+void lib_arena_arena_release(Arena *arena);
+void *lib_arena_alloc(Arena *arena, size_t size);
+void *lib_arena_calloc(Arena *arena, size_t count, size_t size);
+void lib_arena_reset(Arena *arena);
+const ArenaLib *get_lib_arena(void);
+
+#endif
@@ -20,6 +20,7 @@ static int  configure_buffers(int fd, int recv_buf, int send_buf);
 static int  open_socket(int domain, int type, int protocol);
 static void close_socket(int fd);
 static int  wait_readable(int fd, int timeout_ms);
+static int  wait_readable_or_wake(int fd, int wake_fd, int timeout_ms);
 
 static void socket_init(void) {
   /* No-op on POSIX. */
@@ -131,6 +132,39 @@ static int wait_readable(int fd, int timeout_ms)
   return rc;
 }
 
+static int wait_readable_or_wake(int fd, int wake_fd, int timeout_ms)
+{
+  fd_set readfds;
+  struct timeval tv;
+  struct timeval *tv_ptr = NULL;
+  int max_fd = fd;
+  int rc = 0;
+
+  if (fd < 0)
+    return -1;
+
+  if (wake_fd < 0)
+    return wait_readable(fd, timeout_ms);
+
+  if (timeout_ms >= 0) {
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    tv_ptr = &tv;
+  }
+
+  FD_ZERO(&readfds);
+  FD_SET(fd, &readfds);
+  FD_SET(wake_fd, &readfds);
+  if (wake_fd > max_fd)
+    max_fd = wake_fd;
+
+  rc = select(max_fd + 1, &readfds, NULL, NULL, tv_ptr);
+  if (rc <= 0)
+    return rc;
+
+  return FD_ISSET(fd, &readfds) ? 1 : 0;
+}
+
 
 static const SocketLib instance = {
   .init              = socket_init,
@@ -139,7 +173,8 @@ static const SocketLib instance = {
   .set_buffers       = configure_buffers,
   .open              = open_socket,
   .close             = close_socket,
-  .wait_readable     = wait_readable
+  .wait_readable     = wait_readable,
+  .wait_readable_or_wake = wait_readable_or_wake
 };
 
 const SocketLib *get_lib_socket(void) {
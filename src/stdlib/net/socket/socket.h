@@ -108,6 +108,19 @@ typedef struct {
    */
 
   int (*wait_readable)(int fd, int timeout_ms);
+
+  /**
+   * @brief Wait until a socket becomes readable or a wake descriptor fires.
+   *
+   * Same as wait_readable(), but also returns early when @p wake_fd becomes
+   * readable. The wake descriptor is not drained; that is the caller's job.
+   *
+   * @param fd          Socket file descriptor
+   * @param wake_fd     Wake descriptor (eventfd/pipe), or < 0 for none
+   * @param timeout_ms  Timeout in milliseconds; values < 0 wait indefinitely
+   * @return >0 if @p fd is readable, 0 on timeout or wake-only, -1 on error
+   */
+  int (*wait_readable_or_wake)(int fd, int wake_fd, int timeout_ms);
   
 } SocketLib;
 
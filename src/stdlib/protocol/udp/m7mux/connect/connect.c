@@ -84,6 +84,7 @@ static int m7mux_connect_state_init(M7MuxState *state) {
 
   memset(state, 0, sizeof(*state));
   state->connect.socket_fd = -1;
+  state->connect.wake_fd = -1;
   state->policy_enforce_encryption = M7MUX_POLICY_ENFORCE_ENCRYPTION_ANY;
 
   internal = m7mux_connect_internal();
@@ -132,6 +133,7 @@ static void m7mux_connect_state_reset(M7MuxState *state) {
 
   memset(&state->connect, 0, sizeof(state->connect));
   state->connect.socket_fd = -1;
+  state->connect.wake_fd = -1;
   state->policy_enforce_encryption = M7MUX_POLICY_ENFORCE_ENCRYPTION_ANY;
 }
 
@@ -214,6 +216,20 @@ static void m7mux_connect_disconnect(M7MuxState *state) {
   free(state);
 }
 
+/*
+ * Optional wake descriptor polled alongside the socket. When it becomes
+ * readable the pump returns early so the caller can service other work; the
+ * caller owns and drains it.
+ */
+static int m7mux_connect_set_wake_fd(M7MuxState *state, int wake_fd) {
+  if (!state) {
+    return 0;
+  }
+
+  state->connect.wake_fd = wake_fd >= 0 ? wake_fd : -1;
+  return 1;
+}
+
 static const M7MuxConnectLib _instance = {
   .init = m7mux_connect_init,
   .set_context = m7mux_connect_set_context,
@@ -222,7 +238,8 @@ static const M7MuxConnectLib _instance = {
   .state_reset = m7mux_connect_state_reset,
   .connect_ip = m7mux_connect_ip,
   .connect_socket = m7mux_connect_socket,
-  .disconnect = m7mux_connect_disconnect
+  .disconnect = m7mux_connect_disconnect,
+  .set_wake_fd = m7mux_connect_set_wake_fd
 };
 
 const M7MuxConnectLib *get_protocol_udp_m7mux_connect_lib(void) {
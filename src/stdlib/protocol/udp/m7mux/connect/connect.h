@@ -22,6 +22,7 @@ typedef struct {
   M7MuxState *(*connect_ip)(const char *ip, uint16_t port);
   M7MuxState *(*connect_socket)(int socket_fd);
   void (*disconnect)(M7MuxState *state);
+  int (*set_wake_fd)(M7MuxState *state, int wake_fd);
 } M7MuxConnectLib;
 
 const M7MuxConnectLib *get_protocol_udp_m7mux_connect_lib(void);
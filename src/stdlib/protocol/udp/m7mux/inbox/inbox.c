@@ -49,6 +49,8 @@ static void m7mux_inbox_state_reset(M7MuxState *state) {
   g_ctx.internal->ingress->state_reset(&state->ingress);
   g_ctx.internal->session->state_reset(&state->session);
   g_ctx.internal->stream->state_reset(&state->stream);
+  g_ctx.internal->replay->state_reset(&state->replay);
+  g_ctx.internal->limit->state_reset(&state->limit);
   m7mux_inbox_configure_stream_adapter(state);
 }
 
@@ -72,6 +74,16 @@ static int m7mux_inbox_state_init(M7MuxState *state) {
     return 0;
   }
 
+  if (!g_ctx.internal->replay->state_init(&state->replay)) {
+    m7mux_inbox_state_reset(state);
+    return 0;
+  }
+
+  if (!g_ctx.internal->limit->state_init(&state->limit)) {
+    m7mux_inbox_state_reset(state);
+    return 0;
+  }
+
   m7mux_inbox_configure_stream_adapter(state);
 
   return 1;
@@ -89,6 +101,8 @@ static int m7mux_inbox_pump(M7MuxState *state, uint64_t timeout_ms) {
   M7MuxIngress raw = {0};
   M7MuxRecvPacket normal = {0};
   M7MuxControl control = {0};
+  M7MuxEgressData cached = {0};
+  uint64_t request_key = 0u;
   uint64_t now_ms = 0u;
   int rc = 0;
   int did_work = 0;
@@ -99,9 +113,11 @@ static int m7mux_inbox_pump(M7MuxState *state, uint64_t timeout_ms) {
 
   /* Keep ingress pointed at the connected socket before staging raw packets. */
   state->ingress.socket_fd = state->connect.socket_fd;
+  state->ingress.wake_fd = state->connect.wake_fd;
   now_ms = g_ctx.time->monotonic_ms();
   did_work = g_ctx.internal->session->expire(&state->session, now_ms) > 0;
   did_work = g_ctx.internal->stream->expire(&state->stream, now_ms) > 0 || did_work;
+  (void)g_ctx.internal->replay->expire(&state->replay, now_ms);
 
   rc = g_ctx.internal->ingress->pump(&state->ingress, timeout_ms);
   if (rc < 0) {
@@ -112,19 +128,55 @@ static int m7mux_inbox_pump(M7MuxState *state, uint64_t timeout_ms) {
     did_work = 1;
   }
 
+  g_ctx.internal->limit->assess(&state->limit, state->ingress.queue_count, g_ctx.overload_high_water);
+
   while (g_ctx.internal->ingress->drain(&state->ingress, &raw)) {
     memset(&normal, 0, sizeof(normal));
 
+    /* A source over its rate costs no more than this lookup. */
+    if (!g_ctx.internal->limit->admit(&state->limit,
+                                      &raw,
+                                      g_ctx.time->monotonic_ms(),
+                                      &g_ctx.rate_limit)) {
+      continue;
+    }
+
+    /* Under overload, known peers go ahead of new work that needs a decrypt. */
+    if (!g_ctx.internal->limit->triage(&state->limit, &raw, g_ctx.time->monotonic_ms())) {
+      continue;
+    }
+
+    /* Retransmits are answered or dropped here, before any decode work. */
+    switch (g_ctx.internal->replay->admit(&state->replay,
+                                          &raw,
+                                          g_ctx.time->monotonic_ms(),
+                                          g_ctx.reply_cache_ms,
+                                          &request_key,
+                                          &cached)) {
+      case M7MUX_REPLAY_HIT:
+        (void)g_ctx.internal->egress->stage(&state->egress, &cached);
+        did_work = 1;
+        continue;
+      case M7MUX_REPLAY_DUPLICATE:
+        continue;
+      default:
+        break;
+    }
+
     if (!g_ctx.internal->normalize->normalize(state, &raw, &control, &normal)) {
+      g_ctx.internal->replay->forget(&state->replay, request_key);
       continue;
     }
+    normal.request_key = request_key;
 
     if (!g_ctx.internal->session->ingest(&state->session, &control, &normal)) {
+      g_ctx.internal->replay->forget(&state->replay, request_key);
       m7mux_stream_release_user(&state->stream, &normal);
       return did_work;
     }
 
     if (!g_ctx.internal->stream->ingest(&state->stream, &normal)) {
+      g_ctx.internal->replay->forget(&state->replay, request_key);
       m7mux_stream_release_user(&state->stream, &normal);
       return did_work;
     }
@@ -146,6 +198,44 @@ static int m7mux_inbox_drain(M7MuxState *state, M7MuxRecvPacket *out_normal) {
   return g_ctx.internal->stream->drain(&state->stream, out_normal);
 }
 
+static int m7mux_inbox_release(M7MuxState *state, uint64_t session_id) {
+  int released = 0;
+
+  if (!state || session_id == 0u) {
+    return 0;
+  }
+
+  released = g_ctx.internal->stream->release_session(&state->stream, session_id);
+  return g_ctx.internal->session->release(&state->session, session_id) || released;
+}
+
+static int m7mux_inbox_limit_stats(const M7MuxState *state, M7MuxLimitStats *out) {
+  if (!state || !out) {
+    return 0;
+  }
+
+  *out = state->limit.stats;
+  return 1;
+}
+
+static int m7mux_inbox_set_backlog(M7MuxState *state, size_t backlog) {
+  if (!state) {
+    return 0;
+  }
+
+  state->limit.backlog = backlog;
+  return 1;
+}
+
+static int m7mux_inbox_note_peer(M7MuxState *state, const char *ip, int authenticated) {
+  if (!state || !ip) {
+    return 0;
+  }
+
+  g_ctx.internal->limit->note_peer(&state->limit, ip, authenticated, g_ctx.time->monotonic_ms());
+  return 1;
+}
+
 static const M7MuxInboxLib _instance = {
   .init = m7mux_inbox_init,
   .set_context = m7mux_inbox_set_context,
@@ -154,7 +244,11 @@ static const M7MuxInboxLib _instance = {
   .state_reset = m7mux_inbox_state_reset,
   .has_pending = m7mux_inbox_has_pending,
   .pump = m7mux_inbox_pump,
-  .drain = m7mux_inbox_drain
+  .drain = m7mux_inbox_drain,
+  .release = m7mux_inbox_release,
+  .limit_stats = m7mux_inbox_limit_stats,
+  .set_backlog = m7mux_inbox_set_backlog,
+  .note_peer = m7mux_inbox_note_peer
 };
 
 const M7MuxInboxLib *get_protocol_udp_m7mux_inbox_lib(void) {
@@ -6,9 +6,11 @@
 #ifndef LIB_PROTOCOL_UDP_M7MUX_INBOX_H
 #define LIB_PROTOCOL_UDP_M7MUX_INBOX_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 typedef struct M7MuxContext M7MuxContext;
+typedef struct M7MuxLimitStats M7MuxLimitStats;
 typedef struct M7MuxRecvPacket M7MuxRecvPacket;
 typedef struct M7MuxState M7MuxState;
 
@@ -22,6 +24,22 @@ typedef struct {
   int (*has_pending)(const M7MuxState *state);
   int (*pump)(M7MuxState *state, uint64_t timeout_ms);
   int (*drain)(M7MuxState *state, M7MuxRecvPacket *out_normal);
+  /*
+   * Forget a session the caller has finished with. Packets without a wire
+   * session id each get a synthetic session, so a client reading many of them
+   * should release each one instead of waiting for expiry to free the slot.
+   */
+  int (*release)(M7MuxState *state, uint64_t session_id);
+  /* Counters for datagrams the per-source rate limit let through or shed. */
+  int (*limit_stats)(const M7MuxState *state, M7MuxLimitStats *out);
+  /*
+   * Overload admission inputs. The backlog is work the caller has queued but
+   * not finished, counted with waiting datagrams against the high-water mark.
+   * Each request's authentication result marks its source address trusted or
+   * failed, which decides whether it is let through or dropped first under load.
+   */
+  int (*set_backlog)(M7MuxState *state, size_t backlog);
+  int (*note_peer)(M7MuxState *state, const char *ip, int authenticated);
 } M7MuxInboxLib;
 
 const M7MuxInboxLib *get_protocol_udp_m7mux_inbox_lib(void);
@@ -55,6 +55,31 @@ static int m7mux_ingress_peer_to_ip(const struct sockaddr_storage *peer,
   return 0;
 }
 
+/* Binary form of the sender for the rate limit; v4-mapped IPv6 counts as IPv4. */
+static void m7mux_ingress_peer_to_addr(const struct sockaddr_storage *peer, M7MuxIngress *ingress) {
+  static const uint8_t v4_mapped[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff };
+
+  memset(ingress->addr, 0, sizeof(ingress->addr));
+  ingress->addr_family = 0;
+
+  if (peer->ss_family == AF_INET) {
+    const struct sockaddr_in *addr = (const struct sockaddr_in *)peer;
+
+    memcpy(ingress->addr, &addr->sin_addr, 4);
+    ingress->addr_family = AF_INET;
+  } else if (peer->ss_family == AF_INET6) {
+    const struct sockaddr_in6 *addr = (const struct sockaddr_in6 *)peer;
+
+    if (memcmp(addr->sin6_addr.s6_addr, v4_mapped, sizeof(v4_mapped)) == 0) {
+      memcpy(ingress->addr, addr->sin6_addr.s6_addr + 12, 4);
+      ingress->addr_family = AF_INET;
+    } else {
+      memcpy(ingress->addr, addr->sin6_addr.s6_addr, 16);
+      ingress->addr_family = AF_INET6;
+    }
+  }
+}
+
 static int m7mux_ingress_state_init(M7MuxIngressState *state) {
   if (!state) {
     return 0;
@@ -62,6 +87,7 @@ static int m7mux_ingress_state_init(M7MuxIngressState *state) {
 
   memset(state, 0, sizeof(*state));
   state->socket_fd = -1;
+  state->wake_fd = -1;
   return 1;
 }
 
@@ -72,6 +98,7 @@ static void m7mux_ingress_state_reset(M7MuxIngressState *state) {
 
   memset(state, 0, sizeof(*state));
   state->socket_fd = -1;
+  state->wake_fd = -1;
 }
 
 static int m7mux_ingress_has_pending(const M7MuxIngressState *state) {
@@ -141,7 +168,11 @@ static int m7mux_ingress_pump(M7MuxIngressState *state, uint64_t timeout_ms) {
   }
   timeout = (int)timeout_ms;
 
-  wait_rc = g_ctx.socket->wait_readable(state->socket_fd, timeout);
+  if (state->wake_fd >= 0 && g_ctx.socket->wait_readable_or_wake) {
+    wait_rc = g_ctx.socket->wait_readable_or_wake(state->socket_fd, state->wake_fd, timeout);
+  } else {
+    wait_rc = g_ctx.socket->wait_readable(state->socket_fd, timeout);
+  }
   if (wait_rc <= 0) {
     return wait_rc;
   }
@@ -168,6 +199,7 @@ static int m7mux_ingress_pump(M7MuxIngressState *state, uint64_t timeout_ms) {
                                   &ingress.client_port)) {
       break;
     }
+    m7mux_ingress_peer_to_addr(&peer, &ingress);
 
     /*
      * Packet-level encryption is determined during codec detection/decoding.
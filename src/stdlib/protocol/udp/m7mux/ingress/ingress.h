@@ -14,6 +14,8 @@ typedef struct M7MuxIngress {
   size_t len;
   uint64_t received_ms;
   char ip[64];
+  uint8_t addr[16];                /* Network order; IPv4 (incl. v4-mapped) in the first 4 bytes */
+  uint8_t addr_family;             /* AF_INET or AF_INET6, 0 if unknown */
   uint16_t client_port;
   int encrypted;
   uint32_t magic;
@@ -23,6 +25,7 @@ typedef struct M7MuxIngress {
 
 typedef struct {
   int socket_fd;
+  int wake_fd;
   M7MuxIngress queue[M7MUX_INGRESS_QUEUE_CAPACITY];
   size_t queue_head;
   size_t queue_tail;
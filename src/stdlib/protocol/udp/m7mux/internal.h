@@ -8,12 +8,14 @@
 
 #include "connect/connect.h"
 #include "ingress/ingress.h"
+#include "limit/limit.h"
 #include "inbox/inbox.h"
 #include "normalize/normalize.h"
 #include "session/session.h"
 #include "outbox/outbox.h"
 #include "stream/stream.h"
 #include "egress/egress.h"
+#include "replay/replay.h"
 
 typedef enum M7MuxPolicyEnforceEncryption {
   M7MUX_POLICY_ENFORCE_ENCRYPTION_ANY = 0,
@@ -27,6 +29,7 @@ typedef enum M7MuxPolicyEnforceEncryption {
  */
 typedef struct M7MuxConnectState {
   int socket_fd;
+  int wake_fd;
   int owns_socket;
   int connected;
   char remote_ip[64];
@@ -37,9 +40,11 @@ typedef struct M7MuxState {
   M7MuxConnectState connect;
   M7MuxPolicyEnforceEncryption policy_enforce_encryption;
   M7MuxIngressState ingress;
+  M7MuxLimitState limit;
   M7MuxSessionState session;
   M7MuxStreamState stream;
   M7MuxEgressState egress;
+  M7MuxReplayState replay;
 } M7MuxState;
 
 typedef struct M7MuxInternalLib {
@@ -47,10 +52,12 @@ typedef struct M7MuxInternalLib {
   const M7MuxInboxLib *inbox;
   const M7MuxOutboxLib *outbox;
   const M7MuxIngressLib *ingress;
+  const M7MuxLimitLib *limit;
   const M7MuxNormalizeLib *normalize;
   const M7MuxSessionLib *session;
   const M7MuxStreamLib *stream;
   const M7MuxEgressLib *egress;
+  const M7MuxReplayLib *replay;
 } M7MuxInternalLib;
 
 #endif
@@ -0,0 +1,491 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "limit.h"
+
+#include <arpa/inet.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define M7MUX_LIMIT_TOKEN 1000u
+#define M7MUX_LIMIT_PREFIX_V4_DEFAULT 32u
+#define M7MUX_LIMIT_PREFIX_V6_DEFAULT 64u
+#define M7MUX_LIMIT_PEER_PROBE 8u
+
+static int m7mux_limit_init(void) {
+  return 1;
+}
+
+static void m7mux_limit_shutdown(void) {
+}
+
+static int m7mux_limit_state_init(M7MuxLimitState *state) {
+  uint64_t seed = 0u;
+
+  if (!state) {
+    return 0;
+  }
+
+  memset(state, 0, sizeof(*state));
+
+  /* Sources pick their own addresses; keep the slots they land in unguessable. */
+  if (getentropy(&seed, sizeof(seed)) != 0) {
+    seed = (uint64_t)(uintptr_t)state ^ 0x9e3779b97f4a7c15ull;
+  }
+  state->seed = seed;
+  return 1;
+}
+
+static void m7mux_limit_state_reset(M7MuxLimitState *state) {
+  (void)m7mux_limit_state_init(state);
+}
+
+/* Copy the sender's address with everything past the policy prefix cleared. */
+static int m7mux_limit_key(const M7MuxIngress *ingress,
+                           const M7MuxRateLimit *policy,
+                           uint8_t key[16],
+                           uint8_t *family) {
+  unsigned int prefix = 0u;
+  unsigned int width = 0u;
+  unsigned int i = 0u;
+
+  if (ingress->addr_family == AF_INET) {
+    prefix = policy->prefix_v4 ? policy->prefix_v4 : M7MUX_LIMIT_PREFIX_V4_DEFAULT;
+    width = 32u;
+  } else if (ingress->addr_family == AF_INET6) {
+    prefix = policy->prefix_v6 ? policy->prefix_v6 : M7MUX_LIMIT_PREFIX_V6_DEFAULT;
+    width = 128u;
+  } else {
+    return 0;
+  }
+
+  if (prefix > width) {
+    prefix = width;
+  }
+
+  memset(key, 0, 16);
+  for (i = 0u; i < prefix / 8u; ++i) {
+    key[i] = ingress->addr[i];
+  }
+  if (prefix % 8u) {
+    key[i] = (uint8_t)(ingress->addr[i] & (uint8_t)(0xffu << (8u - prefix % 8u)));
+  }
+
+  *family = ingress->addr_family;
+  return 1;
+}
+
+/* Seeded FNV-1a with a final avalanche so low and high bits are both usable. */
+static uint64_t m7mux_limit_hash(const M7MuxLimitState *state, const uint8_t key[16], uint8_t family) {
+  uint64_t hash = 1469598103934665603ull ^ state->seed;
+  size_t i = 0;
+
+  hash ^= family;
+  hash *= 1099511628211ull;
+  for (i = 0; i < 16u; ++i) {
+    hash ^= key[i];
+    hash *= 1099511628211ull;
+  }
+
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdull;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+static void m7mux_limit_sketch_decay(M7MuxLimitState *state, uint64_t now_ms) {
+  uint64_t windows = 0u;
+  size_t row = 0;
+  size_t col = 0;
+
+  if (now_ms < state->sketch_decay_at_ms) {
+    return;
+  }
+
+  windows = 1u + (now_ms - state->sketch_decay_at_ms) / M7MUX_LIMIT_SKETCH_WINDOW_MS;
+  for (row = 0; row < M7MUX_LIMIT_SKETCH_DEPTH; ++row) {
+    for (col = 0; col < M7MUX_LIMIT_SKETCH_WIDTH; ++col) {
+      state->sketch[row][col] = windows >= 32u ? 0u : state->sketch[row][col] >> windows;
+    }
+  }
+
+  state->sketch_decay_at_ms = now_ms + M7MUX_LIMIT_SKETCH_WINDOW_MS;
+}
+
+/* Count one datagram and return the sketch's estimate for its source. */
+static uint32_t m7mux_limit_sketch_add(M7MuxLimitState *state, uint64_t hash) {
+  uint64_t step = (hash >> 32) | 1u;
+  uint32_t estimate = UINT32_MAX;
+  size_t row = 0;
+
+  for (row = 0; row < M7MUX_LIMIT_SKETCH_DEPTH; ++row) {
+    uint32_t *cell = &state->sketch[row][(hash + row * step) & (M7MUX_LIMIT_SKETCH_WIDTH - 1u)];
+
+    if (*cell < UINT32_MAX) {
+      (*cell)++;
+    }
+    if (*cell < estimate) {
+      estimate = *cell;
+    }
+  }
+
+  return estimate;
+}
+
+static M7MuxLimitEntry *m7mux_limit_find(M7MuxLimitState *state,
+                                         uint64_t hash,
+                                         const uint8_t key[16],
+                                         uint8_t family) {
+  uint32_t at = state->buckets[hash & (M7MUX_LIMIT_BUCKETS - 1u)];
+
+  while (at) {
+    M7MuxLimitEntry *entry = &state->entries[at - 1u];
+
+    if (entry->family == family && memcmp(entry->key, key, 16) == 0) {
+      return entry;
+    }
+    at = entry->hash_next;
+  }
+
+  return NULL;
+}
+
+static void m7mux_limit_lru_unlink(M7MuxLimitState *state, M7MuxLimitEntry *entry) {
+  if (entry->lru_prev) {
+    state->entries[entry->lru_prev - 1u].lru_next = entry->lru_next;
+  } else {
+    state->lru_head = entry->lru_next;
+  }
+
+  if (entry->lru_next) {
+    state->entries[entry->lru_next - 1u].lru_prev = entry->lru_prev;
+  } else {
+    state->lru_tail = entry->lru_prev;
+  }
+
+  entry->lru_prev = 0u;
+  entry->lru_next = 0u;
+}
+
+static void m7mux_limit_lru_push(M7MuxLimitState *state, M7MuxLimitEntry *entry) {
+  uint32_t self = (uint32_t)(entry - state->entries) + 1u;
+
+  entry->lru_prev = 0u;
+  entry->lru_next = state->lru_head;
+  if (state->lru_head) {
+    state->entries[state->lru_head - 1u].lru_prev = self;
+  } else {
+    state->lru_tail = self;
+  }
+  state->lru_head = self;
+}
+
+static void m7mux_limit_hash_unlink(M7MuxLimitState *state, M7MuxLimitEntry *entry) {
+  uint32_t self = (uint32_t)(entry - state->entries) + 1u;
+  uint32_t *link = &state->buckets[m7mux_limit_hash(state, entry->key, entry->family) &
+                                   (M7MUX_LIMIT_BUCKETS - 1u)];
+
+  while (*link && *link != self) {
+    link = &state->entries[*link - 1u].hash_next;
+  }
+  if (*link) {
+    *link = entry->hash_next;
+  }
+  entry->hash_next = 0u;
+}
+
+/*
+ * A slot for a source not in the table, or NULL to shed it. Past capacity
+ * the coldest entry is reused, unless the newcomer is already a heavy hitter.
+ */
+static M7MuxLimitEntry *m7mux_limit_claim(M7MuxLimitState *state,
+                                          uint64_t hash,
+                                          const uint8_t key[16],
+                                          uint8_t family,
+                                          uint32_t estimate,
+                                          uint64_t burst,
+                                          uint64_t now_ms) {
+  M7MuxLimitEntry *entry = NULL;
+  uint32_t *head = &state->buckets[hash & (M7MUX_LIMIT_BUCKETS - 1u)];
+
+  if (state->count < M7MUX_LIMIT_CAPACITY) {
+    entry = &state->entries[state->count++];
+    entry->tokens = burst * M7MUX_LIMIT_TOKEN;
+  } else {
+    if (estimate > burst || !state->lru_tail) {
+      return NULL;
+    }
+
+    entry = &state->entries[state->lru_tail - 1u];
+    m7mux_limit_hash_unlink(state, entry);
+    m7mux_limit_lru_unlink(state, entry);
+    state->stats.evictions++;
+    entry->tokens = (burst - (estimate - 1u)) * M7MUX_LIMIT_TOKEN;
+  }
+
+  memcpy(entry->key, key, 16);
+  entry->family = family;
+  entry->refill_ms = now_ms;
+  entry->hash_next = *head;
+  *head = (uint32_t)(entry - state->entries) + 1u;
+  m7mux_limit_lru_push(state, entry);
+  return entry;
+}
+
+static void m7mux_limit_refill(M7MuxLimitEntry *entry, uint64_t rate, uint64_t burst, uint64_t now_ms) {
+  uint64_t cap = burst * M7MUX_LIMIT_TOKEN;
+  uint64_t elapsed = now_ms > entry->refill_ms ? now_ms - entry->refill_ms : 0u;
+
+  entry->refill_ms = now_ms;
+  if (elapsed >= cap / rate + 1u) {
+    entry->tokens = cap;
+    return;
+  }
+
+  /* rate packets per second is rate thousandths of a packet per millisecond. */
+  entry->tokens += elapsed * rate;
+  if (entry->tokens > cap) {
+    entry->tokens = cap;
+  }
+}
+
+static void m7mux_limit_shed(M7MuxLimitState *state, const M7MuxIngress *ingress, uint64_t *counter) {
+  (*counter)++;
+  memcpy(state->stats.last_shed_ip, ingress->ip, sizeof(state->stats.last_shed_ip));
+  state->stats.last_shed_ip[sizeof(state->stats.last_shed_ip) - 1u] = '\0';
+}
+
+static int m7mux_limit_admit(M7MuxLimitState *state,
+                             const M7MuxIngress *ingress,
+                             uint64_t now_ms,
+                             const M7MuxRateLimit *policy) {
+  M7MuxLimitEntry *entry = NULL;
+  uint8_t key[16];
+  uint8_t family = 0u;
+  uint64_t burst = 0u;
+  uint64_t hash = 0u;
+  uint32_t estimate = 0u;
+
+  if (!state || !ingress || !policy || policy->rate == 0u) {
+    return 1;
+  }
+
+  if (!m7mux_limit_key(ingress, policy, key, &family)) {
+    state->stats.admitted++;
+    return 1;
+  }
+
+  burst = policy->burst ? policy->burst : policy->rate;
+  hash = m7mux_limit_hash(state, key, family);
+  m7mux_limit_sketch_decay(state, now_ms);
+  estimate = m7mux_limit_sketch_add(state, hash);
+
+  entry = m7mux_limit_find(state, hash, key, family);
+  if (entry) {
+    m7mux_limit_refill(entry, policy->rate, burst, now_ms);
+    m7mux_limit_lru_unlink(state, entry);
+    m7mux_limit_lru_push(state, entry);
+  } else {
+    entry = m7mux_limit_claim(state, hash, key, family, estimate, burst, now_ms);
+    state->stats.tracked = state->count;
+    if (!entry) {
+      m7mux_limit_shed(state, ingress, &state->stats.shed_heavy);
+      return 0;
+    }
+  }
+
+  if (entry->tokens < M7MUX_LIMIT_TOKEN) {
+    m7mux_limit_shed(state, ingress, &state->stats.shed_rate);
+    return 0;
+  }
+
+  entry->tokens -= M7MUX_LIMIT_TOKEN;
+  state->stats.admitted++;
+  return 1;
+}
+
+static void m7mux_limit_assess(M7MuxLimitState *state, size_t queued, uint32_t high_water) {
+  size_t load = 0;
+  size_t level = 0;
+
+  if (!state) {
+    return;
+  }
+
+  load = queued + state->backlog;
+  if (high_water == 0u) {
+    level = 0u;
+  } else if (load >= high_water) {
+    /* Deeper past the mark, or still over it since the last pump, sheds harder. */
+    level = 1u + (load - high_water) / high_water;
+    if (level <= state->overload_level) {
+      level = state->overload_level + 1u;
+    }
+    if (level > M7MUX_LIMIT_OVERLOAD_LEVEL_MAX) {
+      level = M7MUX_LIMIT_OVERLOAD_LEVEL_MAX;
+    }
+  } else if (state->overload_level > 0u) {
+    /* Ease off a step at a time so a lull between bursts does not reopen the gate. */
+    level = state->overload_level - 1u;
+  }
+
+  state->overload_level = (uint32_t)level;
+  state->stats.overload_level = (uint32_t)level;
+}
+
+/* First slot of the peer's probe window; peers use whole addresses, not prefixes. */
+static size_t m7mux_limit_peer_home(const M7MuxLimitState *state, const uint8_t addr[16], uint8_t family) {
+  return (size_t)(m7mux_limit_hash(state, addr, family) & (M7MUX_LIMIT_PEER_CAPACITY - 1u));
+}
+
+static M7MuxLimitPeer *m7mux_limit_peer_find(M7MuxLimitState *state, const uint8_t addr[16], uint8_t family) {
+  size_t home = m7mux_limit_peer_home(state, addr, family);
+  size_t i = 0;
+
+  for (i = 0; i < M7MUX_LIMIT_PEER_PROBE; ++i) {
+    M7MuxLimitPeer *peer = &state->peers[(home + i) & (M7MUX_LIMIT_PEER_CAPACITY - 1u)];
+
+    if (peer->family == family && memcmp(peer->addr, addr, 16) == 0) {
+      return peer;
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * A slot for a peer not yet recorded. An expired slot is taken first, then
+ * the one closest to expiry. A failure may only take a slot that holds no
+ * current trust, so a flood of bad requests cannot age out the operators.
+ */
+static M7MuxLimitPeer *m7mux_limit_peer_claim(M7MuxLimitState *state,
+                                              const uint8_t addr[16],
+                                              uint8_t family,
+                                              int authenticated,
+                                              uint64_t now_ms) {
+  M7MuxLimitPeer *best = NULL;
+  uint64_t best_until = UINT64_MAX;
+  size_t home = m7mux_limit_peer_home(state, addr, family);
+  size_t i = 0;
+
+  for (i = 0; i < M7MUX_LIMIT_PEER_PROBE; ++i) {
+    M7MuxLimitPeer *peer = &state->peers[(home + i) & (M7MUX_LIMIT_PEER_CAPACITY - 1u)];
+    uint64_t until = peer->trusted_until_ms > peer->failed_until_ms ? peer->trusted_until_ms
+                                                                   : peer->failed_until_ms;
+
+    if (!authenticated && peer->trusted_until_ms > now_ms) {
+      continue;
+    }
+    if (peer->family == 0u || until <= now_ms) {
+      best = peer;
+      break;
+    }
+    if (until < best_until) {
+      best = peer;
+      best_until = until;
+    }
+  }
+
+  if (best) {
+    memset(best, 0, sizeof(*best));
+    memcpy(best->addr, addr, 16);
+    best->family = family;
+  }
+
+  return best;
+}
+
+static void m7mux_limit_note_peer(M7MuxLimitState *state, const char *ip, int authenticated, uint64_t now_ms) {
+  static const uint8_t v4_mapped[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff };
+  M7MuxLimitPeer *peer = NULL;
+  uint8_t addr[16];
+  uint8_t family = 0u;
+
+  if (!state || !ip) {
+    return;
+  }
+
+  /* Same layout the ingress stage gives each datagram. */
+  memset(addr, 0, sizeof(addr));
+  if (inet_pton(AF_INET, ip, addr) == 1) {
+    family = AF_INET;
+  } else if (inet_pton(AF_INET6, ip, addr) == 1) {
+    family = AF_INET6;
+    if (memcmp(addr, v4_mapped, sizeof(v4_mapped)) == 0) {
+      memmove(addr, addr + 12, 4);
+      memset(addr + 4, 0, 12);
+      family = AF_INET;
+    }
+  } else {
+    return;
+  }
+
+  peer = m7mux_limit_peer_find(state, addr, family);
+  if (!peer) {
+    peer = m7mux_limit_peer_claim(state, addr, family, authenticated, now_ms);
+  }
+  if (!peer) {
+    return;
+  }
+
+  if (authenticated) {
+    peer->trusted_until_ms = now_ms + M7MUX_LIMIT_TRUST_MS;
+    peer->failed_until_ms = 0u;
+  } else {
+    peer->failed_until_ms = now_ms + M7MUX_LIMIT_FAIL_MS;
+  }
+}
+
+static int m7mux_limit_triage(M7MuxLimitState *state, const M7MuxIngress *ingress, uint64_t now_ms) {
+  const M7MuxLimitPeer *peer = NULL;
+  uint64_t mask = 0u;
+
+  if (!state || !ingress || state->overload_level == 0u) {
+    return 1;
+  }
+
+  if (ingress->addr_family == AF_INET || ingress->addr_family == AF_INET6) {
+    peer = m7mux_limit_peer_find(state, ingress->addr, ingress->addr_family);
+  }
+
+  /*
+   * Trust is checked first: a source address can be spoofed, so a failure
+   * reported against it must not lock its operator out.
+   */
+  if (peer && peer->trusted_until_ms > now_ms) {
+    state->stats.trusted_admitted++;
+    return 1;
+  }
+
+  /* A peer that just failed is dropped ahead of anyone unknown. */
+  if (peer && peer->failed_until_ms > now_ms) {
+    m7mux_limit_shed(state, ingress, &state->stats.shed_failed);
+    return 0;
+  }
+
+  mask = (1ull << state->overload_level) - 1u;
+  if ((state->sample_seq++ & mask) != 0u) {
+    m7mux_limit_shed(state, ingress, &state->stats.shed_sampled);
+    return 0;
+  }
+
+  return 1;
+}
+
+static const M7MuxLimitLib _instance = {
+  .init = m7mux_limit_init,
+  .shutdown = m7mux_limit_shutdown,
+  .state_init = m7mux_limit_state_init,
+  .state_reset = m7mux_limit_state_reset,
+  .admit = m7mux_limit_admit,
+  .assess = m7mux_limit_assess,
+  .triage = m7mux_limit_triage,
+  .note_peer = m7mux_limit_note_peer
+};
+
+const M7MuxLimitLib *get_protocol_udp_m7mux_limit_lib(void) {
+  return &_instance;
+}
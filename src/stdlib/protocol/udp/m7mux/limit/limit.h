@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef LIB_PROTOCOL_UDP_M7MUX_LIMIT_H
+#define LIB_PROTOCOL_UDP_M7MUX_LIMIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../m7mux.h"
+#include "../ingress/ingress.h"
+
+#define M7MUX_LIMIT_CAPACITY 4096u
+#define M7MUX_LIMIT_BUCKETS 8192u
+#define M7MUX_LIMIT_SKETCH_DEPTH 4u
+#define M7MUX_LIMIT_SKETCH_WIDTH 1024u
+#define M7MUX_LIMIT_SKETCH_WINDOW_MS 1000u
+#define M7MUX_LIMIT_PEER_CAPACITY 256u
+#define M7MUX_LIMIT_TRUST_MS 600000u
+#define M7MUX_LIMIT_FAIL_MS 60000u
+#define M7MUX_LIMIT_OVERLOAD_LEVEL_MAX 4u
+
+/*
+ * Per-source rate limit, checked before a datagram is replayed or decoded.
+ *
+ * Each source prefix gets a token bucket in a fixed table, kept in LRU order
+ * and reused from the cold end once full. Every datagram is also counted in
+ * a count-min sketch whose counters halve each window. When the table is full,
+ * a new source whose recent count already exceeds the burst is shed without
+ * taking a slot. Otherwise it takes the coldest slot with its recent count
+ * already charged against its bucket. A host cannot get a fresh bucket by
+ * waiting to be evicted, and spraying new addresses cannot push the
+ * established ones out.
+ */
+typedef struct {
+  uint8_t key[16];
+  uint8_t family;
+  uint64_t tokens;                 /* Thousandths of a packet */
+  uint64_t refill_ms;
+  uint32_t hash_next;              /* Entry index + 1, 0 = end */
+  uint32_t lru_prev;
+  uint32_t lru_next;
+} M7MuxLimitEntry;
+
+/*
+ * Overload admission.
+ *
+ * Once the datagrams waiting in ingress plus the caller's own backlog reach
+ * the high-water mark, each datagram is classed by its sender before decode:
+ * a peer that failed authentication in the last minute is dropped, one that
+ * authenticated in the last ten minutes is let through, and everyone else is
+ * sampled down: 1 in 2 at the mark, halving again for each further multiple
+ * of it and for each pump the load stays over it, to at most 1 in 16. Below
+ * the mark the rate recovers one step per pump. Peers are whole addresses;
+ * trust only comes from the caller reporting a request that passed
+ * authentication, and failures neither override nor displace it.
+ */
+typedef struct {
+  uint8_t addr[16];
+  uint8_t family;
+  uint64_t trusted_until_ms;
+  uint64_t failed_until_ms;
+} M7MuxLimitPeer;
+
+typedef struct {
+  M7MuxLimitEntry entries[M7MUX_LIMIT_CAPACITY];
+  uint32_t buckets[M7MUX_LIMIT_BUCKETS];
+  uint32_t lru_head;               /* Most recent; entry index + 1 */
+  uint32_t lru_tail;
+  uint32_t count;
+  uint32_t sketch[M7MUX_LIMIT_SKETCH_DEPTH][M7MUX_LIMIT_SKETCH_WIDTH];
+  uint64_t sketch_decay_at_ms;
+  uint64_t seed;
+  M7MuxLimitPeer peers[M7MUX_LIMIT_PEER_CAPACITY];
+  size_t backlog;                  /* Caller's queued work, set through the inbox */
+  uint32_t overload_level;         /* 0 = not overloaded */
+  uint64_t sample_seq;
+  M7MuxLimitStats stats;
+} M7MuxLimitState;
+
+typedef struct {
+  int (*init)(void);
+  void (*shutdown)(void);
+  int (*state_init)(M7MuxLimitState *state);
+  void (*state_reset)(M7MuxLimitState *state);
+  /* 1 to let the datagram through, 0 to drop it; always 1 while policy is off. */
+  int (*admit)(M7MuxLimitState *state,
+               const M7MuxIngress *ingress,
+               uint64_t now_ms,
+               const M7MuxRateLimit *policy);
+  /* Recompute the overload level from queued datagrams plus the backlog. */
+  void (*assess)(M7MuxLimitState *state, size_t queued, uint32_t high_water);
+  /* 1 to let the datagram through at the current overload level. */
+  int (*triage)(M7MuxLimitState *state, const M7MuxIngress *ingress, uint64_t now_ms);
+  /* Record that a request from ip passed or failed authentication. */
+  void (*note_peer)(M7MuxLimitState *state, const char *ip, int authenticated, uint64_t now_ms);
+} M7MuxLimitLib;
+
+const M7MuxLimitLib *get_protocol_udp_m7mux_limit_lib(void);
+
+#endif
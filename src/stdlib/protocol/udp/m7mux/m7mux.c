@@ -14,10 +14,12 @@ static const M7MuxConnectLib *g_connect = NULL;
 static const M7MuxInboxLib *g_inbox = NULL;
 static const M7MuxOutboxLib *g_outbox = NULL;
 static const M7MuxIngressLib *g_ingress = NULL;
+static const M7MuxLimitLib *g_limit = NULL;
 static const M7MuxNormalizeLib *g_normalize = NULL;
 static const M7MuxSessionLib *g_session = NULL;
 static const M7MuxStreamLib *g_stream = NULL;
 static const M7MuxEgressLib *g_egress = NULL;
+static const M7MuxReplayLib *g_replay = NULL;
 static M7MuxLib g_lib = {0};
 
 #define M7MUX_FLUSH_OUTBOX_OR_RETURN(_state, _now_ms, _did_work, _inbox_timeout) \
@@ -76,6 +78,12 @@ static void m7mux_shutdown_bundle(void) {
   if (g_ingress && g_ingress->shutdown) {
     g_ingress->shutdown();
   }
+  if (g_replay && g_replay->shutdown) {
+    g_replay->shutdown();
+  }
+  if (g_limit && g_limit->shutdown) {
+    g_limit->shutdown();
+  }
 
   g_connect = NULL;
   g_inbox = NULL;
@@ -85,6 +93,8 @@ static void m7mux_shutdown_bundle(void) {
   g_session = NULL;
   g_stream = NULL;
   g_egress = NULL;
+  g_replay = NULL;
+  g_limit = NULL;
   memset(&g_internal, 0, sizeof(g_internal));
   m7mux_reset_context();
 }
@@ -98,6 +108,8 @@ static int m7mux_init(const M7MuxContext *ctx) {
   g_session = get_protocol_udp_m7mux_session_lib();
   g_stream = get_protocol_udp_m7mux_stream_lib();
   g_egress = get_protocol_udp_m7mux_egress_lib();
+  g_replay = get_protocol_udp_m7mux_replay_lib();
+  g_limit = get_protocol_udp_m7mux_limit_lib();
 
   g_internal.connect = g_connect;
   g_internal.inbox = g_inbox;
@@ -107,6 +119,8 @@ static int m7mux_init(const M7MuxContext *ctx) {
   g_internal.session = g_session;
   g_internal.stream = g_stream;
   g_internal.egress = g_egress;
+  g_internal.replay = g_replay;
+  g_internal.limit = g_limit;
 
   if (!m7mux_apply_context(ctx)) {
     return 0;
@@ -120,6 +134,8 @@ static int m7mux_init(const M7MuxContext *ctx) {
       !g_session->init() ||
       !g_stream->init() ||
       !g_egress->init() ||
+      !g_replay->init() ||
+      !g_limit->init() ||
       !g_connect->set_context(&g_ctx) ||
       !g_inbox->set_context(&g_ctx) ||
       !g_outbox->set_context(&g_ctx) ||
@@ -22,6 +22,31 @@
  * and egress live in the nested submodules below this layer.
  */
 
+/*
+ * Per-source datagram limit applied before decode. rate is packets per
+ * second refilled into a bucket of burst packets; sources are grouped by the
+ * given prefix lengths. rate 0 turns the limit off.
+ */
+typedef struct M7MuxRateLimit {
+  uint32_t rate;
+  uint32_t burst;
+  uint8_t prefix_v4;
+  uint8_t prefix_v6;
+} M7MuxRateLimit;
+
+typedef struct M7MuxLimitStats {
+  uint64_t admitted;
+  uint64_t shed_rate;          /* Tracked source with an empty bucket */
+  uint64_t shed_heavy;         /* New source over the burst while the table was full */
+  uint64_t evictions;
+  uint64_t shed_failed;        /* Overloaded; peer recently failed authentication */
+  uint64_t shed_sampled;       /* Overloaded; unknown peer not picked by sampling */
+  uint64_t trusted_admitted;   /* Overloaded; let through as a recently authenticated peer */
+  uint32_t tracked;
+  uint32_t overload_level;     /* 0 = not overloaded, else sampling 1 in 2^level */
+  char last_shed_ip[64];
+} M7MuxLimitStats;
+
 typedef struct M7MuxContext {
   const SocketLib *socket;
   const UdpLib *udp;
@@ -29,6 +54,11 @@ typedef struct M7MuxContext {
   const SharedKnockCodecContext *codec_context;
   int enforce_wire_decode;
   int enforce_wire_auth;
+  /* How long a request's reply is kept for retransmits; 0 disables. */
+  uint64_t reply_cache_ms;
+  M7MuxRateLimit rate_limit;
+  /* Queued datagrams plus caller backlog that start overload admission; 0 disables. */
+  uint32_t overload_high_water;
   const struct M7MuxInternalLib *internal;
   void *reserved;
 } M7MuxContext;
@@ -59,6 +59,8 @@ typedef struct M7MuxRecvPacket {
   int wire_auth;
   uint8_t raw_bytes[M7MUX_NORMALIZED_PACKET_BUFFER_SIZE];
   size_t raw_bytes_len;
+  /* Reply cache handle for this datagram; 0 when caching is off. */
+  uint64_t request_key;
   const M7MuxUserRecvData *user;
 } M7MuxRecvPacket;
 
@@ -78,6 +80,10 @@ typedef struct M7MuxSendPacket {
   uint16_t client_port;
   int encrypted;
   int wire_auth;
+  uint64_t request_key;
+  /* Further requests this reply also answers; each remembers it too. */
+  const uint64_t *shared_keys;
+  size_t shared_key_count;
   const M7MuxUserSendData *user;
 } M7MuxSendPacket;
 
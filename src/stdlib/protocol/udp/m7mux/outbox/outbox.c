@@ -62,6 +62,33 @@ static int m7mux_outbox_has_pending(const M7MuxState *state) {
   return g_ctx.internal->egress->has_pending(&state->egress);
 }
 
+/* Keep the encoded reply so a retransmitted request can be answered from it. */
+static void m7mux_outbox_remember(M7MuxState *state,
+                                  uint64_t request_key,
+                                  const M7MuxEgressData *serialized) {
+  if (request_key == 0u || g_ctx.reply_cache_ms == 0u || !g_ctx.time) {
+    return;
+  }
+
+  (void)g_ctx.internal->replay->store(&state->replay,
+                                      request_key,
+                                      serialized,
+                                      g_ctx.time->monotonic_ms(),
+                                      g_ctx.reply_cache_ms);
+}
+
+/* Remember it under the send's own key and every key it answers for. */
+static void m7mux_outbox_remember_send(M7MuxState *state,
+                                       const M7MuxSendPacket *send,
+                                       const M7MuxEgressData *serialized) {
+  size_t i = 0u;
+
+  m7mux_outbox_remember(state, send->request_key, serialized);
+  for (i = 0u; send->shared_keys && i < send->shared_key_count; ++i) {
+    m7mux_outbox_remember(state, send->shared_keys[i], serialized);
+  }
+}
+
 static const M7MuxNormalizeAdapter *m7mux_outbox_select_adapter(const M7MuxSendPacket *send) {
   if (!send) {
     return NULL;
@@ -122,6 +149,7 @@ static int m7mux_outbox_stage_common(M7MuxState *state,
       return 0;
     }
 
+    m7mux_outbox_remember_send(state, send, &serialized);
     return 1;
   }
 
@@ -156,6 +184,8 @@ static int m7mux_outbox_stage_common(M7MuxState *state,
       free(fragments);
       return 0;
     }
+
+    m7mux_outbox_remember_send(state, send, &fragments[i]);
   }
 
   free(fragments);
@@ -205,7 +235,12 @@ static int m7mux_outbox_stage_bytes(M7MuxState *state, const M7MuxSendBytesPacke
     memcpy(serialized.egress_buffer, send_bytes->bytes, send_bytes->bytes_len);
   }
 
-  return g_ctx.internal->egress->stage(&state->egress, &serialized);
+  if (!g_ctx.internal->egress->stage(&state->egress, &serialized)) {
+    return 0;
+  }
+
+  m7mux_outbox_remember(state, send_bytes->request_key, &serialized);
+  return 1;
 }
 
 static int m7mux_outbox_flush(M7MuxState *state, int sock, uint64_t now_ms) {
@@ -20,6 +20,7 @@ typedef struct M7MuxSendBytesPacket {
   uint64_t received_ms;
   const uint8_t *bytes;
   size_t bytes_len;
+  uint64_t request_key;
 } M7MuxSendBytesPacket;
 typedef struct M7MuxEgressData M7MuxEgressData;
 typedef struct M7MuxState M7MuxState;
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#include "replay.h"
+
+#include <string.h>
+
+static int m7mux_replay_init(void) {
+  return 1;
+}
+
+static void m7mux_replay_shutdown(void) {
+}
+
+static int m7mux_replay_state_init(M7MuxReplayState *state) {
+  if (!state) {
+    return 0;
+  }
+
+  memset(state, 0, sizeof(*state));
+  state->next_key = 1u;
+  return 1;
+}
+
+static void m7mux_replay_state_reset(M7MuxReplayState *state) {
+  (void)m7mux_replay_state_init(state);
+}
+
+/* FNV-1a; only used to skip entries cheaply before the byte compare. */
+static uint64_t m7mux_replay_digest(const uint8_t *bytes, size_t len) {
+  uint64_t hash = 1469598103934665603ull;
+  size_t i = 0;
+
+  for (i = 0; i < len; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+
+  return hash;
+}
+
+static M7MuxReplayEntry *m7mux_replay_find_key(M7MuxReplayState *state, uint64_t key) {
+  size_t i = 0;
+
+  if (!state || key == 0u) {
+    return NULL;
+  }
+
+  for (i = 0; i < M7MUX_REPLAY_CAPACITY; ++i) {
+    if (state->entries[i].active && state->entries[i].key == key) {
+      return &state->entries[i];
+    }
+  }
+
+  return NULL;
+}
+
+/* Free slot first, else the entry closest to expiring. */
+static M7MuxReplayEntry *m7mux_replay_claim(M7MuxReplayState *state) {
+  M7MuxReplayEntry *oldest = NULL;
+  size_t i = 0;
+
+  for (i = 0; i < M7MUX_REPLAY_CAPACITY; ++i) {
+    M7MuxReplayEntry *entry = &state->entries[i];
+
+    if (!entry->active) {
+      return entry;
+    }
+
+    if (!oldest || entry->expires_at_ms < oldest->expires_at_ms) {
+      oldest = entry;
+    }
+  }
+
+  return oldest;
+}
+
+static M7MuxReplayResult m7mux_replay_admit(M7MuxReplayState *state,
+                                            const M7MuxIngress *ingress,
+                                            uint64_t now_ms,
+                                            uint64_t window_ms,
+                                            uint64_t *out_key,
+                                            M7MuxEgressData *out_reply) {
+  M7MuxReplayEntry *entry = NULL;
+  uint64_t digest = 0u;
+  size_t i = 0;
+
+  if (out_key) {
+    *out_key = 0u;
+  }
+
+  if (!state || !ingress || window_ms == 0u || ingress->len == 0u ||
+      ingress->len > sizeof(entry->request)) {
+    return M7MUX_REPLAY_MISS;
+  }
+
+  digest = m7mux_replay_digest(ingress->buffer, ingress->len);
+  for (i = 0; i < M7MUX_REPLAY_CAPACITY; ++i) {
+    entry = &state->entries[i];
+
+    if (!entry->active || entry->digest != digest ||
+        entry->request_len != ingress->len ||
+        entry->expires_at_ms <= now_ms ||
+        strncmp(entry->ip, ingress->ip, sizeof(entry->ip)) != 0 ||
+        memcmp(entry->request, ingress->buffer, ingress->len) != 0) {
+      continue;
+    }
+
+    if (entry->state == M7MUX_REPLAY_ENTRY_READY && out_reply) {
+      *out_reply = entry->reply;
+      out_reply->client_port = ingress->client_port;
+      out_reply->received_ms = ingress->received_ms;
+      state->hits++;
+      return M7MUX_REPLAY_HIT;
+    }
+
+    state->duplicates++;
+    return M7MUX_REPLAY_DUPLICATE;
+  }
+
+  entry = m7mux_replay_claim(state);
+  memset(entry, 0, sizeof(*entry));
+  entry->active = 1;
+  entry->key = state->next_key++;
+  if (state->next_key == 0u) {
+    state->next_key = 1u;
+  }
+  entry->digest = digest;
+  entry->expires_at_ms = now_ms + window_ms;
+  entry->state = M7MUX_REPLAY_ENTRY_PENDING;
+  memcpy(entry->ip, ingress->ip, sizeof(entry->ip));
+  entry->ip[sizeof(entry->ip) - 1u] = '\0';
+  entry->request_len = ingress->len;
+  memcpy(entry->request, ingress->buffer, ingress->len);
+
+  if (out_key) {
+    *out_key = entry->key;
+  }
+
+  return M7MUX_REPLAY_MISS;
+}
+
+static int m7mux_replay_store(M7MuxReplayState *state,
+                              uint64_t key,
+                              const M7MuxEgressData *reply,
+                              uint64_t now_ms,
+                              uint64_t window_ms) {
+  M7MuxReplayEntry *entry = m7mux_replay_find_key(state, key);
+
+  if (!entry || !reply) {
+    return 0;
+  }
+
+  if (entry->state != M7MUX_REPLAY_ENTRY_PENDING) {
+    entry->state = M7MUX_REPLAY_ENTRY_SPENT;
+    return 0;
+  }
+
+  entry->reply = *reply;
+  entry->state = M7MUX_REPLAY_ENTRY_READY;
+  entry->expires_at_ms = now_ms + window_ms;
+  return 1;
+}
+
+static void m7mux_replay_forget(M7MuxReplayState *state, uint64_t key) {
+  M7MuxReplayEntry *entry = m7mux_replay_find_key(state, key);
+
+  if (entry) {
+    entry->active = 0;
+  }
+}
+
+static int m7mux_replay_expire(M7MuxReplayState *state, uint64_t now_ms) {
+  int expired = 0;
+  size_t i = 0;
+
+  if (!state) {
+    return 0;
+  }
+
+  for (i = 0; i < M7MUX_REPLAY_CAPACITY; ++i) {
+    if (state->entries[i].active && state->entries[i].expires_at_ms <= now_ms) {
+      state->entries[i].active = 0;
+      expired++;
+    }
+  }
+
+  return expired;
+}
+
+static const M7MuxReplayLib _instance = {
+  .init = m7mux_replay_init,
+  .shutdown = m7mux_replay_shutdown,
+  .state_init = m7mux_replay_state_init,
+  .state_reset = m7mux_replay_state_reset,
+  .admit = m7mux_replay_admit,
+  .store = m7mux_replay_store,
+  .forget = m7mux_replay_forget,
+  .expire = m7mux_replay_expire
+};
+
+const M7MuxReplayLib *get_protocol_udp_m7mux_replay_lib(void) {
+  return &_instance;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2025 m7.org
+ * License: MTL-10 (see LICENSE.md)
+ */
+
+#ifndef LIB_PROTOCOL_UDP_M7MUX_REPLAY_H
+#define LIB_PROTOCOL_UDP_M7MUX_REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../ingress/ingress.h"
+#include "../normalize/normalize.h"
+
+#define M7MUX_REPLAY_CAPACITY 64u
+
+/*
+ * Reply cache for retransmitted requests.
+ *
+ * Every datagram that goes on to be decoded is remembered, byte for byte,
+ * for the configured window. A second copy from the same address is either
+ * answered with the reply staged for the first one, or dropped while that
+ * first one is still being handled. Either way it is never decoded or
+ * dispatched again.
+ *
+ * A request that produced more than one reply packet is not replayable; its
+ * duplicates are dropped for the rest of the window.
+ */
+typedef enum {
+  M7MUX_REPLAY_MISS = 0,
+  M7MUX_REPLAY_HIT = 1,
+  M7MUX_REPLAY_DUPLICATE = 2
+} M7MuxReplayResult;
+
+typedef enum {
+  M7MUX_REPLAY_ENTRY_PENDING = 0,
+  M7MUX_REPLAY_ENTRY_READY = 1,
+  M7MUX_REPLAY_ENTRY_SPENT = 2
+} M7MuxReplayEntryState;
+
+typedef struct {
+  uint64_t key;
+  uint64_t digest;
+  uint64_t expires_at_ms;
+  M7MuxReplayEntryState state;
+  char ip[64];
+  size_t request_len;
+  uint8_t request[M7MUX_NORMALIZED_PACKET_BUFFER_SIZE];
+  M7MuxEgressData reply;
+  int active;
+} M7MuxReplayEntry;
+
+typedef struct {
+  M7MuxReplayEntry entries[M7MUX_REPLAY_CAPACITY];
+  uint64_t next_key;
+  uint64_t hits;
+  uint64_t duplicates;
+} M7MuxReplayState;
+
+typedef struct {
+  int (*init)(void);
+  void (*shutdown)(void);
+  int (*state_init)(M7MuxReplayState *state);
+  void (*state_reset)(M7MuxReplayState *state);
+  /*
+   * Check one inbound datagram. MISS records it and returns its request key
+   * in out_key; HIT copies the cached reply, readdressed to the sender, into
+   * out_reply.
+   */
+  M7MuxReplayResult (*admit)(M7MuxReplayState *state,
+                             const M7MuxIngress *ingress,
+                             uint64_t now_ms,
+                             uint64_t window_ms,
+                             uint64_t *out_key,
+                             M7MuxEgressData *out_reply);
+  /* Attach the encoded reply for key; a second reply marks it unreplayable. */
+  int (*store)(M7MuxReplayState *state,
+               uint64_t key,
+               const M7MuxEgressData *reply,
+               uint64_t now_ms,
+               uint64_t window_ms);
+  /* Drop a key whose request never reached the app, so a retry is processed. */
+  void (*forget)(M7MuxReplayState *state, uint64_t key);
+  int (*expire)(M7MuxReplayState *state, uint64_t now_ms);
+} M7MuxReplayLib;
+
+const M7MuxReplayLib *get_protocol_udp_m7mux_replay_lib(void);
+
+#endif
@@ -173,6 +173,21 @@ static int m7mux_session_register(M7MuxSessionState *state,
     }
   }
 
+  /*
+   * With every slot taken, the least recently active session gives way. It
+   * would otherwise take a full timeout before any new peer got through.
+   */
+  if (state->session_count >= M7MUX_SESSION_SESSION_CAPACITY) {
+    M7MuxSession *coldest = &state->sessions[0];
+
+    for (i = 1; i < M7MUX_SESSION_SESSION_CAPACITY; ++i) {
+      if (state->sessions[i].last_active_ms < coldest->last_active_ms) {
+        coldest = &state->sessions[i];
+      }
+    }
+    m7mux_session_clear(state, coldest);
+  }
+
   for (i = 0; i < M7MUX_SESSION_SESSION_CAPACITY; ++i) {
     if (!state->sessions[i].active) {
       memset(&state->sessions[i], 0, sizeof(state->sessions[i]));
@@ -71,25 +71,56 @@ static int m7mux_stream_is_expired(const M7MuxRecvPacket *slot, uint64_t now_ms)
   return (now_ms - slot->received_ms) >= M7MUX_STREAM_EXPIRE_AFTER_MS;
 }
 
+static int m7mux_stream_session_has_queued(const M7MuxStreamState *state, uint64_t session_id) {
+  size_t i = 0;
+
+  for (i = 0; i < M7MUX_STREAM_READY_QUEUE_CAPACITY; ++i) {
+    if (state->ready_queue[i].session_id == session_id) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Trackers are normally dropped by release_session(). A peer that never
+ * comes back, or a server that never releases, would otherwise hold its slot
+ * forever, so with no free slot left the least recently active tracker with
+ * nothing queued is reused.
+ */
 static M7MuxStreamSessionTracker *m7mux_stream_find_session_tracker(M7MuxStreamState *state,
                                                                    uint64_t session_id,
                                                                    int create) {
   size_t i = 0;
   M7MuxStreamSessionTracker *free_slot = NULL;
+  M7MuxStreamSessionTracker *coldest = NULL;
 
   if (!state || session_id == 0u) {
     return NULL;
   }
 
   for (i = 0; i < M7MUX_STREAM_SESSION_TRACKER_CAPACITY; ++i) {
-    if (state->session_trackers[i].active &&
-        state->session_trackers[i].session_id == session_id) {
-      return &state->session_trackers[i];
+    M7MuxStreamSessionTracker *tracker = &state->session_trackers[i];
+
+    if (tracker->active && tracker->session_id == session_id) {
+      return tracker;
     }
 
-    if (create && !free_slot && !state->session_trackers[i].active) {
-      free_slot = &state->session_trackers[i];
+    if (!create || free_slot) {
+      continue;
     }
+
+    if (!tracker->active) {
+      free_slot = tracker;
+    } else if ((!coldest || tracker->last_active_ms < coldest->last_active_ms) &&
+               !m7mux_stream_session_has_queued(state, tracker->session_id)) {
+      coldest = tracker;
+    }
+  }
+
+  if (create && !free_slot) {
+    free_slot = coldest;
   }
 
   if (!create || !free_slot) {
@@ -265,6 +296,7 @@ static int m7mux_stream_ingest(M7MuxStreamState *state, const M7MuxRecvPacket *n
   if (!session_tracker) {
     return 0;
   }
+  session_tracker->last_active_ms = packet.received_ms;
 
   if (packet.stream_id == 0u) {
     packet.stream_id = session_tracker->next_stream_id++;
@@ -444,9 +476,45 @@ static int m7mux_stream_expire(M7MuxStreamState *state, uint64_t now_ms) {
     expired++;
   }
 
+  for (i = 0; i < M7MUX_STREAM_SESSION_TRACKER_CAPACITY; ++i) {
+    M7MuxStreamSessionTracker *tracker = &state->session_trackers[i];
+
+    if (!tracker->active || now_ms < tracker->last_active_ms ||
+        now_ms - tracker->last_active_ms < M7MUX_STREAM_EXPIRE_AFTER_MS ||
+        m7mux_stream_session_has_queued(state, tracker->session_id)) {
+      continue;
+    }
+
+    memset(tracker, 0, sizeof(*tracker));
+  }
+
   return expired;
 }
 
+/*
+ * Drop the tracker for a session the caller is done with. Kept while any of
+ * its packets are still queued, since drain needs the tracker to deliver them.
+ */
+static int m7mux_stream_release_session(M7MuxStreamState *state, uint64_t session_id) {
+  M7MuxStreamSessionTracker *session_tracker = NULL;
+
+  if (!state || session_id == 0u) {
+    return 0;
+  }
+
+  if (m7mux_stream_session_has_queued(state, session_id)) {
+    return 0;
+  }
+
+  session_tracker = m7mux_stream_find_session_tracker(state, session_id, 0);
+  if (!session_tracker) {
+    return 0;
+  }
+
+  memset(session_tracker, 0, sizeof(*session_tracker));
+  return 1;
+}
+
 static int m7mux_stream_pump(M7MuxStreamState *state, uint64_t now_ms) {
   return m7mux_stream_expire(state, now_ms);
 }
@@ -460,6 +528,7 @@ static const M7MuxStreamLib _instance = {
   .ingest = m7mux_stream_ingest,
   .drain = m7mux_stream_drain,
   .expire = m7mux_stream_expire,
+  .release_session = m7mux_stream_release_session,
   .pump = m7mux_stream_pump
 };
 
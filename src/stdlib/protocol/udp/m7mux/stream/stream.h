@@ -29,6 +29,7 @@ typedef struct {
 typedef struct {
   uint64_t session_id;
   uint32_t next_stream_id;
+  uint64_t last_active_ms;
   int active;
   M7MuxStreamMessageTracker stream_trackers[M7MUX_STREAM_TRACKER_CAPACITY];
 } M7MuxStreamSessionTracker;
@@ -53,6 +54,7 @@ typedef struct {
   int (*ingest)(M7MuxStreamState *state, const M7MuxRecvPacket *normal);
   int (*drain)(M7MuxStreamState *state, M7MuxRecvPacket *out_normal);
   int (*expire)(M7MuxStreamState *state, uint64_t now_ms);
+  int (*release_session)(M7MuxStreamState *state, uint64_t session_id);
   int (*pump)(M7MuxStreamState *state, uint64_t now_ms);
 } M7MuxStreamLib;
 